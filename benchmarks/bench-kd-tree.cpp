@@ -0,0 +1,95 @@
+/* Nearest neighbour queries on KDTree3 from r2-kd-tree.hpp against the
+ * brute-force loop over LengthSquared it replaces. For growing point sets it
+ * prints the build time and the microseconds per query of single, threaded,
+ * 8 nearest and radius queries, and of the brute-force loop, which is also
+ * checked to agree with the tree.
+ */
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "r2-kd-tree.hpp"
+#include "r2-random.hpp"
+
+using namespace r2::Math;
+
+static const unsigned int K_QUERY_COUNT = 100000;
+static const unsigned int K_BRUTE_FORCE_QUERY_COUNT = 200;
+
+static std::vector<Vector3> RandomPoints(Random& p_random, unsigned int p_count) {
+	std::vector<SCALAR> values(3 * p_count);
+	p_random.Uniform(&values[0], 3 * p_count, -1.0f, 1.0f);
+
+	std::vector<Vector3> result(p_count);
+	for (unsigned int i = 0; i < p_count; ++i) result[i] = Vector3(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+	return result;
+}
+
+// Microseconds per item for p_count items
+template <typename Function>
+static double MeasureTime(unsigned int p_count, Function p_function) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	p_function();
+	std::chrono::duration<double, std::micro> microseconds = std::chrono::steady_clock::now() - start;
+	return microseconds.count() / p_count;
+}
+
+static unsigned int BruteForceNearest(const std::vector<Vector3>& p_points, const Vector3& p_point) {
+	SCALAR best_distance = 0.0f;
+	unsigned int best = KDTree3::K_NONE;
+	for (unsigned int i = 0; i < p_points.size(); ++i) {
+		SCALAR distance = (p_points[i] - p_point).LengthSquared();
+		if (best == KDTree3::K_NONE || distance < best_distance) {
+			best_distance = distance;
+			best = i;
+		}
+	}
+	return best;
+}
+
+int main() {
+	Random random(17);
+	std::vector<Vector3> queries = RandomPoints(random, K_QUERY_COUNT);
+
+	std::printf("%u queries, build in ms, queries in us per query\n", K_QUERY_COUNT);
+	std::printf("%-8s %8s %8s %8s %8s %8s %10s %9s\n", "points", "build", "1-NN", "threaded", "8-NN", "radius", "brute", "mismatch");
+
+	const unsigned int sizes[] = { 10000, 100000, 1000000 };
+	for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		std::vector<Vector3> points = RandomPoints(random, sizes[s]);
+
+		KDTree3 tree;
+		double build = MeasureTime(1, [&]() { tree.Build(&points[0], sizes[s]); }) / 1000.0;
+
+		std::vector<unsigned int> nearest(K_QUERY_COUNT), threaded(K_QUERY_COUNT), nearest_8(8 * K_QUERY_COUNT);
+		double single_time = MeasureTime(K_QUERY_COUNT, [&]() { tree.FindNearest(&queries[0], K_QUERY_COUNT, &nearest[0]); });
+		double threaded_time = MeasureTime(K_QUERY_COUNT, [&]() { tree.FindNearest(&queries[0], K_QUERY_COUNT, &threaded[0], 0); });
+		double nearest_8_time = MeasureTime(K_QUERY_COUNT, [&]() { tree.FindNearest(&queries[0], K_QUERY_COUNT, 8, &nearest_8[0]); });
+
+		// a radius holding about 8 points on average
+		const SCALAR radius = std::cbrt(8.0f * 8.0f / (4.18879f * sizes[s]));
+		std::vector<unsigned int> within;
+		double radius_time = MeasureTime(K_QUERY_COUNT, [&]() {
+			for (unsigned int i = 0; i < K_QUERY_COUNT; ++i) {
+				within.clear();
+				tree.FindInRadius(queries[i], radius, within);
+			}
+		});
+
+		// ties aside, the brute force must find the same points
+		unsigned int mismatches = 0;
+		double brute_force_time = MeasureTime(K_BRUTE_FORCE_QUERY_COUNT, [&]() {
+			for (unsigned int i = 0; i < K_BRUTE_FORCE_QUERY_COUNT; ++i) {
+				unsigned int best = BruteForceNearest(points, queries[i]);
+				if (best != nearest[i] && (points[best] - queries[i]).LengthSquared() != (points[nearest[i]] - queries[i]).LengthSquared()) ++mismatches;
+			}
+		});
+		for (unsigned int i = 0; i < K_QUERY_COUNT; ++i) {
+			if (threaded[i] != nearest[i]) ++mismatches;
+		}
+
+		std::printf("%-8u %8.2f %8.3f %8.3f %8.3f %8.3f %10.1f %9u\n", sizes[s], build, single_time, threaded_time, nearest_8_time, radius_time, brute_force_time, mismatches);
+	}
+
+	return 0;
+}
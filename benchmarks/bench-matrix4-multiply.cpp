@@ -0,0 +1,89 @@
+/* Cost of a Matrix4 product in r2-matrix-4.hpp, in nanoseconds per product
+ * for every instruction set: the GetColumn and Dot loop operator*= used to
+ * be, operator* on one pair at a time, and MultiplyArray over a whole
+ * palette. The results are checked to agree.
+ */
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "r2-matrix-4.hpp"
+#include "r2-random.hpp"
+#include "r2-simd.hpp"
+
+using namespace r2::Math;
+
+// a skinning palette's worth of matrices, small enough to stay in cache
+static const unsigned int K_MATRIX_COUNT = 4096;
+static const int K_REPETITIONS = 200;
+
+// operator*= before the multiply kernels: a column gathered and dotted per element
+static Matrix4 MultiplyByColumns(const Matrix4& p_lhs, const Matrix4& p_rhs) {
+	Matrix4 result;
+	for (unsigned int row = 0; row < Matrix4::K_DIMENSIONS; ++row) {
+		for (unsigned int col = 0; col < Matrix4::K_DIMENSIONS; ++col) {
+			result.m_elements[row][col] = p_lhs.GetRow(row).Dot(p_rhs.GetColumn(col));
+		}
+	}
+
+	return result;
+}
+
+// Nanoseconds per product for K_REPETITIONS runs over K_MATRIX_COUNT products
+template <typename Function>
+static double MeasureTime(Function p_function) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int r = 0; r < K_REPETITIONS; ++r) p_function();
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+	return seconds.count() * 1e9 / (K_MATRIX_COUNT * (double)K_REPETITIONS);
+}
+
+// The largest difference between two arrays of products
+static SCALAR MaxDifference(const std::vector<Matrix4>& p_lhs, const std::vector<Matrix4>& p_rhs) {
+	SCALAR result = 0.0f;
+	for (unsigned int i = 0; i < K_MATRIX_COUNT; ++i) {
+		for (unsigned int e = 0; e < 16; ++e) result = std::max(result, std::fabs(p_lhs[i].m_data[e] - p_rhs[i].m_data[e]));
+	}
+
+	return result;
+}
+
+int main() {
+	Random random(5);
+
+	std::vector<Matrix4> lhs(K_MATRIX_COUNT), rhs(K_MATRIX_COUNT);
+	for (unsigned int i = 0; i < K_MATRIX_COUNT; ++i) {
+		random.Uniform(lhs[i].m_data, 16, -1.0f, 1.0f);
+		random.Uniform(rhs[i].m_data, 16, -1.0f, 1.0f);
+	}
+
+	std::vector<Matrix4> by_columns(K_MATRIX_COUNT), by_operator(K_MATRIX_COUNT), by_array(K_MATRIX_COUNT);
+
+	std::printf("%u products, ns per product\n", K_MATRIX_COUNT);
+	std::printf("%-8s %10s %10s %14s %10s\n", "", "columns", "operator*", "MultiplyArray", "max diff");
+
+	const SIMD::InstructionSet::InstructionSet supported = SIMD::GetInstructionSet();
+	const SIMD::InstructionSet::InstructionSet sets[] = { SIMD::InstructionSet::Scalar, SIMD::InstructionSet::SSE2, SIMD::InstructionSet::AVX2 };
+	const char* set_names[] = { "Scalar", "SSE2", "AVX2" };
+	for (unsigned int s = 0; s < sizeof(sets) / sizeof(sets[0]); ++s) {
+		if (sets[s] > supported) continue;
+		SIMD::SetInstructionSet(sets[s]);
+
+		double columns_time = MeasureTime([&]() {
+			for (unsigned int i = 0; i < K_MATRIX_COUNT; ++i) by_columns[i] = MultiplyByColumns(lhs[i], rhs[i]);
+		});
+		double operator_time = MeasureTime([&]() {
+			for (unsigned int i = 0; i < K_MATRIX_COUNT; ++i) by_operator[i] = lhs[i] * rhs[i];
+		});
+		double array_time = MeasureTime([&]() {
+			MultiplyArray(&lhs[0], &rhs[0], &by_array[0], K_MATRIX_COUNT);
+		});
+
+		SCALAR difference = std::max(MaxDifference(by_columns, by_operator), MaxDifference(by_columns, by_array));
+		std::printf("%-8s %10.2f %10.2f %14.2f %10.2e\n", set_names[s], columns_time, operator_time, array_time, difference);
+	}
+	SIMD::SetInstructionSet(supported);
+
+	return 0;
+}
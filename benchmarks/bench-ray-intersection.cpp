@@ -0,0 +1,127 @@
+/* Throughput of the ray packet intersection kernels in r2-ray-intersection.hpp,
+ * in million rays (or primitives) per second for every instruction set, next
+ * to a single ray Moller-Trumbore written with Vector3 Cross and Dot.
+ */
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include "r2-ray-intersection.hpp"
+#include "r2-random.hpp"
+#include "r2-simd.hpp"
+
+using namespace r2::Math;
+
+static const unsigned int K_RAY_COUNT = 1 << 16;
+static const int K_REPETITIONS = 50;
+
+static Vector3 RandomVector(Random& p_random, SCALAR p_min, SCALAR p_max) {
+	SCALAR values[3];
+	p_random.Uniform(values, 3, p_min, p_max);
+	return Vector3(values[0], values[1], values[2]);
+}
+
+// Million tests per second for K_REPETITIONS runs over K_RAY_COUNT rays or primitives
+template <typename Function>
+static double MeasureThroughput(Function p_function) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int r = 0; r < K_REPETITIONS; ++r) p_function(r);
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+	return K_RAY_COUNT * (double)K_REPETITIONS / seconds.count() / 1e6;
+}
+
+static bool NaiveIntersectTriangle(const Vector3& p_origin, const Vector3& p_direction, const Vector3& p_v0, const Vector3& p_v1, const Vector3& p_v2) {
+	Vector3 edge1 = p_v1 - p_v0;
+	Vector3 edge2 = p_v2 - p_v0;
+	Vector3 p = p_direction.Cross(edge2);
+	SCALAR determinant = edge1.Dot(p);
+	if (determinant == 0.0f) return false;
+
+	SCALAR inverse = 1.0f / determinant;
+	Vector3 s = p_origin - p_v0;
+	SCALAR u = s.Dot(p) * inverse;
+	if (u < 0.0f || u > 1.0f) return false;
+
+	Vector3 q = s.Cross(edge1);
+	SCALAR v = p_direction.Dot(q) * inverse;
+	if (v < 0.0f || u + v > 1.0f) return false;
+	return edge2.Dot(q) * inverse >= 0.0f;
+}
+
+int main() {
+	Random random(19);
+
+	// rays from z = -5 roughly along +z, at triangles and boxes around the origin
+	std::vector<Vector3> origins(K_RAY_COUNT), directions(K_RAY_COUNT), inverse_directions(K_RAY_COUNT);
+	std::vector<Vector3> v0(K_RAY_COUNT), v1(K_RAY_COUNT), v2(K_RAY_COUNT);
+	std::vector<Vector3> mins(K_RAY_COUNT), maxs(K_RAY_COUNT);
+	for (unsigned int i = 0; i < K_RAY_COUNT; ++i) {
+		origins[i] = RandomVector(random, -1.0f, 1.0f) + Vector3(0.0f, 0.0f, -5.0f);
+		directions[i] = Vector3(0.0f, 0.0f, 1.0f) + RandomVector(random, -0.3f, 0.3f);
+		inverse_directions[i] = Vector3(1.0f / directions[i].x, 1.0f / directions[i].y, 1.0f / directions[i].z);
+
+		Vector3 center = RandomVector(random, -3.0f, 3.0f);
+		v0[i] = center + RandomVector(random, -1.0f, 1.0f);
+		v1[i] = center + RandomVector(random, -1.0f, 1.0f);
+		v2[i] = center + RandomVector(random, -1.0f, 1.0f);
+		mins[i] = center - Vector3(0.5f, 0.5f, 0.5f);
+		maxs[i] = center + Vector3(0.5f, 0.5f, 0.5f);
+	}
+
+	Vector3Stream origin_stream(&origins[0], K_RAY_COUNT);
+	Vector3Stream direction_stream(&directions[0], K_RAY_COUNT);
+	Vector3Stream inverse_direction_stream(&inverse_directions[0], K_RAY_COUNT);
+	Vector3Stream v0_stream(&v0[0], K_RAY_COUNT);
+	Vector3Stream v1_stream(&v1[0], K_RAY_COUNT);
+	Vector3Stream v2_stream(&v2[0], K_RAY_COUNT);
+	Vector3Stream min_stream(&mins[0], K_RAY_COUNT);
+	Vector3Stream max_stream(&maxs[0], K_RAY_COUNT);
+
+	const Vector3 triangle[3] = { Vector3(-1.0f, -1.0f, 0.0f), Vector3(1.0f, -1.0f, 0.5f), Vector3(0.0f, 1.0f, 0.2f) };
+	const Vector3 box_min(-1.0f, -1.0f, -1.0f);
+	const Vector3 box_max(1.0f, 1.0f, 1.0f);
+
+	std::vector<RayHit> hits(K_RAY_COUNT);
+	std::vector<unsigned int> mask(K_RAY_COUNT / 32);
+
+	std::printf("Million tests per second, %u rays or primitives\n", K_RAY_COUNT);
+	std::printf("%-8s %14s %14s %14s %14s\n", "", "rays x tri", "ray x tris", "rays x box", "ray x boxes");
+
+	const SIMD::InstructionSet::InstructionSet supported = SIMD::GetInstructionSet();
+	const SIMD::InstructionSet::InstructionSet sets[] = { SIMD::InstructionSet::Scalar, SIMD::InstructionSet::SSE2, SIMD::InstructionSet::AVX2 };
+	const char* set_names[] = { "Scalar", "SSE2", "AVX2" };
+	for (unsigned int s = 0; s < sizeof(sets) / sizeof(sets[0]); ++s) {
+		if (sets[s] > supported) continue;
+		SIMD::SetInstructionSet(sets[s]);
+
+		double rays_triangle = MeasureThroughput([&](int) {
+			for (unsigned int i = 0; i < K_RAY_COUNT; ++i) {
+				hits[i].m_distance = 1e30f;
+				hits[i].m_primitive = RayHit::K_NO_HIT;
+			}
+			IntersectTriangle(origin_stream, direction_stream, triangle[0], triangle[1], triangle[2], &hits[0]);
+		});
+		double ray_triangles = MeasureThroughput([&](int p_repetition) {
+			RayHit hit = { 1e30f, RayHit::K_NO_HIT, 0.0f, 0.0f };
+			IntersectTriangles(origins[p_repetition], directions[p_repetition], v0_stream, v1_stream, v2_stream, hit);
+		});
+		double rays_box = MeasureThroughput([&](int) {
+			IntersectBox(origin_stream, inverse_direction_stream, box_min, box_max, 100.0f, &mask[0]);
+		});
+		double ray_boxes = MeasureThroughput([&](int p_repetition) {
+			IntersectBoxes(origins[p_repetition], inverse_directions[p_repetition], min_stream, max_stream, 100.0f, &mask[0]);
+		});
+
+		std::printf("%-8s %14.1f %14.1f %14.1f %14.1f\n", set_names[s], rays_triangle, ray_triangles, rays_box, ray_boxes);
+	}
+	SIMD::SetInstructionSet(supported);
+
+	unsigned int naive_hits = 0;
+	double naive = MeasureThroughput([&](int) {
+		for (unsigned int i = 0; i < K_RAY_COUNT; ++i) {
+			naive_hits += NaiveIntersectTriangle(origins[i], directions[i], triangle[0], triangle[1], triangle[2]);
+		}
+	});
+	std::printf("%-8s %14.1f (Vector3 Cross/Dot, %u hits)\n", "Naive", naive, naive_hits);
+
+	return 0;
+}
@@ -0,0 +1,253 @@
+#include "r2-affine-transform.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include <cstring>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2
+{
+	namespace Math
+	{
+		AffineTransform::AffineTransform(const Matrix4& p_matrix) {
+			memcpy(m_data, p_matrix.m_data, sizeof(m_data));
+		}
+
+		Matrix4 AffineTransform::GetMatrix4() const {
+			Matrix4 result;
+			memcpy(result.m_data, m_data, sizeof(m_data));
+			result.m_elements[3][3] = 1.0f;
+
+			return result;
+		}
+
+		Matrix3 AffineTransform::GetLinear() const {
+			return Matrix3(m_elements[0][0], m_elements[0][1], m_elements[0][2],
+						   m_elements[1][0], m_elements[1][1], m_elements[1][2],
+						   m_elements[2][0], m_elements[2][1], m_elements[2][2]);
+		}
+
+		Vector3 AffineTransform::GetTranslation() const {
+			return Vector3(m_elements[0][3], m_elements[1][3], m_elements[2][3]);
+		}
+
+		void AffineTransform::SetLinear(const Matrix3& p_linear) {
+			for (int row = 0; row < 3; ++row) {
+				for (int col = 0; col < 3; ++col) {
+					m_elements[row][col] = p_linear.m_elements[row][col];
+				}
+			}
+		}
+
+		void AffineTransform::SetTranslation(const Vector3& p_translation) {
+			for (int row = 0; row < 3; ++row) {
+				m_elements[row][3] = p_translation.m_data[row];
+			}
+		}
+
+		Vector3 AffineTransform::TransformPoint(const Vector3& p_point) const {
+			const SCALAR (*m)[K_COLUMNS] = m_elements;
+			return Vector3(m[0][0] * p_point.x + m[0][1] * p_point.y + m[0][2] * p_point.z + m[0][3],
+						   m[1][0] * p_point.x + m[1][1] * p_point.y + m[1][2] * p_point.z + m[1][3],
+						   m[2][0] * p_point.x + m[2][1] * p_point.y + m[2][2] * p_point.z + m[2][3]);
+		}
+
+		Vector3 AffineTransform::TransformVector(const Vector3& p_vector) const {
+			const SCALAR (*m)[K_COLUMNS] = m_elements;
+			return Vector3(m[0][0] * p_vector.x + m[0][1] * p_vector.y + m[0][2] * p_vector.z,
+						   m[1][0] * p_vector.x + m[1][1] * p_vector.y + m[1][2] * p_vector.z,
+						   m[2][0] * p_vector.x + m[2][1] * p_vector.y + m[2][2] * p_vector.z);
+		}
+
+
+
+		SCALAR& AffineTransform::operator()(unsigned int p_row, unsigned int p_col) {
+			return m_elements[p_row][p_col];
+		}
+
+		AffineTransform& AffineTransform::operator*=(const AffineTransform& p_rhs) {
+			MultiplyArray(this, &p_rhs, this, 1);
+			return *this;
+		}
+
+		SCALAR AffineTransform::Determinant() const {
+			const SCALAR (*m)[K_COLUMNS] = m_elements;
+			return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) +
+				   m[0][1] * (m[1][2] * m[2][0] - m[1][0] * m[2][2]) +
+				   m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+		}
+
+		AffineTransform& AffineTransform::Invert() {
+			AffineTransform result;
+			if (!priv::InvertAffineRows(m_elements, result.m_elements)) throw r2ExceptionDivisionByZeroM("Singular transform cannot be inverted");
+
+			*this = result;
+			return *this;
+		}
+
+		AffineTransform& AffineTransform::InvertRigid() {
+			AffineTransform result;
+			for (int row = 0; row < 3; ++row) {
+				for (int col = 0; col < 3; ++col) {
+					result.m_elements[row][col] = m_elements[col][row];
+				}
+			}
+
+			for (int row = 0; row < 3; ++row) {
+				result.m_elements[row][3] = -(result.m_elements[row][0] * m_elements[0][3] +
+											  result.m_elements[row][1] * m_elements[1][3] +
+											  result.m_elements[row][2] * m_elements[2][3]);
+			}
+
+			*this = result;
+			return *this;
+		}
+
+
+
+		AffineTransform operator*(const AffineTransform& p_lhs, const AffineTransform& p_rhs) {
+			AffineTransform result;
+			MultiplyArray(&p_lhs, &p_rhs, &result, 1);
+			return result;
+		}
+
+		bool operator==(const AffineTransform& p_lhs, const AffineTransform& p_rhs) {
+			for (unsigned int i = 0; i < AffineTransform::K_ROWS * AffineTransform::K_COLUMNS; ++i) {
+				if (!FloatCompare(p_lhs.m_data[i], p_rhs.m_data[i])) return false;
+			}
+
+			return true;
+		}
+
+		bool operator!=(const AffineTransform& p_lhs, const AffineTransform& p_rhs) {
+			return !(p_lhs == p_rhs);
+		}
+
+		std::ostream& operator<<(std::ostream& p_lhs, const AffineTransform& p_rhs) {
+			for (unsigned int row = 0; row < AffineTransform::K_ROWS; ++row) {
+				p_lhs << "[";
+				for (unsigned int col = 0; col < AffineTransform::K_COLUMNS; ++col) {
+					p_lhs << p_rhs.m_elements[row][col];
+					if (col != AffineTransform::K_COLUMNS - 1)
+						p_lhs << ", ";
+				}
+				p_lhs << "]";
+
+				if (row != AffineTransform::K_ROWS - 1)
+					p_lhs << "\n";
+			}
+
+			return p_lhs;
+		}
+
+		AffineTransform GetInverse(const AffineTransform& p_transform) {
+			return AffineTransform(p_transform).Invert();
+		}
+
+		AffineTransform GetInverseRigid(const AffineTransform& p_transform) {
+			return AffineTransform(p_transform).InvertRigid();
+		}
+
+
+
+		// Row i of the product is lhs[i][0] * rhs_row_0 + lhs[i][1] * rhs_row_1 + lhs[i][2] * rhs_row_2
+		// + lhs[i][3] * (0, 0, 0, 1), so the implied last row only adds lhs[i][3] to the translation.
+		static void ScalarMultiply(const AffineTransform* p_lhs, const AffineTransform* p_rhs, AffineTransform* p_result, std::size_t p_count) {
+			for (std::size_t i = 0; i < p_count; ++i) {
+				const SCALAR* a = p_lhs[i].m_data;
+				const SCALAR* b = p_rhs[i].m_data;
+				SCALAR result[AffineTransform::K_ROWS * AffineTransform::K_COLUMNS];
+
+				for (int row = 0; row < 12; row += 4) {
+					SCALAR a_0 = a[row + 0];
+					SCALAR a_1 = a[row + 1];
+					SCALAR a_2 = a[row + 2];
+
+					result[row + 0] = a_0 * b[0] + a_1 * b[4] + a_2 * b[8];
+					result[row + 1] = a_0 * b[1] + a_1 * b[5] + a_2 * b[9];
+					result[row + 2] = a_0 * b[2] + a_1 * b[6] + a_2 * b[10];
+					result[row + 3] = a_0 * b[3] + a_1 * b[7] + a_2 * b[11] + a[row + 3];
+				}
+
+				memcpy(p_result[i].m_data, result, sizeof(result));
+			}
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static void SSE2Multiply(const AffineTransform* p_lhs, const AffineTransform* p_rhs, AffineTransform* p_result, std::size_t p_count) {
+			__m128 translation_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				const SCALAR* a = p_lhs[i].m_data;
+				const SCALAR* b = p_rhs[i].m_data;
+				__m128 b_0 = _mm_loadu_ps(b);
+				__m128 b_1 = _mm_loadu_ps(b + 4);
+				__m128 b_2 = _mm_loadu_ps(b + 8);
+
+				__m128 rows[3];
+				for (int row = 0; row < 3; ++row) {
+					__m128 a_row = _mm_loadu_ps(a + row * 4);
+					__m128 result = _mm_and_ps(a_row, translation_mask);
+					result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(a_row, a_row, _MM_SHUFFLE(0, 0, 0, 0)), b_0));
+					result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(a_row, a_row, _MM_SHUFFLE(1, 1, 1, 1)), b_1));
+					result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(a_row, a_row, _MM_SHUFFLE(2, 2, 2, 2)), b_2));
+					rows[row] = result;
+				}
+
+				SCALAR* out = p_result[i].m_data;
+				_mm_storeu_ps(out, rows[0]);
+				_mm_storeu_ps(out + 4, rows[1]);
+				_mm_storeu_ps(out + 8, rows[2]);
+			}
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static void FMAMultiply(const AffineTransform* p_lhs, const AffineTransform* p_rhs, AffineTransform* p_result, std::size_t p_count) {
+			__m128 translation_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				const SCALAR* a = p_lhs[i].m_data;
+				const SCALAR* b = p_rhs[i].m_data;
+				__m128 b_0 = _mm_loadu_ps(b);
+				__m128 b_1 = _mm_loadu_ps(b + 4);
+				__m128 b_2 = _mm_loadu_ps(b + 8);
+
+				__m128 rows[3];
+				for (int row = 0; row < 3; ++row) {
+					__m128 result = _mm_and_ps(_mm_loadu_ps(a + row * 4), translation_mask);
+					result = _mm_fmadd_ps(_mm_broadcast_ss(a + row * 4), b_0, result);
+					result = _mm_fmadd_ps(_mm_broadcast_ss(a + row * 4 + 1), b_1, result);
+					result = _mm_fmadd_ps(_mm_broadcast_ss(a + row * 4 + 2), b_2, result);
+					rows[row] = result;
+				}
+
+				SCALAR* out = p_result[i].m_data;
+				_mm_storeu_ps(out, rows[0]);
+				_mm_storeu_ps(out + 4, rows[1]);
+				_mm_storeu_ps(out + 8, rows[2]);
+			}
+		}
+#endif
+
+		void MultiplyArray(const AffineTransform* p_lhs, const AffineTransform* p_rhs, AffineTransform* p_result, std::size_t p_count) {
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) return FMAMultiply(p_lhs, p_rhs, p_result, p_count);
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) return SSE2Multiply(p_lhs, p_rhs, p_result, p_count);
+#endif
+			ScalarMultiply(p_lhs, p_rhs, p_result, p_count);
+		}
+
+		// The Matrix4 kernels already treat the last row as implied for points and
+		// directions, so an affine transform costs the same per vector through them.
+		void TransformPoints(const AffineTransform& p_transform, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count) {
+			TransformPoints(p_transform.GetMatrix4(), p_in, p_out, p_count, p_thread_count);
+		}
+
+		void TransformVectors(const AffineTransform& p_transform, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count) {
+			TransformVectors(p_transform.GetMatrix4(), p_in, p_out, p_count, p_thread_count);
+		}
+	}
+}
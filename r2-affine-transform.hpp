@@ -0,0 +1,194 @@
+/* HEADER
+ *
+ * File: r2-affine-transform.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	An affine transform stored as the upper 3x4 part of a Matrix4 - a 3x3
+ *	linear part and a translation column - with the implied last row
+ *	(0, 0, 0, 1). Uses 48 bytes instead of 64 and composes with 36
+ *	multiplies instead of 64.
+ * Depends on:
+ *  * SCALAR
+ *  * FloatCompare
+ *  * r2::Exception::DivisionByZero
+ *  * r2::Math::SIMD
+ *  * Vector3, Matrix3, Matrix4
+ * Updates:
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
+ */
+#ifndef R2_AFFINE_TRANSFORM_HPP
+#define R2_AFFINE_TRANSFORM_HPP
+
+#include <cstddef>
+#include <ostream>
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-matrix-3.hpp"
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		class AffineTransform {
+		public:
+			/**
+			 * Initialize the identity transform
+			 */
+			constexpr AffineTransform();
+
+			/**
+			 * Initialize the transform with the given elements. Row order, so for
+			 * instance p_03 is the x component of the translation.
+			 */
+			constexpr AffineTransform(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_03,
+							SCALAR p_10, SCALAR p_11, SCALAR p_12, SCALAR p_13,
+							SCALAR p_20, SCALAR p_21, SCALAR p_22, SCALAR p_23);
+
+			/**
+			 * Initialize the transform from a linear part and a translation
+			 */
+			constexpr AffineTransform(const Matrix3& p_linear, const Vector3& p_translation);
+
+			/**
+			 * Initialize the transform from the upper 3x4 part of a matrix. The
+			 * last row of the matrix is assumed to be (0, 0, 0, 1).
+			 */
+			explicit AffineTransform(const Matrix4& p_matrix);
+
+
+			/**
+			 * Get the transform as a full matrix
+			 */
+			Matrix4 GetMatrix4() const;
+
+			/**
+			 * Methods for accessing and setting the linear part and the translation
+			 */
+			Matrix3 GetLinear() const;
+			Vector3 GetTranslation() const;
+			void SetLinear(const Matrix3& p_linear);
+			void SetTranslation(const Vector3& p_translation);
+
+			/**
+			 * Transform a point (translated) or a direction (not translated)
+			 */
+			Vector3 TransformPoint(const Vector3& p_point) const;
+			Vector3 TransformVector(const Vector3& p_vector) const;
+
+
+			/**
+			 * Operators
+			 */
+			SCALAR& operator()(unsigned int p_row, unsigned int p_col);
+			AffineTransform& operator*=(const AffineTransform& p_rhs);
+
+			/**
+			 * Calculate the determinant of the linear part
+			 */
+			SCALAR Determinant() const;
+
+			/**
+			 * Invert this transform, if possible. If the linear part is singular,
+			 * a DivisionByZero exception is raised.
+			 */
+			AffineTransform& Invert();
+
+			/**
+			 * Invert this transform, assuming it is rigid - i.e. the linear part is
+			 * orthonormal (a rotation). The rotation is transposed, no check is made
+			 * for the assumption.
+			 */
+			AffineTransform& InvertRigid();
+
+
+			static const unsigned int K_ROWS = 3;
+			static const unsigned int K_COLUMNS = 4;
+			union {
+				/**
+				 * All data is in row order - i.e. the first array index
+				 * in m_elements is the row index.
+				 */
+				SCALAR m_data[K_ROWS * K_COLUMNS];
+				SCALAR m_elements[K_ROWS][K_COLUMNS];
+			};
+
+			static const AffineTransform K_IDENTITY;
+		};
+
+		/**
+		 * Operators. p_lhs * p_rhs applies p_rhs first.
+		 */
+		AffineTransform operator*(const AffineTransform& p_lhs, const AffineTransform& p_rhs);
+		bool operator==(const AffineTransform& p_lhs, const AffineTransform& p_rhs);
+		bool operator!=(const AffineTransform& p_lhs, const AffineTransform& p_rhs);
+		std::ostream& operator<<(std::ostream& p_lhs, const AffineTransform& p_rhs);
+
+		/**
+		 * Get the inverse of the transform, if possible. If the linear part is
+		 * singular, a DivisionByZero exception is raised.
+		 */
+		AffineTransform GetInverse(const AffineTransform& p_transform);
+
+		/**
+		 * Get the inverse of a rigid transform (orthonormal linear part)
+		 */
+		AffineTransform GetInverseRigid(const AffineTransform& p_transform);
+
+		/**
+		 * Compose p_count pairs of transforms, p_result[i] = p_lhs[i] * p_rhs[i]. The
+		 * result array may be the same as either operand array.
+		 */
+		void MultiplyArray(const AffineTransform* p_lhs, const AffineTransform* p_rhs, AffineTransform* p_result, std::size_t p_count);
+
+		/**
+		 * Batched transforms of arrays of p_count vectors, as for Matrix4. p_in and
+		 * p_out may be the same array, but must not otherwise overlap. Large arrays
+		 * are split over p_thread_count threads (0 uses all hardware threads).
+		 */
+		void TransformPoints(const AffineTransform& p_transform, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count = 1);
+		void TransformVectors(const AffineTransform& p_transform, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count = 1);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr AffineTransform::AffineTransform()
+			: m_data{1.0f, 0.0f, 0.0f, 0.0f,
+					 0.0f, 1.0f, 0.0f, 0.0f,
+					 0.0f, 0.0f, 1.0f, 0.0f} {}
+
+		constexpr AffineTransform::AffineTransform(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_03,
+												   SCALAR p_10, SCALAR p_11, SCALAR p_12, SCALAR p_13,
+												   SCALAR p_20, SCALAR p_21, SCALAR p_22, SCALAR p_23)
+			: m_data{p_00, p_01, p_02, p_03,
+					 p_10, p_11, p_12, p_13,
+					 p_20, p_21, p_22, p_23} {}
+
+		constexpr AffineTransform::AffineTransform(const Matrix3& p_linear, const Vector3& p_translation)
+			: m_data{p_linear.m_data[0], p_linear.m_data[1], p_linear.m_data[2], p_translation.x,
+					 p_linear.m_data[3], p_linear.m_data[4], p_linear.m_data[5], p_translation.y,
+					 p_linear.m_data[6], p_linear.m_data[7], p_linear.m_data[8], p_translation.z} {}
+
+		inline constexpr AffineTransform AffineTransform::K_IDENTITY;
+	}
+}
+
+#endif
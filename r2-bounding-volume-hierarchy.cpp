@@ -0,0 +1,742 @@
+#include "r2-bounding-volume-hierarchy.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include "r2-parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		typedef BoundingVolumeHierarchy::Node BVHNode;
+
+		static const unsigned int K_BIN_COUNT = 16;
+		static const unsigned int K_MAX_LEAF_SIZE = 8;
+
+		// the cost of visiting a node, relative to intersecting one primitive
+		static const float K_TRAVERSAL_COST = 1.0f;
+
+		// below this depth nodes are split at the median instead, which bounds the
+		// depth by K_MAX_SAH_DEPTH + 32 and lets traversal use a fixed stack
+		static const unsigned int K_MAX_SAH_DEPTH = 64;
+		static const unsigned int K_STACK_SIZE = 128;
+		static const unsigned int K_NO_NODE = 0xFFFFFFFFu;
+
+		// primitives per subtree handed to a thread, and the rays per thread
+		static const unsigned int K_MIN_SUBTREE_SIZE = 4096;
+		static const unsigned int K_MIN_RAY_PACKETS = 64;
+
+		static const float K_LARGE = 3.402823e38f;
+		static const float K_MIN_DETERMINANT = 1e-12f;
+
+		static const std::size_t K_NODE_ALIGNMENT = 64;
+
+
+
+		/**
+		 * Building. The primitives are reduced to boxes with centers, which are
+		 * partitioned in place as the nodes are split, so every node (and every
+		 * subtree built on another thread) owns one contiguous range of them.
+		 * Moving the boxes rather than indices to them keeps all passes over a
+		 * node sequential in memory.
+		 */
+		struct BuildBox {
+			float m_min[3];
+			float m_max[3];
+
+			void Reset() {
+				for (int a = 0; a < 3; ++a) {
+					m_min[a] = K_LARGE;
+					m_max[a] = -K_LARGE;
+				}
+			}
+
+			// written so that it compiles to min/max instructions rather than branches
+			void Grow(const float* p_min, const float* p_max) {
+				for (int a = 0; a < 3; ++a) {
+					float low = m_min[a], high = m_max[a];
+					m_min[a] = (p_min[a] < low) ? p_min[a] : low;
+					m_max[a] = (p_max[a] > high) ? p_max[a] : high;
+				}
+			}
+
+			float HalfArea() const {
+				float x = m_max[0] - m_min[0], y = m_max[1] - m_min[1], z = m_max[2] - m_min[2];
+				return x * y + y * z + z * x;
+			}
+		};
+
+		struct PrimitiveBounds {
+			float m_min[3];
+			float m_max[3];
+			float m_center[3];
+			unsigned int m_index;
+		};
+
+		struct BuildTask {
+			unsigned int m_node;
+			unsigned int m_begin;
+			unsigned int m_end;
+			unsigned int m_depth;
+		};
+
+		struct BinSplit {
+			unsigned int m_axis;
+			unsigned int m_bin;
+			unsigned int m_bin_count;
+			float m_min;
+			float m_scale;
+
+			unsigned int GetBin(const PrimitiveBounds& p_bounds) const {
+				int bin = static_cast<int>((p_bounds.m_center[m_axis] - m_min) * m_scale);
+				return static_cast<unsigned int>(std::min(std::max(bin, 0), static_cast<int>(m_bin_count) - 1));
+			}
+		};
+
+		// Find the cheapest binned split, false if a leaf is cheaper or no split
+		// exists. Small nodes get fewer bins, as the sweeps would otherwise cost
+		// more than the binning.
+		static bool FindSplit(const PrimitiveBounds* p_bounds, unsigned int p_begin, unsigned int p_end,
+							  const BuildBox& p_box, const BuildBox& p_centers, BinSplit& p_split) {
+			unsigned int count = p_end - p_begin;
+			float best_cost = (count <= K_MAX_LEAF_SIZE) ? static_cast<float>(count) : K_LARGE;
+			float inverse_area = 1.0f / std::max(p_box.HalfArea(), 1e-30f);
+			bool found = false;
+
+			BinSplit splits[3];
+			BuildBox bins[3][K_BIN_COUNT];
+			unsigned int counts[3][K_BIN_COUNT];
+			unsigned int bin_count = std::min(count, K_BIN_COUNT);
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				float extent = p_centers.m_max[axis] - p_centers.m_min[axis];
+				splits[axis].m_axis = axis;
+				splits[axis].m_bin = 0;
+				splits[axis].m_bin_count = bin_count;
+				splits[axis].m_min = p_centers.m_min[axis];
+				splits[axis].m_scale = (extent > 0.0f) ? bin_count / extent : 0.0f;
+
+				for (unsigned int b = 0; b < bin_count; ++b) {
+					bins[axis][b].Reset();
+					counts[axis][b] = 0;
+				}
+			}
+
+			// all three axes in one pass over the primitives
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				const PrimitiveBounds& bounds = p_bounds[i];
+				for (unsigned int axis = 0; axis < 3; ++axis) {
+					unsigned int bin = splits[axis].GetBin(bounds);
+					bins[axis][bin].Grow(bounds.m_min, bounds.m_max);
+					++counts[axis][bin];
+				}
+			}
+
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				if (!(p_centers.m_max[axis] > p_centers.m_min[axis])) continue;
+
+				// sweep from the right, then evaluate every plane sweeping from the left
+				float right_area[K_BIN_COUNT];
+				unsigned int right_count[K_BIN_COUNT];
+				BuildBox right;
+				right.Reset();
+				unsigned int running = 0;
+				for (unsigned int b = bin_count - 1; b > 0; --b) {
+					right.Grow(bins[axis][b].m_min, bins[axis][b].m_max);
+					running += counts[axis][b];
+					right_area[b] = right.HalfArea();
+					right_count[b] = running;
+				}
+
+				BuildBox left;
+				left.Reset();
+				running = 0;
+				for (unsigned int b = 0; b + 1 < bin_count; ++b) {
+					left.Grow(bins[axis][b].m_min, bins[axis][b].m_max);
+					running += counts[axis][b];
+					if (running == 0 || right_count[b + 1] == 0) continue;
+
+					float cost = K_TRAVERSAL_COST + (left.HalfArea() * running + right_area[b + 1] * right_count[b + 1]) * inverse_area;
+					if (cost < best_cost) {
+						best_cost = cost;
+						p_split = splits[axis];
+						p_split.m_bin = b;
+						found = true;
+					}
+				}
+			}
+
+			return found;
+		}
+
+		static void BuildNodes(PrimitiveBounds* p_bounds, std::vector<BVHNode>& p_nodes, const BuildTask& p_root,
+							   unsigned int p_defer_size, std::vector<BuildTask>* p_deferred) {
+			std::vector<BuildTask> tasks(1, p_root);
+			while (!tasks.empty()) {
+				BuildTask task = tasks.back();
+				tasks.pop_back();
+
+				BuildBox box, centers;
+				box.Reset();
+				centers.Reset();
+				for (unsigned int i = task.m_begin; i < task.m_end; ++i) {
+					const PrimitiveBounds& bounds = p_bounds[i];
+					box.Grow(bounds.m_min, bounds.m_max);
+					centers.Grow(bounds.m_center, bounds.m_center);
+				}
+
+				BVHNode& node = p_nodes[task.m_node];
+				memcpy(node.m_min, box.m_min, sizeof(node.m_min));
+				memcpy(node.m_max, box.m_max, sizeof(node.m_max));
+
+				unsigned int count = task.m_end - task.m_begin;
+				if (p_deferred != 0 && count <= p_defer_size) {
+					p_deferred->push_back(task);
+					continue;
+				}
+
+				unsigned int middle;
+				BinSplit split;
+				if (count <= 1) {
+					middle = task.m_begin;
+				} else if (task.m_depth < K_MAX_SAH_DEPTH && FindSplit(p_bounds, task.m_begin, task.m_end, box, centers, split)) {
+					middle = static_cast<unsigned int>(std::partition(p_bounds + task.m_begin, p_bounds + task.m_end, [&](const PrimitiveBounds& p_primitive) {
+						return split.GetBin(p_primitive) <= split.m_bin;
+					}) - p_bounds);
+				} else if (count <= K_MAX_LEAF_SIZE) {
+					middle = task.m_begin;
+				} else {
+					// no useful plane (or too deep), so halve along the longest axis
+					unsigned int axis = 0;
+					for (unsigned int a = 1; a < 3; ++a) {
+						if (centers.m_max[a] - centers.m_min[a] > centers.m_max[axis] - centers.m_min[axis]) axis = a;
+					}
+
+					middle = task.m_begin + count / 2;
+					std::nth_element(p_bounds + task.m_begin, p_bounds + middle, p_bounds + task.m_end, [&](const PrimitiveBounds& p_lhs, const PrimitiveBounds& p_rhs) {
+						return p_lhs.m_center[axis] < p_rhs.m_center[axis];
+					});
+				}
+
+				if (middle == task.m_begin || middle == task.m_end) {
+					node.m_first = task.m_begin;
+					node.m_count = count;
+					continue;
+				}
+
+				unsigned int children = static_cast<unsigned int>(p_nodes.size());
+				node.m_first = children;
+				node.m_count = 0;
+				p_nodes.resize(children + 2);
+
+				BuildTask left = { children, task.m_begin, middle, task.m_depth + 1 };
+				BuildTask right = { children + 1, middle, task.m_end, task.m_depth + 1 };
+				tasks.push_back(right);
+				tasks.push_back(left);
+			}
+		}
+
+		// Builds the upper levels on this thread until there are a few subtrees
+		// per thread, then the subtrees in parallel, each into its own array.
+		static void BuildSubtrees(PrimitiveBounds* p_bounds, unsigned int p_count, unsigned int p_thread_count, std::vector<BVHNode>& p_nodes) {
+			BuildTask root = { 0, 0, p_count, 0 };
+			unsigned int thread_count = Parallel::GetThreadCount(p_thread_count);
+
+			std::vector<BuildTask> deferred;
+			unsigned int defer_size = std::max(p_count / (4 * thread_count), K_MIN_SUBTREE_SIZE);
+			BuildNodes(p_bounds, p_nodes, root, defer_size, &deferred);
+
+			std::vector<std::vector<BVHNode> > subtrees(deferred.size());
+			Parallel::For(deferred.size(), 1, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				for (std::size_t i = p_begin; i < p_end; ++i) {
+					subtrees[i].resize(2);
+					memset(&subtrees[i][0], 0, 2 * sizeof(BVHNode));
+
+					BuildTask subtree_root = { 0, deferred[i].m_begin, deferred[i].m_end, deferred[i].m_depth };
+					BuildNodes(p_bounds, subtrees[i], subtree_root, 0, 0);
+				}
+			});
+
+			// splice every subtree in, its root in place of the deferred node
+			for (std::size_t i = 0; i < deferred.size(); ++i) {
+				std::vector<BVHNode>& subtree = subtrees[i];
+				unsigned int offset = static_cast<unsigned int>(p_nodes.size()) - 2;
+
+				for (std::size_t n = 0; n < subtree.size(); ++n) {
+					if (subtree[n].m_count == 0 && n != 1) subtree[n].m_first += offset;
+				}
+
+				p_nodes[deferred[i].m_node] = subtree[0];
+				p_nodes.insert(p_nodes.end(), subtree.begin() + 2, subtree.end());
+			}
+		}
+
+		// The root is followed by an unused node, so that every pair of children
+		// starts at an even index and shares a 64 byte line.
+		static void BuildTree(PrimitiveBounds* p_bounds, unsigned int p_count, unsigned int p_thread_count,
+							  std::vector<BVHNode>& p_nodes, std::vector<unsigned int>& p_indices) {
+			p_nodes.clear();
+			p_nodes.reserve(2 * p_count + 2);
+			p_nodes.resize(2);
+			memset(&p_nodes[0], 0, 2 * sizeof(BVHNode));
+
+			if (Parallel::GetThreadCount(p_thread_count) <= 1 || p_count < 2 * K_MIN_SUBTREE_SIZE) {
+				BuildTask root = { 0, 0, p_count, 0 };
+				BuildNodes(p_bounds, p_nodes, root, 0, 0);
+			} else {
+				BuildSubtrees(p_bounds, p_count, p_thread_count, p_nodes);
+			}
+
+			// the leaves refer to the boxes in their final order
+			p_indices.resize(p_count);
+			for (unsigned int i = 0; i < p_count; ++i) p_indices[i] = p_bounds[i].m_index;
+		}
+
+
+
+
+		/**
+		 * Ray casting. Every ray keeps the distance of its closest hit so far and
+		 * only enters boxes that start before it.
+		 */
+		static bool IntersectBox(const float* p_min, const float* p_max, const float* p_origin, const float* p_inverse_direction, float p_max_distance, float& p_entry) {
+			float entry = 0.0f;
+			float exit = p_max_distance;
+			for (int a = 0; a < 3; ++a) {
+				float t0 = (p_min[a] - p_origin[a]) * p_inverse_direction[a];
+				float t1 = (p_max[a] - p_origin[a]) * p_inverse_direction[a];
+				float near = (t0 < t1) ? t0 : t1, far = (t0 < t1) ? t1 : t0;
+				entry = (near > entry) ? near : entry;
+				exit = (far < exit) ? far : exit;
+			}
+
+			p_entry = entry;
+			return entry <= exit;
+		}
+
+		// Moller-Trumbore
+		static bool IntersectTriangle(const Vector3* p_vertices, const float* p_origin, const float* p_direction, float p_max_distance, float& p_distance, float& p_u, float& p_v) {
+			const Vector3& v0 = p_vertices[0];
+			float e1[3] = { p_vertices[1].x - v0.x, p_vertices[1].y - v0.y, p_vertices[1].z - v0.z };
+			float e2[3] = { p_vertices[2].x - v0.x, p_vertices[2].y - v0.y, p_vertices[2].z - v0.z };
+
+			float p[3] = { p_direction[1] * e2[2] - p_direction[2] * e2[1], p_direction[2] * e2[0] - p_direction[0] * e2[2], p_direction[0] * e2[1] - p_direction[1] * e2[0] };
+			float determinant = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+			if (std::fabs(determinant) < K_MIN_DETERMINANT) return false;
+			float inverse_determinant = 1.0f / determinant;
+
+			float s[3] = { p_origin[0] - v0.x, p_origin[1] - v0.y, p_origin[2] - v0.z };
+			float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse_determinant;
+			if (u < 0.0f || u > 1.0f) return false;
+
+			float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+			float v = (p_direction[0] * q[0] + p_direction[1] * q[1] + p_direction[2] * q[2]) * inverse_determinant;
+			if (v < 0.0f || u + v > 1.0f) return false;
+
+			float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse_determinant;
+			if (t < 0.0f || t >= p_max_distance) return false;
+
+			p_distance = t;
+			p_u = u;
+			p_v = v;
+			return true;
+		}
+
+#if defined(R2_ARCH_X86)
+		struct AVX2Ray {
+			__m256 m_origin[3];
+			__m256 m_direction[3];
+			__m256 m_inverse_direction[3];
+		};
+
+		// the lanes that enter the box before their closest hit, with their entry distances
+		r2SIMDTargetM("avx2,fma")
+		static inline __m256 AVX2IntersectBox(const float* p_min, const float* p_max, const AVX2Ray& p_ray, __m256 p_max_distance, __m256& p_entry) {
+			__m256 entry = _mm256_setzero_ps();
+			__m256 exit = p_max_distance;
+			for (int a = 0; a < 3; ++a) {
+				__m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(p_min[a]), p_ray.m_origin[a]), p_ray.m_inverse_direction[a]);
+				__m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(p_max[a]), p_ray.m_origin[a]), p_ray.m_inverse_direction[a]);
+				entry = _mm256_max_ps(entry, _mm256_min_ps(t0, t1));
+				exit = _mm256_min_ps(exit, _mm256_max_ps(t0, t1));
+			}
+
+			p_entry = entry;
+			return _mm256_cmp_ps(entry, exit, _CMP_LE_OQ);
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static inline __m256 AVX2IntersectTriangle(const Vector3* p_vertices, const AVX2Ray& p_ray, __m256 p_max_distance, __m256& p_distance, __m256& p_u, __m256& p_v) {
+			const Vector3& v0 = p_vertices[0];
+			__m256 e1[3] = { _mm256_set1_ps(p_vertices[1].x - v0.x), _mm256_set1_ps(p_vertices[1].y - v0.y), _mm256_set1_ps(p_vertices[1].z - v0.z) };
+			__m256 e2[3] = { _mm256_set1_ps(p_vertices[2].x - v0.x), _mm256_set1_ps(p_vertices[2].y - v0.y), _mm256_set1_ps(p_vertices[2].z - v0.z) };
+			const __m256* d = p_ray.m_direction;
+
+			__m256 p[3] = { _mm256_fmsub_ps(d[1], e2[2], _mm256_mul_ps(d[2], e2[1])),
+							_mm256_fmsub_ps(d[2], e2[0], _mm256_mul_ps(d[0], e2[2])),
+							_mm256_fmsub_ps(d[0], e2[1], _mm256_mul_ps(d[1], e2[0])) };
+			__m256 determinant = _mm256_fmadd_ps(e1[0], p[0], _mm256_fmadd_ps(e1[1], p[1], _mm256_mul_ps(e1[2], p[2])));
+			__m256 inverse_determinant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+			__m256 s[3] = { _mm256_sub_ps(p_ray.m_origin[0], _mm256_set1_ps(v0.x)),
+							_mm256_sub_ps(p_ray.m_origin[1], _mm256_set1_ps(v0.y)),
+							_mm256_sub_ps(p_ray.m_origin[2], _mm256_set1_ps(v0.z)) };
+			__m256 u = _mm256_mul_ps(_mm256_fmadd_ps(s[0], p[0], _mm256_fmadd_ps(s[1], p[1], _mm256_mul_ps(s[2], p[2]))), inverse_determinant);
+
+			__m256 q[3] = { _mm256_fmsub_ps(s[1], e1[2], _mm256_mul_ps(s[2], e1[1])),
+							_mm256_fmsub_ps(s[2], e1[0], _mm256_mul_ps(s[0], e1[2])),
+							_mm256_fmsub_ps(s[0], e1[1], _mm256_mul_ps(s[1], e1[0])) };
+			__m256 v = _mm256_mul_ps(_mm256_fmadd_ps(d[0], q[0], _mm256_fmadd_ps(d[1], q[1], _mm256_mul_ps(d[2], q[2]))), inverse_determinant);
+			__m256 t = _mm256_mul_ps(_mm256_fmadd_ps(e2[0], q[0], _mm256_fmadd_ps(e2[1], q[1], _mm256_mul_ps(e2[2], q[2]))), inverse_determinant);
+
+			const __m256 zero = _mm256_setzero_ps();
+			__m256 hit = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), determinant), _mm256_set1_ps(K_MIN_DETERMINANT), _CMP_GE_OQ);
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, p_max_distance, _CMP_LT_OQ));
+
+			p_distance = t;
+			p_u = u;
+			p_v = v;
+			return hit;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static inline float AVX2HorizontalMin(__m256 p_value) {
+			__m128 value = _mm_min_ps(_mm256_castps256_ps128(p_value), _mm256_extractf128_ps(p_value, 1));
+			value = _mm_min_ps(value, _mm_movehl_ps(value, value));
+			value = _mm_min_ss(value, _mm_shuffle_ps(value, value, 1));
+			return _mm_cvtss_f32(value);
+		}
+
+		// Casts the 8 rays starting at p_first together. Lanes past p_lane_count
+		// start with a negative distance, so they never enter a box.
+		r2SIMDTargetM("avx2,fma")
+		static void AVX2IntersectPacket(const BVHNode* p_nodes, const Vector3* p_primitives, bool p_triangles, const float* const* p_origin, const float* const* p_direction,
+										unsigned int p_first, unsigned int p_lane_count, float p_max_distance, const unsigned int* p_indices, RayHit* p_hits) {
+			AVX2Ray ray;
+			for (int a = 0; a < 3; ++a) {
+				ray.m_origin[a] = _mm256_load_ps(p_origin[a] + p_first);
+				ray.m_direction[a] = _mm256_load_ps(p_direction[a] + p_first);
+				ray.m_inverse_direction[a] = _mm256_div_ps(_mm256_set1_ps(1.0f), ray.m_direction[a]);
+			}
+
+			__m256 lanes = _mm256_cmp_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(static_cast<float>(p_lane_count)), _CMP_LT_OQ);
+			__m256 distance = _mm256_blendv_ps(_mm256_set1_ps(-1.0f), _mm256_set1_ps(p_max_distance), lanes);
+			__m256 primitive = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			__m256 u = _mm256_setzero_ps(), v = _mm256_setzero_ps();
+
+			unsigned int stack[K_STACK_SIZE];
+			unsigned int stack_size = 0;
+			__m256 entry;
+			unsigned int current = 0;
+			if (_mm256_movemask_ps(AVX2IntersectBox(p_nodes[0].m_min, p_nodes[0].m_max, ray, distance, entry)) == 0) current = K_NO_NODE;
+
+			while (current != K_NO_NODE) {
+				const BVHNode& node = p_nodes[current];
+
+				if (node.m_count != 0) {
+					for (unsigned int i = node.m_first; i < node.m_first + node.m_count; ++i) {
+						__m256 t = _mm256_setzero_ps(), hit_u = _mm256_setzero_ps(), hit_v = _mm256_setzero_ps(), hit;
+						if (p_triangles) {
+							hit = AVX2IntersectTriangle(&p_primitives[3 * i], ray, distance, t, hit_u, hit_v);
+						} else {
+							hit = _mm256_and_ps(AVX2IntersectBox(p_primitives[2 * i].m_data, p_primitives[2 * i + 1].m_data, ray, distance, t), _mm256_cmp_ps(t, distance, _CMP_LT_OQ));
+						}
+
+						if (_mm256_movemask_ps(hit) == 0) continue;
+						distance = _mm256_blendv_ps(distance, t, hit);
+						primitive = _mm256_blendv_ps(primitive, _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(i))), hit);
+						u = _mm256_blendv_ps(u, hit_u, hit);
+						v = _mm256_blendv_ps(v, hit_v, hit);
+					}
+
+					current = (stack_size == 0) ? K_NO_NODE : stack[--stack_size];
+					continue;
+				}
+
+				__m256 left_entry, right_entry;
+				__m256 left = AVX2IntersectBox(p_nodes[node.m_first].m_min, p_nodes[node.m_first].m_max, ray, distance, left_entry);
+				__m256 right = AVX2IntersectBox(p_nodes[node.m_first + 1].m_min, p_nodes[node.m_first + 1].m_max, ray, distance, right_entry);
+				bool enter_left = _mm256_movemask_ps(left) != 0;
+				bool enter_right = _mm256_movemask_ps(right) != 0;
+
+				if (enter_left && enter_right) {
+					// the child some ray reaches first is visited first
+					const __m256 large = _mm256_set1_ps(K_LARGE);
+					bool left_first = AVX2HorizontalMin(_mm256_blendv_ps(large, left_entry, left)) <= AVX2HorizontalMin(_mm256_blendv_ps(large, right_entry, right));
+					stack[stack_size++] = left_first ? node.m_first + 1 : node.m_first;
+					current = left_first ? node.m_first : node.m_first + 1;
+				} else if (enter_left || enter_right) {
+					current = enter_left ? node.m_first : node.m_first + 1;
+				} else {
+					current = (stack_size == 0) ? K_NO_NODE : stack[--stack_size];
+				}
+			}
+
+			float distances[8], us[8], vs[8];
+			int primitives[8];
+			_mm256_storeu_ps(distances, distance);
+			_mm256_storeu_ps(us, u);
+			_mm256_storeu_ps(vs, v);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(primitives), _mm256_castps_si256(primitive));
+			for (unsigned int lane = 0; lane < p_lane_count; ++lane) {
+				RayHit& hit = p_hits[p_first + lane];
+				hit.m_distance = distances[lane];
+				hit.m_primitive = (primitives[lane] < 0) ? RayHit::K_NO_HIT : p_indices[primitives[lane]];
+				hit.m_u = us[lane];
+				hit.m_v = vs[lane];
+			}
+		}
+#endif
+
+
+
+
+		BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+			: m_nodes(0), m_node_count(0), m_triangles(true) {}
+
+		BoundingVolumeHierarchy::BoundingVolumeHierarchy(const BoundingVolumeHierarchy& p_hierarchy)
+			: m_nodes(0), m_node_count(0), m_primitives(p_hierarchy.m_primitives), m_indices(p_hierarchy.m_indices), m_triangles(p_hierarchy.m_triangles) {
+			if (p_hierarchy.m_node_count == 0) return;
+
+			m_nodes = static_cast<Node*>(SIMD::AllocateAligned(p_hierarchy.m_node_count * sizeof(Node), K_NODE_ALIGNMENT));
+			memcpy(m_nodes, p_hierarchy.m_nodes, p_hierarchy.m_node_count * sizeof(Node));
+			m_node_count = p_hierarchy.m_node_count;
+		}
+
+		BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {
+			SIMD::FreeAligned(m_nodes);
+		}
+
+		BoundingVolumeHierarchy& BoundingVolumeHierarchy::operator=(const BoundingVolumeHierarchy& p_hierarchy) {
+			if (this == &p_hierarchy) return *this;
+
+			BoundingVolumeHierarchy copy(p_hierarchy);
+			std::swap(m_nodes, copy.m_nodes);
+			std::swap(m_node_count, copy.m_node_count);
+			m_primitives.swap(copy.m_primitives);
+			m_indices.swap(copy.m_indices);
+			m_triangles = copy.m_triangles;
+
+			return *this;
+		}
+
+		void BoundingVolumeHierarchy::Build(const Vector3* p_vertices, const unsigned int* p_indices, unsigned int p_count, unsigned int p_thread_count) {
+			std::vector<PrimitiveBounds> bounds(p_count);
+			for (unsigned int i = 0; i < p_count; ++i) {
+				PrimitiveBounds& b = bounds[i];
+				b.m_index = i;
+				for (int a = 0; a < 3; ++a) {
+					SCALAR v0 = p_vertices[p_indices[3 * i]].m_data[a];
+					SCALAR v1 = p_vertices[p_indices[3 * i + 1]].m_data[a];
+					SCALAR v2 = p_vertices[p_indices[3 * i + 2]].m_data[a];
+					b.m_min[a] = std::min(v0, std::min(v1, v2));
+					b.m_max[a] = std::max(v0, std::max(v1, v2));
+					b.m_center[a] = 0.5f * (b.m_min[a] + b.m_max[a]);
+				}
+			}
+
+			std::vector<Node> nodes;
+			BuildTree(p_count == 0 ? 0 : &bounds[0], p_count, p_thread_count, nodes, m_indices);
+			SetNodes(nodes);
+
+			m_triangles = true;
+			m_primitives.resize(3 * p_count);
+			for (unsigned int i = 0; i < p_count; ++i) {
+				for (unsigned int k = 0; k < 3; ++k) {
+					m_primitives[3 * i + k] = p_vertices[p_indices[3 * m_indices[i] + k]];
+				}
+			}
+		}
+
+		void BoundingVolumeHierarchy::Build(const Vector3* p_min, const Vector3* p_max, unsigned int p_count, unsigned int p_thread_count) {
+			std::vector<PrimitiveBounds> bounds(p_count);
+			for (unsigned int i = 0; i < p_count; ++i) {
+				bounds[i].m_index = i;
+				for (int a = 0; a < 3; ++a) {
+					bounds[i].m_min[a] = p_min[i].m_data[a];
+					bounds[i].m_max[a] = p_max[i].m_data[a];
+					bounds[i].m_center[a] = 0.5f * (p_min[i].m_data[a] + p_max[i].m_data[a]);
+				}
+			}
+
+			std::vector<Node> nodes;
+			BuildTree(p_count == 0 ? 0 : &bounds[0], p_count, p_thread_count, nodes, m_indices);
+			SetNodes(nodes);
+
+			m_triangles = false;
+			m_primitives.resize(2 * p_count);
+			for (unsigned int i = 0; i < p_count; ++i) {
+				m_primitives[2 * i] = p_min[m_indices[i]];
+				m_primitives[2 * i + 1] = p_max[m_indices[i]];
+			}
+		}
+
+		void BoundingVolumeHierarchy::SetNodes(const std::vector<Node>& p_nodes) {
+			Node* nodes = static_cast<Node*>(SIMD::AllocateAligned(p_nodes.size() * sizeof(Node), K_NODE_ALIGNMENT));
+			memcpy(nodes, &p_nodes[0], p_nodes.size() * sizeof(Node));
+
+			SIMD::FreeAligned(m_nodes);
+			m_nodes = nodes;
+			m_node_count = static_cast<unsigned int>(p_nodes.size());
+		}
+
+		const BoundingVolumeHierarchy::Node* BoundingVolumeHierarchy::GetNodes() const {
+			return m_nodes;
+		}
+
+		unsigned int BoundingVolumeHierarchy::GetNodeCount() const {
+			return m_node_count;
+		}
+
+		unsigned int BoundingVolumeHierarchy::GetPrimitiveCount() const {
+			return static_cast<unsigned int>(m_indices.size());
+		}
+
+		bool BoundingVolumeHierarchy::Intersect(const Vector3& p_origin, const Vector3& p_direction, RayHit& p_hit, SCALAR p_max_distance) const {
+			if (m_indices.empty()) return false;
+
+			const float* origin = p_origin.m_data;
+			const float* direction = p_direction.m_data;
+			float inverse_direction[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+
+			float distance = p_max_distance;
+			unsigned int primitive = RayHit::K_NO_HIT;
+			float u = 0.0f, v = 0.0f;
+
+			unsigned int stack[K_STACK_SIZE];
+			unsigned int stack_size = 0;
+			float entry;
+			unsigned int current = 0;
+			if (!IntersectBox(m_nodes[0].m_min, m_nodes[0].m_max, origin, inverse_direction, distance, entry)) current = K_NO_NODE;
+
+			while (current != K_NO_NODE) {
+				const Node& node = m_nodes[current];
+
+				if (node.m_count != 0) {
+					for (unsigned int i = node.m_first; i < node.m_first + node.m_count; ++i) {
+						float t = 0.0f, hit_u = 0.0f, hit_v = 0.0f;
+						bool hit = m_triangles ? IntersectTriangle(&m_primitives[3 * i], origin, direction, distance, t, hit_u, hit_v)
+											   : IntersectBox(m_primitives[2 * i].m_data, m_primitives[2 * i + 1].m_data, origin, inverse_direction, distance, t) && t < distance;
+						if (!hit) continue;
+
+						distance = t;
+						primitive = i;
+						u = hit_u;
+						v = hit_v;
+					}
+
+					current = (stack_size == 0) ? K_NO_NODE : stack[--stack_size];
+					continue;
+				}
+
+				float left_entry, right_entry;
+				bool enter_left = IntersectBox(m_nodes[node.m_first].m_min, m_nodes[node.m_first].m_max, origin, inverse_direction, distance, left_entry);
+				bool enter_right = IntersectBox(m_nodes[node.m_first + 1].m_min, m_nodes[node.m_first + 1].m_max, origin, inverse_direction, distance, right_entry);
+
+				if (enter_left && enter_right) {
+					bool left_first = left_entry <= right_entry;
+					stack[stack_size++] = left_first ? node.m_first + 1 : node.m_first;
+					current = left_first ? node.m_first : node.m_first + 1;
+				} else if (enter_left || enter_right) {
+					current = enter_left ? node.m_first : node.m_first + 1;
+				} else {
+					current = (stack_size == 0) ? K_NO_NODE : stack[--stack_size];
+				}
+			}
+
+			if (primitive == RayHit::K_NO_HIT) return false;
+
+			p_hit.m_distance = distance;
+			p_hit.m_primitive = m_indices[primitive];
+			p_hit.m_u = u;
+			p_hit.m_v = v;
+			return true;
+		}
+
+		void BoundingVolumeHierarchy::Intersect(const Vector3Stream& p_origins, const Vector3Stream& p_directions, RayHit* p_hits, SCALAR p_max_distance, unsigned int p_thread_count) const {
+			if (p_origins.Size() != p_directions.Size()) throw r2ExceptionArgumentM("Stream sizes do not match");
+
+			unsigned int count = p_origins.Size();
+			const float* origin[3] = { p_origins.GetX(), p_origins.GetY(), p_origins.GetZ() };
+			const float* direction[3] = { p_directions.GetX(), p_directions.GetY(), p_directions.GetZ() };
+
+			// packets of 8 rays, so every packet starts on an aligned index
+			unsigned int packet_count = (count + 7) / 8;
+			Parallel::For(packet_count, K_MIN_RAY_PACKETS, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				unsigned int begin = static_cast<unsigned int>(p_begin) * 8;
+				unsigned int end = std::min(static_cast<unsigned int>(p_end) * 8, count);
+
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2 && !m_indices.empty()) {
+					for (unsigned int i = begin; i < end; i += 8) {
+						AVX2IntersectPacket(m_nodes, &m_primitives[0], m_triangles, origin, direction, i, std::min(end - i, 8u), p_max_distance, &m_indices[0], p_hits);
+					}
+					return;
+				}
+#endif
+				for (unsigned int i = begin; i < end; ++i) {
+					RayHit& hit = p_hits[i];
+					if (!Intersect(Vector3(origin[0][i], origin[1][i], origin[2][i]), Vector3(direction[0][i], direction[1][i], direction[2][i]), hit, p_max_distance)) {
+						hit.m_distance = p_max_distance;
+						hit.m_primitive = RayHit::K_NO_HIT;
+						hit.m_u = 0.0f;
+						hit.m_v = 0.0f;
+					}
+				}
+			});
+		}
+
+		unsigned int BoundingVolumeHierarchy::Overlap(const Vector3& p_min, const Vector3& p_max, std::vector<unsigned int>& p_result) const {
+			if (m_indices.empty()) return 0;
+
+			std::size_t first_result = p_result.size();
+			unsigned int stack[K_STACK_SIZE];
+			unsigned int stack_size = 0;
+			stack[stack_size++] = 0;
+
+			while (stack_size != 0) {
+				const Node& node = m_nodes[stack[--stack_size]];
+
+				bool overlap = true;
+				for (int a = 0; a < 3; ++a) {
+					overlap = overlap && node.m_min[a] <= p_max.m_data[a] && node.m_max[a] >= p_min.m_data[a];
+				}
+				if (!overlap) continue;
+
+				if (node.m_count == 0) {
+					stack[stack_size++] = node.m_first + 1;
+					stack[stack_size++] = node.m_first;
+					continue;
+				}
+
+				for (unsigned int i = node.m_first; i < node.m_first + node.m_count; ++i) {
+					bool primitive_overlap = true;
+					for (int a = 0; a < 3; ++a) {
+						SCALAR low, high;
+						if (m_triangles) {
+							const Vector3* vertices = &m_primitives[3 * i];
+							low = std::min(vertices[0].m_data[a], std::min(vertices[1].m_data[a], vertices[2].m_data[a]));
+							high = std::max(vertices[0].m_data[a], std::max(vertices[1].m_data[a], vertices[2].m_data[a]));
+						} else {
+							low = m_primitives[2 * i].m_data[a];
+							high = m_primitives[2 * i + 1].m_data[a];
+						}
+
+						primitive_overlap = primitive_overlap && low <= p_max.m_data[a] && high >= p_min.m_data[a];
+					}
+
+					if (primitive_overlap) p_result.push_back(m_indices[i]);
+				}
+			}
+
+			return static_cast<unsigned int>(p_result.size() - first_result);
+		}
+	}
+}
@@ -0,0 +1,143 @@
+/* HEADER
+ *
+ * File: r2-bounding-volume-hierarchy.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A bounding volume hierarchy over static triangles or axis aligned boxes,
+ *	for ray casts and overlap queries in logarithmic instead of linear time.
+ *
+ *	The tree is built top down, splitting every node where the surface area
+ *	heuristic (SAH), evaluated over a fixed number of bins of the primitive
+ *	centers, is cheapest. Once the upper levels have produced enough
+ *	subtrees, the subtrees are built on separate threads.
+ *
+ *	The nodes are 32 bytes, stored depth first in one array aligned to 64
+ *	bytes, with the two children of a node next to each other so that they
+ *	share a cache line. The primitives are copied in leaf order, so a leaf
+ *	reads one contiguous range.
+ *
+ *	Rays can be cast one at a time, or as streams that are traversed in
+ *	packets of 8 rays sharing one walk through the tree (AVX2). Packets
+ *	pay off for coherent rays, such as camera or shadow rays.
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Exception::Argument
+ *  * r2::Math::SIMD
+ *  * r2::Parallel
+ *  * RayHit
+ *  * Vector3, Vector3Stream
+ * Updates:
+ *	2026-10-17 (Rarosu) - Moved RayHit to r2-ray-intersection.hpp
+ */
+#ifndef R2_BOUNDING_VOLUME_HIERARCHY_HPP
+#define R2_BOUNDING_VOLUME_HIERARCHY_HPP
+
+#include <vector>
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-stream.hpp"
+#include "r2-ray-intersection.hpp"
+
+namespace r2 {
+	namespace Math {
+		class BoundingVolumeHierarchy {
+		public:
+			/**
+			 * A node of the flattened tree. Leaves hold m_count primitives starting
+			 * at m_first, inner nodes (m_count == 0) have their children at m_first
+			 * and m_first + 1.
+			 */
+			struct Node {
+				SCALAR m_min[3];
+				unsigned int m_first;
+				SCALAR m_max[3];
+				unsigned int m_count;
+			};
+
+			/**
+			 * Initialize an empty hierarchy
+			 */
+			BoundingVolumeHierarchy();
+
+			BoundingVolumeHierarchy(const BoundingVolumeHierarchy& p_hierarchy);
+			~BoundingVolumeHierarchy();
+
+			BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy& p_hierarchy);
+
+			/**
+			 * Build the hierarchy over p_count triangles, where triangle i has the
+			 * vertices p_vertices[p_indices[3 * i + k]]. The vertices are copied.
+			 * The build is split over p_thread_count threads (0 uses all hardware
+			 * threads).
+			 */
+			void Build(const Vector3* p_vertices, const unsigned int* p_indices, unsigned int p_count, unsigned int p_thread_count = 1);
+
+			/**
+			 * Build the hierarchy over p_count boxes [p_min[i], p_max[i]]
+			 */
+			void Build(const Vector3* p_min, const Vector3* p_max, unsigned int p_count, unsigned int p_thread_count = 1);
+
+			/**
+			 * Get the flattened tree. The root is node 0.
+			 */
+			const Node* GetNodes() const;
+			unsigned int GetNodeCount() const;
+
+			/**
+			 * Get the number of primitives the hierarchy was built over
+			 */
+			unsigned int GetPrimitiveCount() const;
+
+			/**
+			 * Find the closest primitive hit by the ray, not further away than
+			 * p_max_distance (in units of p_direction, which need not be normalized).
+			 * Returns false and leaves p_hit alone if nothing was hit.
+			 */
+			bool Intersect(const Vector3& p_origin, const Vector3& p_direction, RayHit& p_hit, SCALAR p_max_distance = 3.402823e38f) const;
+
+			/**
+			 * Cast a stream of rays and write the closest hit of every ray to
+			 * p_hits, with m_primitive set to RayHit::K_NO_HIT for misses. The
+			 * streams must be of the same size, or an Argument exception is raised.
+			 * Large streams are split over p_thread_count threads.
+			 */
+			void Intersect(const Vector3Stream& p_origins, const Vector3Stream& p_directions, RayHit* p_hits, SCALAR p_max_distance = 3.402823e38f, unsigned int p_thread_count = 1) const;
+
+			/**
+			 * Append the indices of all primitives whose bounding boxes overlap the
+			 * box [p_min, p_max] to p_result, and return their number.
+			 */
+			unsigned int Overlap(const Vector3& p_min, const Vector3& p_max, std::vector<unsigned int>& p_result) const;
+		private:
+			void SetNodes(const std::vector<Node>& p_nodes);
+
+			Node* m_nodes;
+			unsigned int m_node_count;
+
+			// the primitives in leaf order: 3 vertices per triangle or min and max per box
+			std::vector<Vector3> m_primitives;
+			std::vector<unsigned int> m_indices;
+			bool m_triangles;
+		};
+	}
+}
+
+#endif
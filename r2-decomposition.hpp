@@ -0,0 +1,294 @@
+/* HEADER
+ *
+ * File: r2-decomposition.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Matrix decompositions for Matrix2/3/4, for solving A * x = b without
+ *	forming the inverse.
+ *
+ *	* LUDecomposition: partial pivoting, works for any non-singular matrix.
+ *	* CholeskyDecomposition: for symmetric positive definite matrices
+ *	  (inertia tensors, normal equations). About half the work of LU.
+ *	* QRDecomposition: Householder reflections. The most stable of the
+ *	  three, and it gives an orthonormal basis (Q) as a by-product.
+ *
+ *	Each decomposition is computed once by the constructor and can then
+ *	solve any number of right hand sides.
+ *
+ *	For Matrix3 there are also decompositions based on the Jacobi
+ *	eigenvalue method: EigenDecomposition3 (symmetric matrices, e.g. inertia
+ *	tensors), SingularValueDecomposition3 and PolarDecomposition3 (the
+ *	rotation closest to a deformation, as in shape matching).
+ *
+ *	The batched functions take Matrix3Stream/Matrix4Stream
+ *	(r2-vector-stream.hpp) and work on 4 or 8 matrices per instruction.
+ * Depends on:
+ *  * SCALAR
+ *  * FloatCompare
+ *  * r2::Exception::Argument, r2::Exception::DivisionByZero, r2::Exception::Domain
+ *  * Matrix2, Matrix3, Matrix4, Vector2, Vector3, Vector4
+ *  * Matrix3Stream, Matrix4Stream, Vector3Stream, Vector4Stream
+ *  * r2::Math::SIMD
+ *  * r2::Parallel
+ * Updates:
+ *	2026-10-17 (Rarosu) - Added EigenDecomposition3, SingularValueDecomposition3 and PolarDecomposition3
+ */
+#ifndef R2_DECOMPOSITION_HPP
+#define R2_DECOMPOSITION_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-2.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+#include "r2-matrix-2.hpp"
+#include "r2-matrix-3.hpp"
+#include "r2-matrix-4.hpp"
+#include "r2-vector-stream.hpp"
+
+namespace r2 {
+	namespace Math {
+		/**
+		 * P * A = L * U, where P is a permutation, L is lower triangular with a
+		 * unit diagonal and U is upper triangular.
+		 */
+		template <typename MatrixType, typename VectorType>
+		class LUDecomposition {
+		public:
+			/**
+			 * Decompose the matrix. If the matrix is singular, a DivisionByZero
+			 * exception is raised.
+			 */
+			explicit LUDecomposition(const MatrixType& p_matrix);
+
+			/**
+			 * Solve A * x = p_rhs for x
+			 */
+			VectorType Solve(const VectorType& p_rhs) const;
+
+			/**
+			 * Get the inverse of A
+			 */
+			MatrixType GetInverse() const;
+
+			/**
+			 * Get the determinant of A
+			 */
+			SCALAR Determinant() const;
+
+			/**
+			 * Get the factors
+			 */
+			MatrixType GetL() const;
+			MatrixType GetU() const;
+
+			/**
+			 * Get the row of A that ended up as row p_row of P * A
+			 */
+			unsigned int GetPermutation(unsigned int p_row) const;
+
+			static const unsigned int K_DIMENSIONS = MatrixType::K_DIMENSIONS;
+		private:
+			// L below the diagonal, U on and above it
+			MatrixType m_lu;
+			unsigned int m_permutation[K_DIMENSIONS];
+			SCALAR m_sign;
+		};
+
+		/**
+		 * A = L * L^T, where L is lower triangular with a positive diagonal.
+		 */
+		template <typename MatrixType, typename VectorType>
+		class CholeskyDecomposition {
+		public:
+			/**
+			 * Decompose the matrix, which must be symmetric positive definite. Only
+			 * the lower triangle is read. If the matrix is singular, a DivisionByZero
+			 * exception is raised; if it is otherwise not positive definite, a
+			 * Domain exception is raised.
+			 */
+			explicit CholeskyDecomposition(const MatrixType& p_matrix);
+
+			/**
+			 * Solve A * x = p_rhs for x
+			 */
+			VectorType Solve(const VectorType& p_rhs) const;
+
+			/**
+			 * Get the determinant of A
+			 */
+			SCALAR Determinant() const;
+
+			/**
+			 * Get the factor L
+			 */
+			const MatrixType& GetL() const;
+
+			static const unsigned int K_DIMENSIONS = MatrixType::K_DIMENSIONS;
+		private:
+			MatrixType m_l;
+		};
+
+		/**
+		 * A = Q * R, where Q is orthonormal and R is upper triangular.
+		 */
+		template <typename MatrixType, typename VectorType>
+		class QRDecomposition {
+		public:
+			/**
+			 * Decompose the matrix. Singular matrices can be decomposed too, but
+			 * not solved.
+			 */
+			explicit QRDecomposition(const MatrixType& p_matrix);
+
+			/**
+			 * Solve A * x = p_rhs for x. If A is singular, a DivisionByZero exception
+			 * is raised.
+			 */
+			VectorType Solve(const VectorType& p_rhs) const;
+
+			/**
+			 * Get the determinant of A
+			 */
+			SCALAR Determinant() const;
+
+			/**
+			 * Get the factors
+			 */
+			const MatrixType& GetQ() const;
+			const MatrixType& GetR() const;
+
+			static const unsigned int K_DIMENSIONS = MatrixType::K_DIMENSIONS;
+		private:
+			MatrixType m_q;
+			MatrixType m_r;
+			SCALAR m_sign;
+		};
+
+		typedef LUDecomposition<Matrix2, Vector2> LUDecomposition2;
+		typedef LUDecomposition<Matrix3, Vector3> LUDecomposition3;
+		typedef LUDecomposition<Matrix4, Vector4> LUDecomposition4;
+		typedef CholeskyDecomposition<Matrix2, Vector2> CholeskyDecomposition2;
+		typedef CholeskyDecomposition<Matrix3, Vector3> CholeskyDecomposition3;
+		typedef CholeskyDecomposition<Matrix4, Vector4> CholeskyDecomposition4;
+		typedef QRDecomposition<Matrix2, Vector2> QRDecomposition2;
+		typedef QRDecomposition<Matrix3, Vector3> QRDecomposition3;
+		typedef QRDecomposition<Matrix4, Vector4> QRDecomposition4;
+
+		/**
+		 * Solve p_matrix * x = p_rhs for x with an LU decomposition. If the matrix
+		 * is singular, a DivisionByZero exception is raised.
+		 */
+		Vector2 Solve(const Matrix2& p_matrix, const Vector2& p_rhs);
+		Vector3 Solve(const Matrix3& p_matrix, const Vector3& p_rhs);
+		Vector4 Solve(const Matrix4& p_matrix, const Vector4& p_rhs);
+
+		/**
+		 * Solve p_matrices[i] * p_solutions[i] = p_rhs[i] for every system in the
+		 * streams, by Gaussian elimination with partial pivoting. The streams must
+		 * be of the same size, otherwise an Argument exception is raised.
+		 * p_solutions is resized to match and may be the same stream as p_rhs.
+		 * Large streams are split over p_thread_count threads (0 uses all
+		 * hardware threads).
+		 *
+		 * The solutions of singular systems are set to zero. If there were any,
+		 * a DivisionByZero exception is raised once all systems are solved.
+		 */
+		void Solve(const Matrix3Stream& p_matrices, const Vector3Stream& p_rhs, Vector3Stream& p_solutions, unsigned int p_thread_count = 1);
+		void Solve(const Matrix4Stream& p_matrices, const Vector4Stream& p_rhs, Vector4Stream& p_solutions, unsigned int p_thread_count = 1);
+		/**
+		 * A = V * diag(eigenvalues) * V^T for a symmetric matrix A, with V a rotation
+		 * whose columns are the eigenvectors.
+		 */
+		class EigenDecomposition3 {
+		public:
+			/**
+			 * Decompose a symmetric matrix. Only the lower triangle is read.
+			 */
+			explicit EigenDecomposition3(const Matrix3& p_matrix);
+
+			/**
+			 * Get the eigenvalues, largest first
+			 */
+			const Vector3& GetEigenvalues() const;
+
+			/**
+			 * Get the eigenvectors as the columns of a rotation matrix, column i
+			 * belonging to eigenvalue i.
+			 */
+			const Matrix3& GetEigenvectors() const;
+		private:
+			Vector3 m_eigenvalues;
+			Matrix3 m_eigenvectors;
+		};
+
+		/**
+		 * A = U * diag(singular values) * V^T, with U and V rotations. To keep them
+		 * rotations, the last singular value is negative when A is a reflection
+		 * (det(A) < 0).
+		 */
+		class SingularValueDecomposition3 {
+		public:
+			explicit SingularValueDecomposition3(const Matrix3& p_matrix);
+
+			/**
+			 * Get the singular values, ordered by magnitude with the largest first
+			 */
+			const Vector3& GetSingularValues() const;
+
+			/**
+			 * Get the rotations
+			 */
+			const Matrix3& GetU() const;
+			const Matrix3& GetV() const;
+		private:
+			Matrix3 m_u;
+			Vector3 m_singular_values;
+			Matrix3 m_v;
+		};
+
+		/**
+		 * A = R * S, with R a rotation and S symmetric. R is the rotation closest
+		 * to A. If A is a reflection, S has a negative eigenvalue.
+		 */
+		class PolarDecomposition3 {
+		public:
+			explicit PolarDecomposition3(const Matrix3& p_matrix);
+
+			const Matrix3& GetRotation() const;
+			const Matrix3& GetStretch() const;
+		private:
+			Matrix3 m_rotation;
+			Matrix3 m_stretch;
+		};
+
+		/**
+		 * Batched decompositions of every matrix in p_matrices. The result streams are
+		 * resized to match and a result matrix stream may be the same stream as
+		 * p_matrices. Large streams are split over p_thread_count threads (0 uses
+		 * all hardware threads).
+		 */
+		void EigenDecompose(const Matrix3Stream& p_matrices, Vector3Stream& p_eigenvalues, Matrix3Stream& p_eigenvectors, unsigned int p_thread_count = 1);
+		void SingularValueDecompose(const Matrix3Stream& p_matrices, Matrix3Stream& p_u, Vector3Stream& p_singular_values, Matrix3Stream& p_v, unsigned int p_thread_count = 1);
+		void PolarDecompose(const Matrix3Stream& p_matrices, Matrix3Stream& p_rotations, Matrix3Stream& p_stretches, unsigned int p_thread_count = 1);
+	}
+}
+
+#endif
@@ -0,0 +1,294 @@
+/* HEADER
+ *
+ * File: r2-expression.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Opt-in expression templates for the element-wise operations on
+ *	Vector2/3/4 and Matrix2/3/4. Wrapping an operand in Lazy() makes the
+ *	operators build an expression instead of a temporary per operation;
+ *	the whole expression is then evaluated in a single loop when it is
+ *	assigned:
+ *
+ *		using r2::Math::Expression::Lazy;
+ *		Vector3 v = Lazy(a) + Lazy(b) * s - c;
+ *		Assign(v, Lazy(v) * damping + Lazy(f) * dt);
+ *
+ *	Only element-wise operations are supported (sums, differences,
+ *	negation and scaling), so the target may also appear as an operand.
+ *	An expression refers to the Lazy() operands, not copies of them, and
+ *	must be evaluated while they are alive.
+ * Depends on:
+ *  * SCALAR
+ *  * Vector2, Vector3, Vector4
+ *  * Matrix2, Matrix3, Matrix4
+ * Updates:
+ *
+ */
+#ifndef R2_EXPRESSION_HPP
+#define R2_EXPRESSION_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-2.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+#include "r2-matrix-2.hpp"
+#include "r2-matrix-3.hpp"
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		namespace Expression {
+			/**
+			 * The number of scalars in each type that can take part in an expression
+			 */
+			template <typename Result> struct Traits;
+			template <> struct Traits<Vector2> { static const unsigned int K_SIZE = 2; };
+			template <> struct Traits<Vector3> { static const unsigned int K_SIZE = 3; };
+			template <> struct Traits<Vector4> { static const unsigned int K_SIZE = 4; };
+			template <> struct Traits<Matrix2> { static const unsigned int K_SIZE = 4; };
+			template <> struct Traits<Matrix3> { static const unsigned int K_SIZE = 9; };
+			template <> struct Traits<Matrix4> { static const unsigned int K_SIZE = 16; };
+
+			/**
+			 * The base of all expression nodes. Derived must provide
+			 * SCALAR operator[](unsigned int) const for element access.
+			 */
+			template <typename Derived, typename Result>
+			class Base {
+			public:
+				/**
+				 * Get element p_index of the evaluated expression
+				 */
+				SCALAR operator[](unsigned int p_index) const;
+
+				/**
+				 * Evaluate the expression into a new object
+				 */
+				operator Result() const;
+			};
+
+			/**
+			 * A Vector or Matrix operand
+			 */
+			template <typename Result>
+			class Reference : public Base<Reference<Result>, Result> {
+			public:
+				explicit Reference(const Result& p_value);
+				SCALAR operator[](unsigned int p_index) const;
+			private:
+				const Result& m_value;
+			};
+
+			template <typename Lhs, typename Rhs, typename Result>
+			class Sum : public Base<Sum<Lhs, Rhs, Result>, Result> {
+			public:
+				Sum(const Lhs& p_lhs, const Rhs& p_rhs);
+				SCALAR operator[](unsigned int p_index) const;
+			private:
+				Lhs m_lhs;
+				Rhs m_rhs;
+			};
+
+			template <typename Lhs, typename Rhs, typename Result>
+			class Difference : public Base<Difference<Lhs, Rhs, Result>, Result> {
+			public:
+				Difference(const Lhs& p_lhs, const Rhs& p_rhs);
+				SCALAR operator[](unsigned int p_index) const;
+			private:
+				Lhs m_lhs;
+				Rhs m_rhs;
+			};
+
+			template <typename Operand, typename Result>
+			class Scaled : public Base<Scaled<Operand, Result>, Result> {
+			public:
+				Scaled(const Operand& p_operand, SCALAR p_factor);
+				SCALAR operator[](unsigned int p_index) const;
+			private:
+				Operand m_operand;
+				SCALAR m_factor;
+			};
+
+			template <typename Operand, typename Result>
+			class Negated : public Base<Negated<Operand, Result>, Result> {
+			public:
+				explicit Negated(const Operand& p_operand);
+				SCALAR operator[](unsigned int p_index) const;
+			private:
+				Operand m_operand;
+			};
+
+			/**
+			 * Start an expression with p_value as an operand
+			 */
+			template <typename Result>
+			Reference<Result> Lazy(const Result& p_value);
+
+			/**
+			 * Evaluate the expression into p_target, without a temporary
+			 */
+			template <typename E, typename Result>
+			Result& Assign(Result& p_target, const Base<E, Result>& p_expression);
+
+			/**
+			 * Operators
+			 */
+			template <typename L, typename R, typename Result> Sum<L, R, Result> operator+(const Base<L, Result>& p_lhs, const Base<R, Result>& p_rhs);
+			template <typename L, typename Result> Sum<L, Reference<Result>, Result> operator+(const Base<L, Result>& p_lhs, const Result& p_rhs);
+			template <typename R, typename Result> Sum<Reference<Result>, R, Result> operator+(const Result& p_lhs, const Base<R, Result>& p_rhs);
+			template <typename L, typename R, typename Result> Difference<L, R, Result> operator-(const Base<L, Result>& p_lhs, const Base<R, Result>& p_rhs);
+			template <typename L, typename Result> Difference<L, Reference<Result>, Result> operator-(const Base<L, Result>& p_lhs, const Result& p_rhs);
+			template <typename R, typename Result> Difference<Reference<Result>, R, Result> operator-(const Result& p_lhs, const Base<R, Result>& p_rhs);
+			template <typename E, typename Result> Scaled<E, Result> operator*(const Base<E, Result>& p_lhs, SCALAR p_rhs);
+			template <typename E, typename Result> Scaled<E, Result> operator*(SCALAR p_lhs, const Base<E, Result>& p_rhs);
+			template <typename E, typename Result> Scaled<E, Result> operator/(const Base<E, Result>& p_lhs, SCALAR p_rhs);
+			template <typename E, typename Result> Negated<E, Result> operator-(const Base<E, Result>& p_operand);
+
+
+
+			/**
+			 * IMPLEMENTATION
+			 */
+			template <typename Derived, typename Result>
+			inline SCALAR Base<Derived, Result>::operator[](unsigned int p_index) const {
+				return static_cast<const Derived&>(*this)[p_index];
+			}
+
+			template <typename Derived, typename Result>
+			inline Base<Derived, Result>::operator Result() const {
+				Result result;
+				return Assign(result, *this);
+			}
+
+			template <typename Result>
+			inline Reference<Result>::Reference(const Result& p_value)
+				: m_value(p_value) {}
+
+			template <typename Result>
+			inline SCALAR Reference<Result>::operator[](unsigned int p_index) const {
+				return m_value.m_data[p_index];
+			}
+
+			template <typename Lhs, typename Rhs, typename Result>
+			inline Sum<Lhs, Rhs, Result>::Sum(const Lhs& p_lhs, const Rhs& p_rhs)
+				: m_lhs(p_lhs), m_rhs(p_rhs) {}
+
+			template <typename Lhs, typename Rhs, typename Result>
+			inline SCALAR Sum<Lhs, Rhs, Result>::operator[](unsigned int p_index) const {
+				return m_lhs[p_index] + m_rhs[p_index];
+			}
+
+			template <typename Lhs, typename Rhs, typename Result>
+			inline Difference<Lhs, Rhs, Result>::Difference(const Lhs& p_lhs, const Rhs& p_rhs)
+				: m_lhs(p_lhs), m_rhs(p_rhs) {}
+
+			template <typename Lhs, typename Rhs, typename Result>
+			inline SCALAR Difference<Lhs, Rhs, Result>::operator[](unsigned int p_index) const {
+				return m_lhs[p_index] - m_rhs[p_index];
+			}
+
+			template <typename Operand, typename Result>
+			inline Scaled<Operand, Result>::Scaled(const Operand& p_operand, SCALAR p_factor)
+				: m_operand(p_operand), m_factor(p_factor) {}
+
+			template <typename Operand, typename Result>
+			inline SCALAR Scaled<Operand, Result>::operator[](unsigned int p_index) const {
+				return m_operand[p_index] * m_factor;
+			}
+
+			template <typename Operand, typename Result>
+			inline Negated<Operand, Result>::Negated(const Operand& p_operand)
+				: m_operand(p_operand) {}
+
+			template <typename Operand, typename Result>
+			inline SCALAR Negated<Operand, Result>::operator[](unsigned int p_index) const {
+				return -m_operand[p_index];
+			}
+
+			template <typename Result>
+			inline Reference<Result> Lazy(const Result& p_value) {
+				return Reference<Result>(p_value);
+			}
+
+			template <typename E, typename Result>
+			inline Result& Assign(Result& p_target, const Base<E, Result>& p_expression) {
+				const E& expression = static_cast<const E&>(p_expression);
+				for (unsigned int i = 0; i < Traits<Result>::K_SIZE; ++i) {
+					p_target.m_data[i] = expression[i];
+				}
+
+				return p_target;
+			}
+
+			template <typename L, typename R, typename Result>
+			inline Sum<L, R, Result> operator+(const Base<L, Result>& p_lhs, const Base<R, Result>& p_rhs) {
+				return Sum<L, R, Result>(static_cast<const L&>(p_lhs), static_cast<const R&>(p_rhs));
+			}
+
+			template <typename L, typename Result>
+			inline Sum<L, Reference<Result>, Result> operator+(const Base<L, Result>& p_lhs, const Result& p_rhs) {
+				return Sum<L, Reference<Result>, Result>(static_cast<const L&>(p_lhs), Reference<Result>(p_rhs));
+			}
+
+			template <typename R, typename Result>
+			inline Sum<Reference<Result>, R, Result> operator+(const Result& p_lhs, const Base<R, Result>& p_rhs) {
+				return Sum<Reference<Result>, R, Result>(Reference<Result>(p_lhs), static_cast<const R&>(p_rhs));
+			}
+
+			template <typename L, typename R, typename Result>
+			inline Difference<L, R, Result> operator-(const Base<L, Result>& p_lhs, const Base<R, Result>& p_rhs) {
+				return Difference<L, R, Result>(static_cast<const L&>(p_lhs), static_cast<const R&>(p_rhs));
+			}
+
+			template <typename L, typename Result>
+			inline Difference<L, Reference<Result>, Result> operator-(const Base<L, Result>& p_lhs, const Result& p_rhs) {
+				return Difference<L, Reference<Result>, Result>(static_cast<const L&>(p_lhs), Reference<Result>(p_rhs));
+			}
+
+			template <typename R, typename Result>
+			inline Difference<Reference<Result>, R, Result> operator-(const Result& p_lhs, const Base<R, Result>& p_rhs) {
+				return Difference<Reference<Result>, R, Result>(Reference<Result>(p_lhs), static_cast<const R&>(p_rhs));
+			}
+
+			template <typename E, typename Result>
+			inline Scaled<E, Result> operator*(const Base<E, Result>& p_lhs, SCALAR p_rhs) {
+				return Scaled<E, Result>(static_cast<const E&>(p_lhs), p_rhs);
+			}
+
+			template <typename E, typename Result>
+			inline Scaled<E, Result> operator*(SCALAR p_lhs, const Base<E, Result>& p_rhs) {
+				return Scaled<E, Result>(static_cast<const E&>(p_rhs), p_lhs);
+			}
+
+			template <typename E, typename Result>
+			inline Scaled<E, Result> operator/(const Base<E, Result>& p_lhs, SCALAR p_rhs) {
+				return Scaled<E, Result>(static_cast<const E&>(p_lhs), 1.0f / p_rhs);
+			}
+
+			template <typename E, typename Result>
+			inline Negated<E, Result> operator-(const Base<E, Result>& p_operand) {
+				return Negated<E, Result>(static_cast<const E&>(p_operand));
+			}
+		}
+	}
+}
+
+#endif
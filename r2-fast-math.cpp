@@ -0,0 +1,326 @@
+#include "r2-fast-math.hpp"
+#include "r2-simd.hpp"
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		namespace Fast {
+			/**
+			 * Kernels. Each follows the scalar version in r2-math-generic.hpp step by
+			 * step, with the branches turned into masks. Rounding uses the current
+			 * rounding mode (to nearest) instead of rounding halves away from zero,
+			 * which does not change the error bounds.
+			 */
+#if defined(R2_ARCH_X86)
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Select(__m128 p_mask, __m128 p_true, __m128 p_false) {
+				return _mm_or_ps(_mm_and_ps(p_mask, p_true), _mm_andnot_ps(p_mask, p_false));
+			}
+
+			// NaN for zero, denormals and infinity, which the callers mask out
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2NewtonInverseSqrt(__m128 x) {
+				__m128 estimate = _mm_rsqrt_ps(x);
+				__m128 correction = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(estimate, estimate)));
+				return _mm_mul_ps(estimate, correction);
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2InverseSqrt(__m128 x) {
+				const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+				__m128 result = SSE2Select(_mm_cmplt_ps(x, _mm_set1_ps(std::numeric_limits<float>::min())), infinity, SSE2NewtonInverseSqrt(x));
+				return _mm_andnot_ps(_mm_cmpeq_ps(x, infinity), result);
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Sqrt(__m128 x) {
+				__m128 result = SSE2Select(_mm_cmpeq_ps(x, _mm_set1_ps(std::numeric_limits<float>::infinity())), x, _mm_mul_ps(x, SSE2NewtonInverseSqrt(x)));
+				return _mm_and_ps(_mm_cmpge_ps(x, _mm_set1_ps(std::numeric_limits<float>::min())), result);
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2SinPolynomial(__m128 r, __m128i p_quadrant) {
+				__m128 r2 = _mm_mul_ps(r, r);
+				__m128 result = _mm_add_ps(_mm_set1_ps(priv::K_SIN_3), _mm_mul_ps(r2, _mm_set1_ps(priv::K_SIN_4)));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_SIN_2), _mm_mul_ps(r2, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_SIN_1), _mm_mul_ps(r2, result));
+				result = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), result));
+
+				// the lowest bit of the quadrant shifted into the sign bit
+				return _mm_xor_ps(result, _mm_castsi128_ps(_mm_slli_epi32(p_quadrant, 31)));
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Sin(__m128 x) {
+				__m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.0f / K_PI)));
+				__m128 n = _mm_cvtepi32_ps(quadrant);
+				__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(priv::K_PI_HIGH))), _mm_mul_ps(n, _mm_set1_ps(priv::K_PI_LOW)));
+				return SSE2SinPolynomial(r, quadrant);
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Cos(__m128 x) {
+				__m128i quadrant = _mm_cvtps_epi32(_mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(1.0f / K_PI)), _mm_set1_ps(0.5f)));
+				__m128 n = _mm_cvtepi32_ps(quadrant);
+				__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(priv::K_PI_HIGH))), _mm_mul_ps(n, _mm_set1_ps(priv::K_PI_LOW)));
+				r = _mm_sub_ps(r, _mm_set1_ps(K_PI_2));
+				return SSE2SinPolynomial(r, _mm_add_epi32(quadrant, _mm_set1_epi32(1)));
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Exp(__m128 x) {
+				__m128 underflow = _mm_cmplt_ps(x, _mm_set1_ps(-87.0f));
+				x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(88.0f)), _mm_set1_ps(-87.0f));
+
+				__m128i exponent = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(priv::K_LOG2_E)));
+				__m128 n = _mm_cvtepi32_ps(exponent);
+				__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(priv::K_LN2_HIGH))), _mm_mul_ps(n, _mm_set1_ps(priv::K_LN2_LOW)));
+
+				__m128 result = _mm_add_ps(_mm_set1_ps(priv::K_EXP_5), _mm_mul_ps(r, _mm_set1_ps(priv::K_EXP_6)));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_EXP_4), _mm_mul_ps(r, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_EXP_3), _mm_mul_ps(r, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_EXP_2), _mm_mul_ps(r, result));
+				result = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r, result));
+				result = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r, result));
+
+				__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+				return _mm_andnot_ps(underflow, _mm_mul_ps(result, scale));
+			}
+
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Atan2(__m128 y, __m128 x) {
+				__m128 sign = _mm_set1_ps(-0.0f);
+				__m128 abs_x = _mm_andnot_ps(sign, x);
+				__m128 abs_y = _mm_andnot_ps(sign, y);
+				__m128 denominator = _mm_max_ps(abs_x, abs_y);
+				__m128 a = _mm_div_ps(_mm_min_ps(abs_x, abs_y), denominator);
+
+				__m128 a2 = _mm_mul_ps(a, a);
+				__m128 result = _mm_add_ps(_mm_set1_ps(priv::K_ATAN_6), _mm_mul_ps(a2, _mm_set1_ps(priv::K_ATAN_7)));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_ATAN_5), _mm_mul_ps(a2, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_ATAN_4), _mm_mul_ps(a2, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_ATAN_3), _mm_mul_ps(a2, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_ATAN_2), _mm_mul_ps(a2, result));
+				result = _mm_add_ps(_mm_set1_ps(priv::K_ATAN_1), _mm_mul_ps(a2, result));
+				result = _mm_add_ps(a, _mm_mul_ps(_mm_mul_ps(a, a2), result));
+
+				result = SSE2Select(_mm_cmpgt_ps(abs_y, abs_x), _mm_sub_ps(_mm_set1_ps(K_PI_2), result), result);
+				result = SSE2Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(K_PI), result), result);
+				result = _mm_xor_ps(result, _mm_and_ps(_mm_cmplt_ps(y, _mm_setzero_ps()), sign));
+
+				// 0 / 0 gave NaN above
+				return _mm_andnot_ps(_mm_cmpeq_ps(denominator, _mm_setzero_ps()), result);
+			}
+
+			r2SIMDTargetM("sse2")
+			static std::size_t SSE2Atan2(const float* p_y, const float* p_x, float* p_out, std::size_t p_count) {
+				std::size_t blocks = p_count & ~static_cast<std::size_t>(3);
+				for (std::size_t i = 0; i < blocks; i += 4) {
+					_mm_storeu_ps(p_out + i, SSE2Atan2(_mm_loadu_ps(p_y + i), _mm_loadu_ps(p_x + i)));
+				}
+
+				return blocks;
+			}
+
+			template <__m128 (*Function)(__m128)>
+			r2SIMDTargetM("sse2")
+			static std::size_t SSE2Map(const float* p_in, float* p_out, std::size_t p_count) {
+				std::size_t blocks = p_count & ~static_cast<std::size_t>(3);
+				for (std::size_t i = 0; i < blocks; i += 4) {
+					_mm_storeu_ps(p_out + i, Function(_mm_loadu_ps(p_in + i)));
+				}
+
+				return blocks;
+			}
+
+
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2NewtonInverseSqrt(__m256 x) {
+				__m256 estimate = _mm256_rsqrt_ps(x);
+				__m256 correction = _mm256_fnmadd_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), _mm256_mul_ps(estimate, estimate), _mm256_set1_ps(1.5f));
+				return _mm256_mul_ps(estimate, correction);
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2InverseSqrt(__m256 x) {
+				const __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+				__m256 result = _mm256_blendv_ps(AVX2NewtonInverseSqrt(x), infinity, _mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::min()), _CMP_LT_OQ));
+				return _mm256_andnot_ps(_mm256_cmp_ps(x, infinity, _CMP_EQ_OQ), result);
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2Sqrt(__m256 x) {
+				__m256 result = _mm256_blendv_ps(_mm256_mul_ps(x, AVX2NewtonInverseSqrt(x)), x, _mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_EQ_OQ));
+				return _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::min()), _CMP_GE_OQ), result);
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2SinPolynomial(__m256 r, __m256i p_quadrant) {
+				__m256 r2 = _mm256_mul_ps(r, r);
+				__m256 result = _mm256_fmadd_ps(r2, _mm256_set1_ps(priv::K_SIN_4), _mm256_set1_ps(priv::K_SIN_3));
+				result = _mm256_fmadd_ps(r2, result, _mm256_set1_ps(priv::K_SIN_2));
+				result = _mm256_fmadd_ps(r2, result, _mm256_set1_ps(priv::K_SIN_1));
+				result = _mm256_fmadd_ps(_mm256_mul_ps(r, r2), result, r);
+
+				return _mm256_xor_ps(result, _mm256_castsi256_ps(_mm256_slli_epi32(p_quadrant, 31)));
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2Sin(__m256 x) {
+				__m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(1.0f / K_PI)));
+				__m256 n = _mm256_cvtepi32_ps(quadrant);
+				__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(priv::K_PI_HIGH), x);
+				r = _mm256_fnmadd_ps(n, _mm256_set1_ps(priv::K_PI_LOW), r);
+				return AVX2SinPolynomial(r, quadrant);
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2Cos(__m256 x) {
+				__m256i quadrant = _mm256_cvtps_epi32(_mm256_fmsub_ps(x, _mm256_set1_ps(1.0f / K_PI), _mm256_set1_ps(0.5f)));
+				__m256 n = _mm256_cvtepi32_ps(quadrant);
+				__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(priv::K_PI_HIGH), x);
+				r = _mm256_fnmadd_ps(n, _mm256_set1_ps(priv::K_PI_LOW), r);
+				r = _mm256_sub_ps(r, _mm256_set1_ps(K_PI_2));
+				return AVX2SinPolynomial(r, _mm256_add_epi32(quadrant, _mm256_set1_epi32(1)));
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2Exp(__m256 x) {
+				__m256 underflow = _mm256_cmp_ps(x, _mm256_set1_ps(-87.0f), _CMP_LT_OQ);
+				x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(88.0f)), _mm256_set1_ps(-87.0f));
+
+				__m256i exponent = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(priv::K_LOG2_E)));
+				__m256 n = _mm256_cvtepi32_ps(exponent);
+				__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(priv::K_LN2_HIGH), x);
+				r = _mm256_fnmadd_ps(n, _mm256_set1_ps(priv::K_LN2_LOW), r);
+
+				__m256 result = _mm256_fmadd_ps(r, _mm256_set1_ps(priv::K_EXP_6), _mm256_set1_ps(priv::K_EXP_5));
+				result = _mm256_fmadd_ps(r, result, _mm256_set1_ps(priv::K_EXP_4));
+				result = _mm256_fmadd_ps(r, result, _mm256_set1_ps(priv::K_EXP_3));
+				result = _mm256_fmadd_ps(r, result, _mm256_set1_ps(priv::K_EXP_2));
+				result = _mm256_fmadd_ps(r, result, _mm256_set1_ps(1.0f));
+				result = _mm256_fmadd_ps(r, result, _mm256_set1_ps(1.0f));
+
+				__m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(exponent, _mm256_set1_epi32(127)), 23));
+				return _mm256_andnot_ps(underflow, _mm256_mul_ps(result, scale));
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static inline __m256 AVX2Atan2(__m256 y, __m256 x) {
+				__m256 sign = _mm256_set1_ps(-0.0f);
+				__m256 zero = _mm256_setzero_ps();
+				__m256 abs_x = _mm256_andnot_ps(sign, x);
+				__m256 abs_y = _mm256_andnot_ps(sign, y);
+				__m256 denominator = _mm256_max_ps(abs_x, abs_y);
+				__m256 a = _mm256_div_ps(_mm256_min_ps(abs_x, abs_y), denominator);
+
+				__m256 a2 = _mm256_mul_ps(a, a);
+				__m256 result = _mm256_fmadd_ps(a2, _mm256_set1_ps(priv::K_ATAN_7), _mm256_set1_ps(priv::K_ATAN_6));
+				result = _mm256_fmadd_ps(a2, result, _mm256_set1_ps(priv::K_ATAN_5));
+				result = _mm256_fmadd_ps(a2, result, _mm256_set1_ps(priv::K_ATAN_4));
+				result = _mm256_fmadd_ps(a2, result, _mm256_set1_ps(priv::K_ATAN_3));
+				result = _mm256_fmadd_ps(a2, result, _mm256_set1_ps(priv::K_ATAN_2));
+				result = _mm256_fmadd_ps(a2, result, _mm256_set1_ps(priv::K_ATAN_1));
+				result = _mm256_fmadd_ps(_mm256_mul_ps(a, a2), result, a);
+
+				result = _mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(K_PI_2), result), _mm256_cmp_ps(abs_y, abs_x, _CMP_GT_OQ));
+				result = _mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(K_PI), result), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+				result = _mm256_xor_ps(result, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), sign));
+
+				return _mm256_andnot_ps(_mm256_cmp_ps(denominator, zero, _CMP_EQ_OQ), result);
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static std::size_t AVX2Atan2(const float* p_y, const float* p_x, float* p_out, std::size_t p_count) {
+				std::size_t blocks = p_count & ~static_cast<std::size_t>(7);
+				for (std::size_t i = 0; i < blocks; i += 8) {
+					_mm256_storeu_ps(p_out + i, AVX2Atan2(_mm256_loadu_ps(p_y + i), _mm256_loadu_ps(p_x + i)));
+				}
+
+				return blocks;
+			}
+
+			template <__m256 (*Function)(__m256)>
+			r2SIMDTargetM("avx2,fma")
+			static std::size_t AVX2Map(const float* p_in, float* p_out, std::size_t p_count) {
+				std::size_t blocks = p_count & ~static_cast<std::size_t>(7);
+				for (std::size_t i = 0; i < blocks; i += 8) {
+					_mm256_storeu_ps(p_out + i, Function(_mm256_loadu_ps(p_in + i)));
+				}
+
+				return blocks;
+			}
+#endif
+
+			void InverseSqrt(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count) {
+				std::size_t i = 0;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Map<&AVX2InverseSqrt>(p_in, p_out, p_count);
+				else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Map<&SSE2InverseSqrt>(p_in, p_out, p_count);
+#endif
+				for (; i < p_count; ++i) {
+					p_out[i] = InverseSqrt(p_in[i]);
+				}
+			}
+
+			void Sqrt(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count) {
+				std::size_t i = 0;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Map<&AVX2Sqrt>(p_in, p_out, p_count);
+				else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Map<&SSE2Sqrt>(p_in, p_out, p_count);
+#endif
+				for (; i < p_count; ++i) {
+					p_out[i] = Sqrt(p_in[i]);
+				}
+			}
+
+			void Sin(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count) {
+				std::size_t i = 0;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Map<&AVX2Sin>(p_in, p_out, p_count);
+				else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Map<&SSE2Sin>(p_in, p_out, p_count);
+#endif
+				for (; i < p_count; ++i) {
+					p_out[i] = Sin(p_in[i]);
+				}
+			}
+
+			void Cos(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count) {
+				std::size_t i = 0;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Map<&AVX2Cos>(p_in, p_out, p_count);
+				else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Map<&SSE2Cos>(p_in, p_out, p_count);
+#endif
+				for (; i < p_count; ++i) {
+					p_out[i] = Cos(p_in[i]);
+				}
+			}
+
+			void Exp(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count) {
+				std::size_t i = 0;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Map<&AVX2Exp>(p_in, p_out, p_count);
+				else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Map<&SSE2Exp>(p_in, p_out, p_count);
+#endif
+				for (; i < p_count; ++i) {
+					p_out[i] = Exp(p_in[i]);
+				}
+			}
+
+			void Atan2(const SCALAR* p_y, const SCALAR* p_x, SCALAR* p_out, std::size_t p_count) {
+				std::size_t i = 0;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Atan2(p_y, p_x, p_out, p_count);
+				else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Atan2(p_y, p_x, p_out, p_count);
+#endif
+				for (; i < p_count; ++i) {
+					p_out[i] = Atan2(p_y[i], p_x[i]);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,145 @@
+/* HEADER
+ *
+ * File: r2-fast-math.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Array versions of the approximations in r2::Math::Fast (see
+ *	r2-math-generic.hpp for the error bounds, which hold here as well),
+ *	processing 4 (SSE2) or 8 (AVX2) elements at a time, and approximate
+ *	lengths and normalization of vectors.
+ * Depends on:
+ *  * r2::Math::Fast
+ *  * r2::Math::SIMD
+ *  * Vector2, Vector3, Vector4
+ * Updates:
+ *
+ */
+#ifndef R2_FAST_MATH_HPP
+#define R2_FAST_MATH_HPP
+
+#include <cstddef>
+#include "r2-math-generic.hpp"
+#include "r2-vector-2.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		namespace Fast {
+			/**
+			 * Approximate length of a vector
+			 */
+			inline SCALAR Length(const Vector2& p_vector);
+			inline SCALAR Length(const Vector3& p_vector);
+			inline SCALAR Length(const Vector4& p_vector);
+
+			/**
+			 * Approximately normalize the vector and return it
+			 */
+			inline Vector2& Normalize(Vector2& p_vector);
+			inline Vector3& Normalize(Vector3& p_vector);
+			inline Vector4& Normalize(Vector4& p_vector);
+
+			/**
+			 * Get an approximately normalized version of the vector
+			 */
+			inline Vector2 GetNormalized(const Vector2& p_vector);
+			inline Vector3 GetNormalized(const Vector3& p_vector);
+			inline Vector4 GetNormalized(const Vector4& p_vector);
+
+			/**
+			 * Array versions, p_out[i] = f(p_in[i]) for p_count elements. The output
+			 * may be the same array as an input.
+			 */
+			void InverseSqrt(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count);
+			void Sqrt(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count);
+			void Sin(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count);
+			void Cos(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count);
+			void Exp(const SCALAR* p_in, SCALAR* p_out, std::size_t p_count);
+
+			/**
+			 * p_out[i] = Atan2(p_y[i], p_x[i])
+			 */
+			void Atan2(const SCALAR* p_y, const SCALAR* p_x, SCALAR* p_out, std::size_t p_count);
+
+
+
+			/**
+			 * IMPLEMENTATION
+			 */
+			inline SCALAR Length(const Vector2& p_vector) {
+				return Sqrt(p_vector.x * p_vector.x + p_vector.y * p_vector.y);
+			}
+
+			inline SCALAR Length(const Vector3& p_vector) {
+				return Sqrt(p_vector.x * p_vector.x + p_vector.y * p_vector.y + p_vector.z * p_vector.z);
+			}
+
+			inline SCALAR Length(const Vector4& p_vector) {
+				return Sqrt(p_vector.x * p_vector.x + p_vector.y * p_vector.y + p_vector.z * p_vector.z + p_vector.w * p_vector.w);
+			}
+
+			inline Vector2& Normalize(Vector2& p_vector) {
+				SCALAR scale = InverseSqrt(p_vector.x * p_vector.x + p_vector.y * p_vector.y);
+				p_vector.x *= scale;
+				p_vector.y *= scale;
+
+				return p_vector;
+			}
+
+			inline Vector3& Normalize(Vector3& p_vector) {
+				SCALAR scale = InverseSqrt(p_vector.x * p_vector.x + p_vector.y * p_vector.y + p_vector.z * p_vector.z);
+				p_vector.x *= scale;
+				p_vector.y *= scale;
+				p_vector.z *= scale;
+
+				return p_vector;
+			}
+
+			inline Vector4& Normalize(Vector4& p_vector) {
+				SCALAR scale = InverseSqrt(p_vector.x * p_vector.x + p_vector.y * p_vector.y + p_vector.z * p_vector.z + p_vector.w * p_vector.w);
+				p_vector.x *= scale;
+				p_vector.y *= scale;
+				p_vector.z *= scale;
+				p_vector.w *= scale;
+
+				return p_vector;
+			}
+
+			inline Vector2 GetNormalized(const Vector2& p_vector) {
+				Vector2 result = p_vector;
+				return Normalize(result);
+			}
+
+			inline Vector3 GetNormalized(const Vector3& p_vector) {
+				Vector3 result = p_vector;
+				return Normalize(result);
+			}
+
+			inline Vector4 GetNormalized(const Vector4& p_vector) {
+				Vector4 result = p_vector;
+				return Normalize(result);
+			}
+		}
+	}
+}
+
+#endif
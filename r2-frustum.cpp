@@ -0,0 +1,299 @@
+#include "r2-frustum.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include "r2-parallel.hpp"
+#include <cmath>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		Frustum::Frustum() {
+			for (unsigned int i = 0; i < K_PLANE_COUNT; ++i) {
+				m_planes[i] = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+			}
+		}
+
+		// Gribb and Hartmann: -w <= x <= w gives the planes row 3 + row 0 and
+		// row 3 - row 0, and so on for y and z
+		Frustum::Frustum(const Matrix4& p_view_projection, DepthRange::DepthRange p_depth_range) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_view_projection.m_elements;
+
+			for (unsigned int c = 0; c < Matrix4::K_DIMENSIONS; ++c) {
+				m_planes[Left].m_data[c] = m[3][c] + m[0][c];
+				m_planes[Right].m_data[c] = m[3][c] - m[0][c];
+				m_planes[Bottom].m_data[c] = m[3][c] + m[1][c];
+				m_planes[Top].m_data[c] = m[3][c] - m[1][c];
+				m_planes[Near].m_data[c] = (p_depth_range == DepthRange::ZeroToOne) ? m[2][c] : m[3][c] + m[2][c];
+				m_planes[Far].m_data[c] = m[3][c] - m[2][c];
+			}
+
+			for (unsigned int i = 0; i < K_PLANE_COUNT; ++i) {
+				Vector4& plane = m_planes[i];
+				SCALAR length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+				if (length > 0.0f) plane *= 1.0f / length;
+			}
+		}
+
+		const Vector4& Frustum::GetPlane(Plane p_plane) const {
+			return m_planes[p_plane];
+		}
+
+		bool Frustum::IsVisible(const Vector3& p_point) const {
+			return IsVisible(p_point, 0.0f);
+		}
+
+		bool Frustum::IsVisible(const Vector3& p_center, SCALAR p_radius) const {
+			for (unsigned int i = 0; i < K_PLANE_COUNT; ++i) {
+				const Vector4& plane = m_planes[i];
+				if (plane.x * p_center.x + plane.y * p_center.y + plane.z * p_center.z + plane.w < -p_radius) return false;
+			}
+
+			return true;
+		}
+
+		// the corner furthest along the normal is the last one to leave the plane
+		bool Frustum::IsVisible(const Vector3& p_min, const Vector3& p_max) const {
+			for (unsigned int i = 0; i < K_PLANE_COUNT; ++i) {
+				const Vector4& plane = m_planes[i];
+				SCALAR x = (plane.x >= 0.0f) ? p_max.x : p_min.x;
+				SCALAR y = (plane.y >= 0.0f) ? p_max.y : p_min.y;
+				SCALAR z = (plane.z >= 0.0f) ? p_max.z : p_min.z;
+				if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) return false;
+			}
+
+			return true;
+		}
+
+
+
+
+		/**
+		 * Batched culling. Every volume is reduced to its smallest signed distance
+		 * to the planes, spheres as the distance of the center plus the radius and
+		 * boxes as the distance of the center plus the extents projected onto the
+		 * normal, so the planes need no branches. The kernels fill whole mask
+		 * words, starting at a multiple of 32 volumes.
+		 */
+		namespace CullMode {
+			enum CullMode { Sphere, Box };
+		}
+
+		struct CullPlanes {
+			float m_planes[Frustum::K_PLANE_COUNT][4];
+			float m_abs_normals[Frustum::K_PLANE_COUNT][3];
+		};
+
+		static const unsigned int K_MASK_BITS = 32;
+
+		// volumes per thread, a few thousand to pay for starting it
+		static const unsigned int K_MIN_CULL_WORDS = 256;
+
+		static unsigned int BitCount(unsigned int p_word) {
+			p_word = p_word - ((p_word >> 1) & 0x55555555u);
+			p_word = (p_word & 0x33333333u) + ((p_word >> 2) & 0x33333333u);
+			return (((p_word + (p_word >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+		}
+
+		// p_volume holds x, y, z, radius for spheres and min x, y, z, max x, y, z for boxes
+		static bool ScalarIsVisible(const CullPlanes& p_planes, const float* const* p_volume, unsigned int p_index, CullMode::CullMode p_mode) {
+			float x, y, z, extent_x = 0.0f, extent_y = 0.0f, extent_z = 0.0f, radius = 0.0f;
+			if (p_mode == CullMode::Sphere) {
+				x = p_volume[0][p_index];
+				y = p_volume[1][p_index];
+				z = p_volume[2][p_index];
+				radius = p_volume[3][p_index];
+			} else {
+				x = 0.5f * (p_volume[0][p_index] + p_volume[3][p_index]);
+				y = 0.5f * (p_volume[1][p_index] + p_volume[4][p_index]);
+				z = 0.5f * (p_volume[2][p_index] + p_volume[5][p_index]);
+				extent_x = 0.5f * (p_volume[3][p_index] - p_volume[0][p_index]);
+				extent_y = 0.5f * (p_volume[4][p_index] - p_volume[1][p_index]);
+				extent_z = 0.5f * (p_volume[5][p_index] - p_volume[2][p_index]);
+			}
+
+			for (unsigned int i = 0; i < Frustum::K_PLANE_COUNT; ++i) {
+				const float* plane = p_planes.m_planes[i];
+				const float* abs_normal = p_planes.m_abs_normals[i];
+				float distance = plane[0] * x + plane[1] * y + plane[2] * z + plane[3] +
+								 abs_normal[0] * extent_x + abs_normal[1] * extent_y + abs_normal[2] * extent_z;
+				if (distance < -radius) return false;
+			}
+
+			return true;
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2Cull(const CullPlanes& p_planes, const float* const* p_volume, unsigned int p_begin, unsigned int p_end, unsigned int* p_mask, CullMode::CullMode p_mode) {
+			const __m128 half = _mm_set1_ps(0.5f);
+
+			unsigned int i = p_begin;
+			for (; i + K_MASK_BITS <= p_end; i += K_MASK_BITS) {
+				unsigned int word = 0;
+				for (unsigned int bit = 0; bit < K_MASK_BITS; bit += 4) {
+					unsigned int index = i + bit;
+					__m128 x, y, z, extent_x, extent_y, extent_z;
+					if (p_mode == CullMode::Sphere) {
+						x = _mm_load_ps(p_volume[0] + index);
+						y = _mm_load_ps(p_volume[1] + index);
+						z = _mm_load_ps(p_volume[2] + index);
+					} else {
+						__m128 min_x = _mm_load_ps(p_volume[0] + index), max_x = _mm_load_ps(p_volume[3] + index);
+						__m128 min_y = _mm_load_ps(p_volume[1] + index), max_y = _mm_load_ps(p_volume[4] + index);
+						__m128 min_z = _mm_load_ps(p_volume[2] + index), max_z = _mm_load_ps(p_volume[5] + index);
+						x = _mm_mul_ps(half, _mm_add_ps(min_x, max_x));
+						y = _mm_mul_ps(half, _mm_add_ps(min_y, max_y));
+						z = _mm_mul_ps(half, _mm_add_ps(min_z, max_z));
+						extent_x = _mm_mul_ps(half, _mm_sub_ps(max_x, min_x));
+						extent_y = _mm_mul_ps(half, _mm_sub_ps(max_y, min_y));
+						extent_z = _mm_mul_ps(half, _mm_sub_ps(max_z, min_z));
+					}
+
+					__m128 distance = _mm_set1_ps(3.402823e38f);
+					for (unsigned int p = 0; p < Frustum::K_PLANE_COUNT; ++p) {
+						const float* plane = p_planes.m_planes[p];
+						__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), x), _mm_mul_ps(_mm_set1_ps(plane[1]), y)),
+											  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[2]), z), _mm_set1_ps(plane[3])));
+						if (p_mode == CullMode::Box) {
+							const float* abs_normal = p_planes.m_abs_normals[p];
+							d = _mm_add_ps(d, _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(abs_normal[0]), extent_x), _mm_mul_ps(_mm_set1_ps(abs_normal[1]), extent_y)),
+														 _mm_mul_ps(_mm_set1_ps(abs_normal[2]), extent_z)));
+						}
+						distance = _mm_min_ps(distance, d);
+					}
+
+					if (p_mode == CullMode::Sphere) distance = _mm_add_ps(distance, _mm_load_ps(p_volume[3] + index));
+					word |= static_cast<unsigned int>(_mm_movemask_ps(_mm_cmpge_ps(distance, _mm_setzero_ps()))) << bit;
+				}
+
+				p_mask[i / K_MASK_BITS] = word;
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2Cull(const CullPlanes& p_planes, const float* const* p_volume, unsigned int p_begin, unsigned int p_end, unsigned int* p_mask, CullMode::CullMode p_mode) {
+			const __m256 half = _mm256_set1_ps(0.5f);
+
+			unsigned int i = p_begin;
+			for (; i + K_MASK_BITS <= p_end; i += K_MASK_BITS) {
+				unsigned int word = 0;
+				for (unsigned int bit = 0; bit < K_MASK_BITS; bit += 8) {
+					unsigned int index = i + bit;
+					__m256 x, y, z, extent_x, extent_y, extent_z;
+					if (p_mode == CullMode::Sphere) {
+						x = _mm256_load_ps(p_volume[0] + index);
+						y = _mm256_load_ps(p_volume[1] + index);
+						z = _mm256_load_ps(p_volume[2] + index);
+					} else {
+						__m256 min_x = _mm256_load_ps(p_volume[0] + index), max_x = _mm256_load_ps(p_volume[3] + index);
+						__m256 min_y = _mm256_load_ps(p_volume[1] + index), max_y = _mm256_load_ps(p_volume[4] + index);
+						__m256 min_z = _mm256_load_ps(p_volume[2] + index), max_z = _mm256_load_ps(p_volume[5] + index);
+						x = _mm256_mul_ps(half, _mm256_add_ps(min_x, max_x));
+						y = _mm256_mul_ps(half, _mm256_add_ps(min_y, max_y));
+						z = _mm256_mul_ps(half, _mm256_add_ps(min_z, max_z));
+						extent_x = _mm256_mul_ps(half, _mm256_sub_ps(max_x, min_x));
+						extent_y = _mm256_mul_ps(half, _mm256_sub_ps(max_y, min_y));
+						extent_z = _mm256_mul_ps(half, _mm256_sub_ps(max_z, min_z));
+					}
+
+					__m256 distance = _mm256_set1_ps(3.402823e38f);
+					for (unsigned int p = 0; p < Frustum::K_PLANE_COUNT; ++p) {
+						const float* plane = p_planes.m_planes[p];
+						__m256 d = _mm256_fmadd_ps(_mm256_set1_ps(plane[0]), x, _mm256_set1_ps(plane[3]));
+						d = _mm256_fmadd_ps(_mm256_set1_ps(plane[1]), y, d);
+						d = _mm256_fmadd_ps(_mm256_set1_ps(plane[2]), z, d);
+						if (p_mode == CullMode::Box) {
+							const float* abs_normal = p_planes.m_abs_normals[p];
+							d = _mm256_fmadd_ps(_mm256_set1_ps(abs_normal[0]), extent_x, d);
+							d = _mm256_fmadd_ps(_mm256_set1_ps(abs_normal[1]), extent_y, d);
+							d = _mm256_fmadd_ps(_mm256_set1_ps(abs_normal[2]), extent_z, d);
+						}
+						distance = _mm256_min_ps(distance, d);
+					}
+
+					if (p_mode == CullMode::Sphere) distance = _mm256_add_ps(distance, _mm256_load_ps(p_volume[3] + index));
+					word |= static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ))) << bit;
+				}
+
+				p_mask[i / K_MASK_BITS] = word;
+			}
+
+			return i;
+		}
+#endif
+
+		static void CullRange(const CullPlanes& p_planes, const float* const* p_volume, unsigned int p_begin, unsigned int p_end, unsigned int* p_mask, CullMode::CullMode p_mode) {
+			unsigned int i = p_begin;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Cull(p_planes, p_volume, p_begin, p_end, p_mask, p_mode);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Cull(p_planes, p_volume, p_begin, p_end, p_mask, p_mode);
+#endif
+			for (; i < p_end; i += K_MASK_BITS) {
+				unsigned int word = 0;
+				unsigned int bits = (p_end - i < K_MASK_BITS) ? p_end - i : K_MASK_BITS;
+				for (unsigned int bit = 0; bit < bits; ++bit) {
+					if (ScalarIsVisible(p_planes, p_volume, i + bit, p_mode)) word |= 1u << bit;
+				}
+
+				p_mask[i / K_MASK_BITS] = word;
+			}
+		}
+
+		static unsigned int CullStreams(const Frustum& p_frustum, const float* const* p_volume, unsigned int p_count, unsigned int* p_mask, unsigned int p_thread_count, CullMode::CullMode p_mode) {
+			CullPlanes planes;
+			for (unsigned int p = 0; p < Frustum::K_PLANE_COUNT; ++p) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					planes.m_planes[p][c] = p_frustum.m_planes[p].m_data[c];
+				}
+				for (unsigned int c = 0; c < 3; ++c) {
+					planes.m_abs_normals[p][c] = std::fabs(p_frustum.m_planes[p].m_data[c]);
+				}
+			}
+
+			// chunks of whole words keep the kernels on aligned loads and separate words
+			unsigned int word_count = (p_count + K_MASK_BITS - 1) / K_MASK_BITS;
+			Parallel::For(word_count, K_MIN_CULL_WORDS, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				unsigned int begin = static_cast<unsigned int>(p_begin) * K_MASK_BITS;
+				unsigned int end = static_cast<unsigned int>(p_end) * K_MASK_BITS;
+				CullRange(planes, p_volume, begin, (end < p_count) ? end : p_count, p_mask, p_mode);
+			});
+
+			unsigned int visible = 0;
+			for (unsigned int i = 0; i < word_count; ++i) {
+				visible += BitCount(p_mask[i]);
+			}
+
+			return visible;
+		}
+
+		unsigned int Cull(const Frustum& p_frustum, const Vector4Stream& p_spheres, unsigned int* p_mask, unsigned int p_thread_count) {
+			const float* volume[4] = { p_spheres.GetX(), p_spheres.GetY(), p_spheres.GetZ(), p_spheres.GetW() };
+			return CullStreams(p_frustum, volume, p_spheres.Size(), p_mask, p_thread_count, CullMode::Sphere);
+		}
+
+		unsigned int Cull(const Frustum& p_frustum, const Vector3Stream& p_min, const Vector3Stream& p_max, unsigned int* p_mask, unsigned int p_thread_count) {
+			if (p_min.Size() != p_max.Size()) throw r2ExceptionArgumentM("Stream sizes do not match");
+
+			const float* volume[6] = { p_min.GetX(), p_min.GetY(), p_min.GetZ(), p_max.GetX(), p_max.GetY(), p_max.GetZ() };
+			return CullStreams(p_frustum, volume, p_min.Size(), p_mask, p_thread_count, CullMode::Box);
+		}
+
+		unsigned int GetVisibleIndices(const unsigned int* p_mask, unsigned int p_count, unsigned int* p_indices) {
+			unsigned int visible = 0;
+			unsigned int word_count = (p_count + K_MASK_BITS - 1) / K_MASK_BITS;
+			for (unsigned int i = 0; i < word_count; ++i) {
+				// peel off the lowest set bit until the word is empty; the bits below it give its index
+				for (unsigned int word = p_mask[i]; word != 0; word &= word - 1) {
+					p_indices[visible++] = i * K_MASK_BITS + BitCount((word & (0u - word)) - 1);
+				}
+			}
+
+			return visible;
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/* HEADER
+ *
+ * File: r2-frustum.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A view frustum as six planes extracted from a view-projection matrix
+ *	(column vectors, clip = M * v), and frustum culling of bounding spheres
+ *	and axis aligned boxes.
+ *
+ *	The batched tests take the volumes as streams and write a visibility
+ *	bitmask with 32 volumes per word: bit (i % 32) of word (i / 32) is set
+ *	if volume i may be visible. A mask for p_count volumes needs
+ *	(p_count + 31) / 32 words. GetVisibleIndices turns a mask into a
+ *	compact list of indices.
+ *
+ *	The tests are conservative: a volume is culled only if it is entirely
+ *	outside one of the planes, so volumes near the edges of the frustum may
+ *	be reported visible even if they are not.
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Exception::Argument
+ *  * r2::Math::SIMD
+ *  * r2::Parallel
+ *  * Vector3, Vector4, Matrix4
+ *  * Vector3Stream, Vector4Stream
+ *  * DepthRange (r2-projection)
+ * Updates:
+ *	2026-10-17 (Rarosu) - DepthRange moved to r2-projection.hpp
+ */
+#ifndef R2_FRUSTUM_HPP
+#define R2_FRUSTUM_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+#include "r2-matrix-4.hpp"
+#include "r2-projection.hpp"
+#include "r2-vector-stream.hpp"
+
+namespace r2 {
+	namespace Math {
+		class Frustum {
+		public:
+			/**
+			 * The order of the planes
+			 */
+			enum Plane { Left, Right, Bottom, Top, Near, Far };
+			static const unsigned int K_PLANE_COUNT = 6;
+
+			/**
+			 * Initialize a frustum that contains everything
+			 */
+			Frustum();
+
+			/**
+			 * Extract the planes from a view-projection matrix. With a projection
+			 * matrix alone, the planes are in view space.
+			 */
+			explicit Frustum(const Matrix4& p_view_projection, DepthRange::DepthRange p_depth_range = DepthRange::MinusOneToOne);
+
+			/**
+			 * Get a plane as (normal, distance), with a unit normal pointing into
+			 * the frustum. A point p is on the inside if Dot(normal, p) + distance >= 0.
+			 */
+			const Vector4& GetPlane(Plane p_plane) const;
+
+			/**
+			 * Test a single volume
+			 */
+			bool IsVisible(const Vector3& p_point) const;
+			bool IsVisible(const Vector3& p_center, SCALAR p_radius) const;
+			bool IsVisible(const Vector3& p_min, const Vector3& p_max) const;
+
+			Vector4 m_planes[K_PLANE_COUNT];
+		};
+
+		/**
+		 * Test p_spheres (xyz is the center, w the radius) against the frustum and
+		 * write the visibility bitmask. Returns the number of visible spheres.
+		 * Large streams are split over p_thread_count threads (0 uses all hardware
+		 * threads).
+		 */
+		unsigned int Cull(const Frustum& p_frustum, const Vector4Stream& p_spheres, unsigned int* p_mask, unsigned int p_thread_count = 1);
+
+		/**
+		 * Test the boxes [p_min[i], p_max[i]] against the frustum and write the
+		 * visibility bitmask. Returns the number of visible boxes. The streams
+		 * must be of the same size, or an Argument exception is raised.
+		 */
+		unsigned int Cull(const Frustum& p_frustum, const Vector3Stream& p_min, const Vector3Stream& p_max, unsigned int* p_mask, unsigned int p_thread_count = 1);
+
+		/**
+		 * Write the indices of the set bits of a mask for p_count volumes into
+		 * p_indices, in increasing order, and return their number. p_indices must
+		 * have room for all visible volumes.
+		 */
+		unsigned int GetVisibleIndices(const unsigned int* p_mask, unsigned int p_count, unsigned int* p_indices);
+	}
+}
+
+#endif
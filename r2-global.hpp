@@ -26,6 +26,7 @@
  *
  * Updates:
  *	2011-08-26 (Rarosu) - Updated with system defines
+ *	2026-10-17 (Rarosu) - Added architecture defines
  */
 #ifndef R2_GLOBAL_HPP
 #define R2_GLOBAL_HPP
@@ -43,6 +44,15 @@
 #endif
 
 
+// determine what architecture we are compiling for.
+#if defined(__x86_64__) || defined(__amd64__) || defined(_M_X64)
+	#define R2_ARCH_X86
+	#define R2_ARCH_X86_64
+#elif defined(__i386__) || defined(_M_IX86)
+	#define R2_ARCH_X86
+#endif
+
+
 // determine whether the debug flag should be on or not.
 #ifdef R2_SYSTEM_WINDOWS
 	#ifdef _DEBUG
@@ -0,0 +1,242 @@
+#include "r2-kd-tree.hpp"
+#include "r2-parallel.hpp"
+#include <algorithm>
+
+namespace r2 {
+	namespace Math {
+		// points per subtree handed to a thread, and queries per thread
+		static const unsigned int K_MIN_SUBTREE_SIZE = 16384;
+		static const unsigned int K_MIN_QUERY_CHUNK = 1024;
+
+		static const SCALAR K_LARGE = 3.402823e38f;
+
+		template <typename VectorType> const unsigned int KDTree<VectorType>::K_DIMENSIONS;
+		template <typename VectorType> const unsigned int KDTree<VectorType>::K_LEAF_SIZE;
+		template <typename VectorType> const unsigned int KDTree<VectorType>::K_NONE;
+
+		template <typename VectorType>
+		static inline SCALAR DistanceSquared(const VectorType& p_lhs, const VectorType& p_rhs) {
+			SCALAR sum = 0.0f;
+			for (unsigned int a = 0; a < KDTree<VectorType>::K_DIMENSIONS; ++a) {
+				SCALAR difference = p_lhs.m_data[a] - p_rhs.m_data[a];
+				sum += difference * difference;
+			}
+
+			return sum;
+		}
+
+		template <typename VectorType>
+		KDTree<VectorType>::KDTree() {}
+
+		template <typename VectorType>
+		KDTree<VectorType>::KDTree(const VectorType* p_points, unsigned int p_count, unsigned int p_thread_count) {
+			Build(p_points, p_count, p_thread_count);
+		}
+
+		template <typename VectorType>
+		void KDTree<VectorType>::Build(const VectorType* p_points, unsigned int p_count, unsigned int p_thread_count) {
+			m_entries.resize(p_count);
+			m_axes.assign(p_count, 0);
+			for (unsigned int i = 0; i < p_count; ++i) {
+				m_entries[i].m_point = p_points[i];
+				m_entries[i].m_index = i;
+			}
+
+			unsigned int thread_count = Parallel::GetThreadCount(p_thread_count);
+			if (thread_count <= 1 || p_count < 2 * K_MIN_SUBTREE_SIZE) {
+				BuildRange(0, p_count, 0, 0);
+				return;
+			}
+
+			// the upper levels here, then the subtrees below them in parallel
+			std::vector<unsigned int> deferred;
+			BuildRange(0, p_count, std::max(p_count / (4 * thread_count), K_MIN_SUBTREE_SIZE), &deferred);
+			Parallel::For(deferred.size() / 2, 1, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				for (std::size_t i = p_begin; i < p_end; ++i) {
+					BuildRange(deferred[2 * i], deferred[2 * i + 1], 0, 0);
+				}
+			});
+		}
+
+		// splits the range on the axis where the points spread the most
+		template <typename VectorType>
+		void KDTree<VectorType>::BuildRange(unsigned int p_begin, unsigned int p_end, unsigned int p_defer_size, std::vector<unsigned int>* p_deferred) {
+			if (p_end - p_begin <= K_LEAF_SIZE) return;
+			if (p_deferred != 0 && p_end - p_begin <= p_defer_size) {
+				p_deferred->push_back(p_begin);
+				p_deferred->push_back(p_end);
+				return;
+			}
+
+			SCALAR minimum[K_DIMENSIONS], maximum[K_DIMENSIONS];
+			for (unsigned int a = 0; a < K_DIMENSIONS; ++a) {
+				minimum[a] = maximum[a] = m_entries[p_begin].m_point.m_data[a];
+			}
+			for (unsigned int i = p_begin + 1; i < p_end; ++i) {
+				for (unsigned int a = 0; a < K_DIMENSIONS; ++a) {
+					SCALAR value = m_entries[i].m_point.m_data[a];
+					minimum[a] = (value < minimum[a]) ? value : minimum[a];
+					maximum[a] = (value > maximum[a]) ? value : maximum[a];
+				}
+			}
+
+			unsigned int axis = 0;
+			for (unsigned int a = 1; a < K_DIMENSIONS; ++a) {
+				if (maximum[a] - minimum[a] > maximum[axis] - minimum[axis]) axis = a;
+			}
+
+			unsigned int middle = p_begin + (p_end - p_begin) / 2;
+			std::nth_element(m_entries.begin() + p_begin, m_entries.begin() + middle, m_entries.begin() + p_end, [axis](const Entry& p_lhs, const Entry& p_rhs) {
+				return p_lhs.m_point.m_data[axis] < p_rhs.m_point.m_data[axis];
+			});
+			m_axes[middle] = static_cast<unsigned char>(axis);
+
+			BuildRange(p_begin, middle, p_defer_size, p_deferred);
+			BuildRange(middle + 1, p_end, p_defer_size, p_deferred);
+		}
+
+		template <typename VectorType>
+		unsigned int KDTree<VectorType>::Size() const {
+			return static_cast<unsigned int>(m_entries.size());
+		}
+
+		template <typename VectorType>
+		unsigned int KDTree<VectorType>::FindNearest(const VectorType& p_point) const {
+			Neighbour best = { K_LARGE, K_NONE };
+			SearchNearest(p_point, 0, Size(), best);
+			return best.m_index;
+		}
+
+		template <typename VectorType>
+		unsigned int KDTree<VectorType>::FindNearest(const VectorType& p_point, unsigned int p_k, unsigned int* p_indices, SCALAR* p_distances_squared) const {
+			if (p_k == 0) return 0;
+
+			std::vector<Neighbour> heap(p_k);
+			unsigned int size = 0;
+			SearchNearest(p_point, 0, Size(), &heap[0], p_k, size);
+
+			std::sort_heap(heap.begin(), heap.begin() + size);
+			for (unsigned int i = 0; i < size; ++i) {
+				p_indices[i] = heap[i].m_index;
+				if (p_distances_squared != 0) p_distances_squared[i] = heap[i].m_distance_squared;
+			}
+
+			return size;
+		}
+
+		template <typename VectorType>
+		unsigned int KDTree<VectorType>::FindInRadius(const VectorType& p_point, SCALAR p_radius, std::vector<unsigned int>& p_result) const {
+			std::size_t first_result = p_result.size();
+			SearchRadius(p_point, 0, Size(), p_radius * p_radius, p_result);
+			return static_cast<unsigned int>(p_result.size() - first_result);
+		}
+
+		template <typename VectorType>
+		void KDTree<VectorType>::FindNearest(const VectorType* p_points, unsigned int p_count, unsigned int* p_result, unsigned int p_thread_count) const {
+			Parallel::For(p_count, K_MIN_QUERY_CHUNK, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				for (std::size_t i = p_begin; i < p_end; ++i) {
+					p_result[i] = FindNearest(p_points[i]);
+				}
+			});
+		}
+
+		template <typename VectorType>
+		void KDTree<VectorType>::FindNearest(const VectorType* p_points, unsigned int p_count, unsigned int p_k, unsigned int* p_result, unsigned int p_thread_count) const {
+			if (p_k == 0) return;
+
+			Parallel::For(p_count, K_MIN_QUERY_CHUNK, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				std::vector<Neighbour> heap(p_k);
+				for (std::size_t i = p_begin; i < p_end; ++i) {
+					unsigned int size = 0;
+					SearchNearest(p_points[i], 0, Size(), &heap[0], p_k, size);
+					std::sort_heap(heap.begin(), heap.begin() + size);
+
+					unsigned int* result = p_result + i * p_k;
+					for (unsigned int j = 0; j < p_k; ++j) {
+						result[j] = (j < size) ? heap[j].m_index : K_NONE;
+					}
+				}
+			});
+		}
+
+		// The near side of the split first, the far side only if the splitting
+		// plane is closer than the best point so far.
+		template <typename VectorType>
+		void KDTree<VectorType>::SearchNearest(const VectorType& p_point, unsigned int p_begin, unsigned int p_end, Neighbour& p_best) const {
+			if (p_end - p_begin <= K_LEAF_SIZE) {
+				for (unsigned int i = p_begin; i < p_end; ++i) {
+					SCALAR distance = DistanceSquared(p_point, m_entries[i].m_point);
+					if (distance < p_best.m_distance_squared) {
+						p_best.m_distance_squared = distance;
+						p_best.m_index = m_entries[i].m_index;
+					}
+				}
+				return;
+			}
+
+			unsigned int middle = p_begin + (p_end - p_begin) / 2;
+			const Entry& entry = m_entries[middle];
+			SCALAR distance = DistanceSquared(p_point, entry.m_point);
+			if (distance < p_best.m_distance_squared) {
+				p_best.m_distance_squared = distance;
+				p_best.m_index = entry.m_index;
+			}
+
+			SCALAR offset = p_point.m_data[m_axes[middle]] - entry.m_point.m_data[m_axes[middle]];
+			if (offset < 0.0f) {
+				SearchNearest(p_point, p_begin, middle, p_best);
+				if (offset * offset < p_best.m_distance_squared) SearchNearest(p_point, middle + 1, p_end, p_best);
+			} else {
+				SearchNearest(p_point, middle + 1, p_end, p_best);
+				if (offset * offset < p_best.m_distance_squared) SearchNearest(p_point, p_begin, middle, p_best);
+			}
+		}
+
+		// p_heap is a max heap of the p_size (at most p_k) closest points so far
+		template <typename VectorType>
+		void KDTree<VectorType>::SearchNearest(const VectorType& p_point, unsigned int p_begin, unsigned int p_end, Neighbour* p_heap, unsigned int p_k, unsigned int& p_size) const {
+			unsigned int middle = p_begin + (p_end - p_begin) / 2;
+			bool leaf = p_end - p_begin <= K_LEAF_SIZE;
+
+			for (unsigned int i = leaf ? p_begin : middle; i < (leaf ? p_end : middle + 1); ++i) {
+				Neighbour candidate = { DistanceSquared(p_point, m_entries[i].m_point), m_entries[i].m_index };
+				if (p_size < p_k) {
+					p_heap[p_size++] = candidate;
+					std::push_heap(p_heap, p_heap + p_size);
+				} else if (candidate < p_heap[0]) {
+					std::pop_heap(p_heap, p_heap + p_size);
+					p_heap[p_size - 1] = candidate;
+					std::push_heap(p_heap, p_heap + p_size);
+				}
+			}
+			if (leaf) return;
+
+			SCALAR offset = p_point.m_data[m_axes[middle]] - m_entries[middle].m_point.m_data[m_axes[middle]];
+			unsigned int near_begin = (offset < 0.0f) ? p_begin : middle + 1;
+			unsigned int near_end = (offset < 0.0f) ? middle : p_end;
+			unsigned int far_begin = (offset < 0.0f) ? middle + 1 : p_begin;
+			unsigned int far_end = (offset < 0.0f) ? p_end : middle;
+
+			SearchNearest(p_point, near_begin, near_end, p_heap, p_k, p_size);
+			if (p_size < p_k || offset * offset < p_heap[0].m_distance_squared) SearchNearest(p_point, far_begin, far_end, p_heap, p_k, p_size);
+		}
+
+		template <typename VectorType>
+		void KDTree<VectorType>::SearchRadius(const VectorType& p_point, unsigned int p_begin, unsigned int p_end, SCALAR p_radius_squared, std::vector<unsigned int>& p_result) const {
+			unsigned int middle = p_begin + (p_end - p_begin) / 2;
+			bool leaf = p_end - p_begin <= K_LEAF_SIZE;
+
+			for (unsigned int i = leaf ? p_begin : middle; i < (leaf ? p_end : middle + 1); ++i) {
+				if (DistanceSquared(p_point, m_entries[i].m_point) <= p_radius_squared) p_result.push_back(m_entries[i].m_index);
+			}
+			if (leaf) return;
+
+			SCALAR offset = p_point.m_data[m_axes[middle]] - m_entries[middle].m_point.m_data[m_axes[middle]];
+			if (offset <= 0.0f || offset * offset <= p_radius_squared) SearchRadius(p_point, p_begin, middle, p_radius_squared, p_result);
+			if (offset >= 0.0f || offset * offset <= p_radius_squared) SearchRadius(p_point, middle + 1, p_end, p_radius_squared, p_result);
+		}
+
+		template class KDTree<Vector2>;
+		template class KDTree<Vector3>;
+	}
+}
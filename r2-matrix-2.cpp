@@ -4,36 +4,11 @@
 
 namespace r2 {
 	namespace Math {
-		const Matrix2 Matrix2::K_ZERO_MATRIX;
-		const Matrix2 Matrix2::K_IDENTITY(1.0f);
-
-		Matrix2::Matrix2() {
-			memset(m_data, 0, sizeof(m_data));
-		}
-
-		Matrix2::Matrix2(SCALAR p_diagonal_element) {
-			memset(m_data, 0, sizeof(m_data));
-			for (int i = 0; i < K_DIMENSIONS; ++i) {
-				m_elements[i][i] = p_diagonal_element;
-			}
-		}
-
-		Matrix2::Matrix2(SCALAR p_00, SCALAR p_01, SCALAR p_10, SCALAR p_11) {
-			m_elements[0][0] = p_00;
-			m_elements[0][1] = p_01;
-			m_elements[1][0] = p_10;
-			m_elements[1][1] = p_11;
-		}
 
 		Matrix2::Matrix2(const SCALAR* p_raw_data) {
 			memcpy(m_data, p_raw_data, sizeof(m_data));
 		}
 
-		Matrix2::Matrix2(const Vector2& p_row_1, const Vector2& p_row_2) {
-			SetRow(0, p_row_1);
-			SetRow(1, p_row_2);
-		}
-
 		Vector2 Matrix2::GetRow(unsigned int p_row) const {
 			return Vector2(m_elements[p_row]);
 		}
@@ -81,7 +56,13 @@ namespace r2 {
 		}
 
 		Matrix2& Matrix2::operator-=(const Matrix2& p_rhs) {
-			return *this += (-p_rhs);
+			for (int row = 0; row < K_DIMENSIONS; ++row) {
+				for (int col = 0; col < K_DIMENSIONS; ++col) {
+					m_elements[row][col] -= p_rhs.m_elements[row][col];
+				}
+			}
+
+			return *this;
 		}
 
 		Matrix2& Matrix2::operator*=(SCALAR p_rhs) {
@@ -26,7 +26,8 @@
  *  * SCALAR
  *  * FloatCompare
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Fixed operator-= negating a full copy of the operand
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
  */
 #ifndef R2_MATRIX_2_HPP
 #define R2_MATRIX_2_HPP
@@ -42,19 +43,19 @@ namespace r2 {
 			/**
 			 * Initialize the zero matrix
 			 */
-			Matrix2();
+			constexpr Matrix2();
 
 			/**
 			 * Initialize a matrix with the given parameter as the diagonal elements. The rest
 			 * of the elements are set to 0.
 			 */
-			Matrix2(SCALAR p_diagonal_element);
+			constexpr Matrix2(SCALAR p_diagonal_element);
 
 			/**
 			 * Initialize the matrix with the given elements. Row order, so for instance
 			 * p_01 will be the first row and the second column.
 			 */
-			Matrix2(SCALAR p_00, SCALAR p_01, SCALAR p_10, SCALAR p_11);
+			constexpr Matrix2(SCALAR p_00, SCALAR p_01, SCALAR p_10, SCALAR p_11);
 
 			/**
 			 * Initialize the matrix from an array of scalars. Will assume the array
@@ -66,7 +67,7 @@ namespace r2 {
 			/**
 			 * Initialize the matrix with the given row vectors
 			 */
-			Matrix2(const Vector2& p_row_1,
+			constexpr Matrix2(const Vector2& p_row_1,
 					const Vector2& p_row_2);
 
 
@@ -171,6 +172,30 @@ namespace r2 {
 		 * singular, a DivisionByZero exception is raised.
 		 */
 		Matrix2 GetInverse(const Matrix2& p_matrix);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Matrix2::Matrix2()
+			: m_data{} {}
+
+		constexpr Matrix2::Matrix2(SCALAR p_diagonal_element)
+			: m_data{p_diagonal_element, 0.0f,
+					 0.0f, p_diagonal_element} {}
+
+		constexpr Matrix2::Matrix2(SCALAR p_00, SCALAR p_01,
+					SCALAR p_10, SCALAR p_11)
+			: m_data{p_00, p_01,
+					 p_10, p_11} {}
+
+		constexpr Matrix2::Matrix2(const Vector2& p_row_1, const Vector2& p_row_2)
+			: m_data{p_row_1.x, p_row_1.y,
+					 p_row_2.x, p_row_2.y} {}
+
+		inline constexpr Matrix2 Matrix2::K_ZERO_MATRIX;
+		inline constexpr Matrix2 Matrix2::K_IDENTITY(1.0f);
 	}
 }
 
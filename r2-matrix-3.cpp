@@ -6,44 +6,11 @@ namespace r2
 {
 	namespace Math
 	{
-		const Matrix3 Matrix3::K_ZERO_MATRIX;
-		const Matrix3 Matrix3::K_IDENTITY(1.0f);
-
-		Matrix3::Matrix3() {
-			memset(m_data, 0, sizeof(m_data));
-		}
-
-		Matrix3::Matrix3(SCALAR p_diagonal_element) {
-			memset(m_data, 0, sizeof(m_data));
-			for (int i = 0; i < K_DIMENSIONS; ++i) {
-				m_elements[i][i] = p_diagonal_element;
-			}
-		}
-
-		Matrix3::Matrix3(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_10, SCALAR p_11, SCALAR p_12, SCALAR p_20, SCALAR p_21, SCALAR p_22) {
-			m_elements[0][0] = p_00;
-			m_elements[0][1] = p_01;
-			m_elements[0][2] = p_02;
-
-			m_elements[1][0] = p_10;
-			m_elements[1][1] = p_11;
-			m_elements[1][2] = p_12;
-
-			m_elements[2][0] = p_20;
-			m_elements[2][1] = p_21;
-			m_elements[2][2] = p_22;
-		}
 
 		Matrix3::Matrix3(SCALAR* p_raw_data) {
 			memcpy(m_data, p_raw_data, sizeof(m_data));
 		}
 
-		Matrix3::Matrix3(const Vector3& p_row_1, const Vector3& p_row_2, const Vector3& p_row_3) {
-			SetRow(0, p_row_1);
-			SetRow(1, p_row_2);
-			SetRow(2, p_row_3);
-		}
-
 
 		Vector3 Matrix3::GetRow(int p_row) const {
 			return Vector3(m_elements[p_row]);
@@ -72,7 +39,7 @@ namespace r2
 		}
 
 		Matrix3 Matrix3::operator-() const {
-			Matrix3 result;
+			Matrix3 result = *this;
 			for (int row = 0; row < K_DIMENSIONS; ++row) {
 				for (int col = 0; col < K_DIMENSIONS; ++col) {
 					result.m_elements[row][col] = -result.m_elements[row][col];
@@ -93,7 +60,13 @@ namespace r2
 		}
 
 		Matrix3& Matrix3::operator-=(const Matrix3& p_rhs) {
-			return *this += (-p_rhs);
+			for (int row = 0; row < K_DIMENSIONS; ++row) {
+				for (int col = 0; col < K_DIMENSIONS; ++col) {
+					m_elements[row][col] -= p_rhs.m_elements[row][col];
+				}
+			}
+
+			return *this;
 		}
 
 		Matrix3& Matrix3::operator*=(SCALAR p_rhs) {
@@ -209,7 +182,7 @@ namespace r2
 
 		Vector3 operator*(const Matrix3& p_lhs, const Vector3& p_rhs) {
 			Vector3 result;
-			for (int row = 0; row < Matrix2::K_DIMENSIONS; ++row) {
+			for (int row = 0; row < Matrix3::K_DIMENSIONS; ++row) {
 				result[row] = Dot(p_lhs.GetRow(row), p_rhs);
 			}
 
@@ -26,7 +26,9 @@
  *  * SCALAR
  *  * FloatCompare
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Fixed operator-() negating the zero matrix and operator-= negating a full copy
+ *	2026-10-17 (Rarosu) - Fixed Matrix3 * Vector3 only computing two components
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
  */
 #ifndef R2_MATRIX_3_HPP
 #define R2_MATRIX_3_HPP
@@ -43,19 +45,19 @@ namespace r2 {
 			/**
 			 * Initialize the zero matrix
 			 */
-			Matrix3();
+			constexpr Matrix3();
 
 			/**
 			 * Initialize a matrix with the given parameter as the diagonal elements. The rest
 			 * of the elements are set to 0.
 			 */
-			Matrix3(SCALAR p_diagonal_element);
+			constexpr Matrix3(SCALAR p_diagonal_element);
 
 			/**
 			 * Initialize the matrix with the given elements. Row order, so for instance
 			 * p_01 will be the first row and the second column.
 			 */
-			Matrix3(SCALAR p_00, SCALAR p_01, SCALAR p_02,
+			constexpr Matrix3(SCALAR p_00, SCALAR p_01, SCALAR p_02,
 					SCALAR p_10, SCALAR p_11, SCALAR p_12,
 					SCALAR p_20, SCALAR p_21, SCALAR p_22);
 
@@ -69,7 +71,7 @@ namespace r2 {
 			/**
 			 * Initialize the matrix with the given row vectors
 			 */
-			Matrix3(const Vector3& p_row_1,
+			constexpr Matrix3(const Vector3& p_row_1,
 					const Vector3& p_row_2,
 					const Vector3& p_row_3);
 
@@ -193,6 +195,34 @@ namespace r2 {
 		 * singular, a DivisionByZero exception is raised.
 		 */
 		Matrix3 GetInverse(const Matrix3& p_matrix);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Matrix3::Matrix3()
+			: m_data{} {}
+
+		constexpr Matrix3::Matrix3(SCALAR p_diagonal_element)
+			: m_data{p_diagonal_element, 0.0f, 0.0f,
+					 0.0f, p_diagonal_element, 0.0f,
+					 0.0f, 0.0f, p_diagonal_element} {}
+
+		constexpr Matrix3::Matrix3(SCALAR p_00, SCALAR p_01, SCALAR p_02,
+					SCALAR p_10, SCALAR p_11, SCALAR p_12,
+					SCALAR p_20, SCALAR p_21, SCALAR p_22)
+			: m_data{p_00, p_01, p_02,
+					 p_10, p_11, p_12,
+					 p_20, p_21, p_22} {}
+
+		constexpr Matrix3::Matrix3(const Vector3& p_row_1, const Vector3& p_row_2, const Vector3& p_row_3)
+			: m_data{p_row_1.x, p_row_1.y, p_row_1.z,
+					 p_row_2.x, p_row_2.y, p_row_2.z,
+					 p_row_3.x, p_row_3.y, p_row_3.z} {}
+
+		inline constexpr Matrix3 Matrix3::K_ZERO_MATRIX;
+		inline constexpr Matrix3 Matrix3::K_IDENTITY(1.0f);
 	}
 }
 
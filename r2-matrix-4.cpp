@@ -1,54 +1,53 @@
 #include "r2-matrix-4.hpp"
 #include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include "r2-parallel.hpp"
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
 
 namespace r2
 {
 	namespace Math
 	{
-		const Matrix4 Matrix4::K_ZERO_MATRIX;
-		const Matrix4 Matrix4::K_IDENTITY(1.0f);
 
-		Matrix4::Matrix4() {
-			memset(m_data, 0, sizeof(m_data));
-		}
+		static const SCALAR K_SINGULAR_EPSILON = std::numeric_limits<SCALAR>::epsilon();
+
+		/**
+		 * The determinant below which the upper left p_size x p_size part of
+		 * p_rows is treated as singular: p_size epsilons of the largest possible
+		 * determinant for its row and column lengths (Hadamard's bound), so the
+		 * test follows the scale of the matrix rather than its absolute size.
+		 */
+		static SCALAR GetSingularThreshold(const SCALAR (*p_rows)[Matrix4::K_DIMENSIONS], unsigned int p_size) {
+			double row_bound = 1.0;
+			double column_bound = 1.0;
+			for (unsigned int i = 0; i < p_size; ++i) {
+				double row_length = 0.0;
+				double column_length = 0.0;
+				for (unsigned int k = 0; k < p_size; ++k) {
+					row_length += (double)p_rows[i][k] * p_rows[i][k];
+					column_length += (double)p_rows[k][i] * p_rows[k][i];
+				}
 
-		Matrix4::Matrix4(SCALAR p_diagonal_element) {
-			memset(m_data, 0, sizeof(m_data));
-			for (int i = 0; i < K_DIMENSIONS; ++i) {
-				m_elements[i][i] = p_diagonal_element;
+				row_bound *= std::sqrt(row_length);
+				column_bound *= std::sqrt(column_length);
 			}
-		}
-
-		Matrix4::Matrix4(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_03, SCALAR p_10, SCALAR p_11, SCALAR p_12, SCALAR p_13, SCALAR p_20, SCALAR p_21, SCALAR p_22, SCALAR p_23, SCALAR p_30, SCALAR p_31, SCALAR p_32, SCALAR p_33) {
-			m_elements[0][0] = p_00;
-			m_elements[0][1] = p_01;
-			m_elements[0][2] = p_02;
 
-			m_elements[1][0] = p_10;
-			m_elements[1][1] = p_11;
-			m_elements[1][2] = p_12;
+			return (SCALAR)(p_size * K_SINGULAR_EPSILON * std::min(row_bound, column_bound));
+		}
 
-			m_elements[2][0] = p_20;
-			m_elements[2][1] = p_21;
-			m_elements[2][2] = p_22;
 
-			m_elements[3][0] = p_30;
-			m_elements[3][1] = p_31;
-			m_elements[3][2] = p_32;
-		}
 
 		Matrix4::Matrix4(SCALAR* p_raw_data) {
 			memcpy(m_data, p_raw_data, sizeof(m_data));
 		}
 
-		Matrix4::Matrix4(const Vector4& p_row_1, const Vector4& p_row_2, const Vector4& p_row_3, const Vector4& p_row_4) {
-			SetRow(0, p_row_1);
-			SetRow(1, p_row_2);
-			SetRow(2, p_row_3);
-			SetRow(3, p_row_4);
-		}
-
 
 
 
@@ -85,47 +84,27 @@ namespace r2
 
 		Matrix4 Matrix4::operator-() const {
 			Matrix4 result;
-			for (int row = 0; row < K_DIMENSIONS; ++row) {
-				for (int col = 0; col < K_DIMENSIONS; ++col) {
-					result.m_elements[row][col] = -result.m_elements[row][col];
-				}
-			}
-
+			SIMD::GetKernels().m_matrix4_scale(result.m_data, m_data, -1.0f);
 			return result;
 		}
 
 		Matrix4& Matrix4::operator+=(const Matrix4& p_rhs) {
-			for (int row = 0; row < K_DIMENSIONS; ++row) {
-				for (int col = 0; col < K_DIMENSIONS; ++col) {
-					m_elements[row][col] += p_rhs.m_elements[row][col];
-				}
-			}
-
+			SIMD::GetKernels().m_matrix4_add(m_data, m_data, p_rhs.m_data);
 			return *this;
 		}
 
 		Matrix4& Matrix4::operator-=(const Matrix4& p_rhs) {
-			return *this += (-p_rhs);
+			SIMD::GetKernels().m_matrix4_subtract(m_data, m_data, p_rhs.m_data);
+			return *this;
 		}
 
 		Matrix4& Matrix4::operator*=(SCALAR p_rhs) {
-			for (int row = 0; row < K_DIMENSIONS; ++row) {
-				for (int col = 0; col < K_DIMENSIONS; ++col) {
-					m_elements[row][col] *= p_rhs;
-				}
-			}
-
+			SIMD::GetKernels().m_matrix4_scale(m_data, m_data, p_rhs);
 			return *this;
 		}
 
 		Matrix4& Matrix4::operator*=(const Matrix4& p_rhs) {
-			for (int row = 0; row < K_DIMENSIONS; ++row) {
-				Vector4 temp = GetRow(row);
-				for (int col = 0; col < K_DIMENSIONS; ++col) {
-					m_elements[row][col] = Dot(temp, p_rhs.GetColumn(col));
-				}
-			}
-
+			SIMD::GetKernels().m_matrix4_multiply(m_data, m_data, p_rhs.m_data);
 			return *this;
 		}
 
@@ -148,33 +127,69 @@ namespace r2
 		}
 
 		SCALAR Matrix4::Determinant() const {
-			SCALAR determinant = 0;
-			for (int i = 0; i < K_DIMENSIONS; ++i) {
-				determinant += ((i % 2 == 0) ? 1.0f : -1.0f) * m_elements[0][i] * GetMinorMatrix(0, i).Determinant();
-			}
+			const SCALAR* m = m_data;
+
+			// 2x2 sub-determinants of the upper and lower row pairs
+			SCALAR s0 = m[0] * m[5] - m[4] * m[1];
+			SCALAR s1 = m[0] * m[6] - m[4] * m[2];
+			SCALAR s2 = m[0] * m[7] - m[4] * m[3];
+			SCALAR s3 = m[1] * m[6] - m[5] * m[2];
+			SCALAR s4 = m[1] * m[7] - m[5] * m[3];
+			SCALAR s5 = m[2] * m[7] - m[6] * m[3];
+
+			SCALAR c5 = m[10] * m[15] - m[14] * m[11];
+			SCALAR c4 = m[9] * m[15] - m[13] * m[11];
+			SCALAR c3 = m[9] * m[14] - m[13] * m[10];
+			SCALAR c2 = m[8] * m[15] - m[12] * m[11];
+			SCALAR c1 = m[8] * m[14] - m[12] * m[10];
+			SCALAR c0 = m[8] * m[13] - m[12] * m[9];
 
-			return determinant;
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 		}
 
 
 		Matrix4& Matrix4::Transpose() {
-			for (int row = 0; row < K_DIMENSIONS; ++row) {
-				for (int col = row + 1; col < K_DIMENSIONS; ++col) {
-					SCALAR temp = m_elements[col][row];
-					m_elements[col][row] = m_elements[row][col];
-					m_elements[row][col] = temp;
-				}
-			}
-			
+			SIMD::GetKernels().m_matrix4_transpose(m_data, m_data);
 			return *this;
 		}
 
 		Matrix4& Matrix4::Invert() {
-			SCALAR determinant = Determinant();
+			SCALAR result[K_DIMENSIONS * K_DIMENSIONS];
+			SCALAR determinant = SIMD::GetKernels().m_matrix4_invert(result, m_data);
+
+			if (std::fabs(determinant) <= GetSingularThreshold(m_elements, K_DIMENSIONS)) throw r2ExceptionDivisionByZeroM("Singular matrix cannot be inverted");
+
+			memcpy(m_data, result, sizeof(m_data));
+			return *this;
+		}
+
+		Matrix4& Matrix4::InvertAffine() {
+			Matrix4 result;
+			if (!priv::InvertAffineRows(m_elements, result.m_elements)) throw r2ExceptionDivisionByZeroM("Singular matrix cannot be inverted");
+
+			result.m_elements[3][3] = 1.0f;
+
+			*this = result;
+			return *this;
+		}
+
+		Matrix4& Matrix4::InvertOrthonormal() {
+			Matrix4 result;
+			for (int row = 0; row < 3; ++row) {
+				for (int col = 0; col < 3; ++col) {
+					result.m_elements[row][col] = m_elements[col][row];
+				}
+			}
+
+			for (int row = 0; row < 3; ++row) {
+				result.m_elements[row][3] = -(result.m_elements[row][0] * m_elements[0][3] +
+											  result.m_elements[row][1] * m_elements[1][3] +
+											  result.m_elements[row][2] * m_elements[2][3]);
+			}
 
-			if (FloatCompare(determinant, 0.0f)) throw r2ExceptionDivisionByZeroM("Singular matrix cannot be inverted");
+			result.m_elements[3][3] = 1.0f;
 
-			*this = GetAdjugate(*this) / determinant;
+			*this = result;
 			return *this;
 		}
 
@@ -225,15 +240,14 @@ namespace r2
 		}
 
 		Matrix4 operator*(const Matrix4& p_lhs, const Matrix4& p_rhs) {
-			return (Matrix4(p_lhs) *= p_rhs);
+			Matrix4 result;
+			SIMD::GetKernels().m_matrix4_multiply(result.m_data, p_lhs.m_data, p_rhs.m_data);
+			return result;
 		}
 
 		Vector4 operator*(const Matrix4& p_lhs, const Vector4& p_rhs) {
 			Vector4 result;
-			for (int row = 0; row < Matrix2::K_DIMENSIONS; ++row) {
-				result[row] = Dot(p_lhs.GetRow(row), p_rhs);
-			}
-
+			Transform(p_lhs, &p_rhs, &result, 1);
 			return result;
 		}
 
@@ -314,5 +328,221 @@ namespace r2
 		Matrix4 GetInverse(const Matrix4& p_matrix) {
 			return Matrix4(p_matrix).Invert();
 		}
+
+		void MultiplyArray(const Matrix4* p_lhs, const Matrix4* p_rhs, Matrix4* p_result, std::size_t p_count) {
+			if (p_count == 0) return;
+
+			// a Matrix4 is nothing but its 16 scalars, so an array of them is one array of scalars
+			SIMD::GetKernels().m_matrix4_multiply_array(p_result->m_data, p_lhs->m_data, p_rhs->m_data, p_count);
+		}
+
+		Matrix4 GetInverseAffine(const Matrix4& p_matrix) {
+			return Matrix4(p_matrix).InvertAffine();
+		}
+
+		Matrix4 GetInverseOrthonormal(const Matrix4& p_matrix) {
+			return Matrix4(p_matrix).InvertOrthonormal();
+		}
+
+
+
+
+		/**
+		 * Batched transforms. The matrix columns are kept in registers and every
+		 * vector is the sum of the columns weighted by its components.
+		 */
+		namespace TransformMode {
+			enum TransformMode { Point, Vector, Homogeneous };
+		}
+
+		static void ScalarTransform(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, TransformMode::TransformMode p_mode) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_matrix.m_elements;
+			const SCALAR w = (p_mode == TransformMode::Vector) ? 0.0f : 1.0f;
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				SCALAR x = p_in[i].x, y = p_in[i].y, z = p_in[i].z;
+				SCALAR result_x = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3] * w;
+				SCALAR result_y = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3] * w;
+				SCALAR result_z = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3] * w;
+
+				if (p_mode == TransformMode::Homogeneous) {
+					SCALAR inverse_w = 1.0f / (m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3]);
+					result_x *= inverse_w;
+					result_y *= inverse_w;
+					result_z *= inverse_w;
+				}
+
+				p_out[i].x = result_x;
+				p_out[i].y = result_y;
+				p_out[i].z = result_z;
+			}
+		}
+
+		static void ScalarTransform(const Matrix4& p_matrix, const Vector4* p_in, Vector4* p_out, std::size_t p_count) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_matrix.m_elements;
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				SCALAR x = p_in[i].x, y = p_in[i].y, z = p_in[i].z, w = p_in[i].w;
+				for (int row = 0; row < Matrix4::K_DIMENSIONS; ++row) {
+					p_out[i].m_data[row] = m[row][0] * x + m[row][1] * y + m[row][2] * z + m[row][3] * w;
+				}
+			}
+		}
+
+#if defined(R2_ARCH_X86)
+		// Vector3 is 12 bytes, so it is read as broadcast scalars and written as 8 + 4 bytes,
+		// never touching the next element.
+		r2SIMDTargetM("sse2")
+		static void SSE2Transform(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, TransformMode::TransformMode p_mode) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_matrix.m_elements;
+			__m128 column_0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], m[3][0]);
+			__m128 column_1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], m[3][1]);
+			__m128 column_2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], m[3][2]);
+			__m128 column_3 = (p_mode == TransformMode::Vector) ? _mm_setzero_ps() : _mm_setr_ps(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				__m128 result = _mm_add_ps(_mm_mul_ps(column_0, _mm_set1_ps(p_in[i].x)), column_3);
+				result = _mm_add_ps(result, _mm_mul_ps(column_1, _mm_set1_ps(p_in[i].y)));
+				result = _mm_add_ps(result, _mm_mul_ps(column_2, _mm_set1_ps(p_in[i].z)));
+
+				if (p_mode == TransformMode::Homogeneous) result = _mm_div_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 3, 3, 3)));
+
+				_mm_storel_pi(reinterpret_cast<__m64*>(p_out[i].m_data), result);
+				_mm_store_ss(p_out[i].m_data + 2, _mm_movehl_ps(result, result));
+			}
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static void FMATransform(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, TransformMode::TransformMode p_mode) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_matrix.m_elements;
+			__m128 column_0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], m[3][0]);
+			__m128 column_1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], m[3][1]);
+			__m128 column_2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], m[3][2]);
+			__m128 column_3 = (p_mode == TransformMode::Vector) ? _mm_setzero_ps() : _mm_setr_ps(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				__m128 result = _mm_fmadd_ps(column_0, _mm_broadcast_ss(&p_in[i].x), column_3);
+				result = _mm_fmadd_ps(column_1, _mm_broadcast_ss(&p_in[i].y), result);
+				result = _mm_fmadd_ps(column_2, _mm_broadcast_ss(&p_in[i].z), result);
+
+				if (p_mode == TransformMode::Homogeneous) result = _mm_div_ps(result, _mm_permute_ps(result, _MM_SHUFFLE(3, 3, 3, 3)));
+
+				_mm_storel_pi(reinterpret_cast<__m64*>(p_out[i].m_data), result);
+				_mm_store_ss(p_out[i].m_data + 2, _mm_movehl_ps(result, result));
+			}
+		}
+
+		r2SIMDTargetM("sse2")
+		static void SSE2Transform(const Matrix4& p_matrix, const Vector4* p_in, Vector4* p_out, std::size_t p_count) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_matrix.m_elements;
+			__m128 column_0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], m[3][0]);
+			__m128 column_1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], m[3][1]);
+			__m128 column_2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], m[3][2]);
+			__m128 column_3 = _mm_setr_ps(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				__m128 vector = _mm_loadu_ps(p_in[i].m_data);
+				__m128 result = _mm_mul_ps(column_0, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(0, 0, 0, 0)));
+				result = _mm_add_ps(result, _mm_mul_ps(column_1, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(1, 1, 1, 1))));
+				result = _mm_add_ps(result, _mm_mul_ps(column_2, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(2, 2, 2, 2))));
+				result = _mm_add_ps(result, _mm_mul_ps(column_3, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(3, 3, 3, 3))));
+				_mm_storeu_ps(p_out[i].m_data, result);
+			}
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static void FMATransform(const Matrix4& p_matrix, const Vector4* p_in, Vector4* p_out, std::size_t p_count) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_matrix.m_elements;
+			__m128 column_0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], m[3][0]);
+			__m128 column_1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], m[3][1]);
+			__m128 column_2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], m[3][2]);
+			__m128 column_3 = _mm_setr_ps(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+			for (std::size_t i = 0; i < p_count; ++i) {
+				__m128 result = _mm_mul_ps(column_0, _mm_broadcast_ss(&p_in[i].x));
+				result = _mm_fmadd_ps(column_1, _mm_broadcast_ss(&p_in[i].y), result);
+				result = _mm_fmadd_ps(column_2, _mm_broadcast_ss(&p_in[i].z), result);
+				result = _mm_fmadd_ps(column_3, _mm_broadcast_ss(&p_in[i].w), result);
+				_mm_storeu_ps(p_out[i].m_data, result);
+			}
+		}
+#endif
+
+		// 16384 vectors are 30 to 75 us of AVX2 transforms
+		static const std::size_t K_MIN_TRANSFORM_CHUNK = 16384;
+
+		static void TransformRange(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, TransformMode::TransformMode p_mode) {
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) return FMATransform(p_matrix, p_in, p_out, p_count, p_mode);
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) return SSE2Transform(p_matrix, p_in, p_out, p_count, p_mode);
+#endif
+			ScalarTransform(p_matrix, p_in, p_out, p_count, p_mode);
+		}
+
+		static void TransformArray(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count, TransformMode::TransformMode p_mode) {
+			Parallel::For(p_count, K_MIN_TRANSFORM_CHUNK, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				TransformRange(p_matrix, p_in + p_begin, p_out + p_begin, p_end - p_begin, p_mode);
+			});
+		}
+
+		void TransformPoints(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count) {
+			TransformArray(p_matrix, p_in, p_out, p_count, p_thread_count, TransformMode::Point);
+		}
+
+		void TransformVectors(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count) {
+			TransformArray(p_matrix, p_in, p_out, p_count, p_thread_count, TransformMode::Vector);
+		}
+
+		void TransformPointsHomogeneous(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count) {
+			TransformArray(p_matrix, p_in, p_out, p_count, p_thread_count, TransformMode::Homogeneous);
+		}
+
+		void Transform(const Matrix4& p_matrix, const Vector4* p_in, Vector4* p_out, std::size_t p_count, unsigned int p_thread_count) {
+			Parallel::For(p_count, K_MIN_TRANSFORM_CHUNK, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) return FMATransform(p_matrix, p_in + p_begin, p_out + p_begin, p_end - p_begin);
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) return SSE2Transform(p_matrix, p_in + p_begin, p_out + p_begin, p_end - p_begin);
+#endif
+				ScalarTransform(p_matrix, p_in + p_begin, p_out + p_begin, p_end - p_begin);
+			});
+		}
+
+
+		namespace priv {
+			bool InvertAffineRows(const SCALAR (*p_rows)[4], SCALAR (*p_result)[4]) {
+				const SCALAR (*m)[4] = p_rows;
+
+				// cofactors of the linear part
+				SCALAR c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+				SCALAR c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+				SCALAR c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+
+				SCALAR determinant = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+				if (std::fabs(determinant) <= GetSingularThreshold(m, 3)) return false;
+
+				SCALAR inverse_determinant = 1.0f / determinant;
+
+				SCALAR result[3][4];
+				result[0][0] = c00 * inverse_determinant;
+				result[1][0] = c01 * inverse_determinant;
+				result[2][0] = c02 * inverse_determinant;
+				result[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inverse_determinant;
+				result[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inverse_determinant;
+				result[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inverse_determinant;
+				result[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inverse_determinant;
+				result[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inverse_determinant;
+				result[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inverse_determinant;
+
+				// the translation is moved back through the inverted linear part
+				for (int row = 0; row < 3; ++row) {
+					result[row][3] = -(result[row][0] * m[0][3] +
+									   result[row][1] * m[1][3] +
+									   result[row][2] * m[2][3]);
+				}
+
+				memcpy(p_result, result, sizeof(result));
+				return true;
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -26,11 +26,16 @@
  *  * SCALAR
  *  * FloatCompare
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Add, scale, multiply and transpose use the SIMD kernels (r2-simd.hpp)
+ *	2026-10-17 (Rarosu) - Closed form Determinant and Invert, added InvertAffine and InvertOrthonormal
+ *	2026-10-17 (Rarosu) - Added batched transforms of Vector3 and Vector4 arrays
+ *	2026-10-17 (Rarosu) - Added MultiplyArray
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
  */
 #ifndef R2_MATRIX_4_HPP
 #define R2_MATRIX_4_HPP
 
+#include <cstddef>
 #include <ostream>
 #include "r2-math-generic.hpp"
 #include "r2-vector-4.hpp"
@@ -43,19 +48,19 @@ namespace r2 {
 			/**
 			 * Initialize the zero matrix
 			 */
-			Matrix4();
+			constexpr Matrix4();
 
 			/**
 			 * Initialize a matrix with the given parameter as the diagonal elements. The rest
 			 * of the elements are set to 0.
 			 */
-			Matrix4(SCALAR p_diagonal_element);
+			constexpr Matrix4(SCALAR p_diagonal_element);
 
 			/**
 			 * Initialize the matrix with the given elements. Row order, so for instance
 			 * p_01 will be the first row and the second column.
 			 */
-			Matrix4(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_03,
+			constexpr Matrix4(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_03,
 					SCALAR p_10, SCALAR p_11, SCALAR p_12, SCALAR p_13,
 					SCALAR p_20, SCALAR p_21, SCALAR p_22, SCALAR p_23,
 					SCALAR p_30, SCALAR p_31, SCALAR p_32, SCALAR p_33);
@@ -70,7 +75,7 @@ namespace r2 {
 			/**
 			 * Initialize the matrix with the given row vectors
 			 */
-			Matrix4(const Vector4& p_row_1,
+			constexpr Matrix4(const Vector4& p_row_1,
 					const Vector4& p_row_2,
 					const Vector4& p_row_3,
 					const Vector4& p_row_4);
@@ -118,10 +123,27 @@ namespace r2 {
 
 			/**
 			 * Invert this matrix, if possible. If the matrix is
-			 * singular, a DivisionByZero exception is raised.
+			 * singular, a DivisionByZero exception is raised. Singularity
+			 * is judged relative to the scale of the matrix, so a uniformly
+			 * small matrix is still inverted.
 			 */
 			Matrix4& Invert();
 
+			/**
+			 * Invert this matrix, assuming it is affine - i.e. the last row is
+			 * (0, 0, 0, 1). Only the upper left 3x3 part is inverted and the
+			 * translation is carried through it. If that part is singular,
+			 * a DivisionByZero exception is raised.
+			 */
+			Matrix4& InvertAffine();
+
+			/**
+			 * Invert this matrix, assuming it is a rigid transform - i.e. the last row
+			 * is (0, 0, 0, 1) and the upper left 3x3 part is orthonormal (a rotation).
+			 * The rotation is transposed, no check is made for the assumption.
+			 */
+			Matrix4& InvertOrthonormal();
+
 			/**
 			 * Return a minor matrix of this matrix. A minor is constructed by placing
 			 * all elements that are not on the row p_row_to_remove and the column p_col_to_remove
@@ -195,6 +217,93 @@ namespace r2 {
 		 * singular, a DivisionByZero exception is raised.
 		 */
 		Matrix4 GetInverse(const Matrix4& p_matrix);
+
+		/**
+		 * Multiply p_count pairs of matrices, p_result[i] = p_lhs[i] * p_rhs[i]. The
+		 * result array may be the same as either operand array.
+		 */
+		void MultiplyArray(const Matrix4* p_lhs, const Matrix4* p_rhs, Matrix4* p_result, std::size_t p_count);
+
+		/**
+		 * Get the inverse of an affine matrix (last row is (0, 0, 0, 1)). If the
+		 * matrix is singular, a DivisionByZero exception is raised.
+		 */
+		Matrix4 GetInverseAffine(const Matrix4& p_matrix);
+
+		/**
+		 * Get the inverse of a rigid transform (last row is (0, 0, 0, 1) and an
+		 * orthonormal upper left 3x3 part).
+		 */
+		Matrix4 GetInverseOrthonormal(const Matrix4& p_matrix);
+
+		/**
+		 * Batched transforms of arrays of p_count vectors. p_in and p_out may be the same
+		 * array, but must not otherwise overlap. Large arrays are split over
+		 * p_thread_count threads (0 uses all hardware threads).
+		 */
+
+		/**
+		 * Transform points, i.e. p_out[i] = p_matrix * (p_in[i], 1), ignoring the resulting w.
+		 */
+		void TransformPoints(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count = 1);
+
+		/**
+		 * Transform directions, i.e. p_out[i] = p_matrix * (p_in[i], 0). The translation is ignored.
+		 */
+		void TransformVectors(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count = 1);
+
+		/**
+		 * Transform points and divide by the resulting w (for projections).
+		 */
+		void TransformPointsHomogeneous(const Matrix4& p_matrix, const Vector3* p_in, Vector3* p_out, std::size_t p_count, unsigned int p_thread_count = 1);
+
+		/**
+		 * Transform 4 dimensional vectors, i.e. p_out[i] = p_matrix * p_in[i].
+		 */
+		void Transform(const Matrix4& p_matrix, const Vector4* p_in, Vector4* p_out, std::size_t p_count, unsigned int p_thread_count = 1);
+
+		namespace priv {
+			/**
+			 * Invert the affine transform held in the 3x4 rows of p_rows (the
+			 * linear part and the translation) into the 3x4 rows of p_result.
+			 * Returns false, leaving p_result untouched, if the linear part is
+			 * singular relative to its scale. Shared by Matrix4::InvertAffine
+			 * and AffineTransform::Invert.
+			 */
+			bool InvertAffineRows(const SCALAR (*p_rows)[4], SCALAR (*p_result)[4]);
+		}
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Matrix4::Matrix4()
+			: m_data{} {}
+
+		constexpr Matrix4::Matrix4(SCALAR p_diagonal_element)
+			: m_data{p_diagonal_element, 0.0f, 0.0f, 0.0f,
+					 0.0f, p_diagonal_element, 0.0f, 0.0f,
+					 0.0f, 0.0f, p_diagonal_element, 0.0f,
+					 0.0f, 0.0f, 0.0f, p_diagonal_element} {}
+
+		constexpr Matrix4::Matrix4(SCALAR p_00, SCALAR p_01, SCALAR p_02, SCALAR p_03,
+					SCALAR p_10, SCALAR p_11, SCALAR p_12, SCALAR p_13,
+					SCALAR p_20, SCALAR p_21, SCALAR p_22, SCALAR p_23,
+					SCALAR p_30, SCALAR p_31, SCALAR p_32, SCALAR p_33)
+			: m_data{p_00, p_01, p_02, p_03,
+					 p_10, p_11, p_12, p_13,
+					 p_20, p_21, p_22, p_23,
+					 p_30, p_31, p_32, p_33} {}
+
+		constexpr Matrix4::Matrix4(const Vector4& p_row_1, const Vector4& p_row_2, const Vector4& p_row_3, const Vector4& p_row_4)
+			: m_data{p_row_1.x, p_row_1.y, p_row_1.z, p_row_1.w,
+					 p_row_2.x, p_row_2.y, p_row_2.z, p_row_2.w,
+					 p_row_3.x, p_row_3.y, p_row_3.z, p_row_3.w,
+					 p_row_4.x, p_row_4.y, p_row_4.z, p_row_4.w} {}
+
+		inline constexpr Matrix4 Matrix4::K_ZERO_MATRIX;
+		inline constexpr Matrix4 Matrix4::K_IDENTITY(1.0f);
 	}
 }
 
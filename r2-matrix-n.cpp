@@ -0,0 +1,727 @@
+#include "r2-matrix-n.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include "r2-parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2
+{
+	namespace Math
+	{
+		// Rows are padded to a whole number of SIMD::K_ALIGNMENT bytes
+		static const unsigned int K_ROW_ALIGNMENT = static_cast<unsigned int>(SIMD::K_ALIGNMENT / sizeof(SCALAR));
+
+		static unsigned int GetPaddedStride(unsigned int p_columns) {
+			return (p_columns + K_ROW_ALIGNMENT - 1) & ~(K_ROW_ALIGNMENT - 1);
+		}
+
+		static SCALAR* AllocateElements(unsigned int p_rows, unsigned int p_stride) {
+			std::size_t count = static_cast<std::size_t>(p_rows) * p_stride;
+			if (count == 0) return 0;
+
+			SCALAR* memory = static_cast<SCALAR*>(SIMD::AllocateAligned(count * sizeof(SCALAR)));
+			memset(memory, 0, count * sizeof(SCALAR));
+			return memory;
+		}
+
+		MatrixN::MatrixN()
+			: m_rows(0), m_columns(0), m_stride(0), m_data(0) {}
+
+		MatrixN::MatrixN(unsigned int p_rows, unsigned int p_columns)
+			: m_rows(p_rows), m_columns(p_columns), m_stride(GetPaddedStride(p_columns)), m_data(0) {
+			m_data = AllocateElements(m_rows, m_stride);
+		}
+
+		MatrixN::MatrixN(unsigned int p_rows, unsigned int p_columns, SCALAR p_diagonal_element)
+			: m_rows(p_rows), m_columns(p_columns), m_stride(GetPaddedStride(p_columns)), m_data(0) {
+			m_data = AllocateElements(m_rows, m_stride);
+
+			unsigned int diagonal = std::min(m_rows, m_columns);
+			for (unsigned int i = 0; i < diagonal; ++i) {
+				m_data[i * m_stride + i] = p_diagonal_element;
+			}
+		}
+
+		MatrixN::MatrixN(unsigned int p_rows, unsigned int p_columns, const SCALAR* p_raw_data)
+			: m_rows(p_rows), m_columns(p_columns), m_stride(GetPaddedStride(p_columns)), m_data(0) {
+			m_data = AllocateElements(m_rows, m_stride);
+
+			for (unsigned int row = 0; row < m_rows; ++row) {
+				memcpy(GetRow(row), p_raw_data + row * m_columns, m_columns * sizeof(SCALAR));
+			}
+		}
+
+		MatrixN::MatrixN(const MatrixN& p_matrix)
+			: m_rows(p_matrix.m_rows), m_columns(p_matrix.m_columns), m_stride(p_matrix.m_stride), m_data(0) {
+			m_data = AllocateElements(m_rows, m_stride);
+			if (m_data != 0) memcpy(m_data, p_matrix.m_data, static_cast<std::size_t>(m_rows) * m_stride * sizeof(SCALAR));
+		}
+
+		MatrixN::~MatrixN() {
+			SIMD::FreeAligned(m_data);
+		}
+
+		MatrixN& MatrixN::operator=(const MatrixN& p_matrix) {
+			if (this == &p_matrix) return *this;
+
+			std::size_t count = static_cast<std::size_t>(p_matrix.m_rows) * p_matrix.m_stride;
+			if (count != static_cast<std::size_t>(m_rows) * m_stride) {
+				SCALAR* memory = AllocateElements(p_matrix.m_rows, p_matrix.m_stride);
+				SIMD::FreeAligned(m_data);
+				m_data = memory;
+			}
+
+			m_rows = p_matrix.m_rows;
+			m_columns = p_matrix.m_columns;
+			m_stride = p_matrix.m_stride;
+			if (m_data != 0) memcpy(m_data, p_matrix.m_data, count * sizeof(SCALAR));
+
+			return *this;
+		}
+
+		unsigned int MatrixN::GetRows() const {
+			return m_rows;
+		}
+
+		unsigned int MatrixN::GetColumns() const {
+			return m_columns;
+		}
+
+		unsigned int MatrixN::GetStride() const {
+			return m_stride;
+		}
+
+		void MatrixN::Resize(unsigned int p_rows, unsigned int p_columns) {
+			if (p_rows == m_rows && p_columns == m_columns) return;
+
+			unsigned int stride = GetPaddedStride(p_columns);
+			SCALAR* memory = AllocateElements(p_rows, stride);
+
+			unsigned int rows = std::min(m_rows, p_rows);
+			unsigned int columns = std::min(m_columns, p_columns);
+			for (unsigned int row = 0; row < rows; ++row) {
+				memcpy(memory + row * stride, m_data + row * m_stride, columns * sizeof(SCALAR));
+			}
+
+			SIMD::FreeAligned(m_data);
+			m_data = memory;
+			m_rows = p_rows;
+			m_columns = p_columns;
+			m_stride = stride;
+		}
+
+		SCALAR* MatrixN::GetRow(unsigned int p_row) {
+			return m_data + static_cast<std::size_t>(p_row) * m_stride;
+		}
+
+		const SCALAR* MatrixN::GetRow(unsigned int p_row) const {
+			return m_data + static_cast<std::size_t>(p_row) * m_stride;
+		}
+
+		SCALAR& MatrixN::operator()(unsigned int p_row, unsigned int p_col) {
+			return m_data[static_cast<std::size_t>(p_row) * m_stride + p_col];
+		}
+
+		SCALAR MatrixN::operator()(unsigned int p_row, unsigned int p_col) const {
+			return m_data[static_cast<std::size_t>(p_row) * m_stride + p_col];
+		}
+
+		MatrixN MatrixN::operator-() const {
+			MatrixN result(*this);
+			result *= -1.0f;
+
+			return result;
+		}
+
+		// The padding is kept at zero, so the element wise operations run over whole rows
+		MatrixN& MatrixN::operator+=(const MatrixN& p_rhs) {
+			if (m_rows != p_rhs.m_rows || m_columns != p_rhs.m_columns) throw r2ExceptionArgumentM("Matrix dimensions do not match");
+
+			std::size_t count = static_cast<std::size_t>(m_rows) * m_stride;
+			for (std::size_t i = 0; i < count; ++i) {
+				m_data[i] += p_rhs.m_data[i];
+			}
+
+			return *this;
+		}
+
+		MatrixN& MatrixN::operator-=(const MatrixN& p_rhs) {
+			if (m_rows != p_rhs.m_rows || m_columns != p_rhs.m_columns) throw r2ExceptionArgumentM("Matrix dimensions do not match");
+
+			std::size_t count = static_cast<std::size_t>(m_rows) * m_stride;
+			for (std::size_t i = 0; i < count; ++i) {
+				m_data[i] -= p_rhs.m_data[i];
+			}
+
+			return *this;
+		}
+
+		MatrixN& MatrixN::operator*=(SCALAR p_rhs) {
+			std::size_t count = static_cast<std::size_t>(m_rows) * m_stride;
+			for (std::size_t i = 0; i < count; ++i) {
+				m_data[i] *= p_rhs;
+			}
+
+			return *this;
+		}
+
+		MatrixN& MatrixN::operator*=(const MatrixN& p_rhs) {
+			Multiply(*this, p_rhs, *this);
+			return *this;
+		}
+
+		MatrixN& MatrixN::operator/=(SCALAR p_rhs) {
+			return (*this) *= (1.0f / p_rhs);
+		}
+
+		SCALAR MatrixN::Trace() const {
+			if (m_rows != m_columns) throw r2ExceptionArgumentM("Trace of a non-square matrix");
+
+			SCALAR result = 0.0f;
+			for (unsigned int i = 0; i < m_rows; ++i) {
+				result += m_data[i * m_stride + i];
+			}
+
+			return result;
+		}
+
+		MatrixN& MatrixN::Transpose() {
+			*this = GetTranspose(*this);
+			return *this;
+		}
+
+
+
+		MatrixN operator+(const MatrixN& p_lhs, const MatrixN& p_rhs) {
+			MatrixN result(p_lhs);
+			result += p_rhs;
+
+			return result;
+		}
+
+		MatrixN operator-(const MatrixN& p_lhs, const MatrixN& p_rhs) {
+			MatrixN result(p_lhs);
+			result -= p_rhs;
+
+			return result;
+		}
+
+		MatrixN operator*(const MatrixN& p_lhs, const MatrixN& p_rhs) {
+			MatrixN result;
+			Multiply(p_lhs, p_rhs, result);
+
+			return result;
+		}
+
+		MatrixN operator*(const MatrixN& p_lhs, SCALAR p_rhs) {
+			MatrixN result(p_lhs);
+			result *= p_rhs;
+
+			return result;
+		}
+
+		MatrixN operator*(SCALAR p_lhs, const MatrixN& p_rhs) {
+			return p_rhs * p_lhs;
+		}
+
+		MatrixN operator/(const MatrixN& p_lhs, SCALAR p_rhs) {
+			MatrixN result(p_lhs);
+			result /= p_rhs;
+
+			return result;
+		}
+
+		bool operator==(const MatrixN& p_lhs, const MatrixN& p_rhs) {
+			if (p_lhs.GetRows() != p_rhs.GetRows() || p_lhs.GetColumns() != p_rhs.GetColumns()) return false;
+
+			for (unsigned int row = 0; row < p_lhs.GetRows(); ++row) {
+				const SCALAR* lhs = p_lhs.GetRow(row);
+				const SCALAR* rhs = p_rhs.GetRow(row);
+
+				for (unsigned int col = 0; col < p_lhs.GetColumns(); ++col) {
+					if (!FloatCompare(lhs[col], rhs[col])) return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool operator!=(const MatrixN& p_lhs, const MatrixN& p_rhs) {
+			return !(p_lhs == p_rhs);
+		}
+
+		std::ostream& operator<<(std::ostream& p_lhs, const MatrixN& p_rhs) {
+			for (unsigned int row = 0; row < p_rhs.GetRows(); ++row) {
+				p_lhs << "[";
+
+				for (unsigned int col = 0; col < p_rhs.GetColumns(); ++col) {
+					p_lhs << p_rhs(row, col);
+
+					if (col != p_rhs.GetColumns() - 1) p_lhs << ", ";
+				}
+
+				p_lhs << "]";
+				if (row != p_rhs.GetRows() - 1) p_lhs << std::endl;
+			}
+
+			return p_lhs;
+		}
+
+		MatrixN GetTranspose(const MatrixN& p_matrix) {
+			// copied in square tiles so that both matrices are walked a cache line at a time
+			const unsigned int K_TILE = 32;
+			MatrixN result(p_matrix.GetColumns(), p_matrix.GetRows());
+
+			for (unsigned int row_block = 0; row_block < p_matrix.GetRows(); row_block += K_TILE) {
+				unsigned int row_end = std::min(row_block + K_TILE, p_matrix.GetRows());
+
+				for (unsigned int col_block = 0; col_block < p_matrix.GetColumns(); col_block += K_TILE) {
+					unsigned int col_end = std::min(col_block + K_TILE, p_matrix.GetColumns());
+
+					for (unsigned int row = row_block; row < row_end; ++row) {
+						const SCALAR* source = p_matrix.GetRow(row);
+						for (unsigned int col = col_block; col < col_end; ++col) {
+							result(col, row) = source[col];
+						}
+					}
+				}
+			}
+
+			return result;
+		}
+
+
+
+		/**
+		 * Matrix multiplication
+		 *
+		 * The classic blocked scheme: for every K_NC wide column panel of the
+		 * right operand and every K_KC deep slice of the inner dimension, the
+		 * panel is packed into strips of NR columns, then K_MC row blocks of the
+		 * left operand are packed into strips of MR rows. A micro kernel then
+		 * computes each MR x NR tile of the result from one strip of each, with
+		 * the whole tile held in registers. The packed strips are read
+		 * sequentially, and K_KC and K_MC keep them in the L1 and L2 caches.
+		 */
+		namespace priv {
+			const unsigned int K_MC = 96;
+			const unsigned int K_KC = 256;
+			const unsigned int K_NC = 1024;
+
+			// The largest tile of any kernel
+			const unsigned int K_MAX_MR = 6;
+			const unsigned int K_MAX_NR = 16;
+
+			// The chunks are strips of rows, whose cost grows with the columns and the
+			// depth of the product, so the minimum is counted in multiply-adds and
+			// converted to strips per product. 2^21 are 120 to 140 us with AVX2.
+			const std::size_t K_MIN_MULTIPLY_WORK = 1 << 21;
+
+			/**
+			 * Computes one MR x NR tile, C = A * B (or C += A * B when accumulating), from
+			 * p_depth columns of a packed A strip and p_depth rows of a packed B strip.
+			 */
+			typedef void (*MicroKernel)(std::size_t p_depth, const SCALAR* p_a, const SCALAR* p_b, SCALAR* p_c, std::size_t p_stride, bool p_accumulate);
+
+			struct KernelInfo {
+				unsigned int m_mr;
+				unsigned int m_nr;
+				MicroKernel m_kernel;
+			};
+
+			// Aligned scratch memory, freed when leaving the scope
+			struct PackBuffer {
+				PackBuffer(std::size_t p_count) : m_data(static_cast<SCALAR*>(SIMD::AllocateAligned(p_count * sizeof(SCALAR)))) {}
+				~PackBuffer() { SIMD::FreeAligned(m_data); }
+
+				SCALAR* m_data;
+			private:
+				PackBuffer(const PackBuffer&);
+				PackBuffer& operator=(const PackBuffer&);
+			};
+
+			static void ScalarKernel(std::size_t p_depth, const SCALAR* p_a, const SCALAR* p_b, SCALAR* p_c, std::size_t p_stride, bool p_accumulate) {
+				SCALAR c[4][4] = {};
+
+				for (std::size_t p = 0; p < p_depth; ++p) {
+					for (unsigned int i = 0; i < 4; ++i) {
+						for (unsigned int j = 0; j < 4; ++j) {
+							c[i][j] += p_a[i] * p_b[j];
+						}
+					}
+
+					p_a += 4;
+					p_b += 4;
+				}
+
+				for (unsigned int i = 0; i < 4; ++i) {
+					for (unsigned int j = 0; j < 4; ++j) {
+						p_c[i * p_stride + j] = p_accumulate ? p_c[i * p_stride + j] + c[i][j] : c[i][j];
+					}
+				}
+			}
+
+#if defined(R2_ARCH_X86)
+			// 4 x 8 tile in 8 registers
+			r2SIMDTargetM("sse2")
+			static void SSE2Kernel(std::size_t p_depth, const SCALAR* p_a, const SCALAR* p_b, SCALAR* p_c, std::size_t p_stride, bool p_accumulate) {
+				__m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+				__m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+				__m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+				__m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+
+				for (std::size_t p = 0; p < p_depth; ++p) {
+					__m128 b0 = _mm_load_ps(p_b);
+					__m128 b1 = _mm_load_ps(p_b + 4);
+					__m128 a;
+
+					a = _mm_set1_ps(p_a[0]);
+					c00 = _mm_add_ps(c00, _mm_mul_ps(a, b0));
+					c01 = _mm_add_ps(c01, _mm_mul_ps(a, b1));
+					a = _mm_set1_ps(p_a[1]);
+					c10 = _mm_add_ps(c10, _mm_mul_ps(a, b0));
+					c11 = _mm_add_ps(c11, _mm_mul_ps(a, b1));
+					a = _mm_set1_ps(p_a[2]);
+					c20 = _mm_add_ps(c20, _mm_mul_ps(a, b0));
+					c21 = _mm_add_ps(c21, _mm_mul_ps(a, b1));
+					a = _mm_set1_ps(p_a[3]);
+					c30 = _mm_add_ps(c30, _mm_mul_ps(a, b0));
+					c31 = _mm_add_ps(c31, _mm_mul_ps(a, b1));
+
+					p_a += 4;
+					p_b += 8;
+				}
+
+				if (p_accumulate) {
+					c00 = _mm_add_ps(c00, _mm_loadu_ps(p_c));
+					c01 = _mm_add_ps(c01, _mm_loadu_ps(p_c + 4));
+					c10 = _mm_add_ps(c10, _mm_loadu_ps(p_c + p_stride));
+					c11 = _mm_add_ps(c11, _mm_loadu_ps(p_c + p_stride + 4));
+					c20 = _mm_add_ps(c20, _mm_loadu_ps(p_c + 2 * p_stride));
+					c21 = _mm_add_ps(c21, _mm_loadu_ps(p_c + 2 * p_stride + 4));
+					c30 = _mm_add_ps(c30, _mm_loadu_ps(p_c + 3 * p_stride));
+					c31 = _mm_add_ps(c31, _mm_loadu_ps(p_c + 3 * p_stride + 4));
+				}
+
+				_mm_storeu_ps(p_c, c00);
+				_mm_storeu_ps(p_c + 4, c01);
+				_mm_storeu_ps(p_c + p_stride, c10);
+				_mm_storeu_ps(p_c + p_stride + 4, c11);
+				_mm_storeu_ps(p_c + 2 * p_stride, c20);
+				_mm_storeu_ps(p_c + 2 * p_stride + 4, c21);
+				_mm_storeu_ps(p_c + 3 * p_stride, c30);
+				_mm_storeu_ps(p_c + 3 * p_stride + 4, c31);
+			}
+
+			// 6 x 16 tile in 12 registers, leaving room for the two B rows and the A broadcast
+			r2SIMDTargetM("avx2,fma")
+			static void FMAKernel(std::size_t p_depth, const SCALAR* p_a, const SCALAR* p_b, SCALAR* p_c, std::size_t p_stride, bool p_accumulate) {
+				__m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+				__m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+				__m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+				__m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+				__m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+				__m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+				for (std::size_t p = 0; p < p_depth; ++p) {
+					__m256 b0 = _mm256_load_ps(p_b);
+					__m256 b1 = _mm256_load_ps(p_b + 8);
+					__m256 a;
+
+					a = _mm256_broadcast_ss(p_a);
+					c00 = _mm256_fmadd_ps(a, b0, c00);
+					c01 = _mm256_fmadd_ps(a, b1, c01);
+					a = _mm256_broadcast_ss(p_a + 1);
+					c10 = _mm256_fmadd_ps(a, b0, c10);
+					c11 = _mm256_fmadd_ps(a, b1, c11);
+					a = _mm256_broadcast_ss(p_a + 2);
+					c20 = _mm256_fmadd_ps(a, b0, c20);
+					c21 = _mm256_fmadd_ps(a, b1, c21);
+					a = _mm256_broadcast_ss(p_a + 3);
+					c30 = _mm256_fmadd_ps(a, b0, c30);
+					c31 = _mm256_fmadd_ps(a, b1, c31);
+					a = _mm256_broadcast_ss(p_a + 4);
+					c40 = _mm256_fmadd_ps(a, b0, c40);
+					c41 = _mm256_fmadd_ps(a, b1, c41);
+					a = _mm256_broadcast_ss(p_a + 5);
+					c50 = _mm256_fmadd_ps(a, b0, c50);
+					c51 = _mm256_fmadd_ps(a, b1, c51);
+
+					p_a += 6;
+					p_b += 16;
+				}
+
+				if (p_accumulate) {
+					c00 = _mm256_add_ps(c00, _mm256_loadu_ps(p_c));
+					c01 = _mm256_add_ps(c01, _mm256_loadu_ps(p_c + 8));
+					c10 = _mm256_add_ps(c10, _mm256_loadu_ps(p_c + p_stride));
+					c11 = _mm256_add_ps(c11, _mm256_loadu_ps(p_c + p_stride + 8));
+					c20 = _mm256_add_ps(c20, _mm256_loadu_ps(p_c + 2 * p_stride));
+					c21 = _mm256_add_ps(c21, _mm256_loadu_ps(p_c + 2 * p_stride + 8));
+					c30 = _mm256_add_ps(c30, _mm256_loadu_ps(p_c + 3 * p_stride));
+					c31 = _mm256_add_ps(c31, _mm256_loadu_ps(p_c + 3 * p_stride + 8));
+					c40 = _mm256_add_ps(c40, _mm256_loadu_ps(p_c + 4 * p_stride));
+					c41 = _mm256_add_ps(c41, _mm256_loadu_ps(p_c + 4 * p_stride + 8));
+					c50 = _mm256_add_ps(c50, _mm256_loadu_ps(p_c + 5 * p_stride));
+					c51 = _mm256_add_ps(c51, _mm256_loadu_ps(p_c + 5 * p_stride + 8));
+				}
+
+				_mm256_storeu_ps(p_c, c00);
+				_mm256_storeu_ps(p_c + 8, c01);
+				_mm256_storeu_ps(p_c + p_stride, c10);
+				_mm256_storeu_ps(p_c + p_stride + 8, c11);
+				_mm256_storeu_ps(p_c + 2 * p_stride, c20);
+				_mm256_storeu_ps(p_c + 2 * p_stride + 8, c21);
+				_mm256_storeu_ps(p_c + 3 * p_stride, c30);
+				_mm256_storeu_ps(p_c + 3 * p_stride + 8, c31);
+				_mm256_storeu_ps(p_c + 4 * p_stride, c40);
+				_mm256_storeu_ps(p_c + 4 * p_stride + 8, c41);
+				_mm256_storeu_ps(p_c + 5 * p_stride, c50);
+				_mm256_storeu_ps(p_c + 5 * p_stride + 8, c51);
+			}
+#endif
+
+			static KernelInfo GetKernel() {
+				KernelInfo info = { 4, 4, ScalarKernel };
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+					info.m_mr = 6;
+					info.m_nr = 16;
+					info.m_kernel = FMAKernel;
+				} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+					info.m_mr = 4;
+					info.m_nr = 8;
+					info.m_kernel = SSE2Kernel;
+				}
+#endif
+				return info;
+			}
+
+			// Pack rows [p_row, p_row + p_rows) x columns [p_depth_begin, + p_depth) of A into strips
+			// of p_mr rows, stored column by column. Rows past the end are zero.
+			static void PackA(const MatrixN& p_a, unsigned int p_row, unsigned int p_rows, unsigned int p_depth_begin, unsigned int p_depth, unsigned int p_mr, SCALAR* p_packed) {
+				for (unsigned int strip = 0; strip < p_rows; strip += p_mr) {
+					for (unsigned int i = 0; i < p_mr; ++i) {
+						if (strip + i < p_rows) {
+							const SCALAR* source = p_a.GetRow(p_row + strip + i) + p_depth_begin;
+							for (unsigned int p = 0; p < p_depth; ++p) {
+								p_packed[p * p_mr + i] = source[p];
+							}
+						} else {
+							for (unsigned int p = 0; p < p_depth; ++p) {
+								p_packed[p * p_mr + i] = 0.0f;
+							}
+						}
+					}
+
+					p_packed += p_depth * p_mr;
+				}
+			}
+
+			// Pack rows [p_depth_begin, + p_depth) x columns [p_column, p_column + p_columns) of B into
+			// strips of p_nr columns, stored row by row. Columns past the end are zero.
+			static void PackB(const MatrixN& p_b, unsigned int p_depth_begin, unsigned int p_depth, unsigned int p_column, unsigned int p_columns, unsigned int p_nr, SCALAR* p_packed) {
+				for (unsigned int strip = 0; strip < p_columns; strip += p_nr) {
+					unsigned int width = std::min(p_nr, p_columns - strip);
+
+					for (unsigned int p = 0; p < p_depth; ++p) {
+						const SCALAR* source = p_b.GetRow(p_depth_begin + p) + p_column + strip;
+						SCALAR* destination = p_packed + p * p_nr;
+
+						memcpy(destination, source, width * sizeof(SCALAR));
+						for (unsigned int j = width; j < p_nr; ++j) {
+							destination[j] = 0.0f;
+						}
+					}
+
+					p_packed += p_depth * p_nr;
+				}
+			}
+
+			// C[p_row_begin, p_row_end) = A[p_row_begin, p_row_end) * B
+			static void MultiplyRows(const MatrixN& p_lhs, const MatrixN& p_rhs, MatrixN& p_result, unsigned int p_row_begin, unsigned int p_row_end, const KernelInfo& p_kernel) {
+				unsigned int mr = p_kernel.m_mr;
+				unsigned int nr = p_kernel.m_nr;
+				unsigned int depth = p_lhs.GetColumns();
+				unsigned int columns = p_rhs.GetColumns();
+				unsigned int mc = (K_MC / mr) * mr;
+
+				PackBuffer packed_a(static_cast<std::size_t>(mc) * K_KC);
+				PackBuffer packed_b(static_cast<std::size_t>(K_KC) * ((K_NC + nr - 1) / nr) * nr);
+				SCALAR edge[K_MAX_MR * K_MAX_NR];
+
+				for (unsigned int jc = 0; jc < columns; jc += K_NC) {
+					unsigned int nc = std::min(K_NC, columns - jc);
+
+					for (unsigned int pc = 0; pc < depth; pc += K_KC) {
+						unsigned int kc = std::min(K_KC, depth - pc);
+						bool accumulate = (pc != 0);
+
+						PackB(p_rhs, pc, kc, jc, nc, nr, packed_b.m_data);
+
+						for (unsigned int ic = p_row_begin; ic < p_row_end; ic += mc) {
+							unsigned int rows = std::min(mc, p_row_end - ic);
+
+							PackA(p_lhs, ic, rows, pc, kc, mr, packed_a.m_data);
+
+							for (unsigned int jr = 0; jr < nc; jr += nr) {
+								unsigned int tile_columns = std::min(nr, nc - jr);
+								const SCALAR* b = packed_b.m_data + static_cast<std::size_t>(jr) * kc;
+
+								for (unsigned int ir = 0; ir < rows; ir += mr) {
+									unsigned int tile_rows = std::min(mr, rows - ir);
+									const SCALAR* a = packed_a.m_data + static_cast<std::size_t>(ir) * kc;
+									SCALAR* c = p_result.GetRow(ic + ir) + jc + jr;
+
+									if (tile_rows == mr && tile_columns == nr) {
+										p_kernel.m_kernel(kc, a, b, c, p_result.GetStride(), accumulate);
+										continue;
+									}
+
+									// partial tiles are computed aside and only the valid part is written
+									p_kernel.m_kernel(kc, a, b, edge, nr, false);
+									for (unsigned int i = 0; i < tile_rows; ++i) {
+										SCALAR* destination = c + static_cast<std::size_t>(i) * p_result.GetStride();
+										for (unsigned int j = 0; j < tile_columns; ++j) {
+											destination[j] = accumulate ? destination[j] + edge[i * nr + j] : edge[i * nr + j];
+										}
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		void Multiply(const MatrixN& p_lhs, const MatrixN& p_rhs, MatrixN& p_result, unsigned int p_thread_count) {
+			if (p_lhs.GetColumns() != p_rhs.GetRows()) throw r2ExceptionArgumentM("Matrix dimensions do not match for multiplication");
+
+			if (&p_result == &p_lhs || &p_result == &p_rhs) {
+				MatrixN result;
+				Multiply(p_lhs, p_rhs, result, p_thread_count);
+				p_result = result;
+				return;
+			}
+
+			unsigned int rows = p_lhs.GetRows();
+			unsigned int columns = p_rhs.GetColumns();
+			unsigned int depth = p_lhs.GetColumns();
+
+			if (p_result.GetRows() != rows || p_result.GetColumns() != columns) {
+				p_result = MatrixN(rows, columns);
+			}
+
+			if (rows == 0 || columns == 0) return;
+			if (depth == 0) {
+				p_result = MatrixN(rows, columns);
+				return;
+			}
+
+			// threads get whole strips of rows, each packing its own operands
+			priv::KernelInfo kernel = priv::GetKernel();
+			std::size_t strips = (rows + kernel.m_mr - 1) / kernel.m_mr;
+			std::size_t strip_work = static_cast<std::size_t>(kernel.m_mr) * columns * depth;
+			std::size_t min_strips = (priv::K_MIN_MULTIPLY_WORK + strip_work - 1) / strip_work;
+
+			Parallel::For(strips, min_strips, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				unsigned int row_begin = static_cast<unsigned int>(p_begin * kernel.m_mr);
+				unsigned int row_end = static_cast<unsigned int>(std::min<std::size_t>(p_end * kernel.m_mr, rows));
+				priv::MultiplyRows(p_lhs, p_rhs, p_result, row_begin, row_end, kernel);
+			});
+		}
+
+
+
+		MatrixN Solve(const MatrixN& p_lhs, const MatrixN& p_rhs) {
+			unsigned int n = p_lhs.GetRows();
+			if (p_lhs.GetColumns() != n) throw r2ExceptionArgumentM("Solving a system with a non-square matrix");
+			if (p_rhs.GetRows() != n) throw r2ExceptionArgumentM("Matrix dimensions do not match for solving");
+
+			// Gaussian elimination with partial pivoting, applied to the right hand sides as it goes
+			MatrixN lu(p_lhs);
+			MatrixN result(p_rhs);
+			unsigned int lu_width = lu.GetStride();
+			unsigned int result_width = result.GetStride();
+
+			// pivots at most n * epsilon times the largest entry are rounding noise
+			SCALAR threshold = 0.0f;
+			for (unsigned int row = 0; row < n; ++row) {
+				for (unsigned int col = 0; col < n; ++col) {
+					threshold = std::max(threshold, std::fabs(lu(row, col)));
+				}
+			}
+			threshold *= n * std::numeric_limits<SCALAR>::epsilon();
+
+			for (unsigned int k = 0; k < n; ++k) {
+				unsigned int pivot_row = k;
+				SCALAR pivot_magnitude = std::fabs(lu(k, k));
+				for (unsigned int row = k + 1; row < n; ++row) {
+					SCALAR magnitude = std::fabs(lu(row, k));
+					if (magnitude > pivot_magnitude) {
+						pivot_magnitude = magnitude;
+						pivot_row = row;
+					}
+				}
+
+				if (pivot_magnitude <= threshold) throw r2ExceptionDivisionByZeroM("Singular matrix in solve");
+
+				if (pivot_row != k) {
+					std::swap_ranges(lu.GetRow(k), lu.GetRow(k) + lu_width, lu.GetRow(pivot_row));
+					std::swap_ranges(result.GetRow(k), result.GetRow(k) + result_width, result.GetRow(pivot_row));
+				}
+
+				const SCALAR* pivot_lu = lu.GetRow(k);
+				const SCALAR* pivot_result = result.GetRow(k);
+				SCALAR inverse_pivot = 1.0f / pivot_lu[k];
+
+				for (unsigned int row = k + 1; row < n; ++row) {
+					SCALAR* target_lu = lu.GetRow(row);
+					SCALAR factor = target_lu[k] * inverse_pivot;
+					if (factor == 0.0f) continue;
+
+					for (unsigned int col = k + 1; col < n; ++col) {
+						target_lu[col] -= factor * pivot_lu[col];
+					}
+
+					SCALAR* target_result = result.GetRow(row);
+					for (unsigned int col = 0; col < result_width; ++col) {
+						target_result[col] -= factor * pivot_result[col];
+					}
+				}
+			}
+
+			// back substitution, one row of solutions at a time
+			for (unsigned int k = n; k-- > 0;) {
+				const SCALAR* row_lu = lu.GetRow(k);
+				SCALAR* target = result.GetRow(k);
+
+				for (unsigned int j = k + 1; j < n; ++j) {
+					const SCALAR* solved = result.GetRow(j);
+					SCALAR factor = row_lu[j];
+					for (unsigned int col = 0; col < result_width; ++col) {
+						target[col] -= factor * solved[col];
+					}
+				}
+
+				SCALAR inverse_pivot = 1.0f / row_lu[k];
+				for (unsigned int col = 0; col < result_width; ++col) {
+					target[col] *= inverse_pivot;
+				}
+			}
+
+			return result;
+		}
+
+		MatrixN GetInverse(const MatrixN& p_matrix) {
+			return Solve(p_matrix, MatrixN(p_matrix.GetRows(), p_matrix.GetRows(), 1.0f));
+		}
+	}
+}
@@ -0,0 +1,177 @@
+/* HEADER
+ *
+ * File: r2-matrix-n.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A matrix whose size is chosen at runtime, for problems larger than
+ *	Matrix2/3/4 (least squares, deformation solvers). Elements are in row
+ *	order and every row starts on a SIMD::K_ALIGNMENT boundary, so rows
+ *	may be padded; use GetStride() to step between rows.
+ *
+ *	Multiplication is a cache blocked GEMM: panels of the operands are
+ *	packed into contiguous buffers and a register blocked micro kernel
+ *	(SSE2 or AVX2/FMA) computes small tiles of the result. Large products
+ *	are split over threads by rows.
+ *
+ *	Operands of mismatching sizes raise an Argument exception.
+ * Depends on:
+ *  * SCALAR
+ *  * FloatCompare
+ *  * r2::Exception::Argument, r2::Exception::DivisionByZero
+ *  * r2::Math::SIMD
+ *  * r2::Parallel
+ * Updates:
+ *
+ */
+#ifndef R2_MATRIX_N_HPP
+#define R2_MATRIX_N_HPP
+
+#include <ostream>
+#include "r2-math-generic.hpp"
+
+namespace r2 {
+	namespace Math {
+		class MatrixN {
+		public:
+			/**
+			 * Initialize an empty (0x0) matrix
+			 */
+			MatrixN();
+
+			/**
+			 * Initialize a p_rows x p_columns zero matrix
+			 */
+			MatrixN(unsigned int p_rows, unsigned int p_columns);
+
+			/**
+			 * Initialize a matrix with the given parameter as the diagonal elements. The rest
+			 * of the elements are set to 0.
+			 */
+			MatrixN(unsigned int p_rows, unsigned int p_columns, SCALAR p_diagonal_element);
+
+			/**
+			 * Initialize the matrix from an array of p_rows * p_columns scalars in
+			 * row order (without padding).
+			 */
+			MatrixN(unsigned int p_rows, unsigned int p_columns, const SCALAR* p_raw_data);
+
+			MatrixN(const MatrixN& p_matrix);
+			~MatrixN();
+
+			MatrixN& operator=(const MatrixN& p_matrix);
+
+
+			/**
+			 * Get the dimensions of the matrix
+			 */
+			unsigned int GetRows() const;
+			unsigned int GetColumns() const;
+
+			/**
+			 * Get the number of scalars between the starts of two consecutive rows
+			 */
+			unsigned int GetStride() const;
+
+			/**
+			 * Change the dimensions of the matrix. Elements inside both the old and
+			 * the new dimensions are kept, new ones are set to 0.
+			 */
+			void Resize(unsigned int p_rows, unsigned int p_columns);
+
+			/**
+			 * Get a pointer to the first element of a row. The row is aligned
+			 * to SIMD::K_ALIGNMENT bytes.
+			 */
+			SCALAR* GetRow(unsigned int p_row);
+			const SCALAR* GetRow(unsigned int p_row) const;
+
+
+			/**
+			 * Operators
+			 */
+			SCALAR& operator()(unsigned int p_row, unsigned int p_col);
+			SCALAR operator()(unsigned int p_row, unsigned int p_col) const;
+			MatrixN operator-() const;
+			MatrixN& operator+=(const MatrixN& p_rhs);
+			MatrixN& operator-=(const MatrixN& p_rhs);
+			MatrixN& operator*=(SCALAR p_rhs);
+			MatrixN& operator*=(const MatrixN& p_rhs);
+			MatrixN& operator/=(SCALAR p_rhs);
+
+			/**
+			 * Calculate the trace of the matrix (the sum of the diagonal elements).
+			 * The matrix must be square.
+			 */
+			SCALAR Trace() const;
+
+			/**
+			 * Transpose this matrix (all elements A_ij are set to A_ji). The
+			 * dimensions are swapped.
+			 */
+			MatrixN& Transpose();
+		private:
+			unsigned int m_rows;
+			unsigned int m_columns;
+			unsigned int m_stride;
+			SCALAR* m_data;
+		};
+
+		/**
+		 * Operators
+		 */
+		MatrixN operator+(const MatrixN& p_lhs, const MatrixN& p_rhs);
+		MatrixN operator-(const MatrixN& p_lhs, const MatrixN& p_rhs);
+		MatrixN operator*(const MatrixN& p_lhs, const MatrixN& p_rhs);
+		MatrixN operator*(const MatrixN& p_lhs, SCALAR p_rhs);
+		MatrixN operator*(SCALAR p_lhs, const MatrixN& p_rhs);
+		MatrixN operator/(const MatrixN& p_lhs, SCALAR p_rhs);
+		bool operator==(const MatrixN& p_lhs, const MatrixN& p_rhs);
+		bool operator!=(const MatrixN& p_lhs, const MatrixN& p_rhs);
+		std::ostream& operator<<(std::ostream& p_lhs, const MatrixN& p_rhs);
+
+		/**
+		 * p_result = p_lhs * p_rhs, split over p_thread_count threads (0 uses all
+		 * hardware threads). p_result is resized to match and may be the same
+		 * matrix as an operand.
+		 */
+		void Multiply(const MatrixN& p_lhs, const MatrixN& p_rhs, MatrixN& p_result, unsigned int p_thread_count = 1);
+
+		/**
+		 * Get a transpose of the matrix
+		 */
+		MatrixN GetTranspose(const MatrixN& p_matrix);
+
+		/**
+		 * Solve p_lhs * X = p_rhs for X, with p_lhs square, by LU decomposition with
+		 * partial pivoting. Every column of p_rhs is a separate right hand side. If
+		 * p_lhs is singular, a DivisionByZero exception is raised.
+		 */
+		MatrixN Solve(const MatrixN& p_lhs, const MatrixN& p_rhs);
+
+		/**
+		 * Get the inverse of a square matrix, if possible. If the matrix is
+		 * singular, a DivisionByZero exception is raised.
+		 */
+		MatrixN GetInverse(const MatrixN& p_matrix);
+	}
+}
+
+#endif
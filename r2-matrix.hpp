@@ -0,0 +1,431 @@
+/* HEADER
+ *
+ * File: r2-matrix.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A mathematical matrix of R rows and C columns of any scalar type, the
+ *	matrix counterpart of Vector<N, T>. Elements are stored in row order,
+ *	like Matrix2/3/4, and all loops run over the compile time size.
+ *
+ *	Matrix<2, 2>, Matrix<3, 3> and Matrix<4, 4> convert explicitly to and
+ *	from Matrix2, Matrix3 and Matrix4.
+ * Depends on:
+ *  * Vector<N, T>
+ *  * Matrix2, Matrix3, Matrix4
+ * Updates:
+ *
+ */
+#ifndef R2_MATRIX_HPP
+#define R2_MATRIX_HPP
+
+#include <ostream>
+#include "r2-vector.hpp"
+#include "r2-matrix-2.hpp"
+#include "r2-matrix-3.hpp"
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		template <unsigned int R, unsigned int C, typename T = SCALAR>
+		class Matrix {
+		public:
+			static const unsigned int K_ROWS = R;
+			static const unsigned int K_COLUMNS = C;
+
+			/**
+			 * Initialize the zero matrix
+			 */
+			Matrix();
+
+			/**
+			 * Initialize a matrix with the given parameter as the diagonal elements. The rest
+			 * of the elements are set to 0.
+			 */
+			explicit Matrix(T p_diagonal_element);
+
+			/**
+			 * Initialize the matrix from an array of at least R * C scalars in row order.
+			 */
+			explicit Matrix(const T* p_raw_data);
+
+			/**
+			 * Convert from a matrix of another scalar type
+			 */
+			template <typename U>
+			explicit Matrix(const Matrix<R, C, U>& p_matrix);
+
+			/**
+			 * Convert from and to the fixed size matrices. Only available for the matching size.
+			 */
+			explicit Matrix(const Matrix2& p_matrix);
+			explicit Matrix(const Matrix3& p_matrix);
+			explicit Matrix(const Matrix4& p_matrix);
+			explicit operator Matrix2() const;
+			explicit operator Matrix3() const;
+			explicit operator Matrix4() const;
+
+
+			/**
+			 * Methods for accessing a row or column from the matrix.
+			 */
+			Vector<C, T> GetRow(unsigned int p_row) const;
+			Vector<R, T> GetColumn(unsigned int p_col) const;
+
+			/**
+			 * Methods for setting the rows and the columns of the matrix
+			 */
+			void SetRow(unsigned int p_row_index, const Vector<C, T>& p_row_vector);
+			void SetColumn(unsigned int p_column_index, const Vector<R, T>& p_column_vector);
+
+
+			/**
+			 * Operators
+			 */
+			T& operator()(unsigned int p_row, unsigned int p_col);
+			T operator()(unsigned int p_row, unsigned int p_col) const;
+			Matrix operator-() const;
+			Matrix& operator+=(const Matrix& p_rhs);
+			Matrix& operator-=(const Matrix& p_rhs);
+			Matrix& operator*=(T p_rhs);
+			Matrix& operator*=(const Matrix<C, C, T>& p_rhs);
+			Matrix& operator/=(T p_rhs);
+
+			/**
+			 * Calculate the trace of the matrix (the sum of the diagonal elements).
+			 * Only available for square matrices.
+			 */
+			T Trace() const;
+
+			/**
+			 * Transpose this matrix (all elements A_ij are set to A_ji). Only
+			 * available for square matrices, use GetTransposed otherwise.
+			 */
+			Matrix& Transpose();
+
+
+			union {
+				/**
+				 * All data is in row order - i.e. the first array index
+				 * in m_elements is the row index.
+				 */
+				T m_data[R * C];
+				T m_elements[R][C];
+			};
+		};
+
+		typedef Matrix<2, 2, double> Matrix2d;
+		typedef Matrix<3, 3, double> Matrix3d;
+		typedef Matrix<4, 4, double> Matrix4d;
+
+		/**
+		 * Operators
+		 */
+		template <unsigned int R, unsigned int C, typename T> Matrix<R, C, T> operator+(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs);
+		template <unsigned int R, unsigned int C, typename T> Matrix<R, C, T> operator-(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs);
+		template <unsigned int R, unsigned int K, unsigned int C, typename T> Matrix<R, C, T> operator*(const Matrix<R, K, T>& p_lhs, const Matrix<K, C, T>& p_rhs);
+		template <unsigned int R, unsigned int C, typename T> Vector<R, T> operator*(const Matrix<R, C, T>& p_lhs, const Vector<C, T>& p_rhs);
+		template <unsigned int R, unsigned int C, typename T> Matrix<R, C, T> operator*(const Matrix<R, C, T>& p_lhs, T p_rhs);
+		template <unsigned int R, unsigned int C, typename T> Matrix<R, C, T> operator*(T p_lhs, const Matrix<R, C, T>& p_rhs);
+		template <unsigned int R, unsigned int C, typename T> Matrix<R, C, T> operator/(const Matrix<R, C, T>& p_lhs, T p_rhs);
+		template <unsigned int R, unsigned int C, typename T> bool operator==(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs);
+		template <unsigned int R, unsigned int C, typename T> bool operator!=(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs);
+		template <unsigned int R, unsigned int C, typename T> std::ostream& operator<<(std::ostream& p_lhs, const Matrix<R, C, T>& p_rhs);
+
+		/**
+		 * Get the transpose of a matrix
+		 */
+		template <unsigned int R, unsigned int C, typename T> Matrix<C, R, T> GetTransposed(const Matrix<R, C, T>& p_matrix);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		namespace priv {
+			template <typename T, unsigned int R, unsigned int K, unsigned int C>
+			struct MultiplyElement {
+				const T* m_lhs; const T* m_rhs; T* m_result;
+				inline void operator()(unsigned int i) {
+					unsigned int row = i / C;
+					unsigned int col = i % C;
+					T sum = T(0);
+					for (unsigned int k = 0; k < K; ++k)
+						sum += m_lhs[row * K + k] * m_rhs[k * C + col];
+					m_result[i] = sum;
+				}
+			};
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::Matrix() {
+			priv::Fill<T> fill = { m_data, T(0) };
+			priv::Unroll<0, R * C>::Apply(fill);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::Matrix(T p_diagonal_element) {
+			priv::Fill<T> fill = { m_data, T(0) };
+			priv::Unroll<0, R * C>::Apply(fill);
+			for (unsigned int i = 0; i < R && i < C; ++i)
+				m_elements[i][i] = p_diagonal_element;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::Matrix(const T* p_raw_data) {
+			priv::Copy<T, T> copy = { m_data, p_raw_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		template <typename U>
+		Matrix<R, C, T>::Matrix(const Matrix<R, C, U>& p_matrix) {
+			priv::Copy<T, U> copy = { m_data, p_matrix.m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::Matrix(const Matrix2& p_matrix) {
+			static_assert(R == 2 && C == 2, "Only a 2x2 matrix converts from Matrix2");
+			priv::Copy<T, SCALAR> copy = { m_data, p_matrix.m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::Matrix(const Matrix3& p_matrix) {
+			static_assert(R == 3 && C == 3, "Only a 3x3 matrix converts from Matrix3");
+			priv::Copy<T, SCALAR> copy = { m_data, p_matrix.m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::Matrix(const Matrix4& p_matrix) {
+			static_assert(R == 4 && C == 4, "Only a 4x4 matrix converts from Matrix4");
+			priv::Copy<T, SCALAR> copy = { m_data, p_matrix.m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::operator Matrix2() const {
+			static_assert(R == 2 && C == 2, "Only a 2x2 matrix converts to Matrix2");
+			Matrix2 result;
+			priv::Copy<SCALAR, T> copy = { result.m_data, m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::operator Matrix3() const {
+			static_assert(R == 3 && C == 3, "Only a 3x3 matrix converts to Matrix3");
+			Matrix3 result;
+			priv::Copy<SCALAR, T> copy = { result.m_data, m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>::operator Matrix4() const {
+			static_assert(R == 4 && C == 4, "Only a 4x4 matrix converts to Matrix4");
+			Matrix4 result;
+			priv::Copy<SCALAR, T> copy = { result.m_data, m_data };
+			priv::Unroll<0, R * C>::Apply(copy);
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Vector<C, T> Matrix<R, C, T>::GetRow(unsigned int p_row) const {
+			return Vector<C, T>(m_elements[p_row]);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Vector<R, T> Matrix<R, C, T>::GetColumn(unsigned int p_col) const {
+			Vector<R, T> result;
+			for (unsigned int i = 0; i < R; ++i)
+				result.m_data[i] = m_elements[i][p_col];
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		void Matrix<R, C, T>::SetRow(unsigned int p_row_index, const Vector<C, T>& p_row_vector) {
+			for (unsigned int i = 0; i < C; ++i)
+				m_elements[p_row_index][i] = p_row_vector.m_data[i];
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		void Matrix<R, C, T>::SetColumn(unsigned int p_column_index, const Vector<R, T>& p_column_vector) {
+			for (unsigned int i = 0; i < R; ++i)
+				m_elements[i][p_column_index] = p_column_vector.m_data[i];
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		T& Matrix<R, C, T>::operator()(unsigned int p_row, unsigned int p_col) {
+			return m_elements[p_row][p_col];
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		T Matrix<R, C, T>::operator()(unsigned int p_row, unsigned int p_col) const {
+			return m_elements[p_row][p_col];
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T> Matrix<R, C, T>::operator-() const {
+			return Matrix(*this) *= T(-1);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>& Matrix<R, C, T>::operator+=(const Matrix& p_rhs) {
+			priv::Add<T> add = { m_data, p_rhs.m_data };
+			priv::Unroll<0, R * C>::Apply(add);
+			return *this;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>& Matrix<R, C, T>::operator-=(const Matrix& p_rhs) {
+			priv::Subtract<T> subtract = { m_data, p_rhs.m_data };
+			priv::Unroll<0, R * C>::Apply(subtract);
+			return *this;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>& Matrix<R, C, T>::operator*=(T p_rhs) {
+			priv::Scale<T> scale = { m_data, p_rhs };
+			priv::Unroll<0, R * C>::Apply(scale);
+			return *this;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>& Matrix<R, C, T>::operator*=(const Matrix<C, C, T>& p_rhs) {
+			return *this = *this * p_rhs;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>& Matrix<R, C, T>::operator/=(T p_rhs) {
+			if constexpr (std::is_floating_point<T>::value) return *this *= (T(1) / p_rhs);
+
+			priv::Divide<T> divide = { m_data, p_rhs };
+			priv::Unroll<0, R * C>::Apply(divide);
+			return *this;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		T Matrix<R, C, T>::Trace() const {
+			static_assert(R == C, "The trace is only defined for square matrices");
+			T result = T(0);
+			for (unsigned int i = 0; i < R; ++i)
+				result += m_elements[i][i];
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T>& Matrix<R, C, T>::Transpose() {
+			static_assert(R == C, "Only square matrices can be transposed in place");
+			for (unsigned int i = 0; i < R; ++i) {
+				for (unsigned int k = i + 1; k < C; ++k) {
+					T temp = m_elements[i][k];
+					m_elements[i][k] = m_elements[k][i];
+					m_elements[k][i] = temp;
+				}
+			}
+
+			return *this;
+		}
+
+
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T> operator+(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs) {
+			return (Matrix<R, C, T>(p_lhs) += p_rhs);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T> operator-(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs) {
+			return (Matrix<R, C, T>(p_lhs) -= p_rhs);
+		}
+
+		template <unsigned int R, unsigned int K, unsigned int C, typename T>
+		Matrix<R, C, T> operator*(const Matrix<R, K, T>& p_lhs, const Matrix<K, C, T>& p_rhs) {
+			Matrix<R, C, T> result;
+			priv::MultiplyElement<T, R, K, C> multiply = { p_lhs.m_data, p_rhs.m_data, result.m_data };
+			priv::Unroll<0, R * C>::Apply(multiply);
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Vector<R, T> operator*(const Matrix<R, C, T>& p_lhs, const Vector<C, T>& p_rhs) {
+			Vector<R, T> result;
+			priv::MultiplyElement<T, R, C, 1> multiply = { p_lhs.m_data, p_rhs.m_data, result.m_data };
+			priv::Unroll<0, R>::Apply(multiply);
+			return result;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T> operator*(const Matrix<R, C, T>& p_lhs, T p_rhs) {
+			return (Matrix<R, C, T>(p_lhs) *= p_rhs);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T> operator*(T p_lhs, const Matrix<R, C, T>& p_rhs) {
+			return p_rhs * p_lhs;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<R, C, T> operator/(const Matrix<R, C, T>& p_lhs, T p_rhs) {
+			return (Matrix<R, C, T>(p_lhs) /= p_rhs);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		bool operator==(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs) {
+			priv::Equals<T> equals = { p_lhs.m_data, p_rhs.m_data, true };
+			priv::Unroll<0, R * C>::Apply(equals);
+			return equals.m_equal;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		bool operator!=(const Matrix<R, C, T>& p_lhs, const Matrix<R, C, T>& p_rhs) {
+			return !(p_lhs == p_rhs);
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		std::ostream& operator<<(std::ostream& p_lhs, const Matrix<R, C, T>& p_rhs) {
+			for (unsigned int i = 0; i < R; ++i) {
+				p_lhs << "[";
+				for (unsigned int k = 0; k < C; ++k) {
+					p_lhs << p_rhs.m_elements[i][k];
+					if (k != C - 1) p_lhs << ", ";
+				}
+				p_lhs << "]";
+				if (i != R - 1) p_lhs << "\n";
+			}
+
+			return p_lhs;
+		}
+
+		template <unsigned int R, unsigned int C, typename T>
+		Matrix<C, R, T> GetTransposed(const Matrix<R, C, T>& p_matrix) {
+			Matrix<C, R, T> result;
+			for (unsigned int i = 0; i < R; ++i)
+				for (unsigned int k = 0; k < C; ++k)
+					result.m_elements[k][i] = p_matrix.m_elements[i][k];
+			return result;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,437 @@
+#include "r2-packed-vector.hpp"
+#include "r2-simd.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		// the vectors are converted as flat arrays of components
+		static_assert(sizeof(Vector3) == 3 * sizeof(float) && sizeof(Vector4) == 4 * sizeof(float), "Vectors must be tightly packed floats");
+		static_assert(sizeof(HalfVector3) == 6 && sizeof(HalfVector4) == 8 && sizeof(SNormVector3) == 6, "Packed vectors must not be padded");
+		static_assert(sizeof(UNormVector4) == 4 && sizeof(OctahedralVector) == 4, "Packed vectors must not be padded");
+
+		static const float K_SNORM_SCALE = 32767.0f;
+		static const float K_UNORM_SCALE = 255.0f;
+
+		// the smallest sum of absolute components an octahedral vector is folded with
+		static const float K_MIN_OCTAHEDRAL_SUM = 1e-30f;
+
+		static inline unsigned int FloatBits(float p_value) {
+			unsigned int bits;
+			std::memcpy(&bits, &p_value, sizeof(bits));
+			return bits;
+		}
+
+		static inline float BitsFloat(unsigned int p_bits) {
+			float value;
+			std::memcpy(&value, &p_bits, sizeof(value));
+			return value;
+		}
+
+		// clamped in the order of the SIMD min and max, so NaN goes to p_max as there
+		static inline float Clamp(float p_value, float p_min, float p_max) {
+			p_value = (p_value < p_max) ? p_value : p_max;
+			return (p_value > p_min) ? p_value : p_min;
+		}
+
+		// rounds half to even, like the SIMD conversions
+		static inline short ToSNorm(float p_value) {
+			return static_cast<short>(std::nearbyint(Clamp(p_value, -1.0f, 1.0f) * K_SNORM_SCALE));
+		}
+
+		static inline float FromSNorm(short p_value) {
+			float value = p_value * (1.0f / K_SNORM_SCALE);
+			return (value > -1.0f) ? value : -1.0f;
+		}
+
+
+
+		/**
+		 * Halves. The scalar conversions work on the bits: the exponent is rebiased
+		 * and the mantissa rounded by adding just under half of the dropped bits
+		 * (plus one if the kept part is odd). Results that are subnormal halves are
+		 * produced by a float addition that lines the mantissa up.
+		 */
+		unsigned short FloatToHalf(float p_value) {
+			unsigned int bits = FloatBits(p_value);
+			unsigned int sign = (bits >> 16) & 0x8000u;
+			bits &= 0x7FFFFFFFu;
+
+			unsigned int half;
+			if (bits >= 0x47800000u) {
+				// too large, infinity or NaN (kept quiet)
+				half = (bits > 0x7F800000u) ? 0x7E00u : 0x7C00u;
+			} else if (bits < 0x38800000u) {
+				// adding 0.5 leaves the half mantissa in the low bits, rounded
+				half = FloatBits(BitsFloat(bits) + 0.5f) - 0x3F000000u;
+			} else {
+				unsigned int odd = (bits >> 13) & 1u;
+				bits += 0xC8000FFFu + odd;
+				half = bits >> 13;
+			}
+
+			return static_cast<unsigned short>(half | sign);
+		}
+
+		float HalfToFloat(unsigned short p_value) {
+			const unsigned int exponent_mask = 0x7C00u << 13;
+			unsigned int bits = (p_value & 0x7FFFu) << 13;
+			unsigned int exponent = bits & exponent_mask;
+			bits += (127 - 15) << 23;
+
+			if (exponent == exponent_mask) {
+				// infinity or NaN
+				bits += (128 - 16) << 23;
+			} else if (exponent == 0) {
+				// subnormal, renormalized by a float subtraction
+				bits += 1 << 23;
+				bits = FloatBits(BitsFloat(bits) - BitsFloat(113u << 23));
+			}
+
+			return BitsFloat(bits | ((p_value & 0x8000u) << 16));
+		}
+
+
+
+		/**
+		 * Kernels on flat arrays of components. They return the number of
+		 * components converted, the rest is converted by the scalar code.
+		 */
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("avx2,fma,f16c")
+		static unsigned int F16CFloatsToHalves(const float* p_floats, unsigned int p_count, unsigned short* p_halves) {
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(p_floats + i), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p_halves + i), halves);
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma,f16c")
+		static unsigned int F16CHalvesToFloats(const unsigned short* p_halves, unsigned int p_count, float* p_floats) {
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_halves + i));
+				_mm256_storeu_ps(p_floats + i, _mm256_cvtph_ps(halves));
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2FloatsToSNorm(const float* p_floats, unsigned int p_count, short* p_snorm) {
+			const __m128 minimum = _mm_set1_ps(-1.0f), maximum = _mm_set1_ps(1.0f), scale = _mm_set1_ps(K_SNORM_SCALE);
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m128 low = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(p_floats + i), maximum), minimum);
+				__m128 high = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(p_floats + i + 4), maximum), minimum);
+				__m128i snorm = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(low, scale)), _mm_cvtps_epi32(_mm_mul_ps(high, scale)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p_snorm + i), snorm);
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2SNormToFloats(const short* p_snorm, unsigned int p_count, float* p_floats) {
+			const __m128 minimum = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(1.0f / K_SNORM_SCALE);
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m128i snorm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_snorm + i));
+
+				// sign extended by placing every value in the high half and shifting back
+				__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(snorm, snorm), 16);
+				__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(snorm, snorm), 16);
+				_mm_storeu_ps(p_floats + i, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(low), scale), minimum));
+				_mm_storeu_ps(p_floats + i + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(high), scale), minimum));
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2FloatsToUNorm(const float* p_floats, unsigned int p_count, unsigned char* p_unorm) {
+			const __m128 minimum = _mm_setzero_ps(), maximum = _mm_set1_ps(1.0f), scale = _mm_set1_ps(K_UNORM_SCALE);
+
+			unsigned int i = 0;
+			for (; i + 16 <= p_count; i += 16) {
+				__m128i values[4];
+				for (int k = 0; k < 4; ++k) {
+					__m128 value = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(p_floats + i + 4 * k), maximum), minimum);
+					values[k] = _mm_cvtps_epi32(_mm_mul_ps(value, scale));
+				}
+
+				__m128i unorm = _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p_unorm + i), unorm);
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2UNormToFloats(const unsigned char* p_unorm, unsigned int p_count, float* p_floats) {
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 scale = _mm_set1_ps(1.0f / K_UNORM_SCALE);
+
+			unsigned int i = 0;
+			for (; i + 16 <= p_count; i += 16) {
+				__m128i unorm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_unorm + i));
+				__m128i low = _mm_unpacklo_epi8(unorm, zero), high = _mm_unpackhi_epi8(unorm, zero);
+				__m128i values[4] = { _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero), _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero) };
+				for (int k = 0; k < 4; ++k) {
+					_mm_storeu_ps(p_floats + i + 4 * k, _mm_mul_ps(_mm_cvtepi32_ps(values[k]), scale));
+				}
+			}
+
+			return i;
+		}
+#endif
+
+		static void FloatsToHalves(const float* p_floats, unsigned int p_count, unsigned short* p_halves) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = F16CFloatsToHalves(p_floats, p_count, p_halves);
+#endif
+			for (; i < p_count; ++i) {
+				p_halves[i] = FloatToHalf(p_floats[i]);
+			}
+		}
+
+		static void HalvesToFloats(const unsigned short* p_halves, unsigned int p_count, float* p_floats) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = F16CHalvesToFloats(p_halves, p_count, p_floats);
+#endif
+			for (; i < p_count; ++i) {
+				p_floats[i] = HalfToFloat(p_halves[i]);
+			}
+		}
+
+		static void FloatsToSNorm(const float* p_floats, unsigned int p_count, short* p_snorm) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2FloatsToSNorm(p_floats, p_count, p_snorm);
+#endif
+			for (; i < p_count; ++i) {
+				p_snorm[i] = ToSNorm(p_floats[i]);
+			}
+		}
+
+		static void SNormToFloats(const short* p_snorm, unsigned int p_count, float* p_floats) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2SNormToFloats(p_snorm, p_count, p_floats);
+#endif
+			for (; i < p_count; ++i) {
+				p_floats[i] = FromSNorm(p_snorm[i]);
+			}
+		}
+
+		static void FloatsToUNorm(const float* p_floats, unsigned int p_count, unsigned char* p_unorm) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2FloatsToUNorm(p_floats, p_count, p_unorm);
+#endif
+			for (; i < p_count; ++i) {
+				p_unorm[i] = static_cast<unsigned char>(std::nearbyint(Clamp(p_floats[i], 0.0f, 1.0f) * K_UNORM_SCALE));
+			}
+		}
+
+		static void UNormToFloats(const unsigned char* p_unorm, unsigned int p_count, float* p_floats) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2UNormToFloats(p_unorm, p_count, p_floats);
+#endif
+			for (; i < p_count; ++i) {
+				p_floats[i] = p_unorm[i] * (1.0f / K_UNORM_SCALE);
+			}
+		}
+
+
+
+		/**
+		 * Octahedral vectors. A unit vector is projected onto the octahedron
+		 * |x| + |y| + |z| = 1, whose lower half (z < 0) is folded out over the
+		 * diagonals of the square [-1, 1]^2, and the square is stored as two
+		 * snorm values. Unpacking unfolds and normalizes.
+		 */
+		static void ScalarPackOctahedral(const float* p_vector, short* p_result) {
+			float sum = std::fabs(p_vector[0]) + std::fabs(p_vector[1]) + std::fabs(p_vector[2]);
+			float inverse_sum = 1.0f / ((sum > K_MIN_OCTAHEDRAL_SUM) ? sum : K_MIN_OCTAHEDRAL_SUM);
+			float x = p_vector[0] * inverse_sum;
+			float y = p_vector[1] * inverse_sum;
+
+			if (p_vector[2] < 0.0f) {
+				float folded_x = (1.0f - std::fabs(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+				float folded_y = (1.0f - std::fabs(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+				x = folded_x;
+				y = folded_y;
+			}
+
+			p_result[0] = ToSNorm(x);
+			p_result[1] = ToSNorm(y);
+		}
+
+		static void ScalarUnpackOctahedral(const short* p_packed, float* p_result) {
+			float x = FromSNorm(p_packed[0]);
+			float y = FromSNorm(p_packed[1]);
+			float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+			float fold = (z < 0.0f) ? -z : 0.0f;
+			x += (x >= 0.0f) ? -fold : fold;
+			y += (y >= 0.0f) ? -fold : fold;
+
+			float inverse_length = 1.0f / std::sqrt(x * x + y * y + z * z);
+			p_result[0] = x * inverse_length;
+			p_result[1] = y * inverse_length;
+			p_result[2] = z * inverse_length;
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2PackOctahedral(const float* p_vectors, unsigned int p_count, short* p_result) {
+			const __m256 absolute_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+			const __m256 one = _mm256_set1_ps(1.0f), minus_one = _mm256_set1_ps(-1.0f), zero = _mm256_setzero_ps();
+			const __m256 scale = _mm256_set1_ps(K_SNORM_SCALE);
+			const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				const float* vectors = p_vectors + 3 * i;
+				__m256 x = _mm256_i32gather_ps(vectors, stride, 4);
+				__m256 y = _mm256_i32gather_ps(vectors + 1, stride, 4);
+				__m256 z = _mm256_i32gather_ps(vectors + 2, stride, 4);
+
+				__m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_and_ps(x, absolute_mask), _mm256_and_ps(y, absolute_mask)), _mm256_and_ps(z, absolute_mask));
+				__m256 inverse_sum = _mm256_div_ps(one, _mm256_max_ps(sum, _mm256_set1_ps(K_MIN_OCTAHEDRAL_SUM)));
+				x = _mm256_mul_ps(x, inverse_sum);
+				y = _mm256_mul_ps(y, inverse_sum);
+
+				__m256 lower = _mm256_cmp_ps(z, zero, _CMP_LT_OQ);
+				__m256 sign_x = _mm256_blendv_ps(minus_one, one, _mm256_cmp_ps(x, zero, _CMP_GE_OQ));
+				__m256 sign_y = _mm256_blendv_ps(minus_one, one, _mm256_cmp_ps(y, zero, _CMP_GE_OQ));
+				__m256 folded_x = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_and_ps(y, absolute_mask)), sign_x);
+				__m256 folded_y = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_and_ps(x, absolute_mask)), sign_y);
+				x = _mm256_blendv_ps(x, folded_x, lower);
+				y = _mm256_blendv_ps(y, folded_y, lower);
+
+				x = _mm256_max_ps(_mm256_min_ps(x, one), minus_one);
+				y = _mm256_max_ps(_mm256_min_ps(y, one), minus_one);
+				__m256i packed_x = _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(x, scale)), _mm256_set1_epi32(0xFFFF));
+				__m256i packed_y = _mm256_slli_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(y, scale)), 16);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(p_result + 2 * i), _mm256_or_si256(packed_x, packed_y));
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2UnpackOctahedral(const short* p_packed, unsigned int p_count, float* p_vectors) {
+			const __m256 absolute_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+			const __m256 one = _mm256_set1_ps(1.0f), minimum = _mm256_set1_ps(-1.0f), scale = _mm256_set1_ps(1.0f / K_SNORM_SCALE);
+			const __m256 zero = _mm256_setzero_ps();
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_packed + 2 * i));
+				__m256 x = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(packed, 16), 16)), scale), minimum);
+				__m256 y = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(packed, 16)), scale), minimum);
+				__m256 z = _mm256_sub_ps(_mm256_sub_ps(one, _mm256_and_ps(x, absolute_mask)), _mm256_and_ps(y, absolute_mask));
+
+				__m256 fold = _mm256_max_ps(_mm256_sub_ps(zero, z), zero);
+				x = _mm256_add_ps(x, _mm256_blendv_ps(fold, _mm256_sub_ps(zero, fold), _mm256_cmp_ps(x, zero, _CMP_GE_OQ)));
+				y = _mm256_add_ps(y, _mm256_blendv_ps(fold, _mm256_sub_ps(zero, fold), _mm256_cmp_ps(y, zero, _CMP_GE_OQ)));
+
+				__m256 inverse_length = _mm256_div_ps(one, _mm256_sqrt_ps(_mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z)))));
+				float components[3][8];
+				_mm256_storeu_ps(components[0], _mm256_mul_ps(x, inverse_length));
+				_mm256_storeu_ps(components[1], _mm256_mul_ps(y, inverse_length));
+				_mm256_storeu_ps(components[2], _mm256_mul_ps(z, inverse_length));
+
+				float* vectors = p_vectors + 3 * i;
+				for (int lane = 0; lane < 8; ++lane) {
+					vectors[3 * lane] = components[0][lane];
+					vectors[3 * lane + 1] = components[1][lane];
+					vectors[3 * lane + 2] = components[2][lane];
+				}
+			}
+
+			return i;
+		}
+#endif
+
+
+
+		void Pack(const Vector3* p_vectors, unsigned int p_count, HalfVector3* p_result) {
+			if (p_count == 0) return;
+			FloatsToHalves(p_vectors[0].m_data, 3 * p_count, p_result[0].m_data);
+		}
+
+		void Pack(const Vector4* p_vectors, unsigned int p_count, HalfVector4* p_result) {
+			if (p_count == 0) return;
+			FloatsToHalves(p_vectors[0].m_data, 4 * p_count, p_result[0].m_data);
+		}
+
+		void Pack(const Vector3* p_vectors, unsigned int p_count, SNormVector3* p_result) {
+			if (p_count == 0) return;
+			FloatsToSNorm(p_vectors[0].m_data, 3 * p_count, p_result[0].m_data);
+		}
+
+		void Pack(const Vector4* p_vectors, unsigned int p_count, UNormVector4* p_result) {
+			if (p_count == 0) return;
+			FloatsToUNorm(p_vectors[0].m_data, 4 * p_count, p_result[0].m_data);
+		}
+
+		void Pack(const Vector3* p_vectors, unsigned int p_count, OctahedralVector* p_result) {
+			if (p_count == 0) return;
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2PackOctahedral(p_vectors[0].m_data, p_count, p_result[0].m_data);
+#endif
+			for (; i < p_count; ++i) {
+				ScalarPackOctahedral(p_vectors[i].m_data, p_result[i].m_data);
+			}
+		}
+
+		void Unpack(const HalfVector3* p_vectors, unsigned int p_count, Vector3* p_result) {
+			if (p_count == 0) return;
+			HalvesToFloats(p_vectors[0].m_data, 3 * p_count, p_result[0].m_data);
+		}
+
+		void Unpack(const HalfVector4* p_vectors, unsigned int p_count, Vector4* p_result) {
+			if (p_count == 0) return;
+			HalvesToFloats(p_vectors[0].m_data, 4 * p_count, p_result[0].m_data);
+		}
+
+		void Unpack(const SNormVector3* p_vectors, unsigned int p_count, Vector3* p_result) {
+			if (p_count == 0) return;
+			SNormToFloats(p_vectors[0].m_data, 3 * p_count, p_result[0].m_data);
+		}
+
+		void Unpack(const UNormVector4* p_vectors, unsigned int p_count, Vector4* p_result) {
+			if (p_count == 0) return;
+			UNormToFloats(p_vectors[0].m_data, 4 * p_count, p_result[0].m_data);
+		}
+
+		void Unpack(const OctahedralVector* p_vectors, unsigned int p_count, Vector3* p_result) {
+			if (p_count == 0) return;
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2UnpackOctahedral(p_vectors[0].m_data, p_count, p_result[0].m_data);
+#endif
+			for (; i < p_count; ++i) {
+				ScalarUnpackOctahedral(p_vectors[i].m_data, p_result[i].m_data);
+			}
+		}
+	}
+}
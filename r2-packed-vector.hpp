@@ -0,0 +1,104 @@
+/* HEADER
+ *
+ * File: r2-packed-vector.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Comments:
+ *	Compact storage for vectors, for vertex and particle buffers where
+ *	32-bit floats cost more memory bandwidth than their precision is worth:
+ *
+ *	  HalfVector3, HalfVector4   IEEE 754 half precision (16-bit) floats
+ *	  SNormVector3               16-bit signed normalized, [-1, 1]
+ *	  UNormVector4               8-bit unsigned normalized, [0, 1]
+ *	  OctahedralVector           unit vectors in 2 x 16 bits, folded onto an
+ *	                             octahedron and unfolded onto the plane
+ *
+ *	Pack and Unpack convert arrays to and from the float vectors, using
+ *	F16C (with AVX2) for halves and SSE2/AVX2 for the rest, so data can be
+ *	kept packed in memory and expanded in batches right before use.
+ *	Normalized values are clamped to their range and rounded to nearest.
+ *	Halves round to nearest even; values beyond the half range become
+ *	infinity.
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Math::SIMD
+ *  * Vector3, Vector4
+ * Updates:
+ *
+ */
+#ifndef R2_PACKED_VECTOR_HPP
+#define R2_PACKED_VECTOR_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		struct HalfVector3 {
+			unsigned short m_data[3];
+		};
+
+		struct HalfVector4 {
+			unsigned short m_data[4];
+		};
+
+		struct SNormVector3 {
+			short m_data[3];
+		};
+
+		struct UNormVector4 {
+			unsigned char m_data[4];
+		};
+
+		struct OctahedralVector {
+			short m_data[2];
+		};
+
+		/**
+		 * Convert single values between float and half precision
+		 */
+		unsigned short FloatToHalf(float p_value);
+		float HalfToFloat(unsigned short p_value);
+
+		/**
+		 * Pack p_count vectors into p_result. Vectors packed as OctahedralVector
+		 * must be normalized.
+		 */
+		void Pack(const Vector3* p_vectors, unsigned int p_count, HalfVector3* p_result);
+		void Pack(const Vector4* p_vectors, unsigned int p_count, HalfVector4* p_result);
+		void Pack(const Vector3* p_vectors, unsigned int p_count, SNormVector3* p_result);
+		void Pack(const Vector4* p_vectors, unsigned int p_count, UNormVector4* p_result);
+		void Pack(const Vector3* p_vectors, unsigned int p_count, OctahedralVector* p_result);
+
+		/**
+		 * Unpack p_count vectors into p_result. Octahedral vectors unpack to
+		 * unit vectors.
+		 */
+		void Unpack(const HalfVector3* p_vectors, unsigned int p_count, Vector3* p_result);
+		void Unpack(const HalfVector4* p_vectors, unsigned int p_count, Vector4* p_result);
+		void Unpack(const SNormVector3* p_vectors, unsigned int p_count, Vector3* p_result);
+		void Unpack(const UNormVector4* p_vectors, unsigned int p_count, Vector4* p_result);
+		void Unpack(const OctahedralVector* p_vectors, unsigned int p_count, Vector3* p_result);
+	}
+}
+
+#endif
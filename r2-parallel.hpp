@@ -0,0 +1,128 @@
+/* HEADER
+ *
+ * File: r2-parallel.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Splitting a range of work into chunks that run on several threads. The
+ *	calling thread takes the first chunk itself. An exception thrown by any
+ *	chunk is rethrown in the calling thread once all chunks have finished.
+ *
+ *	Everywhere a thread count is taken, 0 means one thread per hardware
+ *	thread and 1 means running on the calling thread only.
+ * Depends on:
+ *	* <thread> (C++11)
+ * Updates:
+ *
+ */
+#ifndef R2_PARALLEL_HPP
+#define R2_PARALLEL_HPP
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace r2 {
+	namespace Parallel {
+		/**
+		 * Get the number of threads to use for a requested thread count, resolving 0
+		 * to the number of hardware threads.
+		 */
+		inline unsigned int GetThreadCount(unsigned int p_requested);
+
+		/**
+		 * Call p_function(begin, end) for consecutive chunks covering [0, p_count),
+		 * spread over at most p_thread_count threads. No chunk (except a final
+		 * remainder) is smaller than p_min_chunk, so small ranges stay on the
+		 * calling thread. Starting and joining a thread costs tens of
+		 * microseconds, so p_min_chunk should be enough items for a chunk to
+		 * take several times that. Callers pick it from the cost of one item.
+		 */
+		template <typename Function>
+		void For(std::size_t p_count, std::size_t p_min_chunk, unsigned int p_thread_count, Function p_function);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		inline unsigned int GetThreadCount(unsigned int p_requested) {
+			if (p_requested != 0) return p_requested;
+
+			unsigned int hardware = std::thread::hardware_concurrency();
+			return (hardware == 0) ? 1 : hardware;
+		}
+
+		template <typename Function>
+		void For(std::size_t p_count, std::size_t p_min_chunk, unsigned int p_thread_count, Function p_function) {
+			if (p_count == 0) return;
+			if (p_min_chunk == 0) p_min_chunk = 1;
+
+			std::size_t chunk_count = GetThreadCount(p_thread_count);
+			std::size_t max_chunk_count = (p_count + p_min_chunk - 1) / p_min_chunk;
+			if (chunk_count > max_chunk_count) chunk_count = max_chunk_count;
+
+			if (chunk_count <= 1) {
+				p_function(static_cast<std::size_t>(0), p_count);
+				return;
+			}
+
+			std::size_t chunk_size = (p_count + chunk_count - 1) / chunk_count;
+			std::vector<std::exception_ptr> exceptions(chunk_count);
+			std::vector<std::thread> threads;
+			threads.reserve(chunk_count - 1);
+
+			// runs one chunk, keeping its exception for the calling thread
+			auto run = [&p_function, &exceptions](std::size_t p_chunk, std::size_t p_begin, std::size_t p_end) {
+				try {
+					p_function(p_begin, p_end);
+				} catch (...) {
+					exceptions[p_chunk] = std::current_exception();
+				}
+			};
+
+			for (std::size_t chunk = 1; chunk < chunk_count; ++chunk) {
+				std::size_t begin = chunk * chunk_size;
+				std::size_t end = (begin + chunk_size < p_count) ? begin + chunk_size : p_count;
+				if (begin >= end) break;
+
+				try {
+					threads.push_back(std::thread(run, chunk, begin, end));
+				} catch (...) {
+					// out of threads, do the work here instead
+					run(chunk, begin, end);
+				}
+			}
+
+			run(0, 0, chunk_size < p_count ? chunk_size : p_count);
+
+			for (std::size_t i = 0; i < threads.size(); ++i) {
+				threads[i].join();
+			}
+
+			for (std::size_t i = 0; i < exceptions.size(); ++i) {
+				if (exceptions[i]) std::rethrow_exception(exceptions[i]);
+			}
+		}
+	}
+}
+
+#endif
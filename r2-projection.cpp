@@ -0,0 +1,130 @@
+#include "r2-projection.hpp"
+#include "r2-exception.hpp"
+#include <cmath>
+
+namespace r2 {
+	namespace Math {
+		// The cotangent of the half field of view, the y scale of the projections
+		static SCALAR GetFocalLength(SCALAR p_fov_y, SCALAR p_aspect) {
+			if (!(p_fov_y > 0.0f && p_fov_y < K_PI)) throw r2ExceptionArgumentM("The field of view must be in (0, pi)");
+			if (!(p_aspect > 0.0f)) throw r2ExceptionArgumentM("The aspect ratio must be positive");
+
+			return 1.0f / std::tan(p_fov_y * 0.5f);
+		}
+
+		// The depth rows map view z to clip z = A * z + B and clip w = -z. With
+		// rows x and y being plain scales, the inverse is
+		//
+		//   | a/f  0   0    0  |
+		//   |  0  1/f  0    0  |
+		//   |  0   0   0   -1  |
+		//   |  0   0  1/B  A/B |
+		TransformPair Perspective(SCALAR p_fov_y, SCALAR p_aspect, SCALAR p_near, SCALAR p_far, DepthRange::DepthRange p_depth_range) {
+			const SCALAR f = GetFocalLength(p_fov_y, p_aspect);
+			if (!(p_near > 0.0f && p_near < p_far)) throw r2ExceptionArgumentM("The depth range must satisfy 0 < near < far");
+
+			const SCALAR depth_inverse = 1.0f / (p_near - p_far);
+			SCALAR a, b;
+			if (p_depth_range == DepthRange::ZeroToOne) {
+				a = p_far * depth_inverse;
+				b = p_near * p_far * depth_inverse;
+			} else {
+				a = (p_far + p_near) * depth_inverse;
+				b = 2.0f * p_near * p_far * depth_inverse;
+			}
+
+			TransformPair result;
+			result.m_matrix = Matrix4(f / p_aspect, 0.0f, 0.0f, 0.0f,
+									  0.0f, f, 0.0f, 0.0f,
+									  0.0f, 0.0f, a, b,
+									  0.0f, 0.0f, -1.0f, 0.0f);
+			result.m_inverse = Matrix4(p_aspect / f, 0.0f, 0.0f, 0.0f,
+									   0.0f, 1.0f / f, 0.0f, 0.0f,
+									   0.0f, 0.0f, 0.0f, -1.0f,
+									   0.0f, 0.0f, 1.0f / b, a / b);
+			return result;
+		}
+
+		// The limit of the ZeroToOne projection with near and far swapped as far
+		// goes to infinity: A = 0 and B = near
+		TransformPair PerspectiveReverseZInfinite(SCALAR p_fov_y, SCALAR p_aspect, SCALAR p_near) {
+			const SCALAR f = GetFocalLength(p_fov_y, p_aspect);
+			if (!(p_near > 0.0f)) throw r2ExceptionArgumentM("The near plane must be in front of the camera");
+
+			TransformPair result;
+			result.m_matrix = Matrix4(f / p_aspect, 0.0f, 0.0f, 0.0f,
+									  0.0f, f, 0.0f, 0.0f,
+									  0.0f, 0.0f, 0.0f, p_near,
+									  0.0f, 0.0f, -1.0f, 0.0f);
+			result.m_inverse = Matrix4(p_aspect / f, 0.0f, 0.0f, 0.0f,
+									   0.0f, 1.0f / f, 0.0f, 0.0f,
+									   0.0f, 0.0f, 0.0f, -1.0f,
+									   0.0f, 0.0f, 1.0f / p_near, 0.0f);
+			return result;
+		}
+
+		// Every axis is mapped by x' = s * x + t, undone by x = x' / s - t / s
+		TransformPair Orthographic(SCALAR p_left, SCALAR p_right, SCALAR p_bottom, SCALAR p_top, SCALAR p_near, SCALAR p_far, DepthRange::DepthRange p_depth_range) {
+			if (p_left == p_right || p_bottom == p_top || p_near == p_far) throw r2ExceptionArgumentM("The orthographic box must not be empty");
+
+			const SCALAR width_inverse = 1.0f / (p_right - p_left);
+			const SCALAR height_inverse = 1.0f / (p_top - p_bottom);
+			const SCALAR depth_inverse = 1.0f / (p_far - p_near);
+
+			SCALAR scale[3] = { 2.0f * width_inverse, 2.0f * height_inverse, 0.0f };
+			SCALAR offset[3] = { -(p_right + p_left) * width_inverse, -(p_top + p_bottom) * height_inverse, 0.0f };
+			if (p_depth_range == DepthRange::ZeroToOne) {
+				scale[2] = -depth_inverse;
+				offset[2] = -p_near * depth_inverse;
+			} else {
+				scale[2] = -2.0f * depth_inverse;
+				offset[2] = -(p_far + p_near) * depth_inverse;
+			}
+
+			TransformPair result;
+			for (int i = 0; i < 3; ++i) {
+				result.m_matrix.m_elements[i][i] = scale[i];
+				result.m_matrix.m_elements[i][3] = offset[i];
+				result.m_inverse.m_elements[i][i] = 1.0f / scale[i];
+				result.m_inverse.m_elements[i][3] = -offset[i] / scale[i];
+			}
+			result.m_matrix.m_elements[3][3] = 1.0f;
+			result.m_inverse.m_elements[3][3] = 1.0f;
+			return result;
+		}
+
+		// The view matrix has the camera axes as rows, so the inverse is the
+		// transpose of the rotation followed by the translation to the eye
+		TransformPair LookAt(const Vector3& p_eye, const Vector3& p_target, const Vector3& p_up) {
+			Vector3 forward = p_target - p_eye;
+			const SCALAR forward_length = forward.Length();
+			if (forward_length == 0.0f) throw r2ExceptionArgumentM("The eye and the target must differ");
+			forward *= 1.0f / forward_length;
+
+			Vector3 right = Cross(forward, p_up);
+			const SCALAR right_length = right.Length();
+			if (right_length <= K_ERROR_TOLERANCE * p_up.Length()) throw r2ExceptionArgumentM("The up vector must not be parallel to the viewing direction");
+			right *= 1.0f / right_length;
+
+			const Vector3 up = Cross(right, forward);
+
+			TransformPair result;
+			result.m_matrix = Matrix4(right.x, right.y, right.z, -Dot(right, p_eye),
+									  up.x, up.y, up.z, -Dot(up, p_eye),
+									  -forward.x, -forward.y, -forward.z, Dot(forward, p_eye),
+									  0.0f, 0.0f, 0.0f, 1.0f);
+			result.m_inverse = Matrix4(right.x, up.x, -forward.x, p_eye.x,
+									   right.y, up.y, -forward.y, p_eye.y,
+									   right.z, up.z, -forward.z, p_eye.z,
+									   0.0f, 0.0f, 0.0f, 1.0f);
+			return result;
+		}
+
+		TransformPair operator*(const TransformPair& p_lhs, const TransformPair& p_rhs) {
+			TransformPair result;
+			result.m_matrix = p_lhs.m_matrix * p_rhs.m_matrix;
+			result.m_inverse = p_rhs.m_inverse * p_lhs.m_inverse;
+			return result;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+/* HEADER
+ *
+ * File: r2-projection.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Builders for camera matrices that return the matrix together with its
+ *	inverse, computed from the same parameters instead of with GetInverse.
+ *	Unprojecting picking rays, reconstructing positions from depth and
+ *	building a Frustum from the matrices then costs no 4x4 inversion.
+ *
+ *	The conventions match Frustum: column vectors (clip = M * v) and a
+ *	right-handed view space with the camera looking down -z. Projections
+ *	map z / w to the given DepthRange. The reverse-Z projection maps the
+ *	near plane to 1 and infinity to 0, which spreads the float precision
+ *	evenly over the depth; it is meant for a [0, 1] depth range with a
+ *	greater-than depth test.
+ *
+ *	Pairs compose with operator*, inverting the product as the reversed
+ *	product of the inverses, so a view-projection pair is
+ *	Perspective(...) * LookAt(...).
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Exception::Argument
+ *  * Vector3, Matrix4
+ * Updates:
+ *
+ */
+#ifndef R2_PROJECTION_HPP
+#define R2_PROJECTION_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		/**
+		 * The range of the clip space depth (z / w) inside the frustum: [-1, 1]
+		 * as in OpenGL, or [0, 1] as in Direct3D and Vulkan.
+		 */
+		namespace DepthRange {
+			enum DepthRange { MinusOneToOne, ZeroToOne };
+		}
+
+		/**
+		 * A transform and its inverse
+		 */
+		struct TransformPair {
+			Matrix4 m_matrix;
+			Matrix4 m_inverse;
+		};
+
+		/**
+		 * A perspective projection with a vertical field of view in radians, and
+		 * p_aspect as width / height. An Argument exception is raised unless
+		 * 0 < p_fov_y < pi, p_aspect > 0 and 0 < p_near < p_far.
+		 */
+		TransformPair Perspective(SCALAR p_fov_y, SCALAR p_aspect, SCALAR p_near, SCALAR p_far, DepthRange::DepthRange p_depth_range = DepthRange::MinusOneToOne);
+
+		/**
+		 * A reverse-Z perspective projection with the far plane at infinity,
+		 * mapping p_near to depth 1 and infinity to depth 0. Raises an Argument
+		 * exception unless 0 < p_fov_y < pi, p_aspect > 0 and p_near > 0.
+		 */
+		TransformPair PerspectiveReverseZInfinite(SCALAR p_fov_y, SCALAR p_aspect, SCALAR p_near);
+
+		/**
+		 * An orthographic projection of the box [p_left, p_right] x [p_bottom, p_top]
+		 * x [-p_far, -p_near] in view space. An Argument exception is raised if
+		 * the box is empty in any dimension.
+		 */
+		TransformPair Orthographic(SCALAR p_left, SCALAR p_right, SCALAR p_bottom, SCALAR p_top, SCALAR p_near, SCALAR p_far, DepthRange::DepthRange p_depth_range = DepthRange::MinusOneToOne);
+
+		/**
+		 * A view transform for a camera at p_eye looking at p_target, with p_up
+		 * giving the upwards direction. The inverse is the camera's world
+		 * transform. An Argument exception is raised if p_eye equals p_target
+		 * or p_up is parallel to the viewing direction.
+		 */
+		TransformPair LookAt(const Vector3& p_eye, const Vector3& p_target, const Vector3& p_up);
+
+		/**
+		 * Compose pairs: the matrix is p_lhs.m_matrix * p_rhs.m_matrix and the
+		 * inverse p_rhs.m_inverse * p_lhs.m_inverse.
+		 */
+		TransformPair operator*(const TransformPair& p_lhs, const TransformPair& p_rhs);
+	}
+}
+
+#endif
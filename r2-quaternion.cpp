@@ -0,0 +1,370 @@
+#include "r2-quaternion.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include <cmath>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2
+{
+	namespace Math
+	{
+		Quaternion::Quaternion(const Vector3& p_axis, SCALAR p_angle) {
+			SCALAR half_sine = std::sin(p_angle * 0.5f);
+			x = p_axis.x * half_sine;
+			y = p_axis.y * half_sine;
+			z = p_axis.z * half_sine;
+			w = std::cos(p_angle * 0.5f);
+		}
+
+		// Shepperd's method: divide by the largest of the four candidates to stay accurate
+		static void MatrixToQuaternion(SCALAR m00, SCALAR m01, SCALAR m02,
+									   SCALAR m10, SCALAR m11, SCALAR m12,
+									   SCALAR m20, SCALAR m21, SCALAR m22, Quaternion& p_result) {
+			SCALAR trace = m00 + m11 + m22;
+			if (trace > 0.0f) {
+				SCALAR s = std::sqrt(trace + 1.0f) * 2.0f;
+				p_result = Quaternion((m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, 0.25f * s);
+			} else if (m00 > m11 && m00 > m22) {
+				SCALAR s = std::sqrt(1.0f + m00 - m11 - m22) * 2.0f;
+				p_result = Quaternion(0.25f * s, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+			} else if (m11 > m22) {
+				SCALAR s = std::sqrt(1.0f + m11 - m00 - m22) * 2.0f;
+				p_result = Quaternion((m01 + m10) / s, 0.25f * s, (m12 + m21) / s, (m02 - m20) / s);
+			} else {
+				SCALAR s = std::sqrt(1.0f + m22 - m00 - m11) * 2.0f;
+				p_result = Quaternion((m02 + m20) / s, (m12 + m21) / s, 0.25f * s, (m10 - m01) / s);
+			}
+		}
+
+		Quaternion::Quaternion(const Matrix3& p_rotation) {
+			const SCALAR (*m)[Matrix3::K_DIMENSIONS] = p_rotation.m_elements;
+			MatrixToQuaternion(m[0][0], m[0][1], m[0][2],
+							   m[1][0], m[1][1], m[1][2],
+							   m[2][0], m[2][1], m[2][2], *this);
+		}
+
+		Quaternion::Quaternion(const Matrix4& p_rotation) {
+			const SCALAR (*m)[Matrix4::K_DIMENSIONS] = p_rotation.m_elements;
+			MatrixToQuaternion(m[0][0], m[0][1], m[0][2],
+							   m[1][0], m[1][1], m[1][2],
+							   m[2][0], m[2][1], m[2][2], *this);
+		}
+
+		Matrix3 Quaternion::GetMatrix3() const {
+			SCALAR xx = x * x, yy = y * y, zz = z * z;
+			SCALAR xy = x * y, xz = x * z, yz = y * z;
+			SCALAR wx = w * x, wy = w * y, wz = w * z;
+
+			return Matrix3(1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz), 2.0f * (xz + wy),
+						   2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx),
+						   2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy));
+		}
+
+		Matrix4 Quaternion::GetMatrix4() const {
+			Matrix3 rotation = GetMatrix3();
+			const SCALAR (*m)[Matrix3::K_DIMENSIONS] = rotation.m_elements;
+
+			return Matrix4(m[0][0], m[0][1], m[0][2], 0.0f,
+						   m[1][0], m[1][1], m[1][2], 0.0f,
+						   m[2][0], m[2][1], m[2][2], 0.0f,
+						   0.0f, 0.0f, 0.0f, 1.0f);
+		}
+
+		// v' = v + w * t + q x t, where t = 2 * (q x v)
+		Vector3 Quaternion::Rotate(const Vector3& p_vector) const {
+			SCALAR tx = 2.0f * (y * p_vector.z - z * p_vector.y);
+			SCALAR ty = 2.0f * (z * p_vector.x - x * p_vector.z);
+			SCALAR tz = 2.0f * (x * p_vector.y - y * p_vector.x);
+
+			return Vector3(p_vector.x + w * tx + (y * tz - z * ty),
+						   p_vector.y + w * ty + (z * tx - x * tz),
+						   p_vector.z + w * tz + (x * ty - y * tx));
+		}
+
+
+
+		Quaternion Quaternion::operator-() const {
+			return Quaternion(-x, -y, -z, -w);
+		}
+
+		Quaternion& Quaternion::operator+=(const Quaternion& p_rhs) {
+			x += p_rhs.x;
+			y += p_rhs.y;
+			z += p_rhs.z;
+			w += p_rhs.w;
+
+			return *this;
+		}
+
+		Quaternion& Quaternion::operator-=(const Quaternion& p_rhs) {
+			x -= p_rhs.x;
+			y -= p_rhs.y;
+			z -= p_rhs.z;
+			w -= p_rhs.w;
+
+			return *this;
+		}
+
+		Quaternion& Quaternion::operator*=(SCALAR p_rhs) {
+			x *= p_rhs;
+			y *= p_rhs;
+			z *= p_rhs;
+			w *= p_rhs;
+
+			return *this;
+		}
+
+		Quaternion& Quaternion::operator*=(const Quaternion& p_rhs) {
+			return *this = *this * p_rhs;
+		}
+
+		SCALAR Quaternion::Dot(const Quaternion& p_rhs) const {
+			return x * p_rhs.x + y * p_rhs.y + z * p_rhs.z + w * p_rhs.w;
+		}
+
+		SCALAR Quaternion::Length() const {
+			return std::sqrt(LengthSquared());
+		}
+
+		SCALAR Quaternion::LengthSquared() const {
+			return Dot(*this);
+		}
+
+		Quaternion& Quaternion::Normalize() {
+			return *this *= (1.0f / Length());
+		}
+
+		Quaternion& Quaternion::Conjugate() {
+			x = -x;
+			y = -y;
+			z = -z;
+
+			return *this;
+		}
+
+		Quaternion& Quaternion::Invert() {
+			SCALAR length_squared = LengthSquared();
+			if (FloatCompare(length_squared, 0.0f)) throw r2ExceptionDivisionByZeroM("Zero quaternion cannot be inverted");
+
+			return Conjugate() *= (1.0f / length_squared);
+		}
+
+
+
+		Quaternion operator+(const Quaternion& p_lhs, const Quaternion& p_rhs) {
+			return (Quaternion(p_lhs) += p_rhs);
+		}
+
+		Quaternion operator-(const Quaternion& p_lhs, const Quaternion& p_rhs) {
+			return (Quaternion(p_lhs) -= p_rhs);
+		}
+
+		Quaternion operator*(const Quaternion& p_lhs, const Quaternion& p_rhs) {
+			return Quaternion(p_lhs.w * p_rhs.x + p_lhs.x * p_rhs.w + p_lhs.y * p_rhs.z - p_lhs.z * p_rhs.y,
+							  p_lhs.w * p_rhs.y - p_lhs.x * p_rhs.z + p_lhs.y * p_rhs.w + p_lhs.z * p_rhs.x,
+							  p_lhs.w * p_rhs.z + p_lhs.x * p_rhs.y - p_lhs.y * p_rhs.x + p_lhs.z * p_rhs.w,
+							  p_lhs.w * p_rhs.w - p_lhs.x * p_rhs.x - p_lhs.y * p_rhs.y - p_lhs.z * p_rhs.z);
+		}
+
+		Quaternion operator*(const Quaternion& p_lhs, SCALAR p_rhs) {
+			return (Quaternion(p_lhs) *= p_rhs);
+		}
+
+		Quaternion operator*(SCALAR p_lhs, const Quaternion& p_rhs) {
+			return (Quaternion(p_rhs) *= p_lhs);
+		}
+
+		Vector3 operator*(const Quaternion& p_lhs, const Vector3& p_rhs) {
+			return p_lhs.Rotate(p_rhs);
+		}
+
+		bool operator==(const Quaternion& p_lhs, const Quaternion& p_rhs) {
+			return FloatCompare(p_lhs.x, p_rhs.x) && FloatCompare(p_lhs.y, p_rhs.y) && FloatCompare(p_lhs.z, p_rhs.z) && FloatCompare(p_lhs.w, p_rhs.w);
+		}
+
+		bool operator!=(const Quaternion& p_lhs, const Quaternion& p_rhs) {
+			return !(p_lhs == p_rhs);
+		}
+
+		std::ostream& operator<<(std::ostream& p_lhs, const Quaternion& p_rhs) {
+			p_lhs << "(" << p_rhs.x << ", " << p_rhs.y << ", " << p_rhs.z << ", " << p_rhs.w << ")";
+			return p_lhs;
+		}
+
+		SCALAR Dot(const Quaternion& p_lhs, const Quaternion& p_rhs) {
+			return p_lhs.Dot(p_rhs);
+		}
+
+		Quaternion GetNormalized(const Quaternion& p_quaternion) {
+			return Quaternion(p_quaternion).Normalize();
+		}
+
+		Quaternion GetConjugate(const Quaternion& p_quaternion) {
+			return Quaternion(p_quaternion).Conjugate();
+		}
+
+		Quaternion GetInverse(const Quaternion& p_quaternion) {
+			return Quaternion(p_quaternion).Invert();
+		}
+
+		// Above this cosine the arc is too short for sin() to be accurate, so slerp falls back to nlerp
+		static const SCALAR K_SLERP_LINEAR_THRESHOLD = 0.9995f;
+
+		Quaternion Slerp(const Quaternion& p_from, const Quaternion& p_to, SCALAR p_t) {
+			SCALAR cosine = Dot(p_from, p_to);
+			Quaternion to = (cosine < 0.0f) ? -p_to : p_to;
+			if (cosine < 0.0f) cosine = -cosine;
+
+			if (cosine > K_SLERP_LINEAR_THRESHOLD) return Nlerp(p_from, to, p_t);
+
+			SCALAR angle = std::acos(cosine);
+			SCALAR inverse_sine = 1.0f / std::sin(angle);
+			return p_from * (std::sin((1.0f - p_t) * angle) * inverse_sine) + to * (std::sin(p_t * angle) * inverse_sine);
+		}
+
+		Quaternion Nlerp(const Quaternion& p_from, const Quaternion& p_to, SCALAR p_t) {
+			SCALAR t = (Dot(p_from, p_to) < 0.0f) ? -p_t : p_t;
+			return GetNormalized(p_from * (1.0f - p_t) + p_to * t);
+		}
+
+
+
+		static void ScalarRotate(const Quaternion* p_rotations, Vector3* p_vectors, std::size_t p_count) {
+			for (std::size_t i = 0; i < p_count; ++i) {
+				p_vectors[i] = p_rotations[i].Rotate(p_vectors[i]);
+			}
+		}
+
+#if defined(R2_ARCH_X86)
+		// Four Vector3s are 12 floats; they are transposed into x, y and z registers and back.
+		// The stores overlap forwards so the last one is the only partial store, and nothing
+		// past the fourth vector is touched.
+		r2SIMDTargetM("sse2")
+		static inline void SSE2LoadVectors(const Vector3* p_vectors, __m128& p_x, __m128& p_y, __m128& p_z) {
+			const SCALAR* data = p_vectors[0].m_data;
+			__m128 row_0 = _mm_loadu_ps(data);
+			__m128 row_1 = _mm_loadu_ps(data + 3);
+			__m128 row_2 = _mm_loadu_ps(data + 6);
+			__m128 row_3 = _mm_loadu_ps(data + 8);
+			row_3 = _mm_shuffle_ps(row_3, row_3, _MM_SHUFFLE(3, 3, 2, 1));
+			_MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+			p_x = row_0;
+			p_y = row_1;
+			p_z = row_2;
+		}
+
+		r2SIMDTargetM("sse2")
+		static inline void SSE2StoreVectors(Vector3* p_vectors, __m128 p_x, __m128 p_y, __m128 p_z) {
+			SCALAR* data = p_vectors[0].m_data;
+			__m128 row_3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(p_x, p_y, p_z, row_3);
+			_mm_storeu_ps(data, p_x);
+			_mm_storeu_ps(data + 3, p_y);
+			_mm_storeu_ps(data + 6, p_z);
+			_mm_storel_pi(reinterpret_cast<__m64*>(data + 9), row_3);
+			_mm_store_ss(data + 11, _mm_movehl_ps(row_3, row_3));
+		}
+
+		r2SIMDTargetM("sse2")
+		static inline void SSE2LoadQuaternions(const Quaternion* p_rotations, __m128& p_x, __m128& p_y, __m128& p_z, __m128& p_w) {
+			p_x = _mm_loadu_ps(p_rotations[0].m_data);
+			p_y = _mm_loadu_ps(p_rotations[1].m_data);
+			p_z = _mm_loadu_ps(p_rotations[2].m_data);
+			p_w = _mm_loadu_ps(p_rotations[3].m_data);
+			_MM_TRANSPOSE4_PS(p_x, p_y, p_z, p_w);
+		}
+
+		r2SIMDTargetM("sse2")
+		static void SSE2Rotate(const Quaternion* p_rotations, Vector3* p_vectors, std::size_t p_count) {
+			__m128 two = _mm_set1_ps(2.0f);
+			std::size_t i = 0;
+			for (; i + 4 <= p_count; i += 4) {
+				__m128 qx, qy, qz, qw, vx, vy, vz;
+				SSE2LoadQuaternions(p_rotations + i, qx, qy, qz, qw);
+				SSE2LoadVectors(p_vectors + i, vx, vy, vz);
+
+				__m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qy, vz), _mm_mul_ps(qz, vy)));
+				__m128 ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qz, vx), _mm_mul_ps(qx, vz)));
+				__m128 tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qx, vy), _mm_mul_ps(qy, vx)));
+
+				vx = _mm_add_ps(_mm_add_ps(vx, _mm_mul_ps(qw, tx)), _mm_sub_ps(_mm_mul_ps(qy, tz), _mm_mul_ps(qz, ty)));
+				vy = _mm_add_ps(_mm_add_ps(vy, _mm_mul_ps(qw, ty)), _mm_sub_ps(_mm_mul_ps(qz, tx), _mm_mul_ps(qx, tz)));
+				vz = _mm_add_ps(_mm_add_ps(vz, _mm_mul_ps(qw, tz)), _mm_sub_ps(_mm_mul_ps(qx, ty), _mm_mul_ps(qy, tx)));
+
+				SSE2StoreVectors(p_vectors + i, vx, vy, vz);
+			}
+
+			ScalarRotate(p_rotations + i, p_vectors + i, p_count - i);
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static inline __m256 Combine(__m128 p_low, __m128 p_high) {
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(p_low), p_high, 1);
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static void FMARotate(const Quaternion* p_rotations, Vector3* p_vectors, std::size_t p_count) {
+			__m256 two = _mm256_set1_ps(2.0f);
+			std::size_t i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m128 qx_0, qy_0, qz_0, qw_0, vx_0, vy_0, vz_0;
+				__m128 qx_1, qy_1, qz_1, qw_1, vx_1, vy_1, vz_1;
+				SSE2LoadQuaternions(p_rotations + i, qx_0, qy_0, qz_0, qw_0);
+				SSE2LoadQuaternions(p_rotations + i + 4, qx_1, qy_1, qz_1, qw_1);
+				SSE2LoadVectors(p_vectors + i, vx_0, vy_0, vz_0);
+				SSE2LoadVectors(p_vectors + i + 4, vx_1, vy_1, vz_1);
+
+				__m256 qx = Combine(qx_0, qx_1), qy = Combine(qy_0, qy_1), qz = Combine(qz_0, qz_1), qw = Combine(qw_0, qw_1);
+				__m256 vx = Combine(vx_0, vx_1), vy = Combine(vy_0, vy_1), vz = Combine(vz_0, vz_1);
+
+				__m256 tx = _mm256_mul_ps(two, _mm256_fmsub_ps(qy, vz, _mm256_mul_ps(qz, vy)));
+				__m256 ty = _mm256_mul_ps(two, _mm256_fmsub_ps(qz, vx, _mm256_mul_ps(qx, vz)));
+				__m256 tz = _mm256_mul_ps(two, _mm256_fmsub_ps(qx, vy, _mm256_mul_ps(qy, vx)));
+
+				vx = _mm256_add_ps(_mm256_fmadd_ps(qw, tx, vx), _mm256_fmsub_ps(qy, tz, _mm256_mul_ps(qz, ty)));
+				vy = _mm256_add_ps(_mm256_fmadd_ps(qw, ty, vy), _mm256_fmsub_ps(qz, tx, _mm256_mul_ps(qx, tz)));
+				vz = _mm256_add_ps(_mm256_fmadd_ps(qw, tz, vz), _mm256_fmsub_ps(qx, ty, _mm256_mul_ps(qy, tx)));
+
+				SSE2StoreVectors(p_vectors + i, _mm256_castps256_ps128(vx), _mm256_castps256_ps128(vy), _mm256_castps256_ps128(vz));
+				SSE2StoreVectors(p_vectors + i + 4, _mm256_extractf128_ps(vx, 1), _mm256_extractf128_ps(vy, 1), _mm256_extractf128_ps(vz, 1));
+			}
+
+			ScalarRotate(p_rotations + i, p_vectors + i, p_count - i);
+		}
+#endif
+
+		void Rotate(const Quaternion* p_rotations, Vector3* p_vectors, std::size_t p_count) {
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) return FMARotate(p_rotations, p_vectors, p_count);
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) return SSE2Rotate(p_rotations, p_vectors, p_count);
+#endif
+			ScalarRotate(p_rotations, p_vectors, p_count);
+		}
+
+		// With a single rotation a 3x3 matrix is cheaper per vector than the quaternion
+		void Rotate(const Quaternion& p_rotation, const Vector3* p_in, Vector3* p_out, std::size_t p_count) {
+			TransformVectors(p_rotation.GetMatrix4(), p_in, p_out, p_count);
+		}
+
+		void MultiplyArray(const Quaternion* p_lhs, const Quaternion* p_rhs, Quaternion* p_result, std::size_t p_count) {
+			for (std::size_t i = 0; i < p_count; ++i) {
+				p_result[i] = p_lhs[i] * p_rhs[i];
+			}
+		}
+
+		void Slerp(const Quaternion* p_from, const Quaternion* p_to, SCALAR p_t, Quaternion* p_result, std::size_t p_count) {
+			for (std::size_t i = 0; i < p_count; ++i) {
+				p_result[i] = Slerp(p_from[i], p_to[i], p_t);
+			}
+		}
+
+		void Nlerp(const Quaternion* p_from, const Quaternion* p_to, SCALAR p_t, Quaternion* p_result, std::size_t p_count) {
+			for (std::size_t i = 0; i < p_count; ++i) {
+				p_result[i] = Nlerp(p_from[i], p_to[i], p_t);
+			}
+		}
+	}
+}
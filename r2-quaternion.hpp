@@ -0,0 +1,231 @@
+/* HEADER
+ *
+ * File: r2-quaternion.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A quaternion x*i + y*j + z*k + w, used to represent rotations. Unit
+ *	quaternions are assumed wherever a rotation is expected; keep them
+ *	normalized, it is far cheaper than reorthogonalizing a matrix.
+ *
+ *	Composition follows the matrix convention: (p * q) rotates by q first,
+ *	then by p.
+ * Depends on:
+ *  * SCALAR
+ *  * FloatCompare
+ *  * r2::Exception::DivisionByZero
+ *  * Vector3, Matrix3, Matrix4
+ * Updates:
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
+ */
+#ifndef R2_QUATERNION_HPP
+#define R2_QUATERNION_HPP
+
+#include <cstddef>
+#include <ostream>
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-matrix-3.hpp"
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		class Quaternion {
+		public:
+			/**
+			 * Initialize the identity rotation (0, 0, 0, 1)
+			 */
+			constexpr Quaternion();
+
+			/**
+			 * Initialize the quaternion p_x*i + p_y*j + p_z*k + p_w
+			 */
+			constexpr Quaternion(SCALAR p_x, SCALAR p_y, SCALAR p_z, SCALAR p_w);
+
+			/**
+			 * Initialize a rotation of p_angle radians around p_axis. The axis
+			 * must be normalized.
+			 */
+			Quaternion(const Vector3& p_axis, SCALAR p_angle);
+
+			/**
+			 * Initialize a rotation from a rotation matrix (or the upper left 3x3
+			 * part of one). The matrix must be orthonormal.
+			 */
+			explicit Quaternion(const Matrix3& p_rotation);
+			explicit Quaternion(const Matrix4& p_rotation);
+
+
+			/**
+			 * Get the rotation as a matrix. GetMatrix4 has no translation.
+			 */
+			Matrix3 GetMatrix3() const;
+			Matrix4 GetMatrix4() const;
+
+			/**
+			 * Rotate a vector by this quaternion
+			 */
+			Vector3 Rotate(const Vector3& p_vector) const;
+
+
+			/**
+			 * Operators
+			 */
+			Quaternion operator-() const;
+			Quaternion& operator+=(const Quaternion& p_rhs);
+			Quaternion& operator-=(const Quaternion& p_rhs);
+			Quaternion& operator*=(SCALAR p_rhs);
+			Quaternion& operator*=(const Quaternion& p_rhs);
+
+			/**
+			 * Calculate the dot product
+			 */
+			SCALAR Dot(const Quaternion& p_rhs) const;
+
+			/**
+			 * Calculate the length (norm) of the quaternion
+			 */
+			SCALAR Length() const;
+
+			/**
+			 * Calculate the square of the length (norm) of the quaternion
+			 */
+			SCALAR LengthSquared() const;
+
+			/**
+			 * Normalize the quaternion and return this
+			 */
+			Quaternion& Normalize();
+
+			/**
+			 * Conjugate the quaternion, (-x, -y, -z, w). For a unit quaternion
+			 * this is the inverse rotation.
+			 */
+			Quaternion& Conjugate();
+
+			/**
+			 * Invert this quaternion, if possible. If the quaternion is zero, a
+			 * DivisionByZero exception is raised.
+			 */
+			Quaternion& Invert();
+
+
+			/**
+			 * The components of the quaternion
+			 */
+			union {
+				struct {
+					SCALAR x;
+					SCALAR y;
+					SCALAR z;
+					SCALAR w;
+				};
+
+				SCALAR m_data[4];
+			};
+
+			static const Quaternion K_IDENTITY;
+		};
+
+		/**
+		 * Operators
+		 */
+		Quaternion operator+(const Quaternion& p_lhs, const Quaternion& p_rhs);
+		Quaternion operator-(const Quaternion& p_lhs, const Quaternion& p_rhs);
+		Quaternion operator*(const Quaternion& p_lhs, const Quaternion& p_rhs);
+		Quaternion operator*(const Quaternion& p_lhs, SCALAR p_rhs);
+		Quaternion operator*(SCALAR p_lhs, const Quaternion& p_rhs);
+		Vector3 operator*(const Quaternion& p_lhs, const Vector3& p_rhs);
+		bool operator==(const Quaternion& p_lhs, const Quaternion& p_rhs);
+		bool operator!=(const Quaternion& p_lhs, const Quaternion& p_rhs);
+		std::ostream& operator<<(std::ostream& p_lhs, const Quaternion& p_rhs);
+
+		/**
+		 * Calculate the dot product
+		 */
+		SCALAR Dot(const Quaternion& p_lhs, const Quaternion& p_rhs);
+
+		/**
+		 * Get a normalized version of the quaternion
+		 */
+		Quaternion GetNormalized(const Quaternion& p_quaternion);
+
+		/**
+		 * Get the conjugate of the quaternion
+		 */
+		Quaternion GetConjugate(const Quaternion& p_quaternion);
+
+		/**
+		 * Get the inverse of the quaternion, if possible. If the quaternion is
+		 * zero, a DivisionByZero exception is raised.
+		 */
+		Quaternion GetInverse(const Quaternion& p_quaternion);
+
+		/**
+		 * Interpolate between two unit quaternions along the shortest arc. Slerp
+		 * moves at constant angular speed; Nlerp is cheaper, normalizing a linear
+		 * blend, and is usually close enough for animation blending.
+		 */
+		Quaternion Slerp(const Quaternion& p_from, const Quaternion& p_to, SCALAR p_t);
+		Quaternion Nlerp(const Quaternion& p_from, const Quaternion& p_to, SCALAR p_t);
+
+		/**
+		 * Batched operations on arrays of p_count elements. Output arrays may be
+		 * the same as input arrays, but must not otherwise overlap.
+		 */
+
+		/**
+		 * Rotate every vector by its own rotation, p_vectors[i] = p_rotations[i] * p_vectors[i].
+		 */
+		void Rotate(const Quaternion* p_rotations, Vector3* p_vectors, std::size_t p_count);
+
+		/**
+		 * Rotate every vector by the same rotation, p_out[i] = p_rotation * p_in[i].
+		 */
+		void Rotate(const Quaternion& p_rotation, const Vector3* p_in, Vector3* p_out, std::size_t p_count);
+
+		/**
+		 * Compose rotations, p_result[i] = p_lhs[i] * p_rhs[i].
+		 */
+		void MultiplyArray(const Quaternion* p_lhs, const Quaternion* p_rhs, Quaternion* p_result, std::size_t p_count);
+
+		/**
+		 * Interpolate arrays of rotations with the same blend factor,
+		 * p_result[i] = Slerp(p_from[i], p_to[i], p_t) and likewise for Nlerp.
+		 */
+		void Slerp(const Quaternion* p_from, const Quaternion* p_to, SCALAR p_t, Quaternion* p_result, std::size_t p_count);
+		void Nlerp(const Quaternion* p_from, const Quaternion* p_to, SCALAR p_t, Quaternion* p_result, std::size_t p_count);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Quaternion::Quaternion()
+			: x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+
+		constexpr Quaternion::Quaternion(SCALAR p_x, SCALAR p_y, SCALAR p_z, SCALAR p_w)
+			: x(p_x), y(p_y), z(p_z), w(p_w) {}
+
+		inline constexpr Quaternion Quaternion::K_IDENTITY;
+	}
+}
+
+#endif
@@ -0,0 +1,463 @@
+#include "r2-random.hpp"
+#include "r2-fast-math.hpp"
+#include "r2-simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		const unsigned int Random::K_LANE_COUNT;
+
+		// the samples transformed at a time, in buffers on the stack
+		static const unsigned int K_CHUNK_SIZE = 256;
+
+		// 2^-24, from the upper 24 bits of a 32-bit value to [0, 1)
+		static const float K_FLOAT_SCALE = 1.0f / 16777216.0f;
+
+		// the samplers whose end points are harmless do not clamp
+		static const float K_NO_LIMIT = std::numeric_limits<float>::infinity();
+
+		// the jump polynomials of xoshiro128, for 2^64 and 2^96 steps
+		static const unsigned int K_JUMP[4] = { 0x8764000Bu, 0xF542D2D3u, 0x6FA035C3u, 0x77F2DB5Bu };
+		static const unsigned int K_LONG_JUMP[4] = { 0xB523952Eu, 0x0B6F099Fu, 0xCCF5A0EFu, 0x1C580662u };
+
+		static inline unsigned int RotateLeft(unsigned int p_value, unsigned int p_bits) {
+			return (p_value << p_bits) | (p_value >> (32 - p_bits));
+		}
+
+		// xoshiro128+ on one stream, returning the output before the step
+		static inline unsigned int Step(unsigned int& p_s0, unsigned int& p_s1, unsigned int& p_s2, unsigned int& p_s3) {
+			unsigned int result = p_s0 + p_s3;
+			unsigned int t = p_s1 << 9;
+			p_s2 ^= p_s0;
+			p_s3 ^= p_s1;
+			p_s1 ^= p_s2;
+			p_s0 ^= p_s3;
+			p_s2 ^= t;
+			p_s3 = RotateLeft(p_s3, 11);
+			return result;
+		}
+
+		// moves one stream ahead by the number of steps the polynomial stands for
+		static void JumpLane(unsigned int (*p_state)[Random::K_LANE_COUNT], unsigned int p_lane, const unsigned int* p_polynomial) {
+			unsigned int& s0 = p_state[0][p_lane];
+			unsigned int& s1 = p_state[1][p_lane];
+			unsigned int& s2 = p_state[2][p_lane];
+			unsigned int& s3 = p_state[3][p_lane];
+
+			unsigned int j0 = 0, j1 = 0, j2 = 0, j3 = 0;
+			for (unsigned int i = 0; i < 4; ++i) {
+				for (unsigned int b = 0; b < 32; ++b) {
+					if (p_polynomial[i] & (1u << b)) {
+						j0 ^= s0;
+						j1 ^= s1;
+						j2 ^= s2;
+						j3 ^= s3;
+					}
+					Step(s0, s1, s2, s3);
+				}
+			}
+
+			s0 = j0;
+			s1 = j1;
+			s2 = j2;
+			s3 = j3;
+		}
+
+		// SplitMix64, which spreads the bits of consecutive seeds over the whole state
+		static unsigned long long SplitMix(unsigned long long& p_state) {
+			unsigned long long z = (p_state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		/**
+		 * Generating p_blocks steps of all streams into p_result, with value l of
+		 * every block from stream l, as p_offset + (upper 24 bits) * p_scale, and
+		 * at most p_limit. The SIMD kernels do the same operations in the same
+		 * order, without FMA.
+		 */
+		static void ScalarGenerate(unsigned int (*p_state)[Random::K_LANE_COUNT], float* p_result, unsigned int p_blocks, float p_offset, float p_scale, float p_limit) {
+			for (unsigned int l = 0; l < Random::K_LANE_COUNT; ++l) {
+				unsigned int s0 = p_state[0][l], s1 = p_state[1][l], s2 = p_state[2][l], s3 = p_state[3][l];
+				for (unsigned int b = 0; b < p_blocks; ++b) {
+					unsigned int value = Step(s0, s1, s2, s3);
+					p_result[b * Random::K_LANE_COUNT + l] = std::min(p_offset + static_cast<float>(static_cast<int>(value >> 8)) * p_scale, p_limit);
+				}
+
+				p_state[0][l] = s0;
+				p_state[1][l] = s1;
+				p_state[2][l] = s2;
+				p_state[3][l] = s3;
+			}
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static void SSE2Generate(unsigned int (*p_state)[Random::K_LANE_COUNT], float* p_result, unsigned int p_blocks, float p_offset, float p_scale, float p_limit) {
+			__m128i s[4][2];
+			for (unsigned int w = 0; w < 4; ++w) {
+				s[w][0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_state[w]));
+				s[w][1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_state[w] + 4));
+			}
+
+			const __m128 offset = _mm_set1_ps(p_offset);
+			const __m128 scale = _mm_set1_ps(p_scale);
+			const __m128 limit = _mm_set1_ps(p_limit);
+			for (unsigned int b = 0; b < p_blocks; ++b) {
+				for (unsigned int h = 0; h < 2; ++h) {
+					__m128i value = _mm_add_epi32(s[0][h], s[3][h]);
+					__m128i t = _mm_slli_epi32(s[1][h], 9);
+					s[2][h] = _mm_xor_si128(s[2][h], s[0][h]);
+					s[3][h] = _mm_xor_si128(s[3][h], s[1][h]);
+					s[1][h] = _mm_xor_si128(s[1][h], s[2][h]);
+					s[0][h] = _mm_xor_si128(s[0][h], s[3][h]);
+					s[2][h] = _mm_xor_si128(s[2][h], t);
+					s[3][h] = _mm_or_si128(_mm_slli_epi32(s[3][h], 11), _mm_srli_epi32(s[3][h], 21));
+
+					__m128 sample = _mm_cvtepi32_ps(_mm_srli_epi32(value, 8));
+					_mm_storeu_ps(p_result + b * Random::K_LANE_COUNT + 4 * h, _mm_min_ps(_mm_add_ps(offset, _mm_mul_ps(sample, scale)), limit));
+				}
+			}
+
+			for (unsigned int w = 0; w < 4; ++w) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p_state[w]), s[w][0]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p_state[w] + 4), s[w][1]);
+			}
+		}
+
+		r2SIMDTargetM("avx2")
+		static void AVX2Generate(unsigned int (*p_state)[Random::K_LANE_COUNT], float* p_result, unsigned int p_blocks, float p_offset, float p_scale, float p_limit) {
+			__m256i s[4];
+			for (unsigned int w = 0; w < 4; ++w) {
+				s[w] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_state[w]));
+			}
+
+			const __m256 offset = _mm256_set1_ps(p_offset);
+			const __m256 scale = _mm256_set1_ps(p_scale);
+			const __m256 limit = _mm256_set1_ps(p_limit);
+			for (unsigned int b = 0; b < p_blocks; ++b) {
+				__m256i value = _mm256_add_epi32(s[0], s[3]);
+				__m256i t = _mm256_slli_epi32(s[1], 9);
+				s[2] = _mm256_xor_si256(s[2], s[0]);
+				s[3] = _mm256_xor_si256(s[3], s[1]);
+				s[1] = _mm256_xor_si256(s[1], s[2]);
+				s[0] = _mm256_xor_si256(s[0], s[3]);
+				s[2] = _mm256_xor_si256(s[2], t);
+				s[3] = _mm256_or_si256(_mm256_slli_epi32(s[3], 11), _mm256_srli_epi32(s[3], 21));
+
+				__m256 sample = _mm256_cvtepi32_ps(_mm256_srli_epi32(value, 8));
+				_mm256_storeu_ps(p_result + b * Random::K_LANE_COUNT, _mm256_min_ps(_mm256_add_ps(offset, _mm256_mul_ps(sample, scale)), limit));
+			}
+
+			for (unsigned int w = 0; w < 4; ++w) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(p_state[w]), s[w]);
+			}
+		}
+#endif
+
+		static void GenerateBlocks(unsigned int (*p_state)[Random::K_LANE_COUNT], float* p_result, unsigned int p_blocks, float p_offset, float p_scale, float p_limit) {
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+				AVX2Generate(p_state, p_result, p_blocks, p_offset, p_scale, p_limit);
+				return;
+			} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+				SSE2Generate(p_state, p_result, p_blocks, p_offset, p_scale, p_limit);
+				return;
+			}
+#endif
+			ScalarGenerate(p_state, p_result, p_blocks, p_offset, p_scale, p_limit);
+		}
+
+		/**
+		 * Natural logarithm of p_count values in (0, 1], for the radii of the
+		 * normal and sphere samples. The polynomial is the one of Cephes logf:
+		 * the mantissa m is brought to [sqrt(0.5), sqrt(2)) and log(1 + x) for
+		 * x = m - 1 approximated, with relative error around 1e-7.
+		 */
+		static const float K_SQRT_HALF = 0.707106781186547524f;
+		static const float K_LOG_POLYNOMIAL[9] = {
+			7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f,
+			-1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f
+		};
+		static const float K_LOG_2_HIGH = 0.693359375f;
+		static const float K_LOG_2_LOW = -2.12194440e-4f;
+
+		static inline float ScalarLog(float p_value) {
+			int exponent;
+			float m = std::frexp(p_value, &exponent);
+			if (m < K_SQRT_HALF) {
+				exponent -= 1;
+				m = m + m - 1.0f;
+			} else {
+				m = m - 1.0f;
+			}
+
+			float z = m * m;
+			float y = K_LOG_POLYNOMIAL[0];
+			for (unsigned int k = 1; k < 9; ++k) {
+				y = y * m + K_LOG_POLYNOMIAL[k];
+			}
+			y = y * m * z;
+
+			float e = static_cast<float>(exponent);
+			y += K_LOG_2_LOW * e;
+			y -= 0.5f * z;
+			return (m + y) + K_LOG_2_HIGH * e;
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2Log(const float* p_in, float* p_out, unsigned int p_count) {
+			const __m128i exponent_mask = _mm_set1_epi32(0x7F800000);
+			const __m128 half_bits = _mm_castsi128_ps(_mm_set1_epi32(0x3F000000));
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 sqrt_half = _mm_set1_ps(K_SQRT_HALF);
+
+			unsigned int i = 0;
+			for (; i + 4 <= p_count; i += 4) {
+				__m128 x = _mm_loadu_ps(p_in + i);
+
+				// x = m * 2^e with m in [0.5, 1), as frexp
+				__m128i bits = _mm_castps_si128(x);
+				__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_and_si128(bits, exponent_mask), 23), _mm_set1_epi32(126)));
+				__m128 m = _mm_or_ps(_mm_andnot_ps(_mm_castsi128_ps(exponent_mask), x), half_bits);
+
+				__m128 small = _mm_cmplt_ps(m, sqrt_half);
+				e = _mm_sub_ps(e, _mm_and_ps(small, one));
+				m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), one);
+
+				__m128 z = _mm_mul_ps(m, m);
+				__m128 y = _mm_set1_ps(K_LOG_POLYNOMIAL[0]);
+				for (unsigned int k = 1; k < 9; ++k) {
+					y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(K_LOG_POLYNOMIAL[k]));
+				}
+				y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+				y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(K_LOG_2_LOW)));
+				y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+				_mm_storeu_ps(p_out + i, _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(K_LOG_2_HIGH))));
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2Log(const float* p_in, float* p_out, unsigned int p_count) {
+			const __m256i exponent_mask = _mm256_set1_epi32(0x7F800000);
+			const __m256 half_bits = _mm256_castsi256_ps(_mm256_set1_epi32(0x3F000000));
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 sqrt_half = _mm256_set1_ps(K_SQRT_HALF);
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m256 x = _mm256_loadu_ps(p_in + i);
+
+				__m256i bits = _mm256_castps_si256(x);
+				__m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_and_si256(bits, exponent_mask), 23), _mm256_set1_epi32(126)));
+				__m256 m = _mm256_or_ps(_mm256_andnot_ps(_mm256_castsi256_ps(exponent_mask), x), half_bits);
+
+				__m256 small = _mm256_cmp_ps(m, sqrt_half, _CMP_LT_OQ);
+				e = _mm256_sub_ps(e, _mm256_and_ps(small, one));
+				m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(small, m)), one);
+
+				__m256 z = _mm256_mul_ps(m, m);
+				__m256 y = _mm256_set1_ps(K_LOG_POLYNOMIAL[0]);
+				for (unsigned int k = 1; k < 9; ++k) {
+					y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(K_LOG_POLYNOMIAL[k]));
+				}
+				y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+				y = _mm256_fmadd_ps(e, _mm256_set1_ps(K_LOG_2_LOW), y);
+				y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+				_mm256_storeu_ps(p_out + i, _mm256_fmadd_ps(e, _mm256_set1_ps(K_LOG_2_HIGH), _mm256_add_ps(m, y)));
+			}
+
+			return i;
+		}
+#endif
+
+		static void Log(const float* p_in, float* p_out, unsigned int p_count) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+				i = AVX2Log(p_in, p_out, p_count);
+			} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+				i = SSE2Log(p_in, p_out, p_count);
+			}
+#endif
+			for (; i < p_count; ++i) {
+				p_out[i] = ScalarLog(p_in[i]);
+			}
+		}
+
+
+
+		Random::Random(unsigned long long p_seed) {
+			Seed(p_seed);
+		}
+
+		void Random::Seed(unsigned long long p_seed) {
+			unsigned long long seed = p_seed;
+			unsigned long long low = SplitMix(seed);
+			unsigned long long high = SplitMix(seed);
+			m_state[0][0] = static_cast<unsigned int>(low);
+			m_state[1][0] = static_cast<unsigned int>(low >> 32);
+			m_state[2][0] = static_cast<unsigned int>(high);
+			m_state[3][0] = static_cast<unsigned int>(high >> 32);
+
+			// the one state xoshiro can not leave
+			if ((low | high) == 0) m_state[0][0] = 1;
+
+			for (unsigned int l = 1; l < K_LANE_COUNT; ++l) {
+				for (unsigned int w = 0; w < 4; ++w) {
+					m_state[w][l] = m_state[w][l - 1];
+				}
+				JumpLane(m_state, l, K_JUMP);
+			}
+		}
+
+		void Random::Jump() {
+			for (unsigned int l = 0; l < K_LANE_COUNT; ++l) {
+				JumpLane(m_state, l, K_LONG_JUMP);
+			}
+		}
+
+		unsigned int Random::NextUInt() {
+			return Step(m_state[0][0], m_state[1][0], m_state[2][0], m_state[3][0]);
+		}
+
+		SCALAR Random::NextFloat() {
+			return static_cast<float>(static_cast<int>(NextUInt() >> 8)) * K_FLOAT_SCALE;
+		}
+
+		void Random::Uniform(SCALAR* p_result, unsigned int p_count, SCALAR p_min, SCALAR p_max) {
+			// p_min + k * scale can round up to p_max, which is outside the range
+			SCALAR limit = (p_max > p_min) ? std::nextafter(p_max, p_min) : K_NO_LIMIT;
+			Generate(p_result, p_count, p_min, (p_max - p_min) * K_FLOAT_SCALE, limit);
+		}
+
+		// Box-Muller: a radius sqrt(-2 log u) and an angle give two samples, the
+		// cosine ones in the first half of a chunk and the sine ones in the second
+		void Random::Normal(SCALAR* p_result, unsigned int p_count, SCALAR p_mean, SCALAR p_deviation) {
+			float radius[K_CHUNK_SIZE / 2], angle[K_CHUNK_SIZE / 2], sine[K_CHUNK_SIZE / 2];
+
+			for (unsigned int begin = 0; begin < p_count; begin += K_CHUNK_SIZE) {
+				unsigned int count = std::min(p_count - begin, K_CHUNK_SIZE);
+				unsigned int half = (count + 1) / 2;
+
+				// u in (0, 1], so the logarithm is finite
+				Generate(radius, half, K_FLOAT_SCALE, K_FLOAT_SCALE, K_NO_LIMIT);
+				Generate(angle, half, 0.0f, 2.0f * K_PI * K_FLOAT_SCALE, K_NO_LIMIT);
+
+				Log(radius, radius, half);
+				for (unsigned int i = 0; i < half; ++i) {
+					radius[i] = -2.0f * radius[i];
+				}
+				Fast::Sqrt(radius, radius, half);
+				Fast::Sin(angle, sine, count - half);
+				Fast::Cos(angle, angle, half);
+
+				float* result = p_result + begin;
+				for (unsigned int i = 0; i < half; ++i) {
+					result[i] = p_mean + p_deviation * radius[i] * angle[i];
+				}
+				for (unsigned int i = half; i < count; ++i) {
+					result[i] = p_mean + p_deviation * radius[i - half] * sine[i - half];
+				}
+			}
+		}
+
+		void Random::UnitVectors(SCALAR* p_x, SCALAR* p_y, unsigned int p_count) {
+			Generate(p_x, p_count, 0.0f, 2.0f * K_PI * K_FLOAT_SCALE, K_NO_LIMIT);
+			Fast::Sin(p_x, p_y, p_count);
+			Fast::Cos(p_x, p_x, p_count);
+		}
+
+		// the radius of a uniform point in the disk is the square root of a uniform value
+		void Random::PointsInDisk(SCALAR* p_x, SCALAR* p_y, unsigned int p_count) {
+			float radius[K_CHUNK_SIZE];
+
+			UnitVectors(p_x, p_y, p_count);
+			for (unsigned int begin = 0; begin < p_count; begin += K_CHUNK_SIZE) {
+				unsigned int count = std::min(p_count - begin, K_CHUNK_SIZE);
+				Generate(radius, count, 0.0f, K_FLOAT_SCALE, K_NO_LIMIT);
+				Fast::Sqrt(radius, radius, count);
+
+				for (unsigned int i = 0; i < count; ++i) {
+					p_x[begin + i] *= radius[i];
+					p_y[begin + i] *= radius[i];
+				}
+			}
+		}
+
+		// z uniform in [-1, 1] and an angle around it (Archimedes' hat-box theorem)
+		void Random::UnitVectors(Vector3Stream& p_result) {
+			unsigned int size = p_result.Size();
+			SCALAR* x = p_result.GetX();
+			SCALAR* y = p_result.GetY();
+			SCALAR* z = p_result.GetZ();
+			float ring[K_CHUNK_SIZE];
+
+			Generate(z, size, -1.0f, 2.0f * K_FLOAT_SCALE, K_NO_LIMIT);
+			UnitVectors(x, y, size);
+			for (unsigned int begin = 0; begin < size; begin += K_CHUNK_SIZE) {
+				unsigned int count = std::min(size - begin, K_CHUNK_SIZE);
+				for (unsigned int i = 0; i < count; ++i) {
+					ring[i] = std::max(1.0f - z[begin + i] * z[begin + i], 0.0f);
+				}
+				Fast::Sqrt(ring, ring, count);
+
+				for (unsigned int i = 0; i < count; ++i) {
+					x[begin + i] *= ring[i];
+					y[begin + i] *= ring[i];
+				}
+			}
+		}
+
+		// the radius of a uniform point in the ball is the cube root of a uniform value
+		void Random::PointsInSphere(Vector3Stream& p_result) {
+			unsigned int size = p_result.Size();
+			SCALAR* x = p_result.GetX();
+			SCALAR* y = p_result.GetY();
+			SCALAR* z = p_result.GetZ();
+			float radius[K_CHUNK_SIZE];
+
+			UnitVectors(p_result);
+			for (unsigned int begin = 0; begin < size; begin += K_CHUNK_SIZE) {
+				unsigned int count = std::min(size - begin, K_CHUNK_SIZE);
+				Generate(radius, count, K_FLOAT_SCALE, K_FLOAT_SCALE, K_NO_LIMIT);
+				Log(radius, radius, count);
+				for (unsigned int i = 0; i < count; ++i) {
+					radius[i] *= 1.0f / 3.0f;
+				}
+				Fast::Exp(radius, radius, count);
+
+				for (unsigned int i = 0; i < count; ++i) {
+					x[begin + i] *= radius[i];
+					y[begin + i] *= radius[i];
+					z[begin + i] *= radius[i];
+				}
+			}
+		}
+
+		void Random::Generate(float* p_result, unsigned int p_count, float p_offset, float p_scale, float p_limit) {
+			unsigned int blocks = p_count / K_LANE_COUNT;
+			unsigned int remainder = p_count % K_LANE_COUNT;
+
+			// whole blocks in place, the last partial one through a block on the stack
+			GenerateBlocks(m_state, p_result, blocks, p_offset, p_scale, p_limit);
+			if (remainder != 0) {
+				float last[K_LANE_COUNT];
+				GenerateBlocks(m_state, last, 1, p_offset, p_scale, p_limit);
+				std::copy(last, last + remainder, p_result + blocks * K_LANE_COUNT);
+			}
+		}
+	}
+}
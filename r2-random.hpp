@@ -0,0 +1,112 @@
+/* HEADER
+ *
+ * File: r2-random.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A pseudo random number generator for filling large buffers of samples:
+ *	uniform and normally distributed floats, unit vectors and points in the
+ *	unit disk and sphere. Vectors are written as separate component arrays
+ *	(Vector3Stream for 3D), since that is what the SIMD code consuming
+ *	them wants.
+ *
+ *	The generator is xoshiro128+ (Blackman and Vigna), run as K_LANE_COUNT
+ *	independent streams side by side, so SSE2/AVX2 step 4 or 8 of them per
+ *	instruction. The streams are 2^64 steps apart in the same sequence.
+ *	Its lowest bits are weak, so floats are made from the upper 24 bits.
+ *	Uniform samples come out the same on every instruction set.
+ *
+ *	For several threads, give each its own generator: copy one and call
+ *	Jump on the copy once per thread index, which moves it 2^96 steps ahead
+ *	(far beyond anything a thread will draw).
+ *
+ *	Not suitable for cryptography.
+ * Depends on:
+ *  * r2::Math::Fast
+ *  * r2::Math::SIMD
+ *  * Vector3Stream
+ * Updates:
+ *
+ */
+#ifndef R2_RANDOM_HPP
+#define R2_RANDOM_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-stream.hpp"
+
+namespace r2 {
+	namespace Math {
+		class Random {
+		public:
+			static const unsigned int K_LANE_COUNT = 8;
+
+			/**
+			 * Initialize the generator from a seed, see Seed
+			 */
+			explicit Random(unsigned long long p_seed = 0);
+
+			/**
+			 * Restart the generator from a 64-bit seed. Every seed gives a different
+			 * sequence, including 0.
+			 */
+			void Seed(unsigned long long p_seed);
+
+			/**
+			 * Advance the generator 2^96 steps, see above
+			 */
+			void Jump();
+
+			/**
+			 * Draw single values from the first stream. NextFloat is in [0, 1).
+			 */
+			unsigned int NextUInt();
+			SCALAR NextFloat();
+
+			/**
+			 * Fill p_result with p_count values, uniform in [p_min, p_max) or normally
+			 * distributed. Every call draws whole steps of all streams, so a
+			 * count that is not a multiple of K_LANE_COUNT discards a few values.
+			 */
+			void Uniform(SCALAR* p_result, unsigned int p_count, SCALAR p_min = 0.0f, SCALAR p_max = 1.0f);
+			void Normal(SCALAR* p_result, unsigned int p_count, SCALAR p_mean = 0.0f, SCALAR p_deviation = 1.0f);
+
+			/**
+			 * Fill the arrays with p_count unit vectors, uniformly distributed over
+			 * the directions, or with points uniformly distributed in the unit disk.
+			 */
+			void UnitVectors(SCALAR* p_x, SCALAR* p_y, unsigned int p_count);
+			void PointsInDisk(SCALAR* p_x, SCALAR* p_y, unsigned int p_count);
+
+			/**
+			 * Fill the whole stream with unit vectors, uniformly distributed over the
+			 * sphere, or with points uniformly distributed in the unit ball.
+			 */
+			void UnitVectors(Vector3Stream& p_result);
+			void PointsInSphere(Vector3Stream& p_result);
+		private:
+			void Generate(float* p_result, unsigned int p_count, float p_offset, float p_scale, float p_limit);
+
+			// word w of the state of stream l is m_state[w][l]
+			unsigned int m_state[4][K_LANE_COUNT];
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,528 @@
+#include "r2-ray-intersection.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include <cmath>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		const unsigned int RayHit::K_NO_HIT;
+
+		static const unsigned int K_MASK_BITS = 32;
+
+		// rays closer than this to the plane of a triangle count as misses
+		static const float K_MIN_DETERMINANT = 1e-12f;
+
+		static unsigned int BitCount(unsigned int p_word) {
+			p_word = p_word - ((p_word >> 1) & 0x55555555u);
+			p_word = (p_word & 0x33333333u) + ((p_word >> 2) & 0x33333333u);
+			return (((p_word + (p_word >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+		}
+
+
+
+		/**
+		 * Triangles. The kernels do Moller-Trumbore on whole vectors of rays or
+		 * triangles, and only touch the hits of the lanes that hit something. A
+		 * triangle is passed as v0 and the edges v1 - v0 and v2 - v0.
+		 */
+		static bool ScalarIntersectTriangle(const float* p_origin, const float* p_direction, const float* p_v0, const float* p_e1, const float* p_e2, float p_max_distance,
+											float& p_distance, float& p_u, float& p_v) {
+			const float* d = p_direction;
+			float p[3] = { d[1] * p_e2[2] - d[2] * p_e2[1], d[2] * p_e2[0] - d[0] * p_e2[2], d[0] * p_e2[1] - d[1] * p_e2[0] };
+			float determinant = p_e1[0] * p[0] + p_e1[1] * p[1] + p_e1[2] * p[2];
+			if (std::fabs(determinant) < K_MIN_DETERMINANT) return false;
+			float inverse_determinant = 1.0f / determinant;
+
+			float s[3] = { p_origin[0] - p_v0[0], p_origin[1] - p_v0[1], p_origin[2] - p_v0[2] };
+			float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse_determinant;
+			if (u < 0.0f || u > 1.0f) return false;
+
+			float q[3] = { s[1] * p_e1[2] - s[2] * p_e1[1], s[2] * p_e1[0] - s[0] * p_e1[2], s[0] * p_e1[1] - s[1] * p_e1[0] };
+			float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inverse_determinant;
+			if (v < 0.0f || u + v > 1.0f) return false;
+
+			float t = (p_e2[0] * q[0] + p_e2[1] * q[1] + p_e2[2] * q[2]) * inverse_determinant;
+			if (t < 0.0f || t >= p_max_distance) return false;
+
+			p_distance = t;
+			p_u = u;
+			p_v = v;
+			return true;
+		}
+
+		static bool ScalarIntersectBox(const float* p_origin, const float* p_inverse_direction, const float* p_min, const float* p_max, float p_max_distance, float& p_entry) {
+			float entry = 0.0f;
+			float exit = p_max_distance;
+			for (int a = 0; a < 3; ++a) {
+				float t0 = (p_min[a] - p_origin[a]) * p_inverse_direction[a];
+				float t1 = (p_max[a] - p_origin[a]) * p_inverse_direction[a];
+				float near = (t0 < t1) ? t0 : t1, far = (t0 < t1) ? t1 : t0;
+				entry = (near > entry) ? near : entry;
+				exit = (far < exit) ? far : exit;
+			}
+
+			p_entry = entry;
+			return entry <= exit;
+		}
+
+		/**
+		 * Boxes. Either the ray or the box is the same for every lane, the other
+		 * is read from the streams; p_rows holds origin x, y, z and inverse
+		 * direction x, y, z followed by min x, y, z and max x, y, z, of which the
+		 * shared six point to single values. The kernels fill whole mask words,
+		 * starting at a multiple of 32.
+		 */
+		namespace BoxMode {
+			enum BoxMode { Rays, Boxes };
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static inline __m128 SSE2Select(__m128 p_mask, __m128 p_true, __m128 p_false) {
+			return _mm_or_ps(_mm_and_ps(p_mask, p_true), _mm_andnot_ps(p_mask, p_false));
+		}
+
+		// the lanes that hit, with the hit in p_distance, p_u and p_v
+		r2SIMDTargetM("sse2")
+		static inline __m128 SSE2IntersectTriangle(const __m128* p_origin, const __m128* p_direction, const __m128* p_v0, const __m128* p_e1, const __m128* p_e2, __m128 p_max_distance,
+												   __m128& p_distance, __m128& p_u, __m128& p_v) {
+			const __m128* d = p_direction;
+			__m128 p[3] = { _mm_sub_ps(_mm_mul_ps(d[1], p_e2[2]), _mm_mul_ps(d[2], p_e2[1])),
+							_mm_sub_ps(_mm_mul_ps(d[2], p_e2[0]), _mm_mul_ps(d[0], p_e2[2])),
+							_mm_sub_ps(_mm_mul_ps(d[0], p_e2[1]), _mm_mul_ps(d[1], p_e2[0])) };
+			__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p_e1[0], p[0]), _mm_mul_ps(p_e1[1], p[1])), _mm_mul_ps(p_e1[2], p[2]));
+			__m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+			__m128 s[3] = { _mm_sub_ps(p_origin[0], p_v0[0]), _mm_sub_ps(p_origin[1], p_v0[1]), _mm_sub_ps(p_origin[2], p_v0[2]) };
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s[0], p[0]), _mm_mul_ps(s[1], p[1])), _mm_mul_ps(s[2], p[2])), inverse_determinant);
+
+			__m128 q[3] = { _mm_sub_ps(_mm_mul_ps(s[1], p_e1[2]), _mm_mul_ps(s[2], p_e1[1])),
+							_mm_sub_ps(_mm_mul_ps(s[2], p_e1[0]), _mm_mul_ps(s[0], p_e1[2])),
+							_mm_sub_ps(_mm_mul_ps(s[0], p_e1[1]), _mm_mul_ps(s[1], p_e1[0])) };
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], q[0]), _mm_mul_ps(d[1], q[1])), _mm_mul_ps(d[2], q[2])), inverse_determinant);
+			__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p_e2[0], q[0]), _mm_mul_ps(p_e2[1], q[1])), _mm_mul_ps(p_e2[2], q[2])), inverse_determinant);
+
+			const __m128 zero = _mm_setzero_ps();
+			__m128 hit = _mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), determinant), _mm_set1_ps(K_MIN_DETERMINANT));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+			hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+			hit = _mm_and_ps(hit, _mm_cmplt_ps(t, p_max_distance));
+
+			p_distance = t;
+			p_u = u;
+			p_v = v;
+			return hit;
+		}
+
+		// p_rays holds origin x, y, z and direction x, y, z, p_triangle v0, e1 and e2
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2IntersectRays(const float* const* p_rays, unsigned int p_count, const float* p_triangle, unsigned int p_primitive, RayHit* p_hits, unsigned int& p_hit_count) {
+			__m128 triangle[9];
+			for (int k = 0; k < 9; ++k) {
+				triangle[k] = _mm_set1_ps(p_triangle[k]);
+			}
+
+			unsigned int i = 0;
+			for (; i + 4 <= p_count; i += 4) {
+				__m128 origin[3] = { _mm_load_ps(p_rays[0] + i), _mm_load_ps(p_rays[1] + i), _mm_load_ps(p_rays[2] + i) };
+				__m128 direction[3] = { _mm_load_ps(p_rays[3] + i), _mm_load_ps(p_rays[4] + i), _mm_load_ps(p_rays[5] + i) };
+				__m128 closest = _mm_setr_ps(p_hits[i].m_distance, p_hits[i + 1].m_distance, p_hits[i + 2].m_distance, p_hits[i + 3].m_distance);
+
+				__m128 t, u, v;
+				int bits = _mm_movemask_ps(SSE2IntersectTriangle(origin, direction, triangle, triangle + 3, triangle + 6, closest, t, u, v));
+				if (bits == 0) continue;
+
+				float distances[4], us[4], vs[4];
+				_mm_storeu_ps(distances, t);
+				_mm_storeu_ps(us, u);
+				_mm_storeu_ps(vs, v);
+				for (unsigned int lane = 0; lane < 4; ++lane) {
+					if ((bits & (1 << lane)) == 0) continue;
+
+					RayHit& hit = p_hits[i + lane];
+					hit.m_distance = distances[lane];
+					hit.m_primitive = p_primitive;
+					hit.m_u = us[lane];
+					hit.m_v = vs[lane];
+					++p_hit_count;
+				}
+			}
+
+			return i;
+		}
+
+		// p_ray holds origin and direction, p_triangles the rows v0 x, y, z, v1 x, y, z and v2 x, y, z
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2IntersectTriangles(const float* p_ray, const float* const* p_triangles, unsigned int p_count, RayHit& p_hit) {
+			__m128 origin[3] = { _mm_set1_ps(p_ray[0]), _mm_set1_ps(p_ray[1]), _mm_set1_ps(p_ray[2]) };
+			__m128 direction[3] = { _mm_set1_ps(p_ray[3]), _mm_set1_ps(p_ray[4]), _mm_set1_ps(p_ray[5]) };
+
+			// the closest hit of every lane, with index -1 for none
+			__m128 closest = _mm_set1_ps(p_hit.m_distance);
+			__m128 closest_u = _mm_setzero_ps(), closest_v = _mm_setzero_ps();
+			__m128 closest_index = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+
+			unsigned int i = 0;
+			for (; i + 4 <= p_count; i += 4, index = _mm_add_epi32(index, _mm_set1_epi32(4))) {
+				__m128 v0[3] = { _mm_load_ps(p_triangles[0] + i), _mm_load_ps(p_triangles[1] + i), _mm_load_ps(p_triangles[2] + i) };
+				__m128 e1[3] = { _mm_sub_ps(_mm_load_ps(p_triangles[3] + i), v0[0]), _mm_sub_ps(_mm_load_ps(p_triangles[4] + i), v0[1]), _mm_sub_ps(_mm_load_ps(p_triangles[5] + i), v0[2]) };
+				__m128 e2[3] = { _mm_sub_ps(_mm_load_ps(p_triangles[6] + i), v0[0]), _mm_sub_ps(_mm_load_ps(p_triangles[7] + i), v0[1]), _mm_sub_ps(_mm_load_ps(p_triangles[8] + i), v0[2]) };
+
+				__m128 t, u, v;
+				__m128 hit = SSE2IntersectTriangle(origin, direction, v0, e1, e2, closest, t, u, v);
+				closest = SSE2Select(hit, t, closest);
+				closest_u = SSE2Select(hit, u, closest_u);
+				closest_v = SSE2Select(hit, v, closest_v);
+				closest_index = SSE2Select(hit, _mm_castsi128_ps(index), closest_index);
+			}
+
+			float distances[4], us[4], vs[4];
+			int indices[4];
+			_mm_storeu_ps(distances, closest);
+			_mm_storeu_ps(us, closest_u);
+			_mm_storeu_ps(vs, closest_v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indices), _mm_castps_si128(closest_index));
+			for (unsigned int lane = 0; lane < 4; ++lane) {
+				if (indices[lane] < 0 || distances[lane] >= p_hit.m_distance) continue;
+
+				p_hit.m_distance = distances[lane];
+				p_hit.m_primitive = static_cast<unsigned int>(indices[lane]);
+				p_hit.m_u = us[lane];
+				p_hit.m_v = vs[lane];
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2IntersectBoxes(const float* const* p_rows, unsigned int p_count, float p_max_distance, unsigned int* p_mask, float* p_entries, BoxMode::BoxMode p_mode) {
+			__m128 rows[12];
+			const int first_streamed = (p_mode == BoxMode::Rays) ? 0 : 6;
+			const int first_shared = 6 - first_streamed;
+			for (int k = first_shared; k < first_shared + 6; ++k) {
+				rows[k] = _mm_set1_ps(*p_rows[k]);
+			}
+			const __m128 max_distance = _mm_set1_ps(p_max_distance);
+
+			unsigned int i = 0;
+			for (; i + K_MASK_BITS <= p_count; i += K_MASK_BITS) {
+				unsigned int word = 0;
+				for (unsigned int bit = 0; bit < K_MASK_BITS; bit += 4) {
+					unsigned int index = i + bit;
+					for (int k = first_streamed; k < first_streamed + 6; ++k) {
+						rows[k] = _mm_load_ps(p_rows[k] + index);
+					}
+
+					__m128 entry = _mm_setzero_ps();
+					__m128 exit = max_distance;
+					for (int a = 0; a < 3; ++a) {
+						__m128 t0 = _mm_mul_ps(_mm_sub_ps(rows[6 + a], rows[a]), rows[3 + a]);
+						__m128 t1 = _mm_mul_ps(_mm_sub_ps(rows[9 + a], rows[a]), rows[3 + a]);
+						entry = _mm_max_ps(entry, _mm_min_ps(t0, t1));
+						exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+					}
+
+					if (p_entries != 0) _mm_storeu_ps(p_entries + index, entry);
+					word |= static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(entry, exit))) << bit;
+				}
+
+				p_mask[i / K_MASK_BITS] = word;
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static inline __m256 AVX2IntersectTriangle(const __m256* p_origin, const __m256* p_direction, const __m256* p_v0, const __m256* p_e1, const __m256* p_e2, __m256 p_max_distance,
+												   __m256& p_distance, __m256& p_u, __m256& p_v) {
+			const __m256* d = p_direction;
+			__m256 p[3] = { _mm256_fmsub_ps(d[1], p_e2[2], _mm256_mul_ps(d[2], p_e2[1])),
+							_mm256_fmsub_ps(d[2], p_e2[0], _mm256_mul_ps(d[0], p_e2[2])),
+							_mm256_fmsub_ps(d[0], p_e2[1], _mm256_mul_ps(d[1], p_e2[0])) };
+			__m256 determinant = _mm256_fmadd_ps(p_e1[0], p[0], _mm256_fmadd_ps(p_e1[1], p[1], _mm256_mul_ps(p_e1[2], p[2])));
+			__m256 inverse_determinant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+			__m256 s[3] = { _mm256_sub_ps(p_origin[0], p_v0[0]), _mm256_sub_ps(p_origin[1], p_v0[1]), _mm256_sub_ps(p_origin[2], p_v0[2]) };
+			__m256 u = _mm256_mul_ps(_mm256_fmadd_ps(s[0], p[0], _mm256_fmadd_ps(s[1], p[1], _mm256_mul_ps(s[2], p[2]))), inverse_determinant);
+
+			__m256 q[3] = { _mm256_fmsub_ps(s[1], p_e1[2], _mm256_mul_ps(s[2], p_e1[1])),
+							_mm256_fmsub_ps(s[2], p_e1[0], _mm256_mul_ps(s[0], p_e1[2])),
+							_mm256_fmsub_ps(s[0], p_e1[1], _mm256_mul_ps(s[1], p_e1[0])) };
+			__m256 v = _mm256_mul_ps(_mm256_fmadd_ps(d[0], q[0], _mm256_fmadd_ps(d[1], q[1], _mm256_mul_ps(d[2], q[2]))), inverse_determinant);
+			__m256 t = _mm256_mul_ps(_mm256_fmadd_ps(p_e2[0], q[0], _mm256_fmadd_ps(p_e2[1], q[1], _mm256_mul_ps(p_e2[2], q[2]))), inverse_determinant);
+
+			const __m256 zero = _mm256_setzero_ps();
+			__m256 hit = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), determinant), _mm256_set1_ps(K_MIN_DETERMINANT), _CMP_GE_OQ);
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, p_max_distance, _CMP_LT_OQ));
+
+			p_distance = t;
+			p_u = u;
+			p_v = v;
+			return hit;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2IntersectRays(const float* const* p_rays, unsigned int p_count, const float* p_triangle, unsigned int p_primitive, RayHit* p_hits, unsigned int& p_hit_count) {
+			__m256 triangle[9];
+			for (int k = 0; k < 9; ++k) {
+				triangle[k] = _mm256_set1_ps(p_triangle[k]);
+			}
+
+			// the distances of 8 consecutive hits, 4 floats apart
+			const __m256i hit_offsets = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8) {
+				__m256 origin[3] = { _mm256_load_ps(p_rays[0] + i), _mm256_load_ps(p_rays[1] + i), _mm256_load_ps(p_rays[2] + i) };
+				__m256 direction[3] = { _mm256_load_ps(p_rays[3] + i), _mm256_load_ps(p_rays[4] + i), _mm256_load_ps(p_rays[5] + i) };
+				__m256 closest = _mm256_i32gather_ps(&p_hits[i].m_distance, hit_offsets, 4);
+
+				__m256 t, u, v;
+				int bits = _mm256_movemask_ps(AVX2IntersectTriangle(origin, direction, triangle, triangle + 3, triangle + 6, closest, t, u, v));
+				if (bits == 0) continue;
+
+				float distances[8], us[8], vs[8];
+				_mm256_storeu_ps(distances, t);
+				_mm256_storeu_ps(us, u);
+				_mm256_storeu_ps(vs, v);
+				for (unsigned int lane = 0; lane < 8; ++lane) {
+					if ((bits & (1 << lane)) == 0) continue;
+
+					RayHit& hit = p_hits[i + lane];
+					hit.m_distance = distances[lane];
+					hit.m_primitive = p_primitive;
+					hit.m_u = us[lane];
+					hit.m_v = vs[lane];
+					++p_hit_count;
+				}
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2IntersectTriangles(const float* p_ray, const float* const* p_triangles, unsigned int p_count, RayHit& p_hit) {
+			__m256 origin[3] = { _mm256_set1_ps(p_ray[0]), _mm256_set1_ps(p_ray[1]), _mm256_set1_ps(p_ray[2]) };
+			__m256 direction[3] = { _mm256_set1_ps(p_ray[3]), _mm256_set1_ps(p_ray[4]), _mm256_set1_ps(p_ray[5]) };
+
+			__m256 closest = _mm256_set1_ps(p_hit.m_distance);
+			__m256 closest_u = _mm256_setzero_ps(), closest_v = _mm256_setzero_ps();
+			__m256 closest_index = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+			unsigned int i = 0;
+			for (; i + 8 <= p_count; i += 8, index = _mm256_add_epi32(index, _mm256_set1_epi32(8))) {
+				__m256 v0[3] = { _mm256_load_ps(p_triangles[0] + i), _mm256_load_ps(p_triangles[1] + i), _mm256_load_ps(p_triangles[2] + i) };
+				__m256 e1[3] = { _mm256_sub_ps(_mm256_load_ps(p_triangles[3] + i), v0[0]), _mm256_sub_ps(_mm256_load_ps(p_triangles[4] + i), v0[1]), _mm256_sub_ps(_mm256_load_ps(p_triangles[5] + i), v0[2]) };
+				__m256 e2[3] = { _mm256_sub_ps(_mm256_load_ps(p_triangles[6] + i), v0[0]), _mm256_sub_ps(_mm256_load_ps(p_triangles[7] + i), v0[1]), _mm256_sub_ps(_mm256_load_ps(p_triangles[8] + i), v0[2]) };
+
+				__m256 t, u, v;
+				__m256 hit = AVX2IntersectTriangle(origin, direction, v0, e1, e2, closest, t, u, v);
+				closest = _mm256_blendv_ps(closest, t, hit);
+				closest_u = _mm256_blendv_ps(closest_u, u, hit);
+				closest_v = _mm256_blendv_ps(closest_v, v, hit);
+				closest_index = _mm256_blendv_ps(closest_index, _mm256_castsi256_ps(index), hit);
+			}
+
+			float distances[8], us[8], vs[8];
+			int indices[8];
+			_mm256_storeu_ps(distances, closest);
+			_mm256_storeu_ps(us, closest_u);
+			_mm256_storeu_ps(vs, closest_v);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(indices), _mm256_castps_si256(closest_index));
+			for (unsigned int lane = 0; lane < 8; ++lane) {
+				if (indices[lane] < 0 || distances[lane] >= p_hit.m_distance) continue;
+
+				p_hit.m_distance = distances[lane];
+				p_hit.m_primitive = static_cast<unsigned int>(indices[lane]);
+				p_hit.m_u = us[lane];
+				p_hit.m_v = vs[lane];
+			}
+
+			return i;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2IntersectBoxes(const float* const* p_rows, unsigned int p_count, float p_max_distance, unsigned int* p_mask, float* p_entries, BoxMode::BoxMode p_mode) {
+			__m256 rows[12];
+			const int first_streamed = (p_mode == BoxMode::Rays) ? 0 : 6;
+			const int first_shared = 6 - first_streamed;
+			for (int k = first_shared; k < first_shared + 6; ++k) {
+				rows[k] = _mm256_set1_ps(*p_rows[k]);
+			}
+			const __m256 max_distance = _mm256_set1_ps(p_max_distance);
+
+			unsigned int i = 0;
+			for (; i + K_MASK_BITS <= p_count; i += K_MASK_BITS) {
+				unsigned int word = 0;
+				for (unsigned int bit = 0; bit < K_MASK_BITS; bit += 8) {
+					unsigned int index = i + bit;
+					for (int k = first_streamed; k < first_streamed + 6; ++k) {
+						rows[k] = _mm256_load_ps(p_rows[k] + index);
+					}
+
+					__m256 entry = _mm256_setzero_ps();
+					__m256 exit = max_distance;
+					for (int a = 0; a < 3; ++a) {
+						__m256 t0 = _mm256_mul_ps(_mm256_sub_ps(rows[6 + a], rows[a]), rows[3 + a]);
+						__m256 t1 = _mm256_mul_ps(_mm256_sub_ps(rows[9 + a], rows[a]), rows[3 + a]);
+						entry = _mm256_max_ps(entry, _mm256_min_ps(t0, t1));
+						exit = _mm256_min_ps(exit, _mm256_max_ps(t0, t1));
+					}
+
+					if (p_entries != 0) _mm256_storeu_ps(p_entries + index, entry);
+					word |= static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ))) << bit;
+				}
+
+				p_mask[i / K_MASK_BITS] = word;
+			}
+
+			return i;
+		}
+#endif
+
+		static unsigned int IntersectBoxStreams(const float* const* p_rows, unsigned int p_count, float p_max_distance, unsigned int* p_mask, float* p_entries, BoxMode::BoxMode p_mode) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2IntersectBoxes(p_rows, p_count, p_max_distance, p_mask, p_entries, p_mode);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2IntersectBoxes(p_rows, p_count, p_max_distance, p_mask, p_entries, p_mode);
+#endif
+			for (; i < p_count; i += K_MASK_BITS) {
+				unsigned int word = 0;
+				unsigned int bits = (p_count - i < K_MASK_BITS) ? p_count - i : K_MASK_BITS;
+				for (unsigned int bit = 0; bit < bits; ++bit) {
+					unsigned int index = i + bit;
+					float values[12];
+					for (int k = 0; k < 12; ++k) {
+						bool streamed = (p_mode == BoxMode::Rays) ? k < 6 : k >= 6;
+						values[k] = streamed ? p_rows[k][index] : *p_rows[k];
+					}
+
+					float entry;
+					if (ScalarIntersectBox(values, values + 3, values + 6, values + 9, p_max_distance, entry)) word |= 1u << bit;
+					if (p_entries != 0) p_entries[index] = entry;
+				}
+
+				p_mask[i / K_MASK_BITS] = word;
+			}
+
+			unsigned int hits = 0;
+			unsigned int word_count = (p_count + K_MASK_BITS - 1) / K_MASK_BITS;
+			for (unsigned int w = 0; w < word_count; ++w) {
+				hits += BitCount(p_mask[w]);
+			}
+
+			return hits;
+		}
+
+
+
+		bool IntersectTriangle(const Vector3& p_origin, const Vector3& p_direction, const Vector3& p_v0, const Vector3& p_v1, const Vector3& p_v2, RayHit& p_hit, unsigned int p_primitive) {
+			float e1[3] = { p_v1.x - p_v0.x, p_v1.y - p_v0.y, p_v1.z - p_v0.z };
+			float e2[3] = { p_v2.x - p_v0.x, p_v2.y - p_v0.y, p_v2.z - p_v0.z };
+
+			float t, u, v;
+			if (!ScalarIntersectTriangle(p_origin.m_data, p_direction.m_data, p_v0.m_data, e1, e2, p_hit.m_distance, t, u, v)) return false;
+
+			p_hit.m_distance = t;
+			p_hit.m_primitive = p_primitive;
+			p_hit.m_u = u;
+			p_hit.m_v = v;
+			return true;
+		}
+
+		unsigned int IntersectTriangle(const Vector3Stream& p_origins, const Vector3Stream& p_directions, const Vector3& p_v0, const Vector3& p_v1, const Vector3& p_v2, RayHit* p_hits, unsigned int p_primitive) {
+			if (p_origins.Size() != p_directions.Size()) throw r2ExceptionArgumentM("Stream sizes do not match");
+
+			const float* rays[6] = { p_origins.GetX(), p_origins.GetY(), p_origins.GetZ(), p_directions.GetX(), p_directions.GetY(), p_directions.GetZ() };
+			const float triangle[9] = { p_v0.x, p_v0.y, p_v0.z,
+										p_v1.x - p_v0.x, p_v1.y - p_v0.y, p_v1.z - p_v0.z,
+										p_v2.x - p_v0.x, p_v2.y - p_v0.y, p_v2.z - p_v0.z };
+			unsigned int count = p_origins.Size();
+			unsigned int hit_count = 0;
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2IntersectRays(rays, count, triangle, p_primitive, p_hits, hit_count);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2IntersectRays(rays, count, triangle, p_primitive, p_hits, hit_count);
+#endif
+			for (; i < count; ++i) {
+				float origin[3] = { rays[0][i], rays[1][i], rays[2][i] };
+				float direction[3] = { rays[3][i], rays[4][i], rays[5][i] };
+
+				RayHit& hit = p_hits[i];
+				float t, u, v;
+				if (!ScalarIntersectTriangle(origin, direction, triangle, triangle + 3, triangle + 6, hit.m_distance, t, u, v)) continue;
+
+				hit.m_distance = t;
+				hit.m_primitive = p_primitive;
+				hit.m_u = u;
+				hit.m_v = v;
+				++hit_count;
+			}
+
+			return hit_count;
+		}
+
+		bool IntersectTriangles(const Vector3& p_origin, const Vector3& p_direction, const Vector3Stream& p_v0, const Vector3Stream& p_v1, const Vector3Stream& p_v2, RayHit& p_hit) {
+			if (p_v0.Size() != p_v1.Size() || p_v0.Size() != p_v2.Size()) throw r2ExceptionArgumentM("Stream sizes do not match");
+
+			const float ray[6] = { p_origin.x, p_origin.y, p_origin.z, p_direction.x, p_direction.y, p_direction.z };
+			const float* triangles[9] = { p_v0.GetX(), p_v0.GetY(), p_v0.GetZ(), p_v1.GetX(), p_v1.GetY(), p_v1.GetZ(), p_v2.GetX(), p_v2.GetY(), p_v2.GetZ() };
+			unsigned int count = p_v0.Size();
+			float first_distance = p_hit.m_distance;
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2IntersectTriangles(ray, triangles, count, p_hit);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2IntersectTriangles(ray, triangles, count, p_hit);
+#endif
+			for (; i < count; ++i) {
+				float v0[3] = { triangles[0][i], triangles[1][i], triangles[2][i] };
+				float e1[3] = { triangles[3][i] - v0[0], triangles[4][i] - v0[1], triangles[5][i] - v0[2] };
+				float e2[3] = { triangles[6][i] - v0[0], triangles[7][i] - v0[1], triangles[8][i] - v0[2] };
+
+				float t, u, v;
+				if (!ScalarIntersectTriangle(ray, ray + 3, v0, e1, e2, p_hit.m_distance, t, u, v)) continue;
+
+				p_hit.m_distance = t;
+				p_hit.m_primitive = i;
+				p_hit.m_u = u;
+				p_hit.m_v = v;
+			}
+
+			return p_hit.m_distance < first_distance;
+		}
+
+		bool IntersectBox(const Vector3& p_origin, const Vector3& p_inverse_direction, const Vector3& p_min, const Vector3& p_max, SCALAR p_max_distance, SCALAR& p_entry) {
+			return ScalarIntersectBox(p_origin.m_data, p_inverse_direction.m_data, p_min.m_data, p_max.m_data, p_max_distance, p_entry);
+		}
+
+		unsigned int IntersectBox(const Vector3Stream& p_origins, const Vector3Stream& p_inverse_directions, const Vector3& p_min, const Vector3& p_max, SCALAR p_max_distance, unsigned int* p_mask, SCALAR* p_entries) {
+			if (p_origins.Size() != p_inverse_directions.Size()) throw r2ExceptionArgumentM("Stream sizes do not match");
+
+			const float* rows[12] = { p_origins.GetX(), p_origins.GetY(), p_origins.GetZ(), p_inverse_directions.GetX(), p_inverse_directions.GetY(), p_inverse_directions.GetZ(),
+									  &p_min.x, &p_min.y, &p_min.z, &p_max.x, &p_max.y, &p_max.z };
+			return IntersectBoxStreams(rows, p_origins.Size(), p_max_distance, p_mask, p_entries, BoxMode::Rays);
+		}
+
+		unsigned int IntersectBoxes(const Vector3& p_origin, const Vector3& p_inverse_direction, const Vector3Stream& p_min, const Vector3Stream& p_max, SCALAR p_max_distance, unsigned int* p_mask, SCALAR* p_entries) {
+			if (p_min.Size() != p_max.Size()) throw r2ExceptionArgumentM("Stream sizes do not match");
+
+			const float* rows[12] = { &p_origin.x, &p_origin.y, &p_origin.z, &p_inverse_direction.x, &p_inverse_direction.y, &p_inverse_direction.z,
+									  p_min.GetX(), p_min.GetY(), p_min.GetZ(), p_max.GetX(), p_max.GetY(), p_max.GetZ() };
+			return IntersectBoxStreams(rows, p_min.Size(), p_max_distance, p_mask, p_entries, BoxMode::Boxes);
+		}
+	}
+}
@@ -0,0 +1,122 @@
+/* HEADER
+ *
+ * File: r2-ray-intersection.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Comments:
+ *	Ray intersection tests against triangles (Moller-Trumbore) and axis
+ *	aligned boxes (slab test), for single rays and for packets.
+ *
+ *	The packet tests take their rays or primitives as streams and test 4
+ *	(SSE2) or 8 (AVX2) of them per instruction: many rays against one
+ *	primitive, or one ray against many primitives. Ray directions need not
+ *	be normalized; distances are in units of the direction.
+ *
+ *	Triangle tests keep the closest hit: a RayHit is only replaced by a hit
+ *	closer than its m_distance, so initialize m_distance to the maximum
+ *	distance and m_primitive to RayHit::K_NO_HIT before the first test.
+ *
+ *	Box tests write a hit bitmask with 32 rays or boxes per word, in the
+ *	format of Cull in r2-frustum.hpp (see GetVisibleIndices there). They
+ *	take the component-wise reciprocals of the ray directions, which are
+ *	usually shared by many tests.
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Exception::Argument
+ *  * r2::Math::SIMD
+ *  * Vector3, Vector3Stream
+ * Updates:
+ *
+ */
+#ifndef R2_RAY_INTERSECTION_HPP
+#define R2_RAY_INTERSECTION_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-stream.hpp"
+
+namespace r2 {
+	namespace Math {
+		/**
+		 * The closest hit along a ray. For triangles, the hit point is
+		 * (1 - u - v) * v0 + u * v1 + v * v2, for boxes u and v are 0.
+		 */
+		struct RayHit {
+			/**
+			 * The value of m_primitive for rays that hit nothing
+			 */
+			static const unsigned int K_NO_HIT = 0xFFFFFFFFu;
+
+			SCALAR m_distance;
+			unsigned int m_primitive;
+			SCALAR m_u;
+			SCALAR m_v;
+		};
+
+		/**
+		 * Intersect one ray with the triangle (p_v0, p_v1, p_v2). If it is hit
+		 * closer than p_hit.m_distance, p_hit is set to the hit with m_primitive
+		 * set to p_primitive and true is returned.
+		 */
+		bool IntersectTriangle(const Vector3& p_origin, const Vector3& p_direction, const Vector3& p_v0, const Vector3& p_v1, const Vector3& p_v2, RayHit& p_hit, unsigned int p_primitive = 0);
+
+		/**
+		 * Intersect the rays (p_origins[i], p_directions[i]) with the triangle,
+		 * updating p_hits[i] as above. Returns the number of updated hits. The
+		 * streams must be of the same size, or an Argument exception is raised.
+		 */
+		unsigned int IntersectTriangle(const Vector3Stream& p_origins, const Vector3Stream& p_directions, const Vector3& p_v0, const Vector3& p_v1, const Vector3& p_v2, RayHit* p_hits, unsigned int p_primitive = 0);
+
+		/**
+		 * Intersect one ray with the triangles (p_v0[i], p_v1[i], p_v2[i]) and
+		 * keep the closest hit in p_hit, with m_primitive set to the index i.
+		 * Returns true if p_hit was updated. The streams must be of the same
+		 * size, or an Argument exception is raised.
+		 */
+		bool IntersectTriangles(const Vector3& p_origin, const Vector3& p_direction, const Vector3Stream& p_v0, const Vector3Stream& p_v1, const Vector3Stream& p_v2, RayHit& p_hit);
+
+		/**
+		 * Intersect one ray with the box [p_min, p_max]. Returns true if the ray
+		 * enters the box before p_max_distance, with the distance at which it
+		 * enters (0 if it starts inside) in p_entry.
+		 */
+		bool IntersectBox(const Vector3& p_origin, const Vector3& p_inverse_direction, const Vector3& p_min, const Vector3& p_max, SCALAR p_max_distance, SCALAR& p_entry);
+
+		/**
+		 * Intersect the rays with the box and write the hit bitmask of the rays.
+		 * If p_entries is not 0, the entry distance of every ray is written to
+		 * it (only meaningful for hits). Returns the number of rays that hit.
+		 * The streams must be of the same size, or an Argument exception is
+		 * raised.
+		 */
+		unsigned int IntersectBox(const Vector3Stream& p_origins, const Vector3Stream& p_inverse_directions, const Vector3& p_min, const Vector3& p_max, SCALAR p_max_distance, unsigned int* p_mask, SCALAR* p_entries = 0);
+
+		/**
+		 * Intersect one ray with the boxes [p_min[i], p_max[i]] and write the hit
+		 * bitmask of the boxes, and their entry distances to p_entries if it is
+		 * not 0. Returns the number of boxes hit. The streams must be of the same
+		 * size, or an Argument exception is raised.
+		 */
+		unsigned int IntersectBoxes(const Vector3& p_origin, const Vector3& p_inverse_direction, const Vector3Stream& p_min, const Vector3Stream& p_max, SCALAR p_max_distance, unsigned int* p_mask, SCALAR* p_entries = 0);
+	}
+}
+
+#endif
@@ -0,0 +1,476 @@
+#include "r2-reduction.hpp"
+#include "r2-exception.hpp"
+#include "r2-parallel.hpp"
+#include "r2-simd.hpp"
+#include <vector>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		// the points are read as a flat array of components
+		static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be tightly packed floats");
+
+		// the blocks must be a multiple of the lane count, so every block starts in lane 0
+		static const unsigned int K_LANE_COUNT = 8;
+		static const unsigned int K_BLOCK_SIZE = 4096;
+		static const unsigned int K_MIN_BLOCKS_PER_THREAD = 4;
+
+		static const float K_LARGE = 3.402823e38f;
+
+		typedef float Lanes[K_LANE_COUNT];
+
+		/**
+		 * The scalar kernels, also used for the last (less than 8) points of the
+		 * SIMD ones. They accumulate into the same lanes, in the same order, as
+		 * the SIMD kernels do.
+		 *
+		 * Sums use the rows x, y, z, weight. Bounds use min x, y, z, max x, y, z.
+		 * Covariance uses xx, yy, zz, xy, yz, zx.
+		 */
+		static void ScalarSum(const float* p_points, const float* p_weights, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				unsigned int lane = i % K_LANE_COUNT;
+				float weight = (p_weights != 0) ? p_weights[i] : 1.0f;
+				p_lanes[0][lane] += weight * p_points[3 * i + 0];
+				p_lanes[1][lane] += weight * p_points[3 * i + 1];
+				p_lanes[2][lane] += weight * p_points[3 * i + 2];
+				p_lanes[3][lane] += weight;
+			}
+		}
+
+		static void ScalarBounds(const float* p_points, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				unsigned int lane = i % K_LANE_COUNT;
+				for (unsigned int c = 0; c < 3; ++c) {
+					float value = p_points[3 * i + c];
+					p_lanes[c][lane] = (value < p_lanes[c][lane]) ? value : p_lanes[c][lane];
+					p_lanes[c + 3][lane] = (value > p_lanes[c + 3][lane]) ? value : p_lanes[c + 3][lane];
+				}
+			}
+		}
+
+		static void ScalarCovariance(const float* p_points, const float* p_weights, const float* p_mean, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				unsigned int lane = i % K_LANE_COUNT;
+				float weight = (p_weights != 0) ? p_weights[i] : 1.0f;
+				float x = p_points[3 * i + 0] - p_mean[0];
+				float y = p_points[3 * i + 1] - p_mean[1];
+				float z = p_points[3 * i + 2] - p_mean[2];
+				float wx = weight * x, wy = weight * y, wz = weight * z;
+				p_lanes[0][lane] += wx * x;
+				p_lanes[1][lane] += wy * y;
+				p_lanes[2][lane] += wz * z;
+				p_lanes[3][lane] += wx * y;
+				p_lanes[4][lane] += wy * z;
+				p_lanes[5][lane] += wz * x;
+			}
+		}
+
+#if defined(R2_ARCH_X86)
+		/**
+		 * Deinterleave 4 points (12 floats) into one register per component.
+		 * The AVX2 version does the same for points 0-3 in the low half and 4-7
+		 * in the high half.
+		 *
+		 * The SIMD kernels do not use FMA, which would round differently from
+		 * the scalar kernels.
+		 */
+		r2SIMDTargetM("sse2")
+		static inline void SSE2LoadPoints(const float* p_points, __m128& p_x, __m128& p_y, __m128& p_z) {
+			__m128 a = _mm_loadu_ps(p_points + 0);
+			__m128 b = _mm_loadu_ps(p_points + 4);
+			__m128 c = _mm_loadu_ps(p_points + 8);
+			__m128 xy = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+			__m128 yz = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+			p_x = _mm_shuffle_ps(a, xy, _MM_SHUFFLE(2, 0, 3, 0));
+			p_y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			p_z = _mm_shuffle_ps(yz, c, _MM_SHUFFLE(3, 0, 3, 1));
+		}
+
+		r2SIMDTargetM("avx2")
+		static inline void AVX2LoadPoints(const float* p_points, __m256& p_x, __m256& p_y, __m256& p_z) {
+			__m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p_points + 0)), _mm_loadu_ps(p_points + 12), 1);
+			__m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p_points + 4)), _mm_loadu_ps(p_points + 16), 1);
+			__m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p_points + 8)), _mm_loadu_ps(p_points + 20), 1);
+			__m256 xy = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+			__m256 yz = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+			p_x = _mm256_shuffle_ps(a, xy, _MM_SHUFFLE(2, 0, 3, 0));
+			p_y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			p_z = _mm256_shuffle_ps(yz, c, _MM_SHUFFLE(3, 0, 3, 1));
+		}
+
+		// p_begin is a multiple of 8, and so is the first point left to the scalar kernel
+		r2SIMDTargetM("sse2")
+		static void SSE2Sum(const float* p_points, const float* p_weights, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			__m128 sums[4][2];
+			for (unsigned int r = 0; r < 4; ++r) {
+				sums[r][0] = _mm_loadu_ps(p_lanes[r]);
+				sums[r][1] = _mm_loadu_ps(p_lanes[r] + 4);
+			}
+
+			const __m128 one = _mm_set1_ps(1.0f);
+			unsigned int i = p_begin;
+			for (; i + K_LANE_COUNT <= p_end; i += K_LANE_COUNT) {
+				for (unsigned int h = 0; h < 2; ++h) {
+					__m128 x, y, z;
+					SSE2LoadPoints(p_points + 3 * (i + 4 * h), x, y, z);
+					__m128 weight = (p_weights != 0) ? _mm_loadu_ps(p_weights + i + 4 * h) : one;
+					sums[0][h] = _mm_add_ps(sums[0][h], _mm_mul_ps(weight, x));
+					sums[1][h] = _mm_add_ps(sums[1][h], _mm_mul_ps(weight, y));
+					sums[2][h] = _mm_add_ps(sums[2][h], _mm_mul_ps(weight, z));
+					sums[3][h] = _mm_add_ps(sums[3][h], weight);
+				}
+			}
+
+			for (unsigned int r = 0; r < 4; ++r) {
+				_mm_storeu_ps(p_lanes[r], sums[r][0]);
+				_mm_storeu_ps(p_lanes[r] + 4, sums[r][1]);
+			}
+			ScalarSum(p_points, p_weights, i, p_end, p_lanes);
+		}
+
+		r2SIMDTargetM("avx2")
+		static void AVX2Sum(const float* p_points, const float* p_weights, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			__m256 sums[4];
+			for (unsigned int r = 0; r < 4; ++r) {
+				sums[r] = _mm256_loadu_ps(p_lanes[r]);
+			}
+
+			const __m256 one = _mm256_set1_ps(1.0f);
+			unsigned int i = p_begin;
+			for (; i + K_LANE_COUNT <= p_end; i += K_LANE_COUNT) {
+				__m256 x, y, z;
+				AVX2LoadPoints(p_points + 3 * i, x, y, z);
+				__m256 weight = (p_weights != 0) ? _mm256_loadu_ps(p_weights + i) : one;
+				sums[0] = _mm256_add_ps(sums[0], _mm256_mul_ps(weight, x));
+				sums[1] = _mm256_add_ps(sums[1], _mm256_mul_ps(weight, y));
+				sums[2] = _mm256_add_ps(sums[2], _mm256_mul_ps(weight, z));
+				sums[3] = _mm256_add_ps(sums[3], weight);
+			}
+
+			for (unsigned int r = 0; r < 4; ++r) {
+				_mm256_storeu_ps(p_lanes[r], sums[r]);
+			}
+			ScalarSum(p_points, p_weights, i, p_end, p_lanes);
+		}
+
+		// the new value is the first operand of min/max, so a NaN keeps the old one
+		r2SIMDTargetM("sse2")
+		static void SSE2Bounds(const float* p_points, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			__m128 bounds[6][2];
+			for (unsigned int r = 0; r < 6; ++r) {
+				bounds[r][0] = _mm_loadu_ps(p_lanes[r]);
+				bounds[r][1] = _mm_loadu_ps(p_lanes[r] + 4);
+			}
+
+			unsigned int i = p_begin;
+			for (; i + K_LANE_COUNT <= p_end; i += K_LANE_COUNT) {
+				for (unsigned int h = 0; h < 2; ++h) {
+					__m128 point[3];
+					SSE2LoadPoints(p_points + 3 * (i + 4 * h), point[0], point[1], point[2]);
+					for (unsigned int c = 0; c < 3; ++c) {
+						bounds[c][h] = _mm_min_ps(point[c], bounds[c][h]);
+						bounds[c + 3][h] = _mm_max_ps(point[c], bounds[c + 3][h]);
+					}
+				}
+			}
+
+			for (unsigned int r = 0; r < 6; ++r) {
+				_mm_storeu_ps(p_lanes[r], bounds[r][0]);
+				_mm_storeu_ps(p_lanes[r] + 4, bounds[r][1]);
+			}
+			ScalarBounds(p_points, i, p_end, p_lanes);
+		}
+
+		r2SIMDTargetM("avx2")
+		static void AVX2Bounds(const float* p_points, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			__m256 bounds[6];
+			for (unsigned int r = 0; r < 6; ++r) {
+				bounds[r] = _mm256_loadu_ps(p_lanes[r]);
+			}
+
+			unsigned int i = p_begin;
+			for (; i + K_LANE_COUNT <= p_end; i += K_LANE_COUNT) {
+				__m256 point[3];
+				AVX2LoadPoints(p_points + 3 * i, point[0], point[1], point[2]);
+				for (unsigned int c = 0; c < 3; ++c) {
+					bounds[c] = _mm256_min_ps(point[c], bounds[c]);
+					bounds[c + 3] = _mm256_max_ps(point[c], bounds[c + 3]);
+				}
+			}
+
+			for (unsigned int r = 0; r < 6; ++r) {
+				_mm256_storeu_ps(p_lanes[r], bounds[r]);
+			}
+			ScalarBounds(p_points, i, p_end, p_lanes);
+		}
+
+		r2SIMDTargetM("sse2")
+		static void SSE2Covariance(const float* p_points, const float* p_weights, const float* p_mean, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			__m128 products[6][2];
+			for (unsigned int r = 0; r < 6; ++r) {
+				products[r][0] = _mm_loadu_ps(p_lanes[r]);
+				products[r][1] = _mm_loadu_ps(p_lanes[r] + 4);
+			}
+
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 mean_x = _mm_set1_ps(p_mean[0]);
+			const __m128 mean_y = _mm_set1_ps(p_mean[1]);
+			const __m128 mean_z = _mm_set1_ps(p_mean[2]);
+			unsigned int i = p_begin;
+			for (; i + K_LANE_COUNT <= p_end; i += K_LANE_COUNT) {
+				for (unsigned int h = 0; h < 2; ++h) {
+					__m128 x, y, z;
+					SSE2LoadPoints(p_points + 3 * (i + 4 * h), x, y, z);
+					__m128 weight = (p_weights != 0) ? _mm_loadu_ps(p_weights + i + 4 * h) : one;
+					x = _mm_sub_ps(x, mean_x);
+					y = _mm_sub_ps(y, mean_y);
+					z = _mm_sub_ps(z, mean_z);
+					__m128 wx = _mm_mul_ps(weight, x), wy = _mm_mul_ps(weight, y), wz = _mm_mul_ps(weight, z);
+					products[0][h] = _mm_add_ps(products[0][h], _mm_mul_ps(wx, x));
+					products[1][h] = _mm_add_ps(products[1][h], _mm_mul_ps(wy, y));
+					products[2][h] = _mm_add_ps(products[2][h], _mm_mul_ps(wz, z));
+					products[3][h] = _mm_add_ps(products[3][h], _mm_mul_ps(wx, y));
+					products[4][h] = _mm_add_ps(products[4][h], _mm_mul_ps(wy, z));
+					products[5][h] = _mm_add_ps(products[5][h], _mm_mul_ps(wz, x));
+				}
+			}
+
+			for (unsigned int r = 0; r < 6; ++r) {
+				_mm_storeu_ps(p_lanes[r], products[r][0]);
+				_mm_storeu_ps(p_lanes[r] + 4, products[r][1]);
+			}
+			ScalarCovariance(p_points, p_weights, p_mean, i, p_end, p_lanes);
+		}
+
+		r2SIMDTargetM("avx2")
+		static void AVX2Covariance(const float* p_points, const float* p_weights, const float* p_mean, unsigned int p_begin, unsigned int p_end, Lanes* p_lanes) {
+			__m256 products[6];
+			for (unsigned int r = 0; r < 6; ++r) {
+				products[r] = _mm256_loadu_ps(p_lanes[r]);
+			}
+
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 mean_x = _mm256_set1_ps(p_mean[0]);
+			const __m256 mean_y = _mm256_set1_ps(p_mean[1]);
+			const __m256 mean_z = _mm256_set1_ps(p_mean[2]);
+			unsigned int i = p_begin;
+			for (; i + K_LANE_COUNT <= p_end; i += K_LANE_COUNT) {
+				__m256 x, y, z;
+				AVX2LoadPoints(p_points + 3 * i, x, y, z);
+				__m256 weight = (p_weights != 0) ? _mm256_loadu_ps(p_weights + i) : one;
+				x = _mm256_sub_ps(x, mean_x);
+				y = _mm256_sub_ps(y, mean_y);
+				z = _mm256_sub_ps(z, mean_z);
+				__m256 wx = _mm256_mul_ps(weight, x), wy = _mm256_mul_ps(weight, y), wz = _mm256_mul_ps(weight, z);
+				products[0] = _mm256_add_ps(products[0], _mm256_mul_ps(wx, x));
+				products[1] = _mm256_add_ps(products[1], _mm256_mul_ps(wy, y));
+				products[2] = _mm256_add_ps(products[2], _mm256_mul_ps(wz, z));
+				products[3] = _mm256_add_ps(products[3], _mm256_mul_ps(wx, y));
+				products[4] = _mm256_add_ps(products[4], _mm256_mul_ps(wy, z));
+				products[5] = _mm256_add_ps(products[5], _mm256_mul_ps(wz, x));
+			}
+
+			for (unsigned int r = 0; r < 6; ++r) {
+				_mm256_storeu_ps(p_lanes[r], products[r]);
+			}
+			ScalarCovariance(p_points, p_weights, p_mean, i, p_end, p_lanes);
+		}
+#endif
+
+
+
+		/**
+		 * Blocks. Every block is reduced into p_stride floats of p_partials, with
+		 * the blocks spread over the threads, and then the blocks are combined.
+		 */
+		template <typename Function>
+		static void ReduceBlocks(unsigned int p_count, unsigned int p_stride, unsigned int p_thread_count, std::vector<float>& p_partials, Function p_function) {
+			unsigned int block_count = (p_count + K_BLOCK_SIZE - 1) / K_BLOCK_SIZE;
+			p_partials.resize(block_count * p_stride);
+
+			Parallel::For(block_count, K_MIN_BLOCKS_PER_THREAD, p_thread_count, [&](std::size_t p_begin, std::size_t p_end) {
+				for (std::size_t b = p_begin; b < p_end; ++b) {
+					unsigned int begin = static_cast<unsigned int>(b) * K_BLOCK_SIZE;
+					unsigned int end = (p_count - begin > K_BLOCK_SIZE) ? begin + K_BLOCK_SIZE : p_count;
+					p_function(begin, end, &p_partials[b * p_stride]);
+				}
+			});
+		}
+
+		static void AddLanes(const Lanes* p_lanes, unsigned int p_rows, float* p_result) {
+			for (unsigned int r = 0; r < p_rows; ++r) {
+				const float* lane = p_lanes[r];
+				p_result[r] = ((lane[0] + lane[1]) + (lane[2] + lane[3])) + ((lane[4] + lane[5]) + (lane[6] + lane[7]));
+			}
+		}
+
+		// adds neighbouring blocks until one is left, which ends up first
+		static void AddBlocks(std::vector<float>& p_partials, unsigned int p_stride) {
+			std::size_t count = p_partials.size() / p_stride;
+			while (count > 1) {
+				for (std::size_t i = 0; i < count / 2; ++i) {
+					for (unsigned int r = 0; r < p_stride; ++r) {
+						p_partials[i * p_stride + r] = p_partials[2 * i * p_stride + r] + p_partials[(2 * i + 1) * p_stride + r];
+					}
+				}
+				if (count % 2 != 0) {
+					for (unsigned int r = 0; r < p_stride; ++r) {
+						p_partials[(count / 2) * p_stride + r] = p_partials[(count - 1) * p_stride + r];
+					}
+				}
+				count = (count + 1) / 2;
+			}
+		}
+
+		// x, y, z and the total weight
+		static void ReduceSum(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count, float* p_result) {
+			const float* points = reinterpret_cast<const float*>(p_points);
+			std::vector<float> partials;
+			ReduceBlocks(p_count, 4, p_thread_count, partials, [&](unsigned int p_begin, unsigned int p_end, float* p_partial) {
+				Lanes lanes[4] = {};
+				unsigned int i = p_begin;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+					AVX2Sum(points, p_weights, p_begin, p_end, lanes);
+					i = p_end;
+				} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+					SSE2Sum(points, p_weights, p_begin, p_end, lanes);
+					i = p_end;
+				}
+#endif
+				ScalarSum(points, p_weights, i, p_end, lanes);
+				AddLanes(lanes, 4, p_partial);
+			});
+
+			AddBlocks(partials, 4);
+			for (unsigned int r = 0; r < 4; ++r) {
+				p_result[r] = partials.empty() ? 0.0f : partials[r];
+			}
+		}
+
+		static Vector3 ReduceMean(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count, SCALAR& p_total_weight) {
+			if (p_count == 0) throw r2ExceptionArgumentM("Mean of no points");
+
+			float sum[4];
+			ReduceSum(p_points, p_weights, p_count, p_thread_count, sum);
+			if (sum[3] == 0.0f) throw r2ExceptionDivisionByZeroM("Weights sum to zero");
+
+			// the point count is exact, the sum of ones per lane stops being so past 2^24
+			p_total_weight = (p_weights != 0) ? sum[3] : static_cast<SCALAR>(p_count);
+			return Vector3(sum[0] / p_total_weight, sum[1] / p_total_weight, sum[2] / p_total_weight);
+		}
+
+		static Matrix3 ReduceCovariance(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count) {
+			SCALAR total_weight;
+			Vector3 mean = ReduceMean(p_points, p_weights, p_count, p_thread_count, total_weight);
+
+			const float* points = reinterpret_cast<const float*>(p_points);
+			std::vector<float> partials;
+			ReduceBlocks(p_count, 6, p_thread_count, partials, [&](unsigned int p_begin, unsigned int p_end, float* p_partial) {
+				Lanes lanes[6] = {};
+				unsigned int i = p_begin;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+					AVX2Covariance(points, p_weights, mean.m_data, p_begin, p_end, lanes);
+					i = p_end;
+				} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+					SSE2Covariance(points, p_weights, mean.m_data, p_begin, p_end, lanes);
+					i = p_end;
+				}
+#endif
+				ScalarCovariance(points, p_weights, mean.m_data, i, p_end, lanes);
+				AddLanes(lanes, 6, p_partial);
+			});
+
+			AddBlocks(partials, 6);
+			const float* products = &partials[0];
+			Matrix3 result(products[0], products[3], products[5],
+						   products[3], products[1], products[4],
+						   products[5], products[4], products[2]);
+			result /= total_weight;
+			return result;
+		}
+
+
+
+		void ComputeBounds(const Vector3* p_points, unsigned int p_count, Vector3& p_min, Vector3& p_max, unsigned int p_thread_count) {
+			if (p_count == 0) throw r2ExceptionArgumentM("Bounds of no points");
+
+			const float* points = reinterpret_cast<const float*>(p_points);
+			std::vector<float> partials;
+			ReduceBlocks(p_count, 6, p_thread_count, partials, [&](unsigned int p_begin, unsigned int p_end, float* p_partial) {
+				Lanes lanes[6];
+				for (unsigned int l = 0; l < K_LANE_COUNT; ++l) {
+					lanes[0][l] = lanes[1][l] = lanes[2][l] = K_LARGE;
+					lanes[3][l] = lanes[4][l] = lanes[5][l] = -K_LARGE;
+				}
+
+				unsigned int i = p_begin;
+#if defined(R2_ARCH_X86)
+				if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+					AVX2Bounds(points, p_begin, p_end, lanes);
+					i = p_end;
+				} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+					SSE2Bounds(points, p_begin, p_end, lanes);
+					i = p_end;
+				}
+#endif
+				ScalarBounds(points, i, p_end, lanes);
+
+				for (unsigned int c = 0; c < 3; ++c) {
+					p_partial[c] = lanes[c][0];
+					p_partial[c + 3] = lanes[c + 3][0];
+					for (unsigned int l = 1; l < K_LANE_COUNT; ++l) {
+						p_partial[c] = (lanes[c][l] < p_partial[c]) ? lanes[c][l] : p_partial[c];
+						p_partial[c + 3] = (lanes[c + 3][l] > p_partial[c + 3]) ? lanes[c + 3][l] : p_partial[c + 3];
+					}
+				}
+			});
+
+			// the order does not matter for min and max
+			for (std::size_t b = 6; b < partials.size(); b += 6) {
+				for (unsigned int c = 0; c < 3; ++c) {
+					partials[c] = (partials[b + c] < partials[c]) ? partials[b + c] : partials[c];
+					partials[c + 3] = (partials[b + c + 3] > partials[c + 3]) ? partials[b + c + 3] : partials[c + 3];
+				}
+			}
+
+			p_min = Vector3(partials[0], partials[1], partials[2]);
+			p_max = Vector3(partials[3], partials[4], partials[5]);
+		}
+
+		Vector3 ComputeSum(const Vector3* p_points, unsigned int p_count, unsigned int p_thread_count) {
+			float sum[4];
+			ReduceSum(p_points, 0, p_count, p_thread_count, sum);
+			return Vector3(sum[0], sum[1], sum[2]);
+		}
+
+		Vector3 ComputeSum(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count) {
+			float sum[4];
+			ReduceSum(p_points, p_weights, p_count, p_thread_count, sum);
+			return Vector3(sum[0], sum[1], sum[2]);
+		}
+
+		Vector3 ComputeMean(const Vector3* p_points, unsigned int p_count, unsigned int p_thread_count) {
+			SCALAR total_weight;
+			return ReduceMean(p_points, 0, p_count, p_thread_count, total_weight);
+		}
+
+		Vector3 ComputeMean(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count) {
+			SCALAR total_weight;
+			return ReduceMean(p_points, p_weights, p_count, p_thread_count, total_weight);
+		}
+
+		Matrix3 ComputeCovariance(const Vector3* p_points, unsigned int p_count, unsigned int p_thread_count) {
+			return ReduceCovariance(p_points, 0, p_count, p_thread_count);
+		}
+
+		Matrix3 ComputeCovariance(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count) {
+			return ReduceCovariance(p_points, p_weights, p_count, p_thread_count);
+		}
+	}
+}
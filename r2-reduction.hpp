@@ -0,0 +1,85 @@
+/* HEADER
+ *
+ * File: r2-reduction.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Reductions over arrays of Vector3: bounds, sums, means and covariance,
+ *	optionally weighted. The points are read 8 at a time (SSE2/AVX2) and
+ *	large arrays are split over threads.
+ *
+ *	The result does not depend on the thread count. The array is cut into
+ *	blocks of a fixed size, every block is summed into 8 lanes (point i
+ *	going to lane i % 8), and the lanes and then the blocks are added
+ *	pairwise in a fixed order. Threads only decide who computes which
+ *	block. The pairwise combining also keeps the rounding error growing
+ *	with the logarithm of the number of blocks instead of linearly.
+ *
+ *	The covariance is computed in two passes, the mean first and then the
+ *	products of the offsets from it, so points far from the origin do not
+ *	lose their precision to cancellation.
+ * Depends on:
+ *  * r2::Exception::Argument, r2::Exception::DivisionByZero
+ *  * r2::Parallel
+ *  * r2::Math::SIMD
+ *  * Vector3, Matrix3
+ * Updates:
+ *
+ */
+#ifndef R2_REDUCTION_HPP
+#define R2_REDUCTION_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-matrix-3.hpp"
+
+namespace r2 {
+	namespace Math {
+		/**
+		 * Get the smallest box containing p_count points. NaN components are
+		 * ignored. Raises an Argument exception if there are no points.
+		 */
+		void ComputeBounds(const Vector3* p_points, unsigned int p_count, Vector3& p_min, Vector3& p_max, unsigned int p_thread_count = 1);
+
+		/**
+		 * Get the sum of p_count points, or of every point times its weight
+		 */
+		Vector3 ComputeSum(const Vector3* p_points, unsigned int p_count, unsigned int p_thread_count = 1);
+		Vector3 ComputeSum(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count = 1);
+
+		/**
+		 * Get the mean (centroid) of p_count points, or their weighted mean.
+		 * Raises an Argument exception if there are no points, and a
+		 * DivisionByZero exception if the weights sum to 0.
+		 */
+		Vector3 ComputeMean(const Vector3* p_points, unsigned int p_count, unsigned int p_thread_count = 1);
+		Vector3 ComputeMean(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count = 1);
+
+		/**
+		 * Get the covariance matrix of p_count points around their (weighted)
+		 * mean, divided by the number of points (the sum of the weights). The
+		 * exceptions are those of ComputeMean.
+		 */
+		Matrix3 ComputeCovariance(const Vector3* p_points, unsigned int p_count, unsigned int p_thread_count = 1);
+		Matrix3 ComputeCovariance(const Vector3* p_points, const SCALAR* p_weights, unsigned int p_count, unsigned int p_thread_count = 1);
+	}
+}
+
+#endif
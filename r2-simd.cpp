@@ -0,0 +1,599 @@
+#include "r2-simd.hpp"
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#if defined(R2_SYSTEM_WINDOWS)
+	#include <malloc.h>
+#endif
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace r2 {
+	namespace Math {
+		namespace SIMD {
+			/**
+			 * Scalar kernels
+			 */
+			static void ScalarVector4Add(float* p_result, const float* p_lhs, const float* p_rhs) {
+				for (int i = 0; i < 4; ++i) {
+					p_result[i] = p_lhs[i] + p_rhs[i];
+				}
+			}
+
+			static void ScalarVector4Subtract(float* p_result, const float* p_lhs, const float* p_rhs) {
+				for (int i = 0; i < 4; ++i) {
+					p_result[i] = p_lhs[i] - p_rhs[i];
+				}
+			}
+
+			static void ScalarVector4Scale(float* p_result, const float* p_lhs, float p_rhs) {
+				for (int i = 0; i < 4; ++i) {
+					p_result[i] = p_lhs[i] * p_rhs;
+				}
+			}
+
+			static float ScalarVector4Dot(const float* p_lhs, const float* p_rhs) {
+				return p_lhs[0] * p_rhs[0] + p_lhs[1] * p_rhs[1] + p_lhs[2] * p_rhs[2] + p_lhs[3] * p_rhs[3];
+			}
+
+			static void ScalarVector4Normalize(float* p_vector) {
+				float length = std::sqrt(ScalarVector4Dot(p_vector, p_vector));
+				for (int i = 0; i < 4; ++i) {
+					p_vector[i] /= length;
+				}
+			}
+
+			static void ScalarMatrix4Add(float* p_result, const float* p_lhs, const float* p_rhs) {
+				for (int i = 0; i < 16; ++i) {
+					p_result[i] = p_lhs[i] + p_rhs[i];
+				}
+			}
+
+			static void ScalarMatrix4Subtract(float* p_result, const float* p_lhs, const float* p_rhs) {
+				for (int i = 0; i < 16; ++i) {
+					p_result[i] = p_lhs[i] - p_rhs[i];
+				}
+			}
+
+			static void ScalarMatrix4Scale(float* p_result, const float* p_lhs, float p_rhs) {
+				for (int i = 0; i < 16; ++i) {
+					p_result[i] = p_lhs[i] * p_rhs;
+				}
+			}
+
+			// Unrolled so that a left hand side row and the right hand side stay in registers
+			static void ScalarMatrix4Multiply(float* p_result, const float* p_lhs, const float* p_rhs) {
+				float result[16];
+				for (int row = 0; row < 16; row += 4) {
+					float lhs_0 = p_lhs[row + 0];
+					float lhs_1 = p_lhs[row + 1];
+					float lhs_2 = p_lhs[row + 2];
+					float lhs_3 = p_lhs[row + 3];
+
+					result[row + 0] = lhs_0 * p_rhs[0] + lhs_1 * p_rhs[4] + lhs_2 * p_rhs[8] + lhs_3 * p_rhs[12];
+					result[row + 1] = lhs_0 * p_rhs[1] + lhs_1 * p_rhs[5] + lhs_2 * p_rhs[9] + lhs_3 * p_rhs[13];
+					result[row + 2] = lhs_0 * p_rhs[2] + lhs_1 * p_rhs[6] + lhs_2 * p_rhs[10] + lhs_3 * p_rhs[14];
+					result[row + 3] = lhs_0 * p_rhs[3] + lhs_1 * p_rhs[7] + lhs_2 * p_rhs[11] + lhs_3 * p_rhs[15];
+				}
+
+				memcpy(p_result, result, sizeof(result));
+			}
+
+			static void ScalarMatrix4MultiplyArray(float* p_result, const float* p_lhs, const float* p_rhs, std::size_t p_count) {
+				for (std::size_t i = 0; i < p_count * 16; i += 16) {
+					ScalarMatrix4Multiply(p_result + i, p_lhs + i, p_rhs + i);
+				}
+			}
+
+			static void ScalarMatrix4Transpose(float* p_result, const float* p_matrix) {
+				float result[16];
+				for (int row = 0; row < 4; ++row) {
+					for (int col = 0; col < 4; ++col) {
+						result[col * 4 + row] = p_matrix[row * 4 + col];
+					}
+				}
+
+				memcpy(p_result, result, sizeof(result));
+			}
+
+			// The inverse is built from the twelve 2x2 sub-determinants of the upper
+			// (s) and lower (c) row pairs, each of which is used several times.
+			static float ScalarMatrix4Invert(float* p_result, const float* p_matrix) {
+				const float* m = p_matrix;
+
+				float s0 = m[0] * m[5] - m[4] * m[1];
+				float s1 = m[0] * m[6] - m[4] * m[2];
+				float s2 = m[0] * m[7] - m[4] * m[3];
+				float s3 = m[1] * m[6] - m[5] * m[2];
+				float s4 = m[1] * m[7] - m[5] * m[3];
+				float s5 = m[2] * m[7] - m[6] * m[3];
+
+				float c5 = m[10] * m[15] - m[14] * m[11];
+				float c4 = m[9] * m[15] - m[13] * m[11];
+				float c3 = m[9] * m[14] - m[13] * m[10];
+				float c2 = m[8] * m[15] - m[12] * m[11];
+				float c1 = m[8] * m[14] - m[12] * m[10];
+				float c0 = m[8] * m[13] - m[12] * m[9];
+
+				float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+				float inverse_determinant = 1.0f / determinant;
+
+				float result[16];
+				result[0] = ( m[5] * c5 - m[6] * c4 + m[7] * c3) * inverse_determinant;
+				result[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * inverse_determinant;
+				result[2] = ( m[13] * s5 - m[14] * s4 + m[15] * s3) * inverse_determinant;
+				result[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * inverse_determinant;
+
+				result[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * inverse_determinant;
+				result[5] = ( m[0] * c5 - m[2] * c2 + m[3] * c1) * inverse_determinant;
+				result[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inverse_determinant;
+				result[7] = ( m[8] * s5 - m[10] * s2 + m[11] * s1) * inverse_determinant;
+
+				result[8] = ( m[4] * c4 - m[5] * c2 + m[7] * c0) * inverse_determinant;
+				result[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * inverse_determinant;
+				result[10] = ( m[12] * s4 - m[13] * s2 + m[15] * s0) * inverse_determinant;
+				result[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * inverse_determinant;
+
+				result[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * inverse_determinant;
+				result[13] = ( m[0] * c3 - m[1] * c1 + m[2] * c0) * inverse_determinant;
+				result[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inverse_determinant;
+				result[15] = ( m[8] * s3 - m[9] * s1 + m[10] * s0) * inverse_determinant;
+
+				memcpy(p_result, result, sizeof(result));
+				return determinant;
+			}
+
+			static const Kernels K_SCALAR_KERNELS = {
+				&ScalarVector4Add,
+				&ScalarVector4Subtract,
+				&ScalarVector4Scale,
+				&ScalarVector4Dot,
+				&ScalarVector4Normalize,
+				&ScalarMatrix4Add,
+				&ScalarMatrix4Subtract,
+				&ScalarMatrix4Scale,
+				&ScalarMatrix4Multiply,
+				&ScalarMatrix4MultiplyArray,
+				&ScalarMatrix4Transpose,
+				&ScalarMatrix4Invert
+			};
+
+
+
+#if defined(R2_ARCH_X86)
+			/**
+			 * SSE2 kernels
+			 */
+			r2SIMDTargetM("sse2")
+			static void SSE2Vector4Add(float* p_result, const float* p_lhs, const float* p_rhs) {
+				_mm_storeu_ps(p_result, _mm_add_ps(_mm_loadu_ps(p_lhs), _mm_loadu_ps(p_rhs)));
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Vector4Subtract(float* p_result, const float* p_lhs, const float* p_rhs) {
+				_mm_storeu_ps(p_result, _mm_sub_ps(_mm_loadu_ps(p_lhs), _mm_loadu_ps(p_rhs)));
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Vector4Scale(float* p_result, const float* p_lhs, float p_rhs) {
+				_mm_storeu_ps(p_result, _mm_mul_ps(_mm_loadu_ps(p_lhs), _mm_set1_ps(p_rhs)));
+			}
+
+			// Sum of the four lanes, broadcast to all lanes.
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2HorizontalSum(__m128 p_value) {
+				__m128 sum = _mm_add_ps(p_value, _mm_shuffle_ps(p_value, p_value, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+			}
+
+			r2SIMDTargetM("sse2")
+			static float SSE2Vector4Dot(const float* p_lhs, const float* p_rhs) {
+				return _mm_cvtss_f32(SSE2HorizontalSum(_mm_mul_ps(_mm_loadu_ps(p_lhs), _mm_loadu_ps(p_rhs))));
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Vector4Normalize(float* p_vector) {
+				__m128 vector = _mm_loadu_ps(p_vector);
+				__m128 length = _mm_sqrt_ps(SSE2HorizontalSum(_mm_mul_ps(vector, vector)));
+				_mm_storeu_ps(p_vector, _mm_div_ps(vector, length));
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Matrix4Add(float* p_result, const float* p_lhs, const float* p_rhs) {
+				for (int i = 0; i < 16; i += 4) {
+					_mm_storeu_ps(p_result + i, _mm_add_ps(_mm_loadu_ps(p_lhs + i), _mm_loadu_ps(p_rhs + i)));
+				}
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Matrix4Subtract(float* p_result, const float* p_lhs, const float* p_rhs) {
+				for (int i = 0; i < 16; i += 4) {
+					_mm_storeu_ps(p_result + i, _mm_sub_ps(_mm_loadu_ps(p_lhs + i), _mm_loadu_ps(p_rhs + i)));
+				}
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Matrix4Scale(float* p_result, const float* p_lhs, float p_rhs) {
+				__m128 scale = _mm_set1_ps(p_rhs);
+				for (int i = 0; i < 16; i += 4) {
+					_mm_storeu_ps(p_result + i, _mm_mul_ps(_mm_loadu_ps(p_lhs + i), scale));
+				}
+			}
+
+			// Each result row is a linear combination of the rows of the right hand side,
+			// weighted by the elements of the corresponding left hand side row.
+			r2SIMDTargetM("sse2")
+			static void SSE2Matrix4Multiply(float* p_result, const float* p_lhs, const float* p_rhs) {
+				__m128 rhs_0 = _mm_loadu_ps(p_rhs + 0);
+				__m128 rhs_1 = _mm_loadu_ps(p_rhs + 4);
+				__m128 rhs_2 = _mm_loadu_ps(p_rhs + 8);
+				__m128 rhs_3 = _mm_loadu_ps(p_rhs + 12);
+
+				for (int row = 0; row < 16; row += 4) {
+					__m128 lhs = _mm_loadu_ps(p_lhs + row);
+					__m128 result = _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(0, 0, 0, 0)), rhs_0);
+					result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(1, 1, 1, 1)), rhs_1));
+					result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(2, 2, 2, 2)), rhs_2));
+					result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(3, 3, 3, 3)), rhs_3));
+					_mm_storeu_ps(p_result + row, result);
+				}
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Matrix4MultiplyArray(float* p_result, const float* p_lhs, const float* p_rhs, std::size_t p_count) {
+				for (std::size_t i = 0; i < p_count * 16; i += 16) {
+					SSE2Matrix4Multiply(p_result + i, p_lhs + i, p_rhs + i);
+				}
+			}
+
+			r2SIMDTargetM("sse2")
+			static void SSE2Matrix4Transpose(float* p_result, const float* p_matrix) {
+				__m128 row_0 = _mm_loadu_ps(p_matrix + 0);
+				__m128 row_1 = _mm_loadu_ps(p_matrix + 4);
+				__m128 row_2 = _mm_loadu_ps(p_matrix + 8);
+				__m128 row_3 = _mm_loadu_ps(p_matrix + 12);
+
+				_MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+				_mm_storeu_ps(p_result + 0, row_0);
+				_mm_storeu_ps(p_result + 4, row_1);
+				_mm_storeu_ps(p_result + 8, row_2);
+				_mm_storeu_ps(p_result + 12, row_3);
+			}
+
+			// Shuffles for the block inverse below. The matrix is split into the 2x2
+			// blocks A B / C D, each stored row order in one register.
+			#define r2Swizzle(p_vector, p_x, p_y, p_z, p_w) _mm_shuffle_ps(p_vector, p_vector, _MM_SHUFFLE(p_w, p_z, p_y, p_x))
+			#define r2Shuffle(p_lhs, p_rhs, p_x, p_y, p_z, p_w) _mm_shuffle_ps(p_lhs, p_rhs, _MM_SHUFFLE(p_w, p_z, p_y, p_x))
+
+			// 2x2 block product A * B
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Matrix2Multiply(__m128 p_lhs, __m128 p_rhs) {
+				return _mm_add_ps(_mm_mul_ps(p_lhs, r2Swizzle(p_rhs, 0, 3, 0, 3)),
+								  _mm_mul_ps(r2Swizzle(p_lhs, 1, 0, 3, 2), r2Swizzle(p_rhs, 2, 1, 2, 1)));
+			}
+
+			// 2x2 block product adj(A) * B
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Matrix2AdjugateMultiply(__m128 p_lhs, __m128 p_rhs) {
+				return _mm_sub_ps(_mm_mul_ps(r2Swizzle(p_lhs, 3, 3, 0, 0), p_rhs),
+								  _mm_mul_ps(r2Swizzle(p_lhs, 1, 1, 2, 2), r2Swizzle(p_rhs, 2, 3, 0, 1)));
+			}
+
+			// 2x2 block product A * adj(B)
+			r2SIMDTargetM("sse2")
+			static inline __m128 SSE2Matrix2MultiplyAdjugate(__m128 p_lhs, __m128 p_rhs) {
+				return _mm_sub_ps(_mm_mul_ps(p_lhs, r2Swizzle(p_rhs, 3, 0, 3, 0)),
+								  _mm_mul_ps(r2Swizzle(p_lhs, 1, 0, 3, 2), r2Swizzle(p_rhs, 2, 1, 2, 1)));
+			}
+
+			r2SIMDTargetM("sse2")
+			static float SSE2Matrix4Invert(float* p_result, const float* p_matrix) {
+				__m128 row_0 = _mm_loadu_ps(p_matrix + 0);
+				__m128 row_1 = _mm_loadu_ps(p_matrix + 4);
+				__m128 row_2 = _mm_loadu_ps(p_matrix + 8);
+				__m128 row_3 = _mm_loadu_ps(p_matrix + 12);
+
+				__m128 a = _mm_movelh_ps(row_0, row_1);
+				__m128 b = _mm_movehl_ps(row_1, row_0);
+				__m128 c = _mm_movelh_ps(row_2, row_3);
+				__m128 d = _mm_movehl_ps(row_3, row_2);
+
+				// the determinants of the blocks: (|A|, |B|, |C|, |D|)
+				__m128 block_determinants = _mm_sub_ps(
+					_mm_mul_ps(r2Shuffle(row_0, row_2, 0, 2, 0, 2), r2Shuffle(row_1, row_3, 1, 3, 1, 3)),
+					_mm_mul_ps(r2Shuffle(row_0, row_2, 1, 3, 1, 3), r2Shuffle(row_1, row_3, 0, 2, 0, 2)));
+				__m128 determinant_a = r2Swizzle(block_determinants, 0, 0, 0, 0);
+				__m128 determinant_b = r2Swizzle(block_determinants, 1, 1, 1, 1);
+				__m128 determinant_c = r2Swizzle(block_determinants, 2, 2, 2, 2);
+				__m128 determinant_d = r2Swizzle(block_determinants, 3, 3, 3, 3);
+
+				__m128 adj_d_c = SSE2Matrix2AdjugateMultiply(d, c);
+				__m128 adj_a_b = SSE2Matrix2AdjugateMultiply(a, b);
+
+				// the adjugates of the blocks of the inverse
+				__m128 x = _mm_sub_ps(_mm_mul_ps(determinant_d, a), SSE2Matrix2Multiply(b, adj_d_c));
+				__m128 w = _mm_sub_ps(_mm_mul_ps(determinant_a, d), SSE2Matrix2Multiply(c, adj_a_b));
+				__m128 y = _mm_sub_ps(_mm_mul_ps(determinant_b, c), SSE2Matrix2MultiplyAdjugate(d, adj_a_b));
+				__m128 z = _mm_sub_ps(_mm_mul_ps(determinant_c, b), SSE2Matrix2MultiplyAdjugate(a, adj_d_c));
+
+				// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+				__m128 determinant = _mm_add_ps(_mm_mul_ps(determinant_a, determinant_d), _mm_mul_ps(determinant_b, determinant_c));
+				determinant = _mm_sub_ps(determinant, SSE2HorizontalSum(_mm_mul_ps(adj_a_b, r2Swizzle(adj_d_c, 0, 2, 1, 3))));
+
+				__m128 inverse_determinant = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+				x = _mm_mul_ps(x, inverse_determinant);
+				y = _mm_mul_ps(y, inverse_determinant);
+				z = _mm_mul_ps(z, inverse_determinant);
+				w = _mm_mul_ps(w, inverse_determinant);
+
+				// the final shuffles take the adjugates and put the blocks back into rows
+				_mm_storeu_ps(p_result + 0, r2Shuffle(x, y, 3, 1, 3, 1));
+				_mm_storeu_ps(p_result + 4, r2Shuffle(x, y, 2, 0, 2, 0));
+				_mm_storeu_ps(p_result + 8, r2Shuffle(z, w, 3, 1, 3, 1));
+				_mm_storeu_ps(p_result + 12, r2Shuffle(z, w, 2, 0, 2, 0));
+
+				return _mm_cvtss_f32(determinant);
+			}
+
+			#undef r2Swizzle
+			#undef r2Shuffle
+
+			static const Kernels K_SSE2_KERNELS = {
+				&SSE2Vector4Add,
+				&SSE2Vector4Subtract,
+				&SSE2Vector4Scale,
+				&SSE2Vector4Dot,
+				&SSE2Vector4Normalize,
+				&SSE2Matrix4Add,
+				&SSE2Matrix4Subtract,
+				&SSE2Matrix4Scale,
+				&SSE2Matrix4Multiply,
+				&SSE2Matrix4MultiplyArray,
+				&SSE2Matrix4Transpose,
+				&SSE2Matrix4Invert
+			};
+
+
+
+			/**
+			 * SSE4.1 kernels - the dot product instruction replaces the shuffles
+			 */
+			r2SIMDTargetM("sse4.1")
+			static float SSE41Vector4Dot(const float* p_lhs, const float* p_rhs) {
+				return _mm_cvtss_f32(_mm_dp_ps(_mm_loadu_ps(p_lhs), _mm_loadu_ps(p_rhs), 0xF1));
+			}
+
+			r2SIMDTargetM("sse4.1")
+			static void SSE41Vector4Normalize(float* p_vector) {
+				__m128 vector = _mm_loadu_ps(p_vector);
+				__m128 length = _mm_sqrt_ps(_mm_dp_ps(vector, vector, 0xFF));
+				_mm_storeu_ps(p_vector, _mm_div_ps(vector, length));
+			}
+
+			static const Kernels K_SSE41_KERNELS = {
+				&SSE2Vector4Add,
+				&SSE2Vector4Subtract,
+				&SSE2Vector4Scale,
+				&SSE41Vector4Dot,
+				&SSE41Vector4Normalize,
+				&SSE2Matrix4Add,
+				&SSE2Matrix4Subtract,
+				&SSE2Matrix4Scale,
+				&SSE2Matrix4Multiply,
+				&SSE2Matrix4MultiplyArray,
+				&SSE2Matrix4Transpose,
+				&SSE2Matrix4Invert
+			};
+
+
+
+			/**
+			 * AVX2 kernels - matrices are processed two rows at a time
+			 */
+			r2SIMDTargetM("avx2")
+			static void AVX2Matrix4Add(float* p_result, const float* p_lhs, const float* p_rhs) {
+				__m256 top = _mm256_add_ps(_mm256_loadu_ps(p_lhs + 0), _mm256_loadu_ps(p_rhs + 0));
+				__m256 bottom = _mm256_add_ps(_mm256_loadu_ps(p_lhs + 8), _mm256_loadu_ps(p_rhs + 8));
+				_mm256_storeu_ps(p_result + 0, top);
+				_mm256_storeu_ps(p_result + 8, bottom);
+			}
+
+			r2SIMDTargetM("avx2")
+			static void AVX2Matrix4Subtract(float* p_result, const float* p_lhs, const float* p_rhs) {
+				__m256 top = _mm256_sub_ps(_mm256_loadu_ps(p_lhs + 0), _mm256_loadu_ps(p_rhs + 0));
+				__m256 bottom = _mm256_sub_ps(_mm256_loadu_ps(p_lhs + 8), _mm256_loadu_ps(p_rhs + 8));
+				_mm256_storeu_ps(p_result + 0, top);
+				_mm256_storeu_ps(p_result + 8, bottom);
+			}
+
+			r2SIMDTargetM("avx2")
+			static void AVX2Matrix4Scale(float* p_result, const float* p_lhs, float p_rhs) {
+				__m256 scale = _mm256_set1_ps(p_rhs);
+				__m256 top = _mm256_mul_ps(_mm256_loadu_ps(p_lhs + 0), scale);
+				__m256 bottom = _mm256_mul_ps(_mm256_loadu_ps(p_lhs + 8), scale);
+				_mm256_storeu_ps(p_result + 0, top);
+				_mm256_storeu_ps(p_result + 8, bottom);
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static void AVX2Matrix4Multiply(float* p_result, const float* p_lhs, const float* p_rhs) {
+				// every right hand side row duplicated into both 128-bit lanes
+				__m256 rhs_0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p_rhs + 0));
+				__m256 rhs_1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p_rhs + 4));
+				__m256 rhs_2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p_rhs + 8));
+				__m256 rhs_3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p_rhs + 12));
+
+				for (int row = 0; row < 16; row += 8) {
+					__m256 lhs = _mm256_loadu_ps(p_lhs + row);
+					__m256 result = _mm256_mul_ps(_mm256_shuffle_ps(lhs, lhs, _MM_SHUFFLE(0, 0, 0, 0)), rhs_0);
+					result = _mm256_fmadd_ps(_mm256_shuffle_ps(lhs, lhs, _MM_SHUFFLE(1, 1, 1, 1)), rhs_1, result);
+					result = _mm256_fmadd_ps(_mm256_shuffle_ps(lhs, lhs, _MM_SHUFFLE(2, 2, 2, 2)), rhs_2, result);
+					result = _mm256_fmadd_ps(_mm256_shuffle_ps(lhs, lhs, _MM_SHUFFLE(3, 3, 3, 3)), rhs_3, result);
+					_mm256_storeu_ps(p_result + row, result);
+				}
+			}
+
+			r2SIMDTargetM("avx2,fma")
+			static void AVX2Matrix4MultiplyArray(float* p_result, const float* p_lhs, const float* p_rhs, std::size_t p_count) {
+				for (std::size_t i = 0; i < p_count * 16; i += 16) {
+					AVX2Matrix4Multiply(p_result + i, p_lhs + i, p_rhs + i);
+				}
+			}
+
+			static const Kernels K_AVX2_KERNELS = {
+				&SSE2Vector4Add,
+				&SSE2Vector4Subtract,
+				&SSE2Vector4Scale,
+				&SSE41Vector4Dot,
+				&SSE41Vector4Normalize,
+				&AVX2Matrix4Add,
+				&AVX2Matrix4Subtract,
+				&AVX2Matrix4Scale,
+				&AVX2Matrix4Multiply,
+				&AVX2Matrix4MultiplyArray,
+				&SSE2Matrix4Transpose,
+				&SSE2Matrix4Invert
+			};
+
+
+
+			/**
+			 * Processor queries
+			 */
+			static void CPUID(unsigned int p_leaf, unsigned int p_subleaf, unsigned int p_registers[4]) {
+	#if defined(_MSC_VER)
+				int registers[4];
+				__cpuidex(registers, static_cast<int>(p_leaf), static_cast<int>(p_subleaf));
+				for (int i = 0; i < 4; ++i) {
+					p_registers[i] = static_cast<unsigned int>(registers[i]);
+				}
+	#else
+				if (p_leaf > __get_cpuid_max(0, 0)) {
+					p_registers[0] = p_registers[1] = p_registers[2] = p_registers[3] = 0;
+					return;
+				}
+
+				__cpuid_count(p_leaf, p_subleaf, p_registers[0], p_registers[1], p_registers[2], p_registers[3]);
+	#endif
+			}
+
+			// The extended control register tells which register states the OS saves on a context switch.
+			static unsigned long long XGETBV() {
+	#if defined(_MSC_VER)
+				return _xgetbv(0);
+	#else
+				unsigned int eax, edx;
+				__asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+				return (static_cast<unsigned long long>(edx) << 32) | eax;
+	#endif
+			}
+#endif
+
+
+
+			/**
+			 * Selection
+			 */
+			namespace priv {
+				const Kernels* g_active_kernels = &K_SCALAR_KERNELS;
+			}
+
+			static InstructionSet::InstructionSet s_instruction_set = InstructionSet::Scalar;
+
+			InstructionSet::InstructionSet DetectInstructionSet() {
+#if defined(R2_ARCH_X86)
+				unsigned int features[4];
+				CPUID(1, 0, features);
+
+				const unsigned int edx = features[3];
+				const unsigned int ecx = features[2];
+
+				if (!(edx & (1u << 26))) return InstructionSet::Scalar;
+				if (!(ecx & (1u << 19))) return InstructionSet::SSE2;
+
+				// AVX2 additionally needs the OS to preserve the YMM registers
+				const bool osxsave = (ecx & (1u << 27)) != 0;
+				const bool avx = (ecx & (1u << 28)) != 0;
+				const bool fma = (ecx & (1u << 12)) != 0;
+				const bool f16c = (ecx & (1u << 29)) != 0;
+				if (!osxsave || !avx || !fma || !f16c) return InstructionSet::SSE41;
+				if ((XGETBV() & 0x6) != 0x6) return InstructionSet::SSE41;
+
+				unsigned int extended_features[4];
+				CPUID(7, 0, extended_features);
+				if (!(extended_features[1] & (1u << 5))) return InstructionSet::SSE41;
+
+				return InstructionSet::AVX2;
+#else
+				return InstructionSet::Scalar;
+#endif
+			}
+
+			InstructionSet::InstructionSet GetInstructionSet() {
+				return s_instruction_set;
+			}
+
+			void SetInstructionSet(InstructionSet::InstructionSet p_set) {
+				InstructionSet::InstructionSet supported = DetectInstructionSet();
+				if (p_set > supported) p_set = supported;
+
+				switch (p_set) {
+#if defined(R2_ARCH_X86)
+					case InstructionSet::AVX2: priv::g_active_kernels = &K_AVX2_KERNELS; break;
+					case InstructionSet::SSE41: priv::g_active_kernels = &K_SSE41_KERNELS; break;
+					case InstructionSet::SSE2: priv::g_active_kernels = &K_SSE2_KERNELS; break;
+#endif
+					default: priv::g_active_kernels = &K_SCALAR_KERNELS; break;
+				}
+
+				s_instruction_set = p_set;
+			}
+
+			void* AllocateAligned(std::size_t p_size, std::size_t p_alignment) {
+				if (p_size == 0) p_size = p_alignment;
+
+#if defined(R2_SYSTEM_WINDOWS)
+				void* memory = _aligned_malloc(p_size, p_alignment);
+#else
+				void* memory = 0;
+				if (posix_memalign(&memory, p_alignment, p_size) != 0) memory = 0;
+#endif
+				if (memory == 0) throw std::bad_alloc();
+
+				return memory;
+			}
+
+			void FreeAligned(void* p_memory) {
+#if defined(R2_SYSTEM_WINDOWS)
+				_aligned_free(p_memory);
+#else
+				free(p_memory);
+#endif
+			}
+
+			// Pick the best kernels at startup. With GCC and Clang this runs ahead of
+			// every C++ static initializer; elsewhere, math done by static
+			// initializers running before this uses the scalar kernels.
+#if defined(__GNUC__)
+			__attribute__((constructor(101))) static void SelectKernels() {
+				SetInstructionSet(DetectInstructionSet());
+			}
+#else
+			static struct KernelSelector {
+				KernelSelector() {
+					SetInstructionSet(DetectInstructionSet());
+				}
+			} s_kernel_selector;
+#endif
+		}
+	}
+}
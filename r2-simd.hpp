@@ -0,0 +1,146 @@
+/* HEADER
+ *
+ * File: r2-simd.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Runtime selection of SIMD kernels for the math module. The instruction
+ *	set is determined once at startup (via cpuid on x86) and a table of
+ *	kernel functions is chosen accordingly. Until the selection has run,
+ *	and on platforms without SIMD support, the scalar kernels are used.
+ *
+ *	The kernels work on raw float arrays so that the public math types
+ *	can keep their union layout. They assume SCALAR is float.
+ * Depends on:
+ *  * r2-global.hpp (R2_ARCH_X86)
+ *  * SCALAR
+ * Updates:
+ *	2026-10-17 (Rarosu) - AVX2 now also requires F16C
+ *	2026-10-17 (Rarosu) - Kernels are selected ahead of C++ static initializers with GCC and Clang
+ */
+#ifndef R2_SIMD_HPP
+#define R2_SIMD_HPP
+
+#include <cstddef>
+#include "r2-global.hpp"
+#include "r2-math-generic.hpp"
+
+// Mark a function as compiled for a specific instruction set, so that it
+// can live in the same translation unit as the generic code.
+#if defined(R2_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define r2SIMDTargetM(p_target) __attribute__((target(p_target)))
+#else
+	#define r2SIMDTargetM(p_target)
+#endif
+
+namespace r2 {
+	namespace Math {
+		namespace SIMD {
+			namespace InstructionSet {
+				/**
+				 * The instruction sets are ordered, so that every set implies
+				 * the availability of all sets before it. AVX2 also implies FMA and
+				 * F16C (half precision conversion).
+				 */
+				enum InstructionSet { Scalar, SSE2, SSE41, AVX2 };
+			}
+
+			/**
+			 * A table of kernels for a specific instruction set. All matrices are
+			 * 16 floats in row order, all vectors 4 floats. The result pointer
+			 * may alias any of the operands.
+			 */
+			struct Kernels {
+				void (*m_vector4_add)(float* p_result, const float* p_lhs, const float* p_rhs);
+				void (*m_vector4_subtract)(float* p_result, const float* p_lhs, const float* p_rhs);
+				void (*m_vector4_scale)(float* p_result, const float* p_lhs, float p_rhs);
+				float (*m_vector4_dot)(const float* p_lhs, const float* p_rhs);
+				void (*m_vector4_normalize)(float* p_vector);
+
+				void (*m_matrix4_add)(float* p_result, const float* p_lhs, const float* p_rhs);
+				void (*m_matrix4_subtract)(float* p_result, const float* p_lhs, const float* p_rhs);
+				void (*m_matrix4_scale)(float* p_result, const float* p_lhs, float p_rhs);
+				void (*m_matrix4_multiply)(float* p_result, const float* p_lhs, const float* p_rhs);
+				void (*m_matrix4_multiply_array)(float* p_result, const float* p_lhs, const float* p_rhs, std::size_t p_count);
+				void (*m_matrix4_transpose)(float* p_result, const float* p_matrix);
+
+				/**
+				 * Writes the inverse and returns the determinant. If the determinant
+				 * is zero the written result is meaningless.
+				 */
+				float (*m_matrix4_invert)(float* p_result, const float* p_matrix);
+			};
+
+			/**
+			 * Query the processor for the best instruction set it (and the operating
+			 * system) supports.
+			 */
+			InstructionSet::InstructionSet DetectInstructionSet();
+
+			/**
+			 * Get the instruction set the active kernels were chosen for.
+			 */
+			InstructionSet::InstructionSet GetInstructionSet();
+
+			/**
+			 * Select the kernels for the given instruction set. The set is clamped
+			 * to what the processor supports, so it can only be used to step down
+			 * (e.g. to compare against the scalar path).
+			 */
+			void SetInstructionSet(InstructionSet::InstructionSet p_set);
+
+			/**
+			 * Get the active kernels.
+			 */
+			inline const Kernels& GetKernels();
+
+
+			/**
+			 * The alignment (in bytes) that lets every kernel use aligned loads.
+			 */
+			const std::size_t K_ALIGNMENT = 32;
+
+			/**
+			 * Allocate memory aligned to p_alignment bytes (a power of two). Throws
+			 * std::bad_alloc on failure. Free it with FreeAligned.
+			 */
+			void* AllocateAligned(std::size_t p_size, std::size_t p_alignment = K_ALIGNMENT);
+
+			/**
+			 * Free memory allocated with AllocateAligned. Null pointers are ignored.
+			 */
+			void FreeAligned(void* p_memory);
+
+
+			namespace priv {
+				extern const Kernels* g_active_kernels;
+			}
+
+			/**
+			 * IMPLEMENTATION
+			 */
+			inline const Kernels& GetKernels() {
+				return *priv::g_active_kernels;
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,364 @@
+#include "r2-spline.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		// the batches write the vectors as a flat array of components
+		static_assert(sizeof(Vector2) == 2 * sizeof(float) && sizeof(Vector3) == 3 * sizeof(float) && sizeof(Vector4) == 4 * sizeof(float), "Vectors must be tightly packed floats");
+
+		// a, b, c and d of 4 components each
+		static const unsigned int K_COEFFICIENT_STRIDE = 16;
+
+		// the distances converted to parameters at a time by EvaluateAtDistance
+		static const unsigned int K_DISTANCE_BATCH_SIZE = 256;
+
+		template <typename VectorType> const unsigned int Spline<VectorType>::K_DIMENSIONS;
+		template <typename VectorType> const unsigned int Spline<VectorType>::K_ARC_LENGTH_SAMPLES;
+
+		// clamps p_u to the spline, a NaN to 0, and splits it into a segment and t in [0, 1]
+		static inline unsigned int FindSegment(float p_u, unsigned int p_segment_count, float& p_t) {
+			float end = static_cast<float>(p_segment_count);
+			float u = (p_u > 0.0f) ? p_u : 0.0f;
+			u = (u < end) ? u : end;
+
+			unsigned int segment = static_cast<unsigned int>(u);
+			segment = (segment < p_segment_count - 1) ? segment : p_segment_count - 1;
+			p_t = u - static_cast<float>(segment);
+			return segment;
+		}
+
+		template <unsigned int D>
+		static void ScalarEvaluate(const float* p_coefficients, unsigned int p_segment_count, const float* p_u, unsigned int p_begin, unsigned int p_end, float* p_result) {
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				float t;
+				const float* coefficients = p_coefficients + FindSegment(p_u[i], p_segment_count, t) * K_COEFFICIENT_STRIDE;
+				for (unsigned int c = 0; c < D; ++c) {
+					p_result[i * D + c] = ((coefficients[12 + c] * t + coefficients[8 + c]) * t + coefficients[4 + c]) * t + coefficients[c];
+				}
+			}
+		}
+
+		template <unsigned int D>
+		static inline void EvaluateDerivativeAt(const float* p_coefficients, float p_t, float* p_result) {
+			for (unsigned int c = 0; c < D; ++c) {
+				p_result[c] = (3.0f * p_coefficients[12 + c] * p_t + 2.0f * p_coefficients[8 + c]) * p_t + p_coefficients[4 + c];
+			}
+		}
+
+		template <unsigned int D>
+		static inline float Speed(const float* p_coefficients, float p_t) {
+			float derivative[D];
+			EvaluateDerivativeAt<D>(p_coefficients, p_t, derivative);
+
+			float speed_squared = 0.0f;
+			for (unsigned int c = 0; c < D; ++c) {
+				speed_squared += derivative[c] * derivative[c];
+			}
+
+			return std::sqrt(speed_squared);
+		}
+
+#if defined(R2_ARCH_X86)
+		// stores the first D components, without touching the vector after it
+		template <unsigned int D>
+		r2SIMDTargetM("sse2")
+		static inline void SSE2Store(float* p_result, __m128 p_value) {
+			if (D == 4) {
+				_mm_storeu_ps(p_result, p_value);
+			} else {
+				_mm_storel_pi(reinterpret_cast<__m64*>(p_result), p_value);
+				if (D == 3) _mm_store_ss(p_result + 2, _mm_movehl_ps(p_value, p_value));
+			}
+		}
+
+		/**
+		 * The components of a segment fill one register, so each step of Horner's
+		 * method is one multiply and one add for the whole vector.
+		 */
+		template <unsigned int D>
+		r2SIMDTargetM("sse2")
+		static void SSE2Evaluate(const float* p_coefficients, unsigned int p_segment_count, const float* p_u, unsigned int p_count, float* p_result) {
+			for (unsigned int i = 0; i < p_count; ++i) {
+				float t;
+				const float* coefficients = p_coefficients + FindSegment(p_u[i], p_segment_count, t) * K_COEFFICIENT_STRIDE;
+				__m128 tt = _mm_set1_ps(t);
+				__m128 value = _mm_add_ps(_mm_mul_ps(_mm_load_ps(coefficients + 12), tt), _mm_load_ps(coefficients + 8));
+				value = _mm_add_ps(_mm_mul_ps(value, tt), _mm_load_ps(coefficients + 4));
+				value = _mm_add_ps(_mm_mul_ps(value, tt), _mm_load_ps(coefficients));
+				SSE2Store<D>(p_result + i * D, value);
+			}
+		}
+#endif
+
+		template <unsigned int D>
+		static void EvaluateBatch(const float* p_coefficients, unsigned int p_segment_count, const float* p_u, unsigned int p_count, float* p_result) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+				SSE2Evaluate<D>(p_coefficients, p_segment_count, p_u, p_count, p_result);
+				i = p_count;
+			}
+#endif
+			ScalarEvaluate<D>(p_coefficients, p_segment_count, p_u, i, p_count, p_result);
+		}
+
+
+
+		// a segment's coefficients fill one line, so line aligned storage keeps them in one
+		static const std::size_t K_COEFFICIENT_ALIGNMENT = K_COEFFICIENT_STRIDE * sizeof(float);
+
+		template <typename VectorType>
+		Spline<VectorType>::Spline()
+			: m_coefficients(0), m_segment_count(0) {}
+
+		template <typename VectorType>
+		Spline<VectorType>::Spline(const Spline& p_spline)
+			: m_coefficients(0), m_segment_count(0) {
+			*this = p_spline;
+		}
+
+		template <typename VectorType>
+		Spline<VectorType>::~Spline() {
+			SIMD::FreeAligned(m_coefficients);
+		}
+
+		template <typename VectorType>
+		Spline<VectorType>& Spline<VectorType>::operator=(const Spline& p_spline) {
+			if (this == &p_spline) return *this;
+
+			AllocateSegments(p_spline.m_segment_count);
+			std::copy(p_spline.m_coefficients, p_spline.m_coefficients + m_segment_count * K_COEFFICIENT_STRIDE, m_coefficients);
+			m_lengths = p_spline.m_lengths;
+			m_speeds = p_spline.m_speeds;
+			m_distance_index = p_spline.m_distance_index;
+			return *this;
+		}
+
+		// Replaces the coefficients with zeroed ones for p_segment_count segments
+		template <typename VectorType>
+		void Spline<VectorType>::AllocateSegments(unsigned int p_segment_count) {
+			float* coefficients = 0;
+			if (p_segment_count != 0) {
+				coefficients = static_cast<float*>(SIMD::AllocateAligned(p_segment_count * K_COEFFICIENT_STRIDE * sizeof(float), K_COEFFICIENT_ALIGNMENT));
+				std::fill(coefficients, coefficients + p_segment_count * K_COEFFICIENT_STRIDE, 0.0f);
+			}
+
+			SIMD::FreeAligned(m_coefficients);
+			m_coefficients = coefficients;
+			m_segment_count = p_segment_count;
+		}
+
+		template <typename VectorType>
+		void Spline<VectorType>::BuildCatmullRom(const VectorType* p_points, unsigned int p_count) {
+			if (p_count < 2) throw r2ExceptionArgumentM("A Catmull-Rom spline needs at least 2 points");
+
+			AllocateSegments(p_count - 1);
+
+			VectorType tangent;
+			for (unsigned int c = 0; c < K_DIMENSIONS; ++c) {
+				tangent.m_data[c] = 0.5f * (p_points[1].m_data[c] - p_points[0].m_data[c]);
+			}
+
+			for (unsigned int i = 0; i < m_segment_count; ++i) {
+				const VectorType& next = p_points[(i + 2 < p_count) ? i + 2 : i + 1];
+				VectorType next_tangent;
+				for (unsigned int c = 0; c < K_DIMENSIONS; ++c) {
+					next_tangent.m_data[c] = 0.5f * (next.m_data[c] - p_points[i].m_data[c]);
+				}
+
+				BuildSegment(i, p_points[i], tangent, p_points[i + 1], next_tangent);
+				tangent = next_tangent;
+			}
+
+			BuildArcLengthTable();
+		}
+
+		// the Hermite tangents of a Bezier segment are 3 times its first and last legs
+		template <typename VectorType>
+		void Spline<VectorType>::BuildBezier(const VectorType* p_points, unsigned int p_count) {
+			if (p_count < 4 || (p_count - 1) % 3 != 0) throw r2ExceptionArgumentM("A Bezier spline needs 3n + 1 control points");
+
+			AllocateSegments((p_count - 1) / 3);
+
+			for (unsigned int i = 0; i < m_segment_count; ++i) {
+				const VectorType* points = p_points + 3 * i;
+				VectorType from_tangent, to_tangent;
+				for (unsigned int c = 0; c < K_DIMENSIONS; ++c) {
+					from_tangent.m_data[c] = 3.0f * (points[1].m_data[c] - points[0].m_data[c]);
+					to_tangent.m_data[c] = 3.0f * (points[3].m_data[c] - points[2].m_data[c]);
+				}
+
+				BuildSegment(i, points[0], from_tangent, points[3], to_tangent);
+			}
+
+			BuildArcLengthTable();
+		}
+
+		template <typename VectorType>
+		void Spline<VectorType>::BuildHermite(const VectorType* p_points, const VectorType* p_tangents, unsigned int p_count) {
+			if (p_count < 2) throw r2ExceptionArgumentM("A Hermite spline needs at least 2 points");
+
+			AllocateSegments(p_count - 1);
+
+			for (unsigned int i = 0; i < m_segment_count; ++i) {
+				BuildSegment(i, p_points[i], p_tangents[i], p_points[i + 1], p_tangents[i + 1]);
+			}
+
+			BuildArcLengthTable();
+		}
+
+		template <typename VectorType>
+		unsigned int Spline<VectorType>::GetSegmentCount() const {
+			return m_segment_count;
+		}
+
+		template <typename VectorType>
+		SCALAR Spline<VectorType>::GetLength() const {
+			return m_lengths.empty() ? 0.0f : m_lengths.back();
+		}
+
+		template <typename VectorType>
+		VectorType Spline<VectorType>::Evaluate(SCALAR p_u) const {
+			if (m_segment_count == 0) throw r2ExceptionLogicM("Evaluating an empty spline");
+
+			VectorType result;
+			ScalarEvaluate<K_DIMENSIONS>(m_coefficients, m_segment_count, &p_u, 0, 1, result.m_data);
+			return result;
+		}
+
+		template <typename VectorType>
+		VectorType Spline<VectorType>::EvaluateDerivative(SCALAR p_u) const {
+			if (m_segment_count == 0) throw r2ExceptionLogicM("Evaluating an empty spline");
+
+			float t;
+			const float* coefficients = &m_coefficients[FindSegment(p_u, m_segment_count, t) * K_COEFFICIENT_STRIDE];
+
+			VectorType result;
+			EvaluateDerivativeAt<K_DIMENSIONS>(coefficients, t, result.m_data);
+			return result;
+		}
+
+		template <typename VectorType>
+		void Spline<VectorType>::Evaluate(const SCALAR* p_u, unsigned int p_count, VectorType* p_result) const {
+			if (p_count == 0) return;
+			if (m_segment_count == 0) throw r2ExceptionLogicM("Evaluating an empty spline");
+
+			EvaluateBatch<K_DIMENSIONS>(m_coefficients, m_segment_count, p_u, p_count, reinterpret_cast<float*>(p_result));
+		}
+
+		/**
+		 * The sample before the distance is found through the distance index, and
+		 * the parameter is interpolated between it and the next with a cubic that
+		 * has the inverse speed as its slope at both ends. The slopes are limited to
+		 * 3 times the straight line's (Fritsch-Carlson), which keeps the parameter
+		 * increasing with the distance.
+		 */
+		template <typename VectorType>
+		SCALAR Spline<VectorType>::GetParameter(SCALAR p_distance) const {
+			if (m_segment_count == 0) throw r2ExceptionLogicM("Evaluating an empty spline");
+
+			SCALAR length = m_lengths.back();
+			if (length <= 0.0f) return 0.0f;
+			SCALAR distance = (p_distance > 0.0f) ? p_distance : 0.0f;
+			distance = (distance < length) ? distance : length;
+
+			unsigned int bucket_count = static_cast<unsigned int>(m_distance_index.size());
+			unsigned int bucket = static_cast<unsigned int>(distance / length * bucket_count);
+			unsigned int sample = m_distance_index[(bucket < bucket_count) ? bucket : bucket_count - 1];
+			while (sample + 2 < m_lengths.size() && m_lengths[sample + 1] <= distance) ++sample;
+
+			const SCALAR step = 1.0f / K_ARC_LENGTH_SAMPLES;
+			SCALAR u = static_cast<SCALAR>(sample) * step;
+			SCALAR interval = m_lengths[sample + 1] - m_lengths[sample];
+			if (interval <= 0.0f) return u;
+
+			SCALAR x = (distance - m_lengths[sample]) / interval;
+			x = (x < 1.0f) ? x : 1.0f;
+
+			SCALAR slope_from = (m_speeds[sample] * 3.0f * step > interval) ? interval / m_speeds[sample] : 3.0f * step;
+			SCALAR slope_to = (m_speeds[sample + 1] * 3.0f * step > interval) ? interval / m_speeds[sample + 1] : 3.0f * step;
+			SCALAR x2 = x * x, x3 = x2 * x;
+			return u + (x3 - 2.0f * x2 + x) * slope_from + (3.0f * x2 - 2.0f * x3) * step + (x3 - x2) * slope_to;
+		}
+
+		template <typename VectorType>
+		void Spline<VectorType>::EvaluateAtDistance(const SCALAR* p_distances, unsigned int p_count, VectorType* p_result) const {
+			if (p_count == 0) return;
+			if (m_segment_count == 0) throw r2ExceptionLogicM("Evaluating an empty spline");
+
+			SCALAR u[K_DISTANCE_BATCH_SIZE];
+			for (unsigned int begin = 0; begin < p_count; begin += K_DISTANCE_BATCH_SIZE) {
+				unsigned int count = std::min(p_count - begin, K_DISTANCE_BATCH_SIZE);
+				for (unsigned int i = 0; i < count; ++i) {
+					u[i] = GetParameter(p_distances[begin + i]);
+				}
+
+				Evaluate(u, count, p_result + begin);
+			}
+		}
+
+		template <typename VectorType>
+		void Spline<VectorType>::BuildSegment(unsigned int p_segment, const VectorType& p_from, const VectorType& p_from_tangent, const VectorType& p_to, const VectorType& p_to_tangent) {
+			float* coefficients = &m_coefficients[p_segment * K_COEFFICIENT_STRIDE];
+			for (unsigned int c = 0; c < K_DIMENSIONS; ++c) {
+				SCALAR p0 = p_from.m_data[c], m0 = p_from_tangent.m_data[c];
+				SCALAR p1 = p_to.m_data[c], m1 = p_to_tangent.m_data[c];
+				coefficients[c] = p0;
+				coefficients[4 + c] = m0;
+				coefficients[8 + c] = 3.0f * (p1 - p0) - 2.0f * m0 - m1;
+				coefficients[12 + c] = 2.0f * (p0 - p1) + m0 + m1;
+			}
+		}
+
+		/**
+		 * The length between samples is the integral of the speed, with 3 point
+		 * Gauss-Legendre quadrature (exact for polynomials up to degree 5). The
+		 * distance index holds, for equally long stretches of the curve, the last
+		 * sample before each of them.
+		 */
+		template <typename VectorType>
+		void Spline<VectorType>::BuildArcLengthTable() {
+			static const double K_GAUSS_NODES[3] = { -0.774596669241483, 0.0, 0.774596669241483 };
+			static const double K_GAUSS_WEIGHTS[3] = { 5.0 / 9.0, 8.0 / 9.0, 5.0 / 9.0 };
+
+			unsigned int interval_count = m_segment_count * K_ARC_LENGTH_SAMPLES;
+			m_lengths.resize(interval_count + 1);
+			m_speeds.resize(interval_count + 1);
+
+			const double half_step = 0.5 / K_ARC_LENGTH_SAMPLES;
+			double length = 0.0;
+			m_lengths[0] = 0.0f;
+			for (unsigned int i = 0; i < interval_count; ++i) {
+				const float* coefficients = &m_coefficients[(i / K_ARC_LENGTH_SAMPLES) * K_COEFFICIENT_STRIDE];
+				double middle = (i % K_ARC_LENGTH_SAMPLES + 0.5) / K_ARC_LENGTH_SAMPLES;
+
+				for (unsigned int k = 0; k < 3; ++k) {
+					length += K_GAUSS_WEIGHTS[k] * half_step * Speed<K_DIMENSIONS>(coefficients, static_cast<float>(middle + K_GAUSS_NODES[k] * half_step));
+				}
+
+				m_lengths[i + 1] = static_cast<SCALAR>(length);
+				m_speeds[i] = Speed<K_DIMENSIONS>(coefficients, static_cast<float>(middle - half_step));
+			}
+			m_speeds[interval_count] = Speed<K_DIMENSIONS>(&m_coefficients[(m_segment_count - 1) * K_COEFFICIENT_STRIDE], 1.0f);
+
+			m_distance_index.resize(interval_count);
+			unsigned int sample = 0;
+			for (unsigned int b = 0; b < interval_count; ++b) {
+				SCALAR distance = m_lengths.back() * b / interval_count;
+				while (sample + 1 < interval_count && m_lengths[sample + 1] <= distance) ++sample;
+				m_distance_index[b] = sample;
+			}
+		}
+
+		template class Spline<Vector2>;
+		template class Spline<Vector3>;
+		template class Spline<Vector4>;
+	}
+}
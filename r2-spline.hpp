@@ -0,0 +1,153 @@
+/* HEADER
+ *
+ * File: r2-spline.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Piecewise cubic curves over Vector2, Vector3 or Vector4, built from
+ *	Catmull-Rom points, cubic Bezier control points or Hermite points and
+ *	tangents.
+ *
+ *	Every segment is converted to its polynomial a + bt + ct^2 + dt^3 once
+ *	when the spline is built, so evaluating it is 3 multiply-adds per
+ *	component (Horner form) with no basis functions to recompute. The
+ *	coefficients of a segment take one 64 byte line, with the components
+ *	padded to 4, and the batched Evaluate computes a whole vector per SSE2
+ *	operation.
+ *
+ *	The parameter u runs from 0 to the segment count, with segment i
+ *	covering [i, i + 1]. Parameters outside are clamped to the ends.
+ *
+ *	A table of the arc length and speed at K_ARC_LENGTH_SAMPLES points per
+ *	segment is built with the spline, to evaluate the curve at a distance
+ *	along it (moving along it at constant speed) instead of at a parameter.
+ *	A uniform index over the distance finds the samples around a distance
+ *	in constant time, and the parameter between them is interpolated with
+ *	a cubic, so the error is far below that of the table resolution.
+ * Depends on:
+ *  * r2::Exception::Argument, r2::Exception::Logic
+ *  * r2::Math::SIMD
+ *  * Vector2, Vector3, Vector4
+ * Updates:
+ *
+ */
+#ifndef R2_SPLINE_HPP
+#define R2_SPLINE_HPP
+
+#include <vector>
+#include "r2-math-generic.hpp"
+#include "r2-vector-2.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		template <typename VectorType>
+		class Spline {
+		public:
+			static const unsigned int K_DIMENSIONS = sizeof(VectorType::m_data) / sizeof(SCALAR);
+			static const unsigned int K_ARC_LENGTH_SAMPLES = 16;
+
+			/**
+			 * Initialize an empty spline
+			 */
+			Spline();
+			Spline(const Spline& p_spline);
+			~Spline();
+
+			Spline& operator=(const Spline& p_spline);
+
+			/**
+			 * Build a uniform Catmull-Rom spline through p_count (at least 2)
+			 * points, with one segment between every pair. The tangent at every
+			 * point is half the difference of its neighbours, and the end points
+			 * are taken as their own outer neighbours.
+			 */
+			void BuildCatmullRom(const VectorType* p_points, unsigned int p_count);
+
+			/**
+			 * Build a spline of cubic Bezier segments from p_count = 3n + 1 control
+			 * points, where segment i uses points 3i to 3i + 3.
+			 */
+			void BuildBezier(const VectorType* p_points, unsigned int p_count);
+
+			/**
+			 * Build a Hermite spline through p_count (at least 2) points with the
+			 * given tangents (derivatives with respect to u).
+			 */
+			void BuildHermite(const VectorType* p_points, const VectorType* p_tangents, unsigned int p_count);
+
+			/**
+			 * Get the number of segments, 0 if the spline is empty
+			 */
+			unsigned int GetSegmentCount() const;
+
+			/**
+			 * Get the total arc length
+			 */
+			SCALAR GetLength() const;
+
+			/**
+			 * Evaluate the curve, or its derivative with respect to u, at p_u.
+			 * Raises a Logic exception if the spline is empty.
+			 */
+			VectorType Evaluate(SCALAR p_u) const;
+			VectorType EvaluateDerivative(SCALAR p_u) const;
+
+			/**
+			 * Evaluate the curve at p_count parameters, in any order
+			 */
+			void Evaluate(const SCALAR* p_u, unsigned int p_count, VectorType* p_result) const;
+
+			/**
+			 * Get the parameter at p_distance along the curve, approximated from the
+			 * arc length table. Distances outside [0, GetLength()] are clamped.
+			 */
+			SCALAR GetParameter(SCALAR p_distance) const;
+
+			/**
+			 * Evaluate the curve at p_count distances along it
+			 */
+			void EvaluateAtDistance(const SCALAR* p_distances, unsigned int p_count, VectorType* p_result) const;
+		private:
+			void AllocateSegments(unsigned int p_segment_count);
+			void BuildSegment(unsigned int p_segment, const VectorType& p_from, const VectorType& p_from_tangent, const VectorType& p_to, const VectorType& p_to_tangent);
+			void BuildArcLengthTable();
+
+			// per segment the coefficients a, b, c, d, each padded to 4 components,
+			// aligned so that every segment is one cache line
+			float* m_coefficients;
+			unsigned int m_segment_count;
+
+			// the arc length up to, and the speed at, u = i / K_ARC_LENGTH_SAMPLES
+			std::vector<SCALAR> m_lengths;
+			std::vector<SCALAR> m_speeds;
+
+			// the last sample before each of m_distance_index.size() equal stretches of length
+			std::vector<unsigned int> m_distance_index;
+		};
+
+		typedef Spline<Vector2> Spline2;
+		typedef Spline<Vector3> Spline3;
+		typedef Spline<Vector4> Spline4;
+	}
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include "r2-sweep-and-prune.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include "r2-parallel.hpp"
+#include <algorithm>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		// bodies per thread for the sweep
+		static const unsigned int K_MIN_SWEEP_CHUNK = 4096;
+
+		// with more new bodies than 1 / K_RESORT_FRACTION of all, a full sort
+		// beats inserting them one at a time
+		static const unsigned int K_RESORT_FRACTION = 16;
+
+		// boxes past the last body, so that the kernels can read whole vectors
+		static const unsigned int K_SWEEP_PADDING = 8;
+
+		static const float K_LARGE = 3.402823e38f;
+
+
+
+		/**
+		 * Sweeping. Every box is tested against the boxes after it that start
+		 * before it ends on the sweep axis, which finds every overlapping pair
+		 * once. p_bounds holds the min of the three axes (sweep axis first)
+		 * followed by the max.
+		 */
+		static inline void AddPair(unsigned int p_body, unsigned int p_other, std::vector<SweepAndPrune::Pair>& p_pairs) {
+			SweepAndPrune::Pair pair = { (p_body < p_other) ? p_body : p_other, (p_body < p_other) ? p_other : p_body };
+			p_pairs.push_back(pair);
+		}
+
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static void SSE2Sweep(const float* const* p_bounds, const unsigned int* p_bodies, unsigned int p_begin, unsigned int p_end, std::vector<SweepAndPrune::Pair>& p_pairs) {
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				const __m128 max_0 = _mm_set1_ps(p_bounds[3][i]);
+				const __m128 min_1 = _mm_set1_ps(p_bounds[1][i]), max_1 = _mm_set1_ps(p_bounds[4][i]);
+				const __m128 min_2 = _mm_set1_ps(p_bounds[2][i]), max_2 = _mm_set1_ps(p_bounds[5][i]);
+
+				// the padding starts after the sweep axis ends, so the loop stops there
+				for (unsigned int j = i + 1; ; j += 4) {
+					__m128 started = _mm_cmple_ps(_mm_loadu_ps(p_bounds[0] + j), max_0);
+					__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(p_bounds[1] + j), max_1), _mm_cmpge_ps(_mm_loadu_ps(p_bounds[4] + j), min_1));
+					overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(p_bounds[2] + j), max_2), _mm_cmpge_ps(_mm_loadu_ps(p_bounds[5] + j), min_2)));
+
+					for (unsigned int bits = _mm_movemask_ps(_mm_and_ps(started, overlap)), k = 0; bits != 0; bits >>= 1, ++k) {
+						if (bits & 1) AddPair(p_bodies[i], p_bodies[j + k], p_pairs);
+					}
+					if (_mm_movemask_ps(started) != 0xF) break;
+				}
+			}
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static void AVX2Sweep(const float* const* p_bounds, const unsigned int* p_bodies, unsigned int p_begin, unsigned int p_end, std::vector<SweepAndPrune::Pair>& p_pairs) {
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				const __m256 max_0 = _mm256_set1_ps(p_bounds[3][i]);
+				const __m256 min_1 = _mm256_set1_ps(p_bounds[1][i]), max_1 = _mm256_set1_ps(p_bounds[4][i]);
+				const __m256 min_2 = _mm256_set1_ps(p_bounds[2][i]), max_2 = _mm256_set1_ps(p_bounds[5][i]);
+
+				for (unsigned int j = i + 1; ; j += 8) {
+					__m256 started = _mm256_cmp_ps(_mm256_loadu_ps(p_bounds[0] + j), max_0, _CMP_LE_OQ);
+					__m256 overlap = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(p_bounds[1] + j), max_1, _CMP_LE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(p_bounds[4] + j), min_1, _CMP_GE_OQ));
+					overlap = _mm256_and_ps(overlap, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(p_bounds[2] + j), max_2, _CMP_LE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(p_bounds[5] + j), min_2, _CMP_GE_OQ)));
+
+					for (unsigned int bits = _mm256_movemask_ps(_mm256_and_ps(started, overlap)), k = 0; bits != 0; bits >>= 1, ++k) {
+						if (bits & 1) AddPair(p_bodies[i], p_bodies[j + k], p_pairs);
+					}
+					if (_mm256_movemask_ps(started) != 0xFF) break;
+				}
+			}
+		}
+#endif
+
+		static void Sweep(const float* const* p_bounds, const unsigned int* p_bodies, unsigned int p_begin, unsigned int p_end, std::vector<SweepAndPrune::Pair>& p_pairs) {
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) {
+				AVX2Sweep(p_bounds, p_bodies, p_begin, p_end, p_pairs);
+				return;
+			} else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) {
+				SSE2Sweep(p_bounds, p_bodies, p_begin, p_end, p_pairs);
+				return;
+			}
+#endif
+			const float* min_0 = p_bounds[0], * min_1 = p_bounds[1], * min_2 = p_bounds[2];
+			const float* max_0 = p_bounds[3], * max_1 = p_bounds[4], * max_2 = p_bounds[5];
+			for (unsigned int i = p_begin; i < p_end; ++i) {
+				for (unsigned int j = i + 1; min_0[j] <= max_0[i]; ++j) {
+					// & rather than && keeps the mostly unpredictable tests free of branches
+					bool overlap = (min_1[j] <= max_1[i]) & (max_1[j] >= min_1[i]) & (min_2[j] <= max_2[i]) & (max_2[j] >= min_2[i]);
+					if (overlap) AddPair(p_bodies[i], p_bodies[j], p_pairs);
+				}
+			}
+		}
+
+
+
+		SweepAndPrune::SweepAndPrune()
+			: m_added(0), m_axis(0) {}
+
+		void SweepAndPrune::Reserve(unsigned int p_count) {
+			m_min.reserve(p_count);
+			m_max.reserve(p_count);
+			m_alive.reserve(p_count);
+			for (int a = 0; a < 3; ++a) {
+				m_endpoints[a].reserve(p_count);
+			}
+			for (int b = 0; b < 6; ++b) {
+				m_sweep_bounds[b].reserve(p_count + K_SWEEP_PADDING);
+			}
+			m_sweep_bodies.reserve(p_count);
+		}
+
+		unsigned int SweepAndPrune::AddBody(const Vector3& p_min, const Vector3& p_max) {
+			unsigned int body;
+			if (m_free.empty()) {
+				body = static_cast<unsigned int>(m_min.size());
+				m_min.push_back(p_min);
+				m_max.push_back(p_max);
+				m_alive.push_back(1);
+			} else {
+				body = m_free.back();
+				m_free.pop_back();
+				m_min[body] = p_min;
+				m_max[body] = p_max;
+				m_alive[body] = 1;
+			}
+
+			// the endpoints are sorted into place by the next FindPairs
+			for (int a = 0; a < 3; ++a) {
+				Endpoint endpoint = { p_min.m_data[a], body };
+				m_endpoints[a].push_back(endpoint);
+			}
+			++m_added;
+
+			return body;
+		}
+
+		void SweepAndPrune::RemoveBody(unsigned int p_body) {
+			if (p_body >= m_alive.size() || !m_alive[p_body]) throw r2ExceptionOutOfRangeM("Body does not exist");
+
+			// the endpoints stay until the next FindPairs, which is also when the
+			// handle can be reused without being confused with the old endpoints
+			m_alive[p_body] = 0;
+			m_removed.push_back(p_body);
+		}
+
+		unsigned int SweepAndPrune::GetBodyCount() const {
+			return static_cast<unsigned int>(m_min.size() - m_removed.size() - m_free.size());
+		}
+
+		const Vector3& SweepAndPrune::GetMin(unsigned int p_body) const {
+			return m_min[p_body];
+		}
+
+		const Vector3& SweepAndPrune::GetMax(unsigned int p_body) const {
+			return m_max[p_body];
+		}
+
+		void SweepAndPrune::SetBounds(unsigned int p_body, const Vector3& p_min, const Vector3& p_max) {
+			m_min[p_body] = p_min;
+			m_max[p_body] = p_max;
+		}
+
+		unsigned int SweepAndPrune::GetSweepAxis() const {
+			return m_axis;
+		}
+
+		unsigned int SweepAndPrune::FindPairs(std::vector<Pair>& p_pairs, unsigned int p_thread_count) {
+			if (!m_removed.empty()) {
+				for (int a = 0; a < 3; ++a) {
+					std::vector<Endpoint>& endpoints = m_endpoints[a];
+					std::size_t kept = 0;
+					for (std::size_t i = 0; i < endpoints.size(); ++i) {
+						if (m_alive[endpoints[i].m_body]) endpoints[kept++] = endpoints[i];
+					}
+					endpoints.resize(kept);
+				}
+
+				m_free.insert(m_free.end(), m_removed.begin(), m_removed.end());
+				m_removed.clear();
+			}
+
+			// the axes are independent, so they are sorted on up to three threads
+			Parallel::For(3, 1, p_thread_count, [this](std::size_t p_begin, std::size_t p_end) {
+				for (std::size_t a = p_begin; a < p_end; ++a) {
+					SortEndpoints(static_cast<unsigned int>(a));
+				}
+			});
+			m_added = 0;
+
+			// sweep along the axis where the centers vary the most
+			unsigned int count = static_cast<unsigned int>(m_endpoints[0].size());
+			double sum[3] = { 0.0, 0.0, 0.0 };
+			double sum_squared[3] = { 0.0, 0.0, 0.0 };
+			for (unsigned int body = 0; body < m_min.size(); ++body) {
+				if (!m_alive[body]) continue;
+				for (int a = 0; a < 3; ++a) {
+					double center = 0.5 * (m_min[body].m_data[a] + m_max[body].m_data[a]);
+					sum[a] += center;
+					sum_squared[a] += center * center;
+				}
+			}
+
+			m_axis = 0;
+			for (unsigned int a = 1; a < 3; ++a) {
+				if (sum_squared[a] * count - sum[a] * sum[a] > sum_squared[m_axis] * count - sum[m_axis] * sum[m_axis]) m_axis = a;
+			}
+
+			// copy the boxes into sweep order, so the sweep reads memory in order
+			const unsigned int axes[3] = { m_axis, (m_axis + 1) % 3, (m_axis + 2) % 3 };
+			const std::vector<Endpoint>& endpoints = m_endpoints[m_axis];
+			for (int b = 0; b < 6; ++b) {
+				m_sweep_bounds[b].resize(count + K_SWEEP_PADDING);
+			}
+			m_sweep_bodies.resize(count);
+			for (unsigned int i = 0; i < count; ++i) {
+				unsigned int body = endpoints[i].m_body;
+				for (int a = 0; a < 3; ++a) {
+					m_sweep_bounds[a][i] = m_min[body].m_data[axes[a]];
+					m_sweep_bounds[a + 3][i] = m_max[body].m_data[axes[a]];
+				}
+				m_sweep_bodies[i] = body;
+			}
+			for (int b = 0; b < 6; ++b) {
+				std::fill(m_sweep_bounds[b].begin() + count, m_sweep_bounds[b].end(), (b < 3) ? K_LARGE : -K_LARGE);
+			}
+
+			const float* bounds[6];
+			for (int b = 0; b < 6; ++b) {
+				bounds[b] = &m_sweep_bounds[b][0];
+			}
+			const unsigned int* bodies = m_sweep_bodies.empty() ? 0 : &m_sweep_bodies[0];
+
+			p_pairs.clear();
+			unsigned int thread_count = Parallel::GetThreadCount(p_thread_count);
+			if (thread_count <= 1 || count < 2 * K_MIN_SWEEP_CHUNK) {
+				Sweep(bounds, bodies, 0, count, p_pairs);
+				return static_cast<unsigned int>(p_pairs.size());
+			}
+
+			// every thread collects pairs in a vector of its own, kept between frames
+			unsigned int chunk_count = std::min(thread_count, count / K_MIN_SWEEP_CHUNK);
+			m_thread_pairs.resize(chunk_count);
+			Parallel::For(chunk_count, 1, chunk_count, [&](std::size_t p_begin, std::size_t p_end) {
+				for (std::size_t chunk = p_begin; chunk < p_end; ++chunk) {
+					m_thread_pairs[chunk].clear();
+					Sweep(bounds, bodies, static_cast<unsigned int>(chunk * count / chunk_count), static_cast<unsigned int>((chunk + 1) * count / chunk_count), m_thread_pairs[chunk]);
+				}
+			});
+
+			for (unsigned int chunk = 0; chunk < chunk_count; ++chunk) {
+				p_pairs.insert(p_pairs.end(), m_thread_pairs[chunk].begin(), m_thread_pairs[chunk].end());
+			}
+
+			return static_cast<unsigned int>(p_pairs.size());
+		}
+
+		void SweepAndPrune::SortEndpoints(unsigned int p_axis) {
+			std::vector<Endpoint>& endpoints = m_endpoints[p_axis];
+			std::size_t count = endpoints.size();
+			for (std::size_t i = 0; i < count; ++i) {
+				endpoints[i].m_value = m_min[endpoints[i].m_body].m_data[p_axis];
+			}
+
+			if (m_added * K_RESORT_FRACTION > count) {
+				std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& p_lhs, const Endpoint& p_rhs) {
+					return p_lhs.m_value < p_rhs.m_value;
+				});
+				return;
+			}
+
+			for (std::size_t i = 1; i < count; ++i) {
+				Endpoint endpoint = endpoints[i];
+				std::size_t j = i;
+				for (; j > 0 && endpoints[j - 1].m_value > endpoint.m_value; --j) {
+					endpoints[j] = endpoints[j - 1];
+				}
+				endpoints[j] = endpoint;
+			}
+		}
+	}
+}
@@ -0,0 +1,146 @@
+/* HEADER
+ *
+ * File: r2-sweep-and-prune.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Comments:
+ *	Sweep and prune broadphase over moving axis aligned boxes, finding the
+ *	pairs of boxes that overlap without testing every pair.
+ *
+ *	The min endpoints of the boxes are kept sorted on every axis between
+ *	calls to FindPairs. Bodies move little from one frame to the next, so
+ *	the arrays are nearly sorted and an insertion sort restores them in
+ *	close to linear time. The sweep runs along the axis where the box
+ *	centers spread the most, so few boxes overlap on it, and every box only
+ *	tests the boxes that start before it ends on that axis. The sweep tests
+ *	4 (SSE2) or 8 (AVX2) boxes at a time, and many bodies are split over
+ *	threads.
+ *
+ *	Bodies are identified by the handle returned when they are added.
+ *	Handles of removed bodies are reused once FindPairs has run.
+ * Depends on:
+ *  * SCALAR
+ *  * r2::Exception::OutOfRange
+ *  * r2::Math::SIMD
+ *  * r2::Parallel
+ *  * Vector3
+ * Updates:
+ *
+ */
+#ifndef R2_SWEEP_AND_PRUNE_HPP
+#define R2_SWEEP_AND_PRUNE_HPP
+
+#include <vector>
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+
+namespace r2 {
+	namespace Math {
+		class SweepAndPrune {
+		public:
+			/**
+			 * Two overlapping bodies, with m_first < m_second
+			 */
+			struct Pair {
+				unsigned int m_first;
+				unsigned int m_second;
+			};
+
+			/**
+			 * Initialize an empty broadphase
+			 */
+			SweepAndPrune();
+
+			/**
+			 * Reserve memory for p_count bodies
+			 */
+			void Reserve(unsigned int p_count);
+
+			/**
+			 * Add a body with the box [p_min, p_max] and return its handle. Boxes
+			 * must be finite.
+			 */
+			unsigned int AddBody(const Vector3& p_min, const Vector3& p_max);
+
+			/**
+			 * Remove a body. Raises an OutOfRange exception if there is no body
+			 * with the handle.
+			 */
+			void RemoveBody(unsigned int p_body);
+
+			/**
+			 * Get the number of bodies
+			 */
+			unsigned int GetBodyCount() const;
+
+			/**
+			 * Methods for accessing the boxes of the bodies. The handles are not
+			 * checked.
+			 */
+			const Vector3& GetMin(unsigned int p_body) const;
+			const Vector3& GetMax(unsigned int p_body) const;
+			void SetBounds(unsigned int p_body, const Vector3& p_min, const Vector3& p_max);
+
+			/**
+			 * Get the axis the last FindPairs swept along
+			 */
+			unsigned int GetSweepAxis() const;
+
+			/**
+			 * Replace the contents of p_pairs with all pairs of bodies whose boxes
+			 * overlap (or touch), in no particular order, and return their number.
+			 * Reusing the same vector every frame avoids reallocating it. Many
+			 * bodies are split over p_thread_count threads (0 uses all hardware
+			 * threads).
+			 */
+			unsigned int FindPairs(std::vector<Pair>& p_pairs, unsigned int p_thread_count = 1);
+		private:
+			struct Endpoint {
+				SCALAR m_value;
+				unsigned int m_body;
+			};
+
+			void SortEndpoints(unsigned int p_axis);
+
+			// indexed by handle
+			std::vector<Vector3> m_min;
+			std::vector<Vector3> m_max;
+			std::vector<unsigned char> m_alive;
+
+			// handles removed since the last FindPairs, and those free for reuse
+			std::vector<unsigned int> m_removed;
+			std::vector<unsigned int> m_free;
+
+			// the bodies sorted by their min on every axis
+			std::vector<Endpoint> m_endpoints[3];
+			unsigned int m_added;
+
+			// the boxes in sweep order: min and max of the sweep axis and the
+			// two other axes, padded with boxes that end the sweep
+			std::vector<SCALAR> m_sweep_bounds[6];
+			std::vector<unsigned int> m_sweep_bodies;
+			std::vector<std::vector<Pair> > m_thread_pairs;
+			unsigned int m_axis;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include "r2-transform-hierarchy.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include "r2-parallel.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace r2 {
+	namespace Math {
+		const std::size_t TransformHierarchy::K_NO_PARENT;
+
+		// updating a node is one 4x4 product, so a chunk needs a few thousand to pay for a thread
+		static const std::size_t K_MIN_UPDATE_CHUNK = 4096;
+
+		TransformHierarchy::TransformHierarchy()
+			: m_first_dirty(0), m_sorted(true) {}
+
+		void TransformHierarchy::Reserve(std::size_t p_count) {
+			m_local.reserve(p_count);
+			m_world.reserve(p_count);
+			m_parent_slot.reserve(p_count);
+			m_dirty.reserve(p_count);
+			m_parent.reserve(p_count);
+			m_slot.reserve(p_count);
+		}
+
+		std::size_t TransformHierarchy::AddNode(const Matrix4& p_local, std::size_t p_parent) {
+			std::size_t node = m_parent.size();
+			if (p_parent != K_NO_PARENT && p_parent >= node) throw r2ExceptionOutOfRangeM("Parent node does not exist");
+
+			std::size_t parent_slot = (p_parent == K_NO_PARENT) ? K_NO_PARENT : m_slot[p_parent];
+
+			// the order stays sorted as long as the node goes on the last level or a new one
+			if (m_sorted) {
+				std::size_t level_count = m_level_begin.empty() ? 0 : m_level_begin.size() - 1;
+				std::size_t depth = 0;
+				if (parent_slot != K_NO_PARENT) {
+					depth = std::upper_bound(m_level_begin.begin(), m_level_begin.end(), parent_slot) - m_level_begin.begin();
+				}
+
+				if (depth == level_count) {
+					if (m_level_begin.empty()) m_level_begin.push_back(0);
+					m_level_begin.push_back(node + 1);
+				} else if (depth + 1 == level_count) {
+					++m_level_begin.back();
+				} else {
+					m_sorted = false;
+				}
+			}
+
+			if (m_first_dirty > node) m_first_dirty = node;
+
+			m_local.push_back(p_local);
+			m_world.push_back(p_local);
+			m_parent_slot.push_back(parent_slot);
+			m_dirty.push_back(1);
+			m_parent.push_back(p_parent);
+			m_slot.push_back(node);
+
+			return node;
+		}
+
+		void TransformHierarchy::SetParent(std::size_t p_node, std::size_t p_parent) {
+			std::size_t count = m_parent.size();
+			if (p_node >= count || (p_parent != K_NO_PARENT && p_parent >= count)) throw r2ExceptionOutOfRangeM("Node does not exist");
+
+			for (std::size_t ancestor = p_parent; ancestor != K_NO_PARENT; ancestor = m_parent[ancestor]) {
+				if (ancestor == p_node) throw r2ExceptionArgumentM("Parenting a node to its own subtree");
+			}
+
+			std::size_t slot = m_slot[p_node];
+			m_parent[p_node] = p_parent;
+			m_parent_slot[slot] = (p_parent == K_NO_PARENT) ? K_NO_PARENT : m_slot[p_parent];
+			m_dirty[slot] = 1;
+			if (m_first_dirty > slot) m_first_dirty = slot;
+
+			// the depth of the whole subtree may have changed
+			m_sorted = false;
+		}
+
+		std::size_t TransformHierarchy::GetNodeCount() const {
+			return m_parent.size();
+		}
+
+		std::size_t TransformHierarchy::GetParent(std::size_t p_node) const {
+			return m_parent[p_node];
+		}
+
+		const Matrix4& TransformHierarchy::GetLocal(std::size_t p_node) const {
+			return m_local[m_slot[p_node]];
+		}
+
+		const Matrix4& TransformHierarchy::GetWorld(std::size_t p_node) const {
+			return m_world[m_slot[p_node]];
+		}
+
+		bool TransformHierarchy::IsDirty(std::size_t p_node) const {
+			return m_dirty[m_slot[p_node]] != 0;
+		}
+
+		void TransformHierarchy::SetLocal(std::size_t p_node, const Matrix4& p_local) {
+			std::size_t slot = m_slot[p_node];
+			m_local[slot] = p_local;
+			m_dirty[slot] = 1;
+			if (m_first_dirty > slot) m_first_dirty = slot;
+		}
+
+		std::size_t TransformHierarchy::GetLevelCount() {
+			if (!m_sorted) Sort();
+			return m_level_begin.empty() ? 0 : m_level_begin.size() - 1;
+		}
+
+		void TransformHierarchy::Update(unsigned int p_thread_count) {
+			if (!m_sorted) Sort();
+
+			std::size_t count = m_local.size();
+			if (m_first_dirty >= count) return;
+
+			// nodes before the first dirty one are all on earlier levels or unaffected
+			std::size_t level = std::upper_bound(m_level_begin.begin(), m_level_begin.end(), m_first_dirty) - m_level_begin.begin() - 1;
+			for (; level + 1 < m_level_begin.size(); ++level) {
+				std::size_t begin = std::max(m_level_begin[level], m_first_dirty);
+				std::size_t end = m_level_begin[level + 1];
+
+				Parallel::For(end - begin, K_MIN_UPDATE_CHUNK, p_thread_count, [this, begin](std::size_t p_begin, std::size_t p_end) {
+					UpdateSlots(begin + p_begin, begin + p_end);
+				});
+			}
+
+			memset(&m_dirty[m_first_dirty], 0, count - m_first_dirty);
+			m_first_dirty = count;
+		}
+
+		// the dirty flags are pushed down as the levels are walked, so every
+		// node only has to look at its parent
+		void TransformHierarchy::UpdateSlots(std::size_t p_begin, std::size_t p_end) {
+			const SIMD::Kernels& kernels = SIMD::GetKernels();
+
+			for (std::size_t slot = p_begin; slot < p_end; ++slot) {
+				std::size_t parent = m_parent_slot[slot];
+
+				if (parent == K_NO_PARENT) {
+					if (m_dirty[slot]) m_world[slot] = m_local[slot];
+					continue;
+				}
+
+				if (m_dirty[parent]) m_dirty[slot] = 1;
+				if (m_dirty[slot]) kernels.m_matrix4_multiply(m_world[slot].m_data, m_world[parent].m_data, m_local[slot].m_data);
+			}
+		}
+
+		// stable counting sort of the nodes by depth
+		void TransformHierarchy::Sort() {
+			std::size_t count = m_parent.size();
+
+			std::vector<std::size_t> depth(count, K_NO_PARENT);
+			std::vector<std::size_t> chain;
+			std::size_t level_count = 0;
+			for (std::size_t node = 0; node < count; ++node) {
+				std::size_t ancestor = node;
+				while (depth[ancestor] == K_NO_PARENT && m_parent[ancestor] != K_NO_PARENT) {
+					chain.push_back(ancestor);
+					ancestor = m_parent[ancestor];
+				}
+
+				if (depth[ancestor] == K_NO_PARENT) depth[ancestor] = 0;
+				for (std::size_t d = depth[ancestor] + 1; !chain.empty(); ++d) {
+					depth[chain.back()] = d;
+					chain.pop_back();
+				}
+
+				level_count = std::max(level_count, depth[node] + 1);
+			}
+
+			m_level_begin.assign(level_count + 1, 0);
+			for (std::size_t node = 0; node < count; ++node) {
+				++m_level_begin[depth[node] + 1];
+			}
+			for (std::size_t level = 0; level < level_count; ++level) {
+				m_level_begin[level + 1] += m_level_begin[level];
+			}
+
+			std::vector<std::size_t> next(m_level_begin.begin(), m_level_begin.end() - 1);
+			std::vector<std::size_t> slot(count);
+			for (std::size_t node = 0; node < count; ++node) {
+				slot[node] = next[depth[node]]++;
+			}
+
+			std::vector<Matrix4> local(count);
+			std::vector<Matrix4> world(count);
+			std::vector<std::size_t> parent_slot(count);
+			std::vector<unsigned char> dirty(count);
+			m_first_dirty = count;
+			for (std::size_t node = 0; node < count; ++node) {
+				std::size_t old_slot = m_slot[node];
+				std::size_t new_slot = slot[node];
+
+				local[new_slot] = m_local[old_slot];
+				world[new_slot] = m_world[old_slot];
+				parent_slot[new_slot] = (m_parent[node] == K_NO_PARENT) ? K_NO_PARENT : slot[m_parent[node]];
+				dirty[new_slot] = m_dirty[old_slot];
+				if (dirty[new_slot] && new_slot < m_first_dirty) m_first_dirty = new_slot;
+			}
+
+			m_local.swap(local);
+			m_world.swap(world);
+			m_parent_slot.swap(parent_slot);
+			m_dirty.swap(dirty);
+			m_slot.swap(slot);
+			m_sorted = true;
+		}
+	}
+}
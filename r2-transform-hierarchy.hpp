@@ -0,0 +1,135 @@
+/* HEADER
+ *
+ * File: r2-transform-hierarchy.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A tree of transforms, where the world matrix of every node is the world
+ *	matrix of its parent times its own local matrix. Roots have their local
+ *	matrix as world matrix.
+ *
+ *	The nodes are kept in flat arrays sorted by depth, so a parent always
+ *	comes before its children and all nodes of one depth (a level) are
+ *	contiguous. Nodes are referred to by the index returned from AddNode,
+ *	which stays the same when the arrays are reordered.
+ *
+ *	Changing a local matrix marks the node dirty, and Update only recomputes
+ *	the world matrices of dirty nodes and their descendants. Update walks the
+ *	levels in order, and the nodes of a level can be split over threads since
+ *	they only depend on the levels before it.
+ * Depends on:
+ *  * Matrix4
+ *  * r2::Exception::Argument, r2::Exception::OutOfRange
+ *  * r2::Math::SIMD
+ *  * r2::Parallel
+ * Updates:
+ *
+ */
+#ifndef R2_TRANSFORM_HIERARCHY_HPP
+#define R2_TRANSFORM_HIERARCHY_HPP
+
+#include <cstddef>
+#include <vector>
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		class TransformHierarchy {
+		public:
+			/**
+			 * The parent of root nodes
+			 */
+			static const std::size_t K_NO_PARENT = static_cast<std::size_t>(-1);
+
+			/**
+			 * Initialize an empty hierarchy
+			 */
+			TransformHierarchy();
+
+			/**
+			 * Reserve memory for p_count nodes
+			 */
+			void Reserve(std::size_t p_count);
+
+			/**
+			 * Add a node with the given local matrix under p_parent (or as a root),
+			 * and return its index. The node is dirty until the next Update. Raises
+			 * an OutOfRange exception if the parent does not exist.
+			 */
+			std::size_t AddNode(const Matrix4& p_local, std::size_t p_parent = K_NO_PARENT);
+
+			/**
+			 * Move a node (with its subtree) under another parent, or make it a root
+			 * with K_NO_PARENT. The subtree is dirty until the next Update. Raises an
+			 * OutOfRange exception for nodes that do not exist, and an Argument
+			 * exception if p_parent is in the subtree of p_node.
+			 */
+			void SetParent(std::size_t p_node, std::size_t p_parent);
+
+			/**
+			 * Methods for accessing the nodes. The node indices are not checked.
+			 * World matrices are those of the last Update.
+			 */
+			std::size_t GetNodeCount() const;
+			std::size_t GetParent(std::size_t p_node) const;
+			const Matrix4& GetLocal(std::size_t p_node) const;
+			const Matrix4& GetWorld(std::size_t p_node) const;
+			bool IsDirty(std::size_t p_node) const;
+
+			/**
+			 * Set the local matrix of a node and mark it dirty. The node index is
+			 * not checked.
+			 */
+			void SetLocal(std::size_t p_node, const Matrix4& p_local);
+
+			/**
+			 * Get the number of levels (the depth of the deepest node plus one)
+			 */
+			std::size_t GetLevelCount();
+
+			/**
+			 * Recompute the world matrices of all dirty nodes and their descendants.
+			 * Levels with many dirty nodes are split over p_thread_count threads
+			 * (0 uses all hardware threads).
+			 */
+			void Update(unsigned int p_thread_count = 1);
+		private:
+			void Sort();
+			void UpdateSlots(std::size_t p_begin, std::size_t p_end);
+
+			// indexed by slot, the position in the depth sorted order
+			std::vector<Matrix4> m_local;
+			std::vector<Matrix4> m_world;
+			std::vector<std::size_t> m_parent_slot;
+			std::vector<unsigned char> m_dirty;
+
+			// indexed by node
+			std::vector<std::size_t> m_parent;
+			std::vector<std::size_t> m_slot;
+
+			// slot of the first node of every level, and one past the last slot
+			std::vector<std::size_t> m_level_begin;
+			std::size_t m_first_dirty;
+			bool m_sorted;
+		};
+	}
+}
+
+#endif
@@ -8,12 +8,6 @@ namespace r2
 {
 	namespace Math
 	{
-		const Vector2 Vector2::K_ZERO(0, 0);
-		const Vector2 Vector2::K_AXIS_X(1, 0);
-		const Vector2 Vector2::K_AXIS_Y(0, 1);
-
-		Vector2::Vector2() : x(0), y(0) {}
-		Vector2::Vector2(SCALAR p_x, SCALAR p_y) : x(p_x), y(p_y) {}
 		Vector2::Vector2(const SCALAR* p_raw_data) {
 			memcpy(m_data, p_raw_data, sizeof(m_data));
 		}
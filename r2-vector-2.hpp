@@ -27,7 +27,7 @@
  *  * SCALAR
  *  * FloatCompare
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
  */
 #ifndef R2_VECTOR_2_HPP
 #define R2_VECTOR_2_HPP
@@ -43,12 +43,12 @@ namespace r2 {
 			/**
 			 * Initialize the zero vector
 			 */
-			Vector2();
+			constexpr Vector2();
 
 			/**
 			 * Initialize a vector (p_x, p_y)
 			 */
-			Vector2(SCALAR p_x, SCALAR p_y);
+			constexpr Vector2(SCALAR p_x, SCALAR p_y);
 
 			/**
 			 * Initialize a vector from an array of scalars. Will assume
@@ -153,6 +153,21 @@ namespace r2 {
 		 * vector and take the normal going to the right.
 		 */
 		Vector2 GetNormal(const Vector2& p_vector, bool p_right_hand);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Vector2::Vector2()
+			: x(0.0f), y(0.0f) {}
+
+		constexpr Vector2::Vector2(SCALAR p_x, SCALAR p_y)
+			: x(p_x), y(p_y) {}
+
+		inline constexpr Vector2 Vector2::K_ZERO(0, 0);
+		inline constexpr Vector2 Vector2::K_AXIS_X(1, 0);
+		inline constexpr Vector2 Vector2::K_AXIS_Y(0, 1);
 	}
 }
 
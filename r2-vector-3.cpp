@@ -8,13 +8,6 @@ namespace r2
 {
 	namespace Math
 	{
-		const Vector3 Vector3::K_ZERO(0, 0, 0);
-		const Vector3 Vector3::K_AXIS_X(1, 0, 0);
-		const Vector3 Vector3::K_AXIS_Y(0, 1, 0);
-		const Vector3 Vector3::K_AXIS_Z(0, 0, 1);
-
-		Vector3::Vector3() : x(0), y(0), z(0) {}
-		Vector3::Vector3(SCALAR p_x, SCALAR p_y, SCALAR p_z) : x(p_x), y(p_y), z(p_z) {}
 		Vector3::Vector3(const SCALAR* p_raw_data) {
 			memcpy(m_data, p_raw_data, sizeof(m_data));
 		}
@@ -27,7 +27,7 @@
  *  * SCALAR
  *  * FloatCompare
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
  */
 #ifndef R2_VECTOR_3_HPP
 #define R2_VECTOR_3_HPP
@@ -43,12 +43,12 @@ namespace r2 {
 			/**
 			 * Initialize the zero vector
 			 */
-			Vector3();
+			constexpr Vector3();
 
 			/**
 			 * Initialize a vector (p_x, p_y, p_z)
 			 */
-			Vector3(SCALAR p_x, SCALAR p_y, SCALAR p_z);
+			constexpr Vector3(SCALAR p_x, SCALAR p_y, SCALAR p_z);
 
 			/**
 			 * Initialize a vector from an array of scalars. Will assume
@@ -160,6 +160,22 @@ namespace r2 {
 		 * Get a normalized version of the vector
 		 */
 		Vector3 GetNormalized(const Vector3& p_vector);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Vector3::Vector3()
+			: x(0.0f), y(0.0f), z(0.0f) {}
+
+		constexpr Vector3::Vector3(SCALAR p_x, SCALAR p_y, SCALAR p_z)
+			: x(p_x), y(p_y), z(p_z) {}
+
+		inline constexpr Vector3 Vector3::K_ZERO(0, 0, 0);
+		inline constexpr Vector3 Vector3::K_AXIS_X(1, 0, 0);
+		inline constexpr Vector3 Vector3::K_AXIS_Y(0, 1, 0);
+		inline constexpr Vector3 Vector3::K_AXIS_Z(0, 0, 1);
 	}
 }
 
@@ -1,5 +1,6 @@
 #include "r2-vector-4.hpp"
 #include "r2-exception.hpp"
+#include "r2-simd.hpp"
 #include <cmath>
 #include <cstring>
 #include <limits>
@@ -8,14 +9,6 @@ namespace r2
 {
 	namespace Math
 	{
-		const Vector4 Vector4::K_ZERO(0, 0, 0, 0);
-		const Vector4 Vector4::K_AXIS_X(1, 0, 0, 0);
-		const Vector4 Vector4::K_AXIS_Y(0, 1, 0, 0);
-		const Vector4 Vector4::K_AXIS_Z(0, 0, 1, 0);
-		const Vector4 Vector4::K_AXIS_W(0, 0, 0, 1);
-
-		Vector4::Vector4() : x(0), y(0), z(0), w(0) {}
-		Vector4::Vector4(SCALAR p_x, SCALAR p_y, SCALAR p_z, SCALAR p_w) : x(p_x), y(p_y), z(p_z), w(p_w) {}
 		Vector4::Vector4(const SCALAR* p_raw_data) {
 			memcpy(m_data, p_raw_data, sizeof(m_data));
 		}
@@ -37,40 +30,27 @@ namespace r2
 		}
 
 		Vector4& Vector4::operator+=(const Vector4& p_rhs) {
-			x += p_rhs.x;
-			y += p_rhs.y;
-			z += p_rhs.z;
-			w += p_rhs.w;
+			SIMD::GetKernels().m_vector4_add(m_data, m_data, p_rhs.m_data);
 			return *this;
 		}
 
 		Vector4& Vector4::operator-=(const Vector4& p_rhs) {
-			x -= p_rhs.x;
-			y -= p_rhs.y;
-			z -= p_rhs.z;
-			w -= p_rhs.w;
+			SIMD::GetKernels().m_vector4_subtract(m_data, m_data, p_rhs.m_data);
 			return *this;
 		}
 
 		Vector4& Vector4::operator*=(SCALAR p_rhs) {
-			x *= p_rhs;
-			y *= p_rhs;
-			z *= p_rhs;
-			w *= p_rhs;
+			SIMD::GetKernels().m_vector4_scale(m_data, m_data, p_rhs);
 			return *this;
 		}
 
 		Vector4& Vector4::operator/=(SCALAR p_rhs) {
-			x /= p_rhs;
-			y /= p_rhs;
-			z /= p_rhs;
-			w /= p_rhs;
-			return *this;
+			return *this *= (1.0f / p_rhs);
 		}
 
 
 		SCALAR Vector4::Dot(const Vector4& p_rhs) const {
-			return x * p_rhs.x + y * p_rhs.y + z * p_rhs.z + w * p_rhs.w;
+			return SIMD::GetKernels().m_vector4_dot(m_data, p_rhs.m_data);
 		}
 
 		SCALAR Vector4::Length() const {
@@ -82,24 +62,19 @@ namespace r2
 		}
 
 		Vector4& Vector4::Normalize() {
-			return (*this /= Length());
+			SIMD::GetKernels().m_vector4_normalize(m_data);
+			return *this;
 		}
 
 
 
 
 		Vector4 operator+(const Vector4& p_lhs, const Vector4& p_rhs) {
-			return Vector4(p_lhs.x + p_rhs.x,
-						   p_lhs.y + p_rhs.y,
-						   p_lhs.z + p_rhs.z,
-						   p_lhs.w + p_rhs.w);
+			return (Vector4(p_lhs) += p_rhs);
 		}
 
 		Vector4 operator-(const Vector4& p_lhs, const Vector4& p_rhs) {
-			return Vector4(p_lhs.x - p_rhs.x,
-						   p_lhs.y - p_rhs.y,
-						   p_lhs.z - p_rhs.z,
-						   p_lhs.w - p_rhs.w);
+			return (Vector4(p_lhs) -= p_rhs);
 		}
 
 		Vector4 operator*(const Vector4& p_lhs, SCALAR p_rhs) {
@@ -168,7 +143,7 @@ namespace r2
 		}
 
 		Vector4 GetNormalized(const Vector4& p_vector) {
-			return p_vector / p_vector.Length();
+			return Vector4(p_vector).Normalize();
 		}
 	}
 }
\ No newline at end of file
@@ -27,7 +27,8 @@
  *  * SCALAR
  *  * FloatCompare
  * Updates:
- * 
+ *	2026-10-17 (Rarosu) - Arithmetic, Dot and Normalize use the SIMD kernels (r2-simd.hpp)
+ *	2026-10-17 (Rarosu) - Constructors from scalars and the constants are constexpr
  */
 #ifndef R2_VECTOR_4_HPP
 #define R2_VECTOR_4_HPP
@@ -43,12 +44,12 @@ namespace r2 {
 			/**
 			 * Initialize the zero vector
 			 */
-			Vector4();
+			constexpr Vector4();
 
 			/**
 			 * Initialize a vector (p_x, p_y, p_z, p_w)
 			 */
-			Vector4(SCALAR p_x, SCALAR p_y, SCALAR p_z, SCALAR p_w);
+			constexpr Vector4(SCALAR p_x, SCALAR p_y, SCALAR p_z, SCALAR p_w);
 
 			/**
 			 * Initialize a vector from an array of scalars. Will assume
@@ -151,6 +152,23 @@ namespace r2 {
 		 * Get a normalized version of the vector
 		 */
 		Vector4 GetNormalized(const Vector4& p_vector);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		constexpr Vector4::Vector4()
+			: x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+
+		constexpr Vector4::Vector4(SCALAR p_x, SCALAR p_y, SCALAR p_z, SCALAR p_w)
+			: x(p_x), y(p_y), z(p_z), w(p_w) {}
+
+		inline constexpr Vector4 Vector4::K_ZERO(0, 0, 0, 0);
+		inline constexpr Vector4 Vector4::K_AXIS_X(1, 0, 0, 0);
+		inline constexpr Vector4 Vector4::K_AXIS_Y(0, 1, 0, 0);
+		inline constexpr Vector4 Vector4::K_AXIS_Z(0, 0, 1, 0);
+		inline constexpr Vector4 Vector4::K_AXIS_W(0, 0, 0, 1);
 	}
 }
 
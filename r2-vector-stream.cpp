@@ -0,0 +1,718 @@
+#include "r2-vector-stream.hpp"
+#include "r2-exception.hpp"
+#include "r2-simd.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(R2_ARCH_X86)
+	#include <immintrin.h>
+#endif
+
+namespace r2 {
+	namespace Math {
+		/**
+		 * Kernels. The SIMD versions process as many whole blocks as possible and
+		 * return the number of vectors processed; the scalar loops finish the rest.
+		 * Component arrays of streams are aligned, scalar result arrays might not be.
+		 */
+#if defined(R2_ARCH_X86)
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2AddArrays(float* p_result, const float* p_lhs, const float* p_rhs, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				_mm_store_ps(p_result + i, _mm_add_ps(_mm_load_ps(p_lhs + i), _mm_load_ps(p_rhs + i)));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("avx2")
+		static unsigned int AVX2AddArrays(float* p_result, const float* p_lhs, const float* p_rhs, unsigned int p_count) {
+			unsigned int blocks = p_count & ~7u;
+			for (unsigned int i = 0; i < blocks; i += 8) {
+				_mm256_store_ps(p_result + i, _mm256_add_ps(_mm256_load_ps(p_lhs + i), _mm256_load_ps(p_rhs + i)));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2SubtractArrays(float* p_result, const float* p_lhs, const float* p_rhs, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				_mm_store_ps(p_result + i, _mm_sub_ps(_mm_load_ps(p_lhs + i), _mm_load_ps(p_rhs + i)));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("avx2")
+		static unsigned int AVX2SubtractArrays(float* p_result, const float* p_lhs, const float* p_rhs, unsigned int p_count) {
+			unsigned int blocks = p_count & ~7u;
+			for (unsigned int i = 0; i < blocks; i += 8) {
+				_mm256_store_ps(p_result + i, _mm256_sub_ps(_mm256_load_ps(p_lhs + i), _mm256_load_ps(p_rhs + i)));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2ScaleArray(float* p_result, const float* p_lhs, float p_rhs, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			__m128 scale = _mm_set1_ps(p_rhs);
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				_mm_store_ps(p_result + i, _mm_mul_ps(_mm_load_ps(p_lhs + i), scale));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("avx2")
+		static unsigned int AVX2ScaleArray(float* p_result, const float* p_lhs, float p_rhs, unsigned int p_count) {
+			unsigned int blocks = p_count & ~7u;
+			__m256 scale = _mm256_set1_ps(p_rhs);
+			for (unsigned int i = 0; i < blocks; i += 8) {
+				_mm256_store_ps(p_result + i, _mm256_mul_ps(_mm256_load_ps(p_lhs + i), scale));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2Dot(const float* const* p_lhs, const float* const* p_rhs, unsigned int p_components, bool p_sqrt, float* p_result, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				__m128 sum = _mm_mul_ps(_mm_load_ps(p_lhs[0] + i), _mm_load_ps(p_rhs[0] + i));
+				for (unsigned int c = 1; c < p_components; ++c) {
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(p_lhs[c] + i), _mm_load_ps(p_rhs[c] + i)));
+				}
+
+				if (p_sqrt) sum = _mm_sqrt_ps(sum);
+				_mm_storeu_ps(p_result + i, sum);
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2Dot(const float* const* p_lhs, const float* const* p_rhs, unsigned int p_components, bool p_sqrt, float* p_result, unsigned int p_count) {
+			unsigned int blocks = p_count & ~7u;
+			for (unsigned int i = 0; i < blocks; i += 8) {
+				__m256 sum = _mm256_mul_ps(_mm256_load_ps(p_lhs[0] + i), _mm256_load_ps(p_rhs[0] + i));
+				for (unsigned int c = 1; c < p_components; ++c) {
+					sum = _mm256_fmadd_ps(_mm256_load_ps(p_lhs[c] + i), _mm256_load_ps(p_rhs[c] + i), sum);
+				}
+
+				if (p_sqrt) sum = _mm256_sqrt_ps(sum);
+				_mm256_storeu_ps(p_result + i, sum);
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2Cross(const float* const* p_lhs, const float* const* p_rhs, float* const* p_result, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				__m128 lx = _mm_load_ps(p_lhs[0] + i), ly = _mm_load_ps(p_lhs[1] + i), lz = _mm_load_ps(p_lhs[2] + i);
+				__m128 rx = _mm_load_ps(p_rhs[0] + i), ry = _mm_load_ps(p_rhs[1] + i), rz = _mm_load_ps(p_rhs[2] + i);
+				_mm_store_ps(p_result[0] + i, _mm_sub_ps(_mm_mul_ps(ly, rz), _mm_mul_ps(lz, ry)));
+				_mm_store_ps(p_result[1] + i, _mm_sub_ps(_mm_mul_ps(lz, rx), _mm_mul_ps(lx, rz)));
+				_mm_store_ps(p_result[2] + i, _mm_sub_ps(_mm_mul_ps(lx, ry), _mm_mul_ps(ly, rx)));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("avx2")
+		static unsigned int AVX2Cross(const float* const* p_lhs, const float* const* p_rhs, float* const* p_result, unsigned int p_count) {
+			unsigned int blocks = p_count & ~7u;
+			for (unsigned int i = 0; i < blocks; i += 8) {
+				__m256 lx = _mm256_load_ps(p_lhs[0] + i), ly = _mm256_load_ps(p_lhs[1] + i), lz = _mm256_load_ps(p_lhs[2] + i);
+				__m256 rx = _mm256_load_ps(p_rhs[0] + i), ry = _mm256_load_ps(p_rhs[1] + i), rz = _mm256_load_ps(p_rhs[2] + i);
+				_mm256_store_ps(p_result[0] + i, _mm256_sub_ps(_mm256_mul_ps(ly, rz), _mm256_mul_ps(lz, ry)));
+				_mm256_store_ps(p_result[1] + i, _mm256_sub_ps(_mm256_mul_ps(lz, rx), _mm256_mul_ps(lx, rz)));
+				_mm256_store_ps(p_result[2] + i, _mm256_sub_ps(_mm256_mul_ps(lx, ry), _mm256_mul_ps(ly, rx)));
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2Normalize(float* const* p_components, unsigned int p_component_count, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				__m128 sum = _mm_setzero_ps();
+				for (unsigned int c = 0; c < p_component_count; ++c) {
+					__m128 component = _mm_load_ps(p_components[c] + i);
+					sum = _mm_add_ps(sum, _mm_mul_ps(component, component));
+				}
+
+				__m128 length = _mm_sqrt_ps(sum);
+				for (unsigned int c = 0; c < p_component_count; ++c) {
+					_mm_store_ps(p_components[c] + i, _mm_div_ps(_mm_load_ps(p_components[c] + i), length));
+				}
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("avx2,fma")
+		static unsigned int AVX2Normalize(float* const* p_components, unsigned int p_component_count, unsigned int p_count) {
+			unsigned int blocks = p_count & ~7u;
+			for (unsigned int i = 0; i < blocks; i += 8) {
+				__m256 sum = _mm256_setzero_ps();
+				for (unsigned int c = 0; c < p_component_count; ++c) {
+					__m256 component = _mm256_load_ps(p_components[c] + i);
+					sum = _mm256_fmadd_ps(component, component, sum);
+				}
+
+				__m256 length = _mm256_sqrt_ps(sum);
+				for (unsigned int c = 0; c < p_component_count; ++c) {
+					_mm256_store_ps(p_components[c] + i, _mm256_div_ps(_mm256_load_ps(p_components[c] + i), length));
+				}
+			}
+
+			return blocks;
+		}
+
+		// Four Vector4s are a 4x4 matrix; transposing it converts between the layouts.
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2LoadVector4(float* const* p_components, const Vector4* p_vectors, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				__m128 x = _mm_loadu_ps(p_vectors[i + 0].m_data);
+				__m128 y = _mm_loadu_ps(p_vectors[i + 1].m_data);
+				__m128 z = _mm_loadu_ps(p_vectors[i + 2].m_data);
+				__m128 w = _mm_loadu_ps(p_vectors[i + 3].m_data);
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_store_ps(p_components[0] + i, x);
+				_mm_store_ps(p_components[1] + i, y);
+				_mm_store_ps(p_components[2] + i, z);
+				_mm_store_ps(p_components[3] + i, w);
+			}
+
+			return blocks;
+		}
+
+		r2SIMDTargetM("sse2")
+		static unsigned int SSE2StoreVector4(Vector4* p_vectors, const float* const* p_components, unsigned int p_count) {
+			unsigned int blocks = p_count & ~3u;
+			for (unsigned int i = 0; i < blocks; i += 4) {
+				__m128 v0 = _mm_load_ps(p_components[0] + i);
+				__m128 v1 = _mm_load_ps(p_components[1] + i);
+				__m128 v2 = _mm_load_ps(p_components[2] + i);
+				__m128 v3 = _mm_load_ps(p_components[3] + i);
+				_MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+				_mm_storeu_ps(p_vectors[i + 0].m_data, v0);
+				_mm_storeu_ps(p_vectors[i + 1].m_data, v1);
+				_mm_storeu_ps(p_vectors[i + 2].m_data, v2);
+				_mm_storeu_ps(p_vectors[i + 3].m_data, v3);
+			}
+
+			return blocks;
+		}
+#endif
+
+
+
+		/**
+		 * Dispatch
+		 */
+		static void AddArrays(float* p_result, const float* p_lhs, const float* p_rhs, unsigned int p_count) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2AddArrays(p_result, p_lhs, p_rhs, p_count);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2AddArrays(p_result, p_lhs, p_rhs, p_count);
+#endif
+			for (; i < p_count; ++i) {
+				p_result[i] = p_lhs[i] + p_rhs[i];
+			}
+		}
+
+		static void SubtractArrays(float* p_result, const float* p_lhs, const float* p_rhs, unsigned int p_count) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2SubtractArrays(p_result, p_lhs, p_rhs, p_count);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2SubtractArrays(p_result, p_lhs, p_rhs, p_count);
+#endif
+			for (; i < p_count; ++i) {
+				p_result[i] = p_lhs[i] - p_rhs[i];
+			}
+		}
+
+		static void ScaleArray(float* p_result, const float* p_lhs, float p_rhs, unsigned int p_count) {
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2ScaleArray(p_result, p_lhs, p_rhs, p_count);
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2ScaleArray(p_result, p_lhs, p_rhs, p_count);
+#endif
+			for (; i < p_count; ++i) {
+				p_result[i] = p_lhs[i] * p_rhs;
+			}
+		}
+
+		static void DotStreams(const priv::VectorStreamBase& p_lhs, const priv::VectorStreamBase& p_rhs, bool p_sqrt, float* p_result) {
+			const float* lhs[4];
+			const float* rhs[4];
+			unsigned int components = p_lhs.GetComponentCount();
+			for (unsigned int c = 0; c < components; ++c) {
+				lhs[c] = p_lhs.GetComponent(c);
+				rhs[c] = p_rhs.GetComponent(c);
+			}
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Dot(lhs, rhs, components, p_sqrt, p_result, p_lhs.Size());
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Dot(lhs, rhs, components, p_sqrt, p_result, p_lhs.Size());
+#endif
+			for (; i < p_lhs.Size(); ++i) {
+				float sum = 0;
+				for (unsigned int c = 0; c < components; ++c) {
+					sum += lhs[c][i] * rhs[c][i];
+				}
+
+				p_result[i] = p_sqrt ? std::sqrt(sum) : sum;
+			}
+		}
+
+		static void NormalizeStream(priv::VectorStreamBase& p_stream) {
+			float* components[4];
+			unsigned int component_count = p_stream.GetComponentCount();
+			for (unsigned int c = 0; c < component_count; ++c) {
+				components[c] = p_stream.GetComponent(c);
+			}
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Normalize(components, component_count, p_stream.Size());
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Normalize(components, component_count, p_stream.Size());
+#endif
+			for (; i < p_stream.Size(); ++i) {
+				float sum = 0;
+				for (unsigned int c = 0; c < component_count; ++c) {
+					sum += components[c][i] * components[c][i];
+				}
+
+				float length = std::sqrt(sum);
+				for (unsigned int c = 0; c < component_count; ++c) {
+					components[c][i] /= length;
+				}
+			}
+		}
+
+		static void CheckSizes(const priv::VectorStreamBase& p_lhs, const priv::VectorStreamBase& p_rhs) {
+			if (p_lhs.Size() != p_rhs.Size()) throw r2ExceptionArgumentM("Vector streams are of different sizes");
+		}
+
+		static void AddStreams(const priv::VectorStreamBase& p_lhs, const priv::VectorStreamBase& p_rhs, priv::VectorStreamBase& p_result) {
+			CheckSizes(p_lhs, p_rhs);
+			p_result.Resize(p_lhs.Size());
+			for (unsigned int c = 0; c < p_lhs.GetComponentCount(); ++c) {
+				AddArrays(p_result.GetComponent(c), p_lhs.GetComponent(c), p_rhs.GetComponent(c), p_lhs.Size());
+			}
+		}
+
+		static void SubtractStreams(const priv::VectorStreamBase& p_lhs, const priv::VectorStreamBase& p_rhs, priv::VectorStreamBase& p_result) {
+			CheckSizes(p_lhs, p_rhs);
+			p_result.Resize(p_lhs.Size());
+			for (unsigned int c = 0; c < p_lhs.GetComponentCount(); ++c) {
+				SubtractArrays(p_result.GetComponent(c), p_lhs.GetComponent(c), p_rhs.GetComponent(c), p_lhs.Size());
+			}
+		}
+
+		static void ScaleStream(const priv::VectorStreamBase& p_lhs, SCALAR p_rhs, priv::VectorStreamBase& p_result) {
+			p_result.Resize(p_lhs.Size());
+			for (unsigned int c = 0; c < p_lhs.GetComponentCount(); ++c) {
+				ScaleArray(p_result.GetComponent(c), p_lhs.GetComponent(c), p_rhs, p_lhs.Size());
+			}
+		}
+
+
+
+		/**
+		 * VectorStreamBase
+		 */
+		namespace priv {
+			// Capacities are kept at whole blocks of 16 scalars, so every component array stays aligned
+			static unsigned int RoundCapacity(unsigned int p_size) {
+				return (p_size + 15) & ~15u;
+			}
+
+			VectorStreamBase::VectorStreamBase(unsigned int p_component_count, unsigned int p_size)
+				: m_component_count(p_component_count), m_size(0), m_capacity(0), m_memory(0) {
+				Allocate(RoundCapacity(p_size));
+				Resize(p_size);
+			}
+
+			VectorStreamBase::VectorStreamBase(const VectorStreamBase& p_stream)
+				: m_component_count(p_stream.m_component_count), m_size(0), m_capacity(0), m_memory(0) {
+				Allocate(RoundCapacity(p_stream.m_size));
+				*this = p_stream;
+			}
+
+			VectorStreamBase::~VectorStreamBase() {
+				SIMD::FreeAligned(m_memory);
+			}
+
+			VectorStreamBase& VectorStreamBase::operator=(const VectorStreamBase& p_stream) {
+				if (this == &p_stream) return *this;
+
+				if (m_capacity < p_stream.m_size) Allocate(RoundCapacity(p_stream.m_size));
+				for (unsigned int c = 0; c < m_component_count; ++c) {
+					memcpy(m_components[c], p_stream.m_components[c], p_stream.m_size * sizeof(SCALAR));
+				}
+
+				m_size = p_stream.m_size;
+				return *this;
+			}
+
+			unsigned int VectorStreamBase::Size() const {
+				return m_size;
+			}
+
+			void VectorStreamBase::Resize(unsigned int p_size) {
+				if (p_size > m_capacity) {
+					SCALAR* old_memory = m_memory;
+					SCALAR* old_components[K_MAX_COMPONENTS];
+					memcpy(old_components, m_components, sizeof(old_components));
+
+					m_memory = 0;
+					try {
+						Allocate(RoundCapacity(p_size));
+					} catch (...) {
+						m_memory = old_memory;
+						throw;
+					}
+
+					for (unsigned int c = 0; c < m_component_count; ++c) {
+						memcpy(m_components[c], old_components[c], m_size * sizeof(SCALAR));
+					}
+
+					SIMD::FreeAligned(old_memory);
+				}
+
+				for (unsigned int c = 0; c < m_component_count; ++c) {
+					for (unsigned int i = m_size; i < p_size; ++i) {
+						m_components[c][i] = 0;
+					}
+				}
+
+				m_size = p_size;
+			}
+
+			SCALAR* VectorStreamBase::GetComponent(unsigned int p_component) {
+				return m_components[p_component];
+			}
+
+			const SCALAR* VectorStreamBase::GetComponent(unsigned int p_component) const {
+				return m_components[p_component];
+			}
+
+			unsigned int VectorStreamBase::GetComponentCount() const {
+				return m_component_count;
+			}
+
+			// Replaces the memory without copying; callers are responsible for the contents.
+			void VectorStreamBase::Allocate(unsigned int p_capacity) {
+				SCALAR* memory = static_cast<SCALAR*>(SIMD::AllocateAligned(p_capacity * m_component_count * sizeof(SCALAR)));
+				if (m_memory != 0) SIMD::FreeAligned(m_memory);
+
+				m_memory = memory;
+				m_capacity = p_capacity;
+				for (unsigned int c = 0; c < K_MAX_COMPONENTS; ++c) {
+					m_components[c] = (c < m_component_count) ? m_memory + c * m_capacity : 0;
+				}
+			}
+		}
+
+
+
+		/**
+		 * Vector3Stream
+		 */
+		Vector3Stream::Vector3Stream() : priv::VectorStreamBase(3, 0) {}
+		Vector3Stream::Vector3Stream(unsigned int p_size) : priv::VectorStreamBase(3, p_size) {}
+		Vector3Stream::Vector3Stream(const Vector3* p_vectors, unsigned int p_count) : priv::VectorStreamBase(3, 0) {
+			Load(p_vectors, p_count);
+		}
+
+		void Vector3Stream::Load(const Vector3* p_vectors, unsigned int p_count) {
+			Resize(p_count);
+
+			SCALAR* x = GetX();
+			SCALAR* y = GetY();
+			SCALAR* z = GetZ();
+			for (unsigned int i = 0; i < p_count; ++i) {
+				x[i] = p_vectors[i].x;
+				y[i] = p_vectors[i].y;
+				z[i] = p_vectors[i].z;
+			}
+		}
+
+		void Vector3Stream::Store(Vector3* p_vectors) const {
+			const SCALAR* x = GetX();
+			const SCALAR* y = GetY();
+			const SCALAR* z = GetZ();
+			for (unsigned int i = 0; i < Size(); ++i) {
+				p_vectors[i].x = x[i];
+				p_vectors[i].y = y[i];
+				p_vectors[i].z = z[i];
+			}
+		}
+
+		Vector3 Vector3Stream::Get(unsigned int p_index) const {
+			return Vector3(GetX()[p_index], GetY()[p_index], GetZ()[p_index]);
+		}
+
+		void Vector3Stream::Set(unsigned int p_index, const Vector3& p_vector) {
+			GetX()[p_index] = p_vector.x;
+			GetY()[p_index] = p_vector.y;
+			GetZ()[p_index] = p_vector.z;
+		}
+
+		SCALAR* Vector3Stream::GetX() { return GetComponent(0); }
+		SCALAR* Vector3Stream::GetY() { return GetComponent(1); }
+		SCALAR* Vector3Stream::GetZ() { return GetComponent(2); }
+		const SCALAR* Vector3Stream::GetX() const { return GetComponent(0); }
+		const SCALAR* Vector3Stream::GetY() const { return GetComponent(1); }
+		const SCALAR* Vector3Stream::GetZ() const { return GetComponent(2); }
+
+
+
+		/**
+		 * Vector4Stream
+		 */
+		Vector4Stream::Vector4Stream() : priv::VectorStreamBase(4, 0) {}
+		Vector4Stream::Vector4Stream(unsigned int p_size) : priv::VectorStreamBase(4, p_size) {}
+		Vector4Stream::Vector4Stream(const Vector4* p_vectors, unsigned int p_count) : priv::VectorStreamBase(4, 0) {
+			Load(p_vectors, p_count);
+		}
+
+		void Vector4Stream::Load(const Vector4* p_vectors, unsigned int p_count) {
+			Resize(p_count);
+
+			SCALAR* components[4] = { GetX(), GetY(), GetZ(), GetW() };
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2LoadVector4(components, p_vectors, p_count);
+#endif
+			for (; i < p_count; ++i) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					components[c][i] = p_vectors[i].m_data[c];
+				}
+			}
+		}
+
+		void Vector4Stream::Store(Vector4* p_vectors) const {
+			const SCALAR* components[4] = { GetX(), GetY(), GetZ(), GetW() };
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2StoreVector4(p_vectors, components, Size());
+#endif
+			for (; i < Size(); ++i) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					p_vectors[i].m_data[c] = components[c][i];
+				}
+			}
+		}
+
+		Vector4 Vector4Stream::Get(unsigned int p_index) const {
+			return Vector4(GetX()[p_index], GetY()[p_index], GetZ()[p_index], GetW()[p_index]);
+		}
+
+		void Vector4Stream::Set(unsigned int p_index, const Vector4& p_vector) {
+			GetX()[p_index] = p_vector.x;
+			GetY()[p_index] = p_vector.y;
+			GetZ()[p_index] = p_vector.z;
+			GetW()[p_index] = p_vector.w;
+		}
+
+		SCALAR* Vector4Stream::GetX() { return GetComponent(0); }
+		SCALAR* Vector4Stream::GetY() { return GetComponent(1); }
+		SCALAR* Vector4Stream::GetZ() { return GetComponent(2); }
+		SCALAR* Vector4Stream::GetW() { return GetComponent(3); }
+		const SCALAR* Vector4Stream::GetX() const { return GetComponent(0); }
+		const SCALAR* Vector4Stream::GetY() const { return GetComponent(1); }
+		const SCALAR* Vector4Stream::GetZ() const { return GetComponent(2); }
+		const SCALAR* Vector4Stream::GetW() const { return GetComponent(3); }
+
+
+		/**
+		 * Matrix3Stream
+		 */
+		Matrix3Stream::Matrix3Stream() : priv::VectorStreamBase(9, 0) {}
+		Matrix3Stream::Matrix3Stream(unsigned int p_size) : priv::VectorStreamBase(9, p_size) {}
+		Matrix3Stream::Matrix3Stream(const Matrix3* p_matrices, unsigned int p_count) : priv::VectorStreamBase(9, 0) {
+			Load(p_matrices, p_count);
+		}
+
+		void Matrix3Stream::Load(const Matrix3* p_matrices, unsigned int p_count) {
+			Resize(p_count);
+
+			for (unsigned int e = 0; e < 9; ++e) {
+				SCALAR* element = GetComponent(e);
+				for (unsigned int i = 0; i < p_count; ++i) {
+					element[i] = p_matrices[i].m_data[e];
+				}
+			}
+		}
+
+		void Matrix3Stream::Store(Matrix3* p_matrices) const {
+			for (unsigned int e = 0; e < 9; ++e) {
+				const SCALAR* element = GetComponent(e);
+				for (unsigned int i = 0; i < Size(); ++i) {
+					p_matrices[i].m_data[e] = element[i];
+				}
+			}
+		}
+
+		Matrix3 Matrix3Stream::Get(unsigned int p_index) const {
+			Matrix3 result;
+			for (unsigned int e = 0; e < 9; ++e) {
+				result.m_data[e] = GetComponent(e)[p_index];
+			}
+
+			return result;
+		}
+
+		void Matrix3Stream::Set(unsigned int p_index, const Matrix3& p_matrix) {
+			for (unsigned int e = 0; e < 9; ++e) {
+				GetComponent(e)[p_index] = p_matrix.m_data[e];
+			}
+		}
+
+		SCALAR* Matrix3Stream::GetElement(unsigned int p_row, unsigned int p_col) { return GetComponent(p_row * Matrix3::K_DIMENSIONS + p_col); }
+		const SCALAR* Matrix3Stream::GetElement(unsigned int p_row, unsigned int p_col) const { return GetComponent(p_row * Matrix3::K_DIMENSIONS + p_col); }
+
+
+		/**
+		 * Matrix4Stream
+		 */
+		Matrix4Stream::Matrix4Stream() : priv::VectorStreamBase(16, 0) {}
+		Matrix4Stream::Matrix4Stream(unsigned int p_size) : priv::VectorStreamBase(16, p_size) {}
+		Matrix4Stream::Matrix4Stream(const Matrix4* p_matrices, unsigned int p_count) : priv::VectorStreamBase(16, 0) {
+			Load(p_matrices, p_count);
+		}
+
+		void Matrix4Stream::Load(const Matrix4* p_matrices, unsigned int p_count) {
+			Resize(p_count);
+
+			for (unsigned int e = 0; e < 16; ++e) {
+				SCALAR* element = GetComponent(e);
+				for (unsigned int i = 0; i < p_count; ++i) {
+					element[i] = p_matrices[i].m_data[e];
+				}
+			}
+		}
+
+		void Matrix4Stream::Store(Matrix4* p_matrices) const {
+			for (unsigned int e = 0; e < 16; ++e) {
+				const SCALAR* element = GetComponent(e);
+				for (unsigned int i = 0; i < Size(); ++i) {
+					p_matrices[i].m_data[e] = element[i];
+				}
+			}
+		}
+
+		Matrix4 Matrix4Stream::Get(unsigned int p_index) const {
+			Matrix4 result;
+			for (unsigned int e = 0; e < 16; ++e) {
+				result.m_data[e] = GetComponent(e)[p_index];
+			}
+
+			return result;
+		}
+
+		void Matrix4Stream::Set(unsigned int p_index, const Matrix4& p_matrix) {
+			for (unsigned int e = 0; e < 16; ++e) {
+				GetComponent(e)[p_index] = p_matrix.m_data[e];
+			}
+		}
+
+		SCALAR* Matrix4Stream::GetElement(unsigned int p_row, unsigned int p_col) { return GetComponent(p_row * Matrix4::K_DIMENSIONS + p_col); }
+		const SCALAR* Matrix4Stream::GetElement(unsigned int p_row, unsigned int p_col) const { return GetComponent(p_row * Matrix4::K_DIMENSIONS + p_col); }
+
+
+
+		/**
+		 * Bulk operations
+		 */
+		void Add(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, Vector3Stream& p_result) {
+			AddStreams(p_lhs, p_rhs, p_result);
+		}
+
+		void Add(const Vector4Stream& p_lhs, const Vector4Stream& p_rhs, Vector4Stream& p_result) {
+			AddStreams(p_lhs, p_rhs, p_result);
+		}
+
+		void Subtract(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, Vector3Stream& p_result) {
+			SubtractStreams(p_lhs, p_rhs, p_result);
+		}
+
+		void Subtract(const Vector4Stream& p_lhs, const Vector4Stream& p_rhs, Vector4Stream& p_result) {
+			SubtractStreams(p_lhs, p_rhs, p_result);
+		}
+
+		void Scale(const Vector3Stream& p_lhs, SCALAR p_rhs, Vector3Stream& p_result) {
+			ScaleStream(p_lhs, p_rhs, p_result);
+		}
+
+		void Scale(const Vector4Stream& p_lhs, SCALAR p_rhs, Vector4Stream& p_result) {
+			ScaleStream(p_lhs, p_rhs, p_result);
+		}
+
+		void Dot(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, SCALAR* p_result) {
+			CheckSizes(p_lhs, p_rhs);
+			DotStreams(p_lhs, p_rhs, false, p_result);
+		}
+
+		void Dot(const Vector4Stream& p_lhs, const Vector4Stream& p_rhs, SCALAR* p_result) {
+			CheckSizes(p_lhs, p_rhs);
+			DotStreams(p_lhs, p_rhs, false, p_result);
+		}
+
+		void Cross(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, Vector3Stream& p_result) {
+			CheckSizes(p_lhs, p_rhs);
+			p_result.Resize(p_lhs.Size());
+
+			const float* lhs[3] = { p_lhs.GetX(), p_lhs.GetY(), p_lhs.GetZ() };
+			const float* rhs[3] = { p_rhs.GetX(), p_rhs.GetY(), p_rhs.GetZ() };
+			float* result[3] = { p_result.GetX(), p_result.GetY(), p_result.GetZ() };
+
+			unsigned int i = 0;
+#if defined(R2_ARCH_X86)
+			if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2) i = AVX2Cross(lhs, rhs, result, p_lhs.Size());
+			else if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::SSE2) i = SSE2Cross(lhs, rhs, result, p_lhs.Size());
+#endif
+			for (; i < p_lhs.Size(); ++i) {
+				Vector3 cross = Math::Cross(p_lhs.Get(i), p_rhs.Get(i));
+				p_result.Set(i, cross);
+			}
+		}
+
+		void Length(const Vector3Stream& p_stream, SCALAR* p_result) {
+			DotStreams(p_stream, p_stream, true, p_result);
+		}
+
+		void Length(const Vector4Stream& p_stream, SCALAR* p_result) {
+			DotStreams(p_stream, p_stream, true, p_result);
+		}
+
+		void LengthSquared(const Vector3Stream& p_stream, SCALAR* p_result) {
+			DotStreams(p_stream, p_stream, false, p_result);
+		}
+
+		void LengthSquared(const Vector4Stream& p_stream, SCALAR* p_result) {
+			DotStreams(p_stream, p_stream, false, p_result);
+		}
+
+		void Normalize(Vector3Stream& p_stream) {
+			NormalizeStream(p_stream);
+		}
+
+		void Normalize(Vector4Stream& p_stream) {
+			NormalizeStream(p_stream);
+		}
+	}
+}
@@ -0,0 +1,325 @@
+/* HEADER
+ *
+ * File: r2-vector-stream.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	Structure-of-arrays containers for large numbers of vectors. Every
+ *	component is stored in its own aligned array, so the bulk operations
+ *	below can process 8 vectors per instruction (AVX2) instead of one.
+ *	Use Load/Store to convert from and to arrays of Vector3/Vector4.
+ *
+ *	Matrix3Stream and Matrix4Stream do the same for matrices, with one
+ *	array per element. They are used by the batched solvers in
+ *	r2-decomposition.hpp.
+ * Depends on:
+ *  * r2::Exception::Argument
+ *  * r2::Math::SIMD
+ *  * Vector3, Vector4
+ *  * Matrix3, Matrix4
+ * Updates:
+ *	2026-10-17 (Rarosu) - Added Matrix3Stream and Matrix4Stream
+ */
+#ifndef R2_VECTOR_STREAM_HPP
+#define R2_VECTOR_STREAM_HPP
+
+#include "r2-math-generic.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+#include "r2-matrix-3.hpp"
+#include "r2-matrix-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		namespace priv {
+			/**
+			 * The storage shared by the vector and matrix streams: one aligned
+			 * allocation, split into an array per component.
+			 */
+			class VectorStreamBase {
+			public:
+				/**
+				 * Get the number of vectors in the stream
+				 */
+				unsigned int Size() const;
+
+				/**
+				 * Change the number of vectors in the stream. Existing vectors are kept,
+				 * new ones are set to zero.
+				 */
+				void Resize(unsigned int p_size);
+
+				/**
+				 * Get the array holding the given component (0 is x) of all vectors.
+				 * The array is aligned to SIMD::K_ALIGNMENT bytes.
+				 */
+				SCALAR* GetComponent(unsigned int p_component);
+				const SCALAR* GetComponent(unsigned int p_component) const;
+
+				/**
+				 * Get the number of components per vector
+				 */
+				unsigned int GetComponentCount() const;
+			protected:
+				VectorStreamBase(unsigned int p_component_count, unsigned int p_size);
+				VectorStreamBase(const VectorStreamBase& p_stream);
+				~VectorStreamBase();
+
+				VectorStreamBase& operator=(const VectorStreamBase& p_stream);
+
+				static const unsigned int K_MAX_COMPONENTS = 16;
+			private:
+				unsigned int m_component_count;
+				unsigned int m_size;
+				unsigned int m_capacity;
+				SCALAR* m_memory;
+				SCALAR* m_components[K_MAX_COMPONENTS];
+
+				void Allocate(unsigned int p_capacity);
+			};
+		}
+
+		class Vector3Stream : public priv::VectorStreamBase {
+		public:
+			/**
+			 * Initialize an empty stream
+			 */
+			Vector3Stream();
+
+			/**
+			 * Initialize a stream of p_size zero vectors
+			 */
+			explicit Vector3Stream(unsigned int p_size);
+
+			/**
+			 * Initialize a stream from an array of p_count vectors
+			 */
+			Vector3Stream(const Vector3* p_vectors, unsigned int p_count);
+
+			/**
+			 * Replace the contents of the stream with an array of p_count vectors
+			 */
+			void Load(const Vector3* p_vectors, unsigned int p_count);
+
+			/**
+			 * Write the stream into an array of at least Size() vectors
+			 */
+			void Store(Vector3* p_vectors) const;
+
+			/**
+			 * Access single vectors
+			 */
+			Vector3 Get(unsigned int p_index) const;
+			void Set(unsigned int p_index, const Vector3& p_vector);
+
+			/**
+			 * Access the component arrays
+			 */
+			SCALAR* GetX();
+			SCALAR* GetY();
+			SCALAR* GetZ();
+			const SCALAR* GetX() const;
+			const SCALAR* GetY() const;
+			const SCALAR* GetZ() const;
+		};
+
+		class Vector4Stream : public priv::VectorStreamBase {
+		public:
+			/**
+			 * Initialize an empty stream
+			 */
+			Vector4Stream();
+
+			/**
+			 * Initialize a stream of p_size zero vectors
+			 */
+			explicit Vector4Stream(unsigned int p_size);
+
+			/**
+			 * Initialize a stream from an array of p_count vectors
+			 */
+			Vector4Stream(const Vector4* p_vectors, unsigned int p_count);
+
+			/**
+			 * Replace the contents of the stream with an array of p_count vectors
+			 */
+			void Load(const Vector4* p_vectors, unsigned int p_count);
+
+			/**
+			 * Write the stream into an array of at least Size() vectors
+			 */
+			void Store(Vector4* p_vectors) const;
+
+			/**
+			 * Access single vectors
+			 */
+			Vector4 Get(unsigned int p_index) const;
+			void Set(unsigned int p_index, const Vector4& p_vector);
+
+			/**
+			 * Access the component arrays
+			 */
+			SCALAR* GetX();
+			SCALAR* GetY();
+			SCALAR* GetZ();
+			SCALAR* GetW();
+			const SCALAR* GetX() const;
+			const SCALAR* GetY() const;
+			const SCALAR* GetZ() const;
+			const SCALAR* GetW() const;
+		};
+
+		class Matrix3Stream : public priv::VectorStreamBase {
+		public:
+			/**
+			 * Initialize an empty stream
+			 */
+			Matrix3Stream();
+
+			/**
+			 * Initialize a stream of p_size zero matrices
+			 */
+			explicit Matrix3Stream(unsigned int p_size);
+
+			/**
+			 * Initialize a stream from an array of p_count matrices
+			 */
+			Matrix3Stream(const Matrix3* p_matrices, unsigned int p_count);
+
+			/**
+			 * Replace the contents of the stream with an array of p_count matrices
+			 */
+			void Load(const Matrix3* p_matrices, unsigned int p_count);
+
+			/**
+			 * Write the stream into an array of at least Size() matrices
+			 */
+			void Store(Matrix3* p_matrices) const;
+
+			/**
+			 * Access single matrices
+			 */
+			Matrix3 Get(unsigned int p_index) const;
+			void Set(unsigned int p_index, const Matrix3& p_matrix);
+
+			/**
+			 * Access the array holding element (p_row, p_col) of all matrices
+			 */
+			SCALAR* GetElement(unsigned int p_row, unsigned int p_col);
+			const SCALAR* GetElement(unsigned int p_row, unsigned int p_col) const;
+		};
+
+		class Matrix4Stream : public priv::VectorStreamBase {
+		public:
+			/**
+			 * Initialize an empty stream
+			 */
+			Matrix4Stream();
+
+			/**
+			 * Initialize a stream of p_size zero matrices
+			 */
+			explicit Matrix4Stream(unsigned int p_size);
+
+			/**
+			 * Initialize a stream from an array of p_count matrices
+			 */
+			Matrix4Stream(const Matrix4* p_matrices, unsigned int p_count);
+
+			/**
+			 * Replace the contents of the stream with an array of p_count matrices
+			 */
+			void Load(const Matrix4* p_matrices, unsigned int p_count);
+
+			/**
+			 * Write the stream into an array of at least Size() matrices
+			 */
+			void Store(Matrix4* p_matrices) const;
+
+			/**
+			 * Access single matrices
+			 */
+			Matrix4 Get(unsigned int p_index) const;
+			void Set(unsigned int p_index, const Matrix4& p_matrix);
+
+			/**
+			 * Access the array holding element (p_row, p_col) of all matrices
+			 */
+			SCALAR* GetElement(unsigned int p_row, unsigned int p_col);
+			const SCALAR* GetElement(unsigned int p_row, unsigned int p_col) const;
+		};
+
+		/**
+		 * Bulk operations. The streams given as operands must be of the same size,
+		 * otherwise an Argument exception is raised. Result streams are resized
+		 * to match and may be the same stream as an operand. Result arrays of
+		 * scalars must hold at least Size() elements.
+		 */
+
+		/**
+		 * p_result[i] = p_lhs[i] + p_rhs[i]
+		 */
+		void Add(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, Vector3Stream& p_result);
+		void Add(const Vector4Stream& p_lhs, const Vector4Stream& p_rhs, Vector4Stream& p_result);
+
+		/**
+		 * p_result[i] = p_lhs[i] - p_rhs[i]
+		 */
+		void Subtract(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, Vector3Stream& p_result);
+		void Subtract(const Vector4Stream& p_lhs, const Vector4Stream& p_rhs, Vector4Stream& p_result);
+
+		/**
+		 * p_result[i] = p_lhs[i] * p_rhs
+		 */
+		void Scale(const Vector3Stream& p_lhs, SCALAR p_rhs, Vector3Stream& p_result);
+		void Scale(const Vector4Stream& p_lhs, SCALAR p_rhs, Vector4Stream& p_result);
+
+		/**
+		 * p_result[i] = Dot(p_lhs[i], p_rhs[i])
+		 */
+		void Dot(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, SCALAR* p_result);
+		void Dot(const Vector4Stream& p_lhs, const Vector4Stream& p_rhs, SCALAR* p_result);
+
+		/**
+		 * p_result[i] = Cross(p_lhs[i], p_rhs[i])
+		 */
+		void Cross(const Vector3Stream& p_lhs, const Vector3Stream& p_rhs, Vector3Stream& p_result);
+
+		/**
+		 * p_result[i] = Length(p_stream[i])
+		 */
+		void Length(const Vector3Stream& p_stream, SCALAR* p_result);
+		void Length(const Vector4Stream& p_stream, SCALAR* p_result);
+
+		/**
+		 * p_result[i] = LengthSquared(p_stream[i])
+		 */
+		void LengthSquared(const Vector3Stream& p_stream, SCALAR* p_result);
+		void LengthSquared(const Vector4Stream& p_stream, SCALAR* p_result);
+
+		/**
+		 * Normalize every vector in the stream
+		 */
+		void Normalize(Vector3Stream& p_stream);
+		void Normalize(Vector4Stream& p_stream);
+	}
+}
+
+#endif
@@ -0,0 +1,493 @@
+/* HEADER
+ *
+ * File: r2-vector.hpp
+ * Created by: Lars Woxberg (Rarosu)
+ * Created on: October 17, 2026
+ *
+ * License:
+ *   Copyright (C) 2010 Lars Woxberg
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Comments:
+ *	A mathematical vector of N components of any scalar type, for when
+ *	Vector2/3/4 (which are fixed to SCALAR) are not enough - e.g. double
+ *	precision simulation or compact integer storage. All loops run over
+ *	the compile time size and are unrolled, so the compiler sees straight
+ *	line code for every dimension.
+ *
+ *	Vector<2>, Vector<3> and Vector<4> convert explicitly to and from
+ *	Vector2, Vector3 and Vector4.
+ * Depends on:
+ *  * SCALAR
+ *  * FloatCompare
+ *  * Vector2, Vector3, Vector4
+ * Updates:
+ *
+ */
+#ifndef R2_VECTOR_HPP
+#define R2_VECTOR_HPP
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+#include "r2-math-generic.hpp"
+#include "r2-vector-2.hpp"
+#include "r2-vector-3.hpp"
+#include "r2-vector-4.hpp"
+
+namespace r2 {
+	namespace Math {
+		namespace priv {
+			/**
+			 * Call p_function(i) for every i in [I, N), unrolled at compile time.
+			 */
+			template <unsigned int I, unsigned int N>
+			struct Unroll {
+				template <typename Function>
+				static inline void Apply(Function& p_function) {
+					p_function(I);
+					Unroll<I + 1, N>::Apply(p_function);
+				}
+			};
+
+			template <unsigned int N>
+			struct Unroll<N, N> {
+				template <typename Function>
+				static inline void Apply(Function&) {}
+			};
+
+			/**
+			 * Compare scalars - with a tolerance for floating point types.
+			 */
+			template <typename T>
+			inline bool ScalarEquals(T p_lhs, T p_rhs) { return p_lhs == p_rhs; }
+			inline bool ScalarEquals(float p_lhs, float p_rhs) { return FloatCompare(p_lhs, p_rhs); }
+			inline bool ScalarEquals(double p_lhs, double p_rhs) { return FloatCompare(p_lhs, p_rhs); }
+		}
+
+		template <unsigned int N, typename T = SCALAR>
+		class Vector {
+		public:
+			static const unsigned int K_DIMENSIONS = N;
+
+			/**
+			 * Initialize the zero vector
+			 */
+			Vector();
+
+			/**
+			 * Initialize a vector with all components set to p_value
+			 */
+			explicit Vector(T p_value);
+
+			/**
+			 * Initialize a vector from its components. Only available for the matching N.
+			 */
+			Vector(T p_x, T p_y);
+			Vector(T p_x, T p_y, T p_z);
+			Vector(T p_x, T p_y, T p_z, T p_w);
+
+			/**
+			 * Initialize a vector from an array of at least N scalars.
+			 */
+			explicit Vector(const T* p_raw_data);
+
+			/**
+			 * Convert from a vector of another scalar type
+			 */
+			template <typename U>
+			explicit Vector(const Vector<N, U>& p_vector);
+
+			/**
+			 * Convert from and to the fixed size vectors. Only available for the matching N.
+			 */
+			explicit Vector(const Vector2& p_vector);
+			explicit Vector(const Vector3& p_vector);
+			explicit Vector(const Vector4& p_vector);
+			explicit operator Vector2() const;
+			explicit operator Vector3() const;
+			explicit operator Vector4() const;
+
+
+			/**
+			 * Operators
+			 */
+			T& operator[](unsigned int p_index);
+			T operator[](unsigned int p_index) const;
+			Vector operator-() const;
+			Vector& operator+=(const Vector& p_rhs);
+			Vector& operator-=(const Vector& p_rhs);
+			Vector& operator*=(T p_rhs);
+			Vector& operator/=(T p_rhs);
+
+			/**
+			 * Calculate the dot product
+			 */
+			T Dot(const Vector& p_rhs) const;
+
+			/**
+			 * Calculate the length (magnitude) of the vector
+			 */
+			T Length() const;
+
+			/**
+			 * Calculate the square of the length (magnitude) of the vector
+			 */
+			T LengthSquared() const;
+
+			/**
+			 * Normalize the vector and return this
+			 */
+			Vector& Normalize();
+
+
+			/**
+			 * The components of the vector
+			 */
+			T m_data[N];
+		};
+
+		typedef Vector<2, double> Vector2d;
+		typedef Vector<3, double> Vector3d;
+		typedef Vector<4, double> Vector4d;
+
+		/**
+		 * Operators
+		 */
+		template <unsigned int N, typename T> Vector<N, T> operator+(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs);
+		template <unsigned int N, typename T> Vector<N, T> operator-(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs);
+		template <unsigned int N, typename T> Vector<N, T> operator*(const Vector<N, T>& p_lhs, T p_rhs);
+		template <unsigned int N, typename T> Vector<N, T> operator*(T p_lhs, const Vector<N, T>& p_rhs);
+		template <unsigned int N, typename T> Vector<N, T> operator/(const Vector<N, T>& p_lhs, T p_rhs);
+		template <unsigned int N, typename T> bool operator==(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs);
+		template <unsigned int N, typename T> bool operator!=(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs);
+		template <unsigned int N, typename T> std::ostream& operator<<(std::ostream& p_lhs, const Vector<N, T>& p_rhs);
+
+		/**
+		 * Calculate the dot product
+		 */
+		template <unsigned int N, typename T> T Dot(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs);
+
+		/**
+		 * Calculate the cross product of two 3 dimensional vectors
+		 */
+		template <typename T> Vector<3, T> Cross(const Vector<3, T>& p_lhs, const Vector<3, T>& p_rhs);
+
+		/**
+		 * Calculate the length (magnitude) of the vector
+		 */
+		template <unsigned int N, typename T> T Length(const Vector<N, T>& p_vector);
+
+		/**
+		 * Calculate the square of the length (magnitude) of the vector
+		 */
+		template <unsigned int N, typename T> T LengthSquared(const Vector<N, T>& p_vector);
+
+		/**
+		 * Get a normalized version of the vector
+		 */
+		template <unsigned int N, typename T> Vector<N, T> GetNormalized(const Vector<N, T>& p_vector);
+
+
+
+		/**
+		 * IMPLEMENTATION
+		 */
+		namespace priv {
+			template <typename T>
+			struct Fill {
+				T* m_data; T m_value;
+				inline void operator()(unsigned int i) { m_data[i] = m_value; }
+			};
+
+			template <typename T, typename U>
+			struct Copy {
+				T* m_data; const U* m_source;
+				inline void operator()(unsigned int i) { m_data[i] = static_cast<T>(m_source[i]); }
+			};
+
+			template <typename T>
+			struct Add {
+				T* m_data; const T* m_rhs;
+				inline void operator()(unsigned int i) { m_data[i] += m_rhs[i]; }
+			};
+
+			template <typename T>
+			struct Subtract {
+				T* m_data; const T* m_rhs;
+				inline void operator()(unsigned int i) { m_data[i] -= m_rhs[i]; }
+			};
+
+			template <typename T>
+			struct Scale {
+				T* m_data; T m_rhs;
+				inline void operator()(unsigned int i) { m_data[i] *= m_rhs; }
+			};
+
+			template <typename T>
+			struct Divide {
+				T* m_data; T m_rhs;
+				inline void operator()(unsigned int i) { m_data[i] /= m_rhs; }
+			};
+
+			template <typename T>
+			struct DotProduct {
+				const T* m_lhs; const T* m_rhs; T m_sum;
+				inline void operator()(unsigned int i) { m_sum += m_lhs[i] * m_rhs[i]; }
+			};
+
+			template <typename T>
+			struct Equals {
+				const T* m_lhs; const T* m_rhs; bool m_equal;
+				inline void operator()(unsigned int i) { m_equal = m_equal && ScalarEquals(m_lhs[i], m_rhs[i]); }
+			};
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector() {
+			priv::Fill<T> fill = { m_data, T(0) };
+			priv::Unroll<0, N>::Apply(fill);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(T p_value) {
+			priv::Fill<T> fill = { m_data, p_value };
+			priv::Unroll<0, N>::Apply(fill);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(T p_x, T p_y) {
+			static_assert(N == 2, "Vector(x, y) requires a 2 dimensional vector");
+			m_data[0] = p_x;
+			m_data[1] = p_y;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(T p_x, T p_y, T p_z) {
+			static_assert(N == 3, "Vector(x, y, z) requires a 3 dimensional vector");
+			m_data[0] = p_x;
+			m_data[1] = p_y;
+			m_data[2] = p_z;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(T p_x, T p_y, T p_z, T p_w) {
+			static_assert(N == 4, "Vector(x, y, z, w) requires a 4 dimensional vector");
+			m_data[0] = p_x;
+			m_data[1] = p_y;
+			m_data[2] = p_z;
+			m_data[3] = p_w;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(const T* p_raw_data) {
+			priv::Copy<T, T> copy = { m_data, p_raw_data };
+			priv::Unroll<0, N>::Apply(copy);
+		}
+
+		template <unsigned int N, typename T>
+		template <typename U>
+		Vector<N, T>::Vector(const Vector<N, U>& p_vector) {
+			priv::Copy<T, U> copy = { m_data, p_vector.m_data };
+			priv::Unroll<0, N>::Apply(copy);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(const Vector2& p_vector) {
+			static_assert(N == 2, "Only a 2 dimensional vector converts from Vector2");
+			priv::Copy<T, SCALAR> copy = { m_data, p_vector.m_data };
+			priv::Unroll<0, N>::Apply(copy);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(const Vector3& p_vector) {
+			static_assert(N == 3, "Only a 3 dimensional vector converts from Vector3");
+			priv::Copy<T, SCALAR> copy = { m_data, p_vector.m_data };
+			priv::Unroll<0, N>::Apply(copy);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::Vector(const Vector4& p_vector) {
+			static_assert(N == 4, "Only a 4 dimensional vector converts from Vector4");
+			priv::Copy<T, SCALAR> copy = { m_data, p_vector.m_data };
+			priv::Unroll<0, N>::Apply(copy);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::operator Vector2() const {
+			static_assert(N == 2, "Only a 2 dimensional vector converts to Vector2");
+			return Vector2(static_cast<SCALAR>(m_data[0]), static_cast<SCALAR>(m_data[1]));
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::operator Vector3() const {
+			static_assert(N == 3, "Only a 3 dimensional vector converts to Vector3");
+			return Vector3(static_cast<SCALAR>(m_data[0]), static_cast<SCALAR>(m_data[1]), static_cast<SCALAR>(m_data[2]));
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>::operator Vector4() const {
+			static_assert(N == 4, "Only a 4 dimensional vector converts to Vector4");
+			return Vector4(static_cast<SCALAR>(m_data[0]), static_cast<SCALAR>(m_data[1]), static_cast<SCALAR>(m_data[2]), static_cast<SCALAR>(m_data[3]));
+		}
+
+		template <unsigned int N, typename T>
+		T& Vector<N, T>::operator[](unsigned int p_index) {
+			return m_data[p_index];
+		}
+
+		template <unsigned int N, typename T>
+		T Vector<N, T>::operator[](unsigned int p_index) const {
+			return m_data[p_index];
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T> Vector<N, T>::operator-() const {
+			return Vector(*this) *= T(-1);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>& Vector<N, T>::operator+=(const Vector& p_rhs) {
+			priv::Add<T> add = { m_data, p_rhs.m_data };
+			priv::Unroll<0, N>::Apply(add);
+			return *this;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>& Vector<N, T>::operator-=(const Vector& p_rhs) {
+			priv::Subtract<T> subtract = { m_data, p_rhs.m_data };
+			priv::Unroll<0, N>::Apply(subtract);
+			return *this;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>& Vector<N, T>::operator*=(T p_rhs) {
+			priv::Scale<T> scale = { m_data, p_rhs };
+			priv::Unroll<0, N>::Apply(scale);
+			return *this;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>& Vector<N, T>::operator/=(T p_rhs) {
+			// one division and N multiplications, unless the reciprocal truncates
+			if constexpr (std::is_floating_point<T>::value) return *this *= (T(1) / p_rhs);
+
+			priv::Divide<T> divide = { m_data, p_rhs };
+			priv::Unroll<0, N>::Apply(divide);
+			return *this;
+		}
+
+		template <unsigned int N, typename T>
+		T Vector<N, T>::Dot(const Vector& p_rhs) const {
+			priv::DotProduct<T> dot = { m_data, p_rhs.m_data, T(0) };
+			priv::Unroll<0, N>::Apply(dot);
+			return dot.m_sum;
+		}
+
+		template <unsigned int N, typename T>
+		T Vector<N, T>::Length() const {
+			return static_cast<T>(std::sqrt(LengthSquared()));
+		}
+
+		template <unsigned int N, typename T>
+		T Vector<N, T>::LengthSquared() const {
+			return Dot(*this);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T>& Vector<N, T>::Normalize() {
+			return *this /= Length();
+		}
+
+
+
+		template <unsigned int N, typename T>
+		Vector<N, T> operator+(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs) {
+			return (Vector<N, T>(p_lhs) += p_rhs);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T> operator-(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs) {
+			return (Vector<N, T>(p_lhs) -= p_rhs);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T> operator*(const Vector<N, T>& p_lhs, T p_rhs) {
+			return (Vector<N, T>(p_lhs) *= p_rhs);
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T> operator*(T p_lhs, const Vector<N, T>& p_rhs) {
+			return p_rhs * p_lhs;
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T> operator/(const Vector<N, T>& p_lhs, T p_rhs) {
+			return (Vector<N, T>(p_lhs) /= p_rhs);
+		}
+
+		template <unsigned int N, typename T>
+		bool operator==(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs) {
+			priv::Equals<T> equals = { p_lhs.m_data, p_rhs.m_data, true };
+			priv::Unroll<0, N>::Apply(equals);
+			return equals.m_equal;
+		}
+
+		template <unsigned int N, typename T>
+		bool operator!=(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs) {
+			return !(p_lhs == p_rhs);
+		}
+
+		template <unsigned int N, typename T>
+		std::ostream& operator<<(std::ostream& p_lhs, const Vector<N, T>& p_rhs) {
+			p_lhs << "(";
+			for (unsigned int i = 0; i < N; ++i) {
+				p_lhs << p_rhs.m_data[i];
+				if (i != N - 1) p_lhs << ", ";
+			}
+
+			return p_lhs << ")";
+		}
+
+		template <unsigned int N, typename T>
+		T Dot(const Vector<N, T>& p_lhs, const Vector<N, T>& p_rhs) {
+			return p_lhs.Dot(p_rhs);
+		}
+
+		template <typename T>
+		Vector<3, T> Cross(const Vector<3, T>& p_lhs, const Vector<3, T>& p_rhs) {
+			return Vector<3, T>(p_lhs.m_data[1] * p_rhs.m_data[2] - p_lhs.m_data[2] * p_rhs.m_data[1],
+								p_lhs.m_data[2] * p_rhs.m_data[0] - p_lhs.m_data[0] * p_rhs.m_data[2],
+								p_lhs.m_data[0] * p_rhs.m_data[1] - p_lhs.m_data[1] * p_rhs.m_data[0]);
+		}
+
+		template <unsigned int N, typename T>
+		T Length(const Vector<N, T>& p_vector) {
+			return p_vector.Length();
+		}
+
+		template <unsigned int N, typename T>
+		T LengthSquared(const Vector<N, T>& p_vector) {
+			return p_vector.LengthSquared();
+		}
+
+		template <unsigned int N, typename T>
+		Vector<N, T> GetNormalized(const Vector<N, T>& p_vector) {
+			return Vector<N, T>(p_vector).Normalize();
+		}
+	}
+}
+
+#endif
@@ -5,9 +5,18 @@
 #include <vector>
 #include <cstdio>
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include "r2-exception.hpp"
 #include "r2-assert.hpp"
 #include "r2-math.hpp"
+#include "r2-matrix-4.hpp"
+#include "r2-matrix.hpp"
+#include "r2-affine-transform.hpp"
+#include "r2-decomposition.hpp"
+#include "r2-simd.hpp"
+#include "r2-random.hpp"
+#include "r2-fast-math.hpp"
 #include "r2-argument-parser.hpp"
 #include "r2-data-types.hpp"
 #include "r2-serialize.hpp"
@@ -166,6 +175,214 @@ int main(int p_argc, char* p_argv[])
 	std::cout << "Math Test Passed" << std::endl;
 	
 	
+	// singular values of [s s 0; 0 s 0; 0 0 s] are (golden ratio, 1, 1 / golden ratio) * s at any scale
+	const float scales[] = { 1e-30f, 1e-12f, 1.0f, 1e10f, 1e30f };
+	for (int i = 0; i < 5; ++i) {
+		const float s = scales[i];
+		r2::Math::Matrix3 matrix(s, s, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, s);
+		
+		r2::Math::SingularValueDecomposition3 svd(matrix);
+		r2::Math::PolarDecomposition3 polar(matrix);
+		const r2::Math::Vector3& values = svd.GetSingularValues();
+		r2AssertM(r2::Math::FloatCompare(values.x / s, 1.618034f) && r2::Math::FloatCompare(values.y / s, 1.0f) && r2::Math::FloatCompare(values.z / s, 0.618034f), "Scaled singular value decomposition failed");
+		r2AssertM(r2::Math::FloatCompare(polar.GetRotation().m_elements[0][0], 0.894427f), "Scaled polar decomposition failed");
+		
+		r2::Math::Matrix3 stream_matrices[8];
+		for (int k = 0; k < 8; ++k) stream_matrices[k] = matrix;
+		r2::Math::Matrix3Stream stream(stream_matrices, 8);
+		r2::Math::Matrix3Stream u;
+		r2::Math::Matrix3Stream v;
+		r2::Math::Vector3Stream stream_values;
+		r2::Math::SingularValueDecompose(stream, u, stream_values, v);
+		r2AssertM(r2::Math::FloatCompare(stream_values.Get(7).x / s, 1.618034f) && r2::Math::FloatCompare(stream_values.Get(7).z / s, 0.618034f), "Scaled batched singular value decomposition failed");
+		
+		r2::Math::EigenDecomposition3 eigen(r2::Math::Matrix3(2.0f * s, s, 0.0f, s, 3.0f * s, 0.0f, 0.0f, 0.0f, s));
+		r2AssertM(r2::Math::FloatCompare(eigen.GetEigenvalues().x / s, 3.618034f) && r2::Math::FloatCompare(eigen.GetEigenvalues().z / s, 1.0f), "Scaled eigen decomposition failed");
+	}
+	
+	std::cout << "Scaled Decomposition Test Passed" << std::endl;
+	
+	
+	// 1e-6 * I is only small, not singular, while a rank deficient matrix is singular at any scale
+	const r2::Math::Matrix3 small_identity(1e-6f);
+	const r2::Math::Matrix3 rank_deficient(1.0f, 2.0f, 3.0f, 2.0f, 4.0f, 6.0f, 1.0f, 0.0f, 1.0f);
+	const r2::Math::Vector3 small_rhs(1e-6f, 2e-6f, 3e-6f);
+	
+	r2::Math::Vector3 small_solutions[3] = {
+		r2::Math::LUDecomposition3(small_identity).Solve(small_rhs),
+		r2::Math::QRDecomposition3(small_identity).Solve(small_rhs),
+		r2::Math::Solve(small_identity, small_rhs)
+	};
+	for (int i = 0; i < 3; ++i) {
+		r2AssertM(r2::Math::FloatCompare(small_solutions[i].x, 1.0f) && r2::Math::FloatCompare(small_solutions[i].y, 2.0f) && r2::Math::FloatCompare(small_solutions[i].z, 3.0f), "Solving a small but regular system failed");
+	}
+	
+	bool singular_thrown = false;
+	try { r2::Math::LUDecomposition3 lu(rank_deficient); } catch (r2::Exception::DivisionByZero&) { singular_thrown = true; }
+	r2AssertM(singular_thrown, "Singular LU decomposition did not throw");
+	singular_thrown = false;
+	try { r2::Math::QRDecomposition3(rank_deficient).Solve(small_rhs); } catch (r2::Exception::DivisionByZero&) { singular_thrown = true; }
+	r2AssertM(singular_thrown, "Singular QR solve did not throw");
+	singular_thrown = false;
+	try { r2::Math::Solve(rank_deficient, small_rhs); } catch (r2::Exception::DivisionByZero&) { singular_thrown = true; }
+	r2AssertM(singular_thrown, "Singular solve did not throw");
+	
+	const r2::Math::SIMD::InstructionSet::InstructionSet supported_set = r2::Math::SIMD::GetInstructionSet();
+	const r2::Math::SIMD::InstructionSet::InstructionSet instruction_sets[] = { r2::Math::SIMD::InstructionSet::Scalar, r2::Math::SIMD::InstructionSet::SSE2, r2::Math::SIMD::InstructionSet::AVX2 };
+	for (int i = 0; i < 3; ++i) {
+		if (instruction_sets[i] > supported_set) continue;
+		r2::Math::SIMD::SetInstructionSet(instruction_sets[i]);
+		
+		r2::Math::Matrix3 system_matrices[16];
+		r2::Math::Vector3 system_rhs[16];
+		for (int k = 0; k < 16; ++k) {
+			system_matrices[k] = small_identity;
+			system_rhs[k] = small_rhs;
+		}
+		r2::Math::Matrix3Stream matrix_stream(system_matrices, 16);
+		r2::Math::Vector3Stream rhs_stream(system_rhs, 16);
+		r2::Math::Vector3Stream solution_stream;
+		r2::Math::Solve(matrix_stream, rhs_stream, solution_stream);
+		r2AssertM(r2::Math::FloatCompare(solution_stream.Get(0).x, 1.0f) && r2::Math::FloatCompare(solution_stream.Get(15).z, 3.0f), "Batched solve of small but regular systems failed");
+		
+		matrix_stream.Set(5, rank_deficient);
+		singular_thrown = false;
+		try { r2::Math::Solve(matrix_stream, rhs_stream, solution_stream); } catch (r2::Exception::DivisionByZero&) { singular_thrown = true; }
+		r2AssertM(singular_thrown, "Batched singular solve did not throw");
+		r2AssertM(solution_stream.Get(5).x == 0.0f && r2::Math::FloatCompare(solution_stream.Get(4).y, 2.0f), "Batched singular solve did not zero only the singular system");
+	}
+	r2::Math::SIMD::SetInstructionSet(supported_set);
+	
+	std::cout << "Small Pivot Test Passed" << std::endl;
+	
+	
+	// at 10 the float spacing is coarse enough for p_min + u * (p_max - p_min) to round up to p_max
+	std::vector<float> draws(1 << 20);
+	for (int i = 0; i < 3; ++i) {
+		if (instruction_sets[i] > supported_set) continue;
+		r2::Math::SIMD::SetInstructionSet(instruction_sets[i]);
+		
+		r2::Math::Random random(i);
+		for (int batch = 0; batch < 4; ++batch) {
+			random.Uniform(&draws[0], (unsigned int)draws.size(), 10.0f, 11.0f);
+			r2AssertM(*std::max_element(draws.begin(), draws.end()) < 11.0f && *std::min_element(draws.begin(), draws.end()) >= 10.0f, "Bulk uniform draw left [p_min, p_max)");
+		}
+		for (int k = 0; k < (1 << 20); ++k) {
+			float draw;
+			random.Uniform(&draw, 1, 10.0f, 11.0f);
+			r2AssertM(draw < 11.0f && draw >= 10.0f, "Single uniform draw left [p_min, p_max)");
+		}
+	}
+	r2::Math::SIMD::SetInstructionSet(supported_set);
+	
+	std::cout << "Uniform Range Test Passed" << std::endl;
+	
+	
+	// denormals give 0 or infinity, FLT_MIN is still accurate and infinity gives infinity or 0
+	const float sqrt_inputs[3] = { 1e-39f, FLT_MIN, INFINITY };
+	const float sqrt_expected[3] = { 0.0f, 1.0842022e-19f, INFINITY };
+	const float inverse_sqrt_expected[3] = { INFINITY, 9.2233720e18f, 0.0f };
+	for (int i = 0; i < 3; ++i) {
+		if (instruction_sets[i] > supported_set) continue;
+		r2::Math::SIMD::SetInstructionSet(instruction_sets[i]);
+		
+		// enough elements for whole SIMD blocks and a remainder
+		float inputs[19];
+		float sqrt_results[19];
+		float inverse_sqrt_results[19];
+		for (int k = 0; k < 19; ++k) inputs[k] = sqrt_inputs[k % 3];
+		r2::Math::Fast::Sqrt(inputs, sqrt_results, 19);
+		r2::Math::Fast::InverseSqrt(inputs, inverse_sqrt_results, 19);
+		
+		for (int k = 0; k < 19; ++k) {
+			const float scalar_results[2] = { r2::Math::Fast::Sqrt(inputs[k]), r2::Math::Fast::InverseSqrt(inputs[k]) };
+			const float array_results[2] = { sqrt_results[k], inverse_sqrt_results[k] };
+			const float expected[2] = { sqrt_expected[k % 3], inverse_sqrt_expected[k % 3] };
+			for (int f = 0; f < 2; ++f) {
+				const bool exact = (expected[f] == 0.0f || std::isinf(expected[f]));
+				r2AssertM(exact ? scalar_results[f] == expected[f] : r2::Math::FloatCompare(scalar_results[f] / expected[f], 1.0f), "Fast square root of an extreme value failed");
+				r2AssertM(exact ? array_results[f] == expected[f] : r2::Math::FloatCompare(array_results[f] / expected[f], 1.0f), "Fast square root array of extreme values failed");
+			}
+		}
+	}
+	r2::Math::SIMD::SetInstructionSet(supported_set);
+	
+	std::cout << "Fast Square Root Test Passed" << std::endl;
+	
+	
+	// integer elements are divided, with C++ truncation, instead of multiplied by a reciprocal of 0
+	r2::Math::Vector<3, int> integer_vector(10, 20, 30);
+	const r2::Math::Vector<3, int> integer_quotient = r2::Math::Vector<3, int>(7, -7, 9) / 2;
+	integer_vector /= 5;
+	r2AssertM(integer_vector.m_data[0] == 2 && integer_vector.m_data[1] == 4 && integer_vector.m_data[2] == 6, "Integer vector /= failed");
+	r2AssertM(integer_quotient.m_data[0] == 3 && integer_quotient.m_data[1] == -3 && integer_quotient.m_data[2] == 4, "Integer vector / failed");
+	
+	const int integer_elements[6] = { 10, 20, 30, -7, 7, 9 };
+	r2::Math::Matrix<2, 3, int> integer_matrix(integer_elements);
+	const r2::Math::Matrix<2, 3, int> integer_matrix_quotient = integer_matrix / 2;
+	integer_matrix /= 5;
+	const int expected_matrix[6] = { 2, 4, 6, -1, 1, 1 };
+	const int expected_matrix_quotient[6] = { 5, 10, 15, -3, 3, 4 };
+	for (int i = 0; i < 6; ++i) {
+		r2AssertM(integer_matrix.m_data[i] == expected_matrix[i], "Integer matrix /= failed");
+		r2AssertM(integer_matrix_quotient.m_data[i] == expected_matrix_quotient[i], "Integer matrix / failed");
+	}
+	
+	std::cout << "Integer Division Test Passed" << std::endl;
+	
+	
+	// rigid transforms uniformly scaled by s invert through all three paths, however small s is
+	const float inverse_scales[] = { 1.0f, 0.02f, 1e-3f };
+	for (int i = 0; i < 3; ++i) {
+		const float s = inverse_scales[i];
+		const float c = 0.866025f * s;
+		const float n = 0.5f * s;
+		r2::Math::Matrix4 transform(c, -n, 0.0f, 5.0f,
+									n, c, 0.0f, -3.0f,
+									0.0f, 0.0f, s, 2.0f,
+									0.0f, 0.0f, 0.0f, 1.0f);
+		
+		r2::Math::Matrix4 inverse = r2::Math::Matrix4(transform).Invert();
+		r2::Math::Matrix4 affine_inverse = r2::Math::Matrix4(transform).InvertAffine();
+		r2::Math::Matrix4 identity = inverse * transform;
+		r2::Math::Matrix4 affine_identity = affine_inverse * transform;
+		for (int row = 0; row < 4; ++row) {
+			for (int col = 0; col < 4; ++col) {
+				const float expected = (row == col) ? 1.0f : 0.0f;
+				r2AssertM(r2::Math::FloatCompare(identity.m_elements[row][col], expected, 1e-4f), "Scaled Matrix4 inverse failed");
+				r2AssertM(r2::Math::FloatCompare(affine_identity.m_elements[row][col], expected, 1e-4f), "Scaled Matrix4 affine inverse failed");
+			}
+		}
+		
+		r2::Math::AffineTransform transform_inverse = r2::Math::AffineTransform(transform).Invert();
+		for (int e = 0; e < 12; ++e) {
+			r2AssertM(r2::Math::FloatCompare(transform_inverse.m_data[e], inverse.m_data[e], 1e-4f / s), "Scaled AffineTransform inverse failed");
+		}
+		
+		if (s == 1.0f) {
+			r2::Math::Matrix4 orthonormal_inverse = r2::Math::Matrix4(transform).InvertOrthonormal();
+			for (int e = 0; e < 16; ++e) {
+				r2AssertM(r2::Math::FloatCompare(orthonormal_inverse.m_data[e], inverse.m_data[e], 1e-4f), "Matrix4 orthonormal inverse failed");
+			}
+		}
+		
+		// the same transform with its x axis flattened onto its y axis
+		r2::Math::Matrix4 singular(transform);
+		for (int row = 0; row < 3; ++row) singular.m_elements[row][0] = singular.m_elements[row][1];
+		bool thrown = false;
+		try { singular.Invert(); } catch (r2::Exception::DivisionByZero&) { thrown = true; }
+		r2AssertM(thrown, "Singular Matrix4 was inverted");
+		thrown = false;
+		try { singular.InvertAffine(); } catch (r2::Exception::DivisionByZero&) { thrown = true; }
+		r2AssertM(thrown, "Singular Matrix4 was inverted as affine");
+		thrown = false;
+		try { r2::Math::AffineTransform(singular).Invert(); } catch (r2::Exception::DivisionByZero&) { thrown = true; }
+		r2AssertM(thrown, "Singular AffineTransform was inverted");
+	}
+	
+	std::cout << "Scaled Inverse Test Passed" << std::endl;
+	
+	
 	std::cout << "sizeof(r2::Byte): " << sizeof(r2::Byte) << std::endl;
 	
 	std::cout << "sizeof(r2::SInt8): " << sizeof(r2::SInt8) << std::endl;